@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench.hh"
+//
+#include "IR/binary_module.hh"
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+#include "IR/lazy_module.hh"
+
+/**
+ * @brief Startup cost of the module: building it by IRBuilder vs loading the
+ *        binary image (mmap + validation, then first walk over it) vs
+ *        decoding the image back into pointer based functions vs lazy
+ *        module, which decodes bodies on the first access only
+ *
+ *        usage: binary_module_bench [funcs_num] [instrs_per_func]
+ */
+namespace {
+
+using namespace jj_vm::ir;
+using FunctionList = std::vector<std::unique_ptr<Function>>;
+
+FunctionList build_funcs(std::size_t funcs_num, std::size_t instrs_per_func) {
+    FunctionList funcs{};
+    IRBuilder builder{};
+    for (std::size_t f = 0; f < funcs_num; ++f) {
+        auto func = std::make_unique<Function>(Type::create<TypeId::I64>(),
+                                               "f" + std::to_string(f));
+        auto* arg = func->create<Param, Type>(TypeId::I64);
+        auto* bb0 = func->create<BasicBlock>();
+        auto* bb1 = func->create<BasicBlock>();
+        auto* bb2 = func->create<BasicBlock>();
+        auto* bb3 = func->create<BasicBlock>();
+        //
+        builder.set_insert_point(bb0);
+        auto* one = builder.create<ConstI64>(1);
+        builder.create<BranchInstr>(bb1);
+        //
+        builder.set_insert_point(bb1);
+        auto* cnt = builder.create<PhiInstr>(TypeId::I64);
+        auto* acc = builder.create<PhiInstr>(TypeId::I64);
+        auto* cond = builder.create<BinInstr>(Opcode::LE, cnt, arg);
+        builder.create<IfInstr>(bb2, bb3, cond);
+        //
+        builder.set_insert_point(bb2);
+        auto* next = builder.create<BinInstr>(Opcode::ADD, cnt, one);
+        Instr* prev = acc;
+        for (std::size_t i = 0; i < instrs_per_func; ++i)
+            prev = builder.create<BinInstr>(i % 2 ? Opcode::MUL : Opcode::XOR,
+                                            prev, next);
+        builder.create<BranchInstr>(bb1);
+        //
+        builder.set_insert_point(bb3);
+        builder.create<RetInstr>(acc);
+        //
+        cnt->add_node({one, bb0});
+        cnt->add_node({next, bb2});
+        acc->add_node({one, bb0});
+        acc->add_node({prev, bb2});
+        func->renumber();
+        funcs.push_back(std::move(func));
+    }
+    return funcs;
+}
+
+//! NOTE: result is destroyed out of the measurement
+template <typename Fn>
+double measure_alive_ms(Fn&& fn) {
+    double best = std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i < 5; ++i) {
+        decltype(fn()) result{};
+        best = std::min(best,
+                        jj_vm::bench::measure_ms([&] { result = fn(); }, 1));
+    }
+    return best;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto funcs_num = jj_vm::bench::arg_or(argc, argv, 1, 100);
+    auto instrs_per_func = jj_vm::bench::arg_or(argc, argv, 2, 1'000);
+    //
+    auto path =
+        std::filesystem::temp_directory_path() / "jj_vm_binary_module_bench.bin";
+    {
+        compact::ModuleWriter writer{};
+        for (auto&& func : build_funcs(funcs_num, instrs_per_func))
+            writer.add(*func);
+        writer.write(path);
+    }
+    auto image_size = compact::ModuleImage::load(path).image_size();
+    std::printf("%zu functions x %zu instrs, image %.1f KB\n", funcs_num,
+                instrs_per_func, image_size / 1024.0);
+
+    jj_vm::bench::report("IRBuilder", measure_alive_ms([&] {
+                             return build_funcs(funcs_num, instrs_per_func);
+                         }));
+    jj_vm::bench::report("load image (mmap + validate)", measure_alive_ms([&] {
+                             return std::make_unique<compact::ModuleImage>(
+                                 compact::ModuleImage::load(path));
+                         }));
+    jj_vm::bench::report(
+        "load image + walk instrs", measure_alive_ms([&] {
+            auto image = std::make_unique<compact::ModuleImage>(
+                compact::ModuleImage::load(path));
+            std::size_t sum = 0;
+            for (auto&& func : *image)
+                for (std::size_t i = 0; i < func.blocks_num(); ++i)
+                    for (auto it = func.front(compact::BlockHandle(i)); it;
+                         it = func.next(it))
+                        for (auto input : func.inputs(it)) sum += input.idx();
+            jj_vm::bench::do_not_optimize(sum);
+            return image;
+        }));
+    jj_vm::bench::report("load image + decode to Function",
+                         measure_alive_ms([&] {
+                             return compact::decode(
+                                 compact::ModuleImage::load(path));
+                         }));
+    jj_vm::bench::report("lazy module (headers only)", measure_alive_ms([&] {
+                             return std::make_unique<compact::LazyModule>(path);
+                         }));
+
+    //! NOTE: typical startup calls a few functions of the module
+    compact::LazyModule lazy{path};
+    auto touched = jj_vm::bench::measure_ms(
+        [&] {
+            for (std::size_t i = 0; i < lazy.size(); i += 10)
+                jj_vm::bench::do_not_optimize(lazy[i].size());
+        },
+        1);
+    jj_vm::bench::report("lazy module: touch every 10th body", touched,
+                         std::to_string(lazy.materialized_num()) +
+                             " materialized, " +
+                             std::to_string(lazy.pending_num()) +
+                             " never materialized");
+
+    std::filesystem::remove(path);
+    return 0;
+}
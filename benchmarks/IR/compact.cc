@@ -0,0 +1,77 @@
+#include <vector>
+
+#include "bench.hh"
+//
+#include "IR/compact_function.hh"
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+
+/**
+ * @brief Pointer-based Function vs CompactFunction: bytes per instruction and
+ *        traversal throughput over blocks, instructions and operands
+ *
+ *        usage: compact_bench [blocks_num] [instrs_per_block]
+ */
+namespace {
+
+using namespace jj_vm::ir;
+
+void make_chain(Function& func, std::size_t blocks_num,
+                std::size_t instrs_per_block) {
+    IRBuilder builder{};
+    std::vector<BasicBlock*> blocks{};
+    for (std::size_t i = 0; i < blocks_num; ++i)
+        blocks.push_back(func.create<BasicBlock>());
+    //
+    builder.set_insert_point(blocks.front());
+    Instr* prev = builder.create<ConstI64>(1);
+    auto* step = builder.create<ConstI64>(2);
+    for (std::size_t i = 0; i < blocks_num; ++i) {
+        builder.set_insert_point(blocks[i]);
+        for (std::size_t j = 0; j < instrs_per_block; ++j)
+            prev = builder.create<BinInstr>(Opcode::ADD, prev, step);
+        //
+        if (i + 1 != blocks_num)
+            builder.create<BranchInstr>(blocks[i + 1]);
+        else
+            builder.create<RetInstr>(prev);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto blocks_num = jj_vm::bench::arg_or(argc, argv, 1, 10'000);
+    auto instrs_per_block = jj_vm::bench::arg_or(argc, argv, 2, 100);
+    //
+    Function func{Type::create<TypeId::I64>(), "compact"};
+    make_chain(func, blocks_num, instrs_per_block);
+    auto compact = compact::CompactFunction::build(func);
+    //
+    auto instrs_num = static_cast<double>(compact.instrs_num());
+    std::printf("%zu blocks x %zu BinInstr\n", blocks_num, instrs_per_block);
+    std::printf("%-40s %12.1f bytes/instr\n", "Function (arena)",
+                func.arena().allocated() / instrs_num);
+    std::printf("%-40s %12.1f bytes/instr\n", "CompactFunction (pools)",
+                compact.memory_usage() / instrs_num);
+
+    jj_vm::bench::report("Function traversal", jj_vm::bench::measure_ms([&] {
+                             std::size_t sum = 0;
+                             for (auto&& bb : func)
+                                 for (auto&& instr : bb)
+                                     for (auto* input : instr.inputs())
+                                         sum += input->id();
+                             jj_vm::bench::do_not_optimize(sum);
+                         }));
+    jj_vm::bench::report(
+        "CompactFunction traversal", jj_vm::bench::measure_ms([&] {
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < compact.blocks_num(); ++i)
+                for (auto it = compact.front(compact::BlockHandle(i)); it;
+                     it = compact.next(it))
+                    for (auto input : compact.inputs(it)) sum += input.idx();
+            jj_vm::bench::do_not_optimize(sum);
+        }));
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "bench.hh"
+//
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+
+/**
+ * @brief Operand storage: heap allocations per BinInstr and operands
+ *        traversal through non-owning view vs per-instruction vector copy
+ *        (former Instr::inputs() behaviour)
+ *
+ *        usage: operands_bench [instrs_num]
+ */
+namespace {
+std::size_t g_allocs_num = 0;
+}  // namespace
+
+void* operator new(std::size_t size) {
+    ++g_allocs_num;
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+using namespace jj_vm::ir;
+
+std::vector<Value*> copy_inputs(const Instr& instr) {
+    std::vector<Value*> inputs{};
+    inputs.reserve(instr.num_inputs());
+    for (auto* input : instr.inputs()) inputs.push_back(input);
+    return inputs;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto instrs_num = jj_vm::bench::arg_or(argc, argv, 1, 1'000'000);
+    //
+    Function func{Type::create<TypeId::I64>(), "operands"};
+    IRBuilder builder{};
+    builder.set_insert_point(func.create<BasicBlock>());
+    //
+    Instr* prev = builder.create<ConstI64>(1);
+    auto* step = builder.create<ConstI64>(2);
+    auto before = g_allocs_num;
+    for (std::size_t i = 0; i < instrs_num; ++i)
+        prev = builder.create<BinInstr>(Opcode::ADD, prev, step);
+    //
+    std::printf("%zu BinInstr: %.3f heap allocations per instruction\n",
+                instrs_num,
+                static_cast<double>(g_allocs_num - before) / instrs_num);
+
+    auto& bb = *func.begin();
+    jj_vm::bench::report("inputs() copy", jj_vm::bench::measure_ms([&] {
+                             std::size_t sum = 0;
+                             for (auto&& instr : bb)
+                                 for (auto* input : copy_inputs(instr))
+                                     sum += input != nullptr;
+                             jj_vm::bench::do_not_optimize(sum);
+                         }));
+    jj_vm::bench::report("inputs() view", jj_vm::bench::measure_ms([&] {
+                             std::size_t sum = 0;
+                             for (auto&& instr : bb)
+                                 for (auto* input : instr.inputs())
+                                     sum += input != nullptr;
+                             jj_vm::bench::do_not_optimize(sum);
+                         }));
+    return 0;
+}
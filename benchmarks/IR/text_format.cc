@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "bench.hh"
+//
+#include "IR/ir_builder.hh"
+#include "IR/ir_parser.hh"
+#include "IR/ir_printer.hh"
+#include "utils/mapped_file.hh"
+
+/**
+ * @brief Throughput of the textual IR: parsing from the mapped file and
+ *        printing back, both in MB/s of text. Building the same IR by
+ *        IRBuilder is the lower bound of parsing
+ *
+ *        usage: text_format_bench [funcs_num] [instrs_per_func]
+ */
+namespace {
+
+using namespace jj_vm::ir;
+
+//! NOTE: loop with phis & the chain of arithmetic in its body
+std::string make_text(std::size_t funcs_num, std::size_t instrs_per_func) {
+    std::ostringstream os{};
+    for (std::size_t f = 0; f < funcs_num; ++f) {
+        os << "func f" << f << "(v0: i64) -> i64 {\n"
+           << "bb0:\n"
+           << "    v1 = const i64 1\n"
+           << "    jmp bb1\n"
+           << "bb1:\n"
+           << "    v2 = phi i64 [v1, bb0], [v5, bb2]\n"
+           << "    v3 = phi i64 [v1, bb0], [v" << instrs_per_func + 5
+           << ", bb2]\n"
+           << "    v4 = le i64 v2, v0\n"
+           << "    if v4, bb2, bb3\n"
+           << "bb2:\n"
+           << "    v5 = add i64 v2, v1\n";
+        std::size_t prev = 3;
+        for (std::size_t i = 0; i < instrs_per_func; ++i) {
+            auto id = i + 6;
+            os << "    v" << id << " = " << (i % 2 ? "mul" : "xor") << " i64 v"
+               << prev << ", v5\n";
+            prev = id;
+        }
+        os << "    jmp bb1\n"
+           << "bb3:\n"
+           << "    ret v3\n"
+           << "}\n";
+    }
+    return os.str();
+}
+
+//! NOTE: the same functions built in memory
+IRParser::FunctionList build_funcs(std::size_t funcs_num,
+                                   std::size_t instrs_per_func) {
+    IRParser::FunctionList funcs{};
+    IRBuilder builder{};
+    for (std::size_t f = 0; f < funcs_num; ++f) {
+        auto func = std::make_unique<Function>(Type::create<TypeId::I64>(),
+                                               "f" + std::to_string(f));
+        auto* arg = func->create<Param, Type>(TypeId::I64);
+        auto* bb0 = func->create<BasicBlock>();
+        auto* bb1 = func->create<BasicBlock>();
+        auto* bb2 = func->create<BasicBlock>();
+        auto* bb3 = func->create<BasicBlock>();
+        //
+        builder.set_insert_point(bb0);
+        auto* one = builder.create<ConstI64>(1);
+        builder.create<BranchInstr>(bb1);
+        //
+        builder.set_insert_point(bb1);
+        auto* cnt = builder.create<PhiInstr>(TypeId::I64);
+        auto* acc = builder.create<PhiInstr>(TypeId::I64);
+        auto* cond = builder.create<BinInstr>(Opcode::LE, cnt, arg);
+        builder.create<IfInstr>(bb2, bb3, cond);
+        //
+        builder.set_insert_point(bb2);
+        auto* next = builder.create<BinInstr>(Opcode::ADD, cnt, one);
+        Instr* prev = acc;
+        for (std::size_t i = 0; i < instrs_per_func; ++i)
+            prev = builder.create<BinInstr>(i % 2 ? Opcode::MUL : Opcode::XOR,
+                                            prev, next);
+        builder.create<BranchInstr>(bb1);
+        //
+        builder.set_insert_point(bb3);
+        builder.create<RetInstr>(acc);
+        //
+        cnt->add_node({one, bb0});
+        cnt->add_node({next, bb2});
+        acc->add_node({one, bb0});
+        acc->add_node({prev, bb2});
+        func->renumber();
+        funcs.push_back(std::move(func));
+    }
+    return funcs;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto funcs_num = jj_vm::bench::arg_or(argc, argv, 1, 1'000);
+    auto instrs_per_func = jj_vm::bench::arg_or(argc, argv, 2, 1'000);
+    //
+    auto path =
+        std::filesystem::temp_directory_path() / "jj_vm_text_format_bench.ir";
+    auto text = make_text(funcs_num, instrs_per_func);
+    std::ofstream{path} << text;
+    //
+    auto mb = static_cast<double>(text.size()) / (1024 * 1024);
+    std::printf("%zu functions x %zu instrs: %.1f MB\n", funcs_num,
+                instrs_per_func, mb);
+
+    //! NOTE: destruction of the parsed functions is out of the measurement
+    IRParser::FunctionList funcs{};
+    double parse_ms = std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i < 5; ++i) {
+        funcs.clear();
+        parse_ms = std::min(parse_ms, jj_vm::bench::measure_ms(
+                                          [&] {
+                                              funcs = IRParser::parse_file(path);
+                                          },
+                                          1));
+    }
+    jj_vm::bench::report("parse (mapped file)", parse_ms,
+                         std::to_string(mb / parse_ms * 1000) + " MB/s");
+
+    //! NOTE: lower bound: the same number of instructions w/o text
+    double build_ms = std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i < 5; ++i) {
+        IRParser::FunctionList built{};
+        build_ms = std::min(
+            build_ms, jj_vm::bench::measure_ms(
+                          [&] { built = build_funcs(funcs_num, instrs_per_func); },
+                          1));
+    }
+    jj_vm::bench::report("IRBuilder (same IR)", build_ms);
+
+    auto print_ms = jj_vm::bench::measure_ms([&] {
+        std::ostringstream os{};
+        for (auto&& func : funcs) print(os, *func);
+        jj_vm::bench::do_not_optimize(os.tellp());
+    });
+    jj_vm::bench::report("print (ostringstream)", print_ms,
+                         std::to_string(mb / print_ms * 1000) + " MB/s");
+
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <unordered_set>
+
+#include "bench.hh"
+//
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+
+/**
+ * @brief RAUW cost on values with thousands of users:
+ *        intrusive use-lists vs the former unordered_set + std::replace scheme
+ *
+ *        usage: use_list_bench [users_num] [rounds]
+ */
+namespace {
+
+using namespace jj_vm::ir;
+
+//! NOTE: minimal model of the previous users representation
+struct LegacyInstr;
+
+struct LegacyValue {
+    std::unordered_set<LegacyInstr*> m_users;
+    void replace_users(LegacyValue& other);
+};
+
+struct LegacyInstr : LegacyValue {
+    std::vector<LegacyValue*> m_inputs;
+
+    void add_input(LegacyValue* val) {
+        val->m_users.insert(this);
+        m_inputs.push_back(val);
+    }
+};
+
+void LegacyValue::replace_users(LegacyValue& other) {
+    m_users.merge(other.m_users);
+    other.m_users.clear();
+    for (auto* user : m_users)
+        std::replace(user->m_inputs.begin(), user->m_inputs.end(), &other,
+                     this);
+}
+
+double legacy_rauw(std::size_t users_num, std::size_t rounds) {
+    LegacyValue lhs{}, rhs{}, step{};
+    std::vector<LegacyInstr> users(users_num);
+    for (auto&& user : users) {
+        user.add_input(&lhs);
+        user.add_input(&step);
+    }
+    //
+    return jj_vm::bench::measure_ms([&] {
+        for (std::size_t i = 0; i < rounds; ++i) {
+            rhs.replace_users(lhs);
+            lhs.replace_users(rhs);
+        }
+    });
+}
+
+double use_list_rauw(std::size_t users_num, std::size_t rounds) {
+    Function func{Type::create<TypeId::I64>(), "rauw"};
+    IRBuilder builder{};
+    builder.set_insert_point(func.create<BasicBlock>());
+    //
+    auto* lhs = builder.create<ConstI64>(1);
+    auto* rhs = builder.create<ConstI64>(2);
+    auto* step = builder.create<ConstI64>(3);
+    for (std::size_t i = 0; i < users_num; ++i)
+        builder.create<BinInstr>(Opcode::ADD, lhs, step);
+    //
+    return jj_vm::bench::measure_ms([&] {
+        for (std::size_t i = 0; i < rounds; ++i) {
+            rhs->replace_users(*lhs);
+            lhs->replace_users(*rhs);
+        }
+    });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto users_num = jj_vm::bench::arg_or(argc, argv, 1, 4096);
+    auto rounds = jj_vm::bench::arg_or(argc, argv, 2, 100);
+    std::printf("%zu x 2 RAUW of value with %zu users\n", rounds, users_num);
+    //
+    jj_vm::bench::report("unordered_set users",
+                         legacy_rauw(users_num, rounds));
+    jj_vm::bench::report("intrusive use-list", use_list_rauw(users_num, rounds));
+    return 0;
+}
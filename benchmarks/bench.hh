@@ -0,0 +1,70 @@
+#pragma once
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+
+namespace jj_vm::bench {
+
+/**
+ * @brief Prevent compiler from throwing away the benchmarked value
+ */
+template <typename T>
+void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Run function several times and get the best wall time in ms
+ */
+template <typename Fn>
+double measure_ms(Fn&& fn, std::size_t repeats = 5) {
+    double best = std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i < repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto finish = std::chrono::steady_clock::now();
+        //
+        std::chrono::duration<double, std::milli> elapsed = finish - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+/**
+ * @brief Run function in the forked process to get its own peak RSS in KiB
+ *        (maxrss of the current process is monotonic, so it can't be reset)
+ */
+template <typename Fn>
+long isolated_peak_rss_kb(Fn&& fn) {
+    auto pid = ::fork();
+    if (pid == 0) {
+        fn();
+        std::_Exit(0);
+    }
+    //
+    int status = 0;
+    struct rusage usage {};
+    if (pid < 0 || ::wait4(pid, &status, 0, &usage) < 0) return -1;
+    return usage.ru_maxrss;
+}
+
+inline void report(const std::string& name, double ms,
+                   const std::string& extra = {}) {
+    std::printf("%-40s %12.3f ms  %s\n", name.c_str(), ms, extra.c_str());
+}
+
+inline std::size_t arg_or(int argc, char** argv, int idx, std::size_t def) {
+    return argc > idx ? std::strtoull(argv[idx], nullptr, 10) : def;
+}
+
+}  // namespace jj_vm::bench
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.hh"
+//
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "analysis/loop_analyzer.hh"
+#include "graph/bb_graph.hh"
+#include "graph/csr_graph.hh"
+#include "graph/dfs.hh"
+#include "graph/dom3.hh"
+
+/**
+ * @brief CFG traversals over succs/preds vectors of blocks (BBGraph) vs
+ *        the CSR snapshot (CSRGraph): DFS, dominator & loop trees,
+ *        dominance queries.
+ *        Edges are linked in the shuffled order, so vectors of blocks are
+ *        scattered over the heap like in the CFG changed by passes
+ *
+ *        usage: csr_graph_bench [blocks_num] [rounds]
+ *               (10k, 100k & 1M blocks by default)
+ */
+namespace {
+
+using namespace jj_vm::ir;
+
+constexpr std::size_t kQueries = 1'000'000;
+
+/// Chain of blocks with forward branches & back edges of small loops
+void make_cfg(Function& func, std::size_t blocks_num) {
+    std::vector<BasicBlock*> bbs{};
+    for (std::size_t i = 0; i < blocks_num; ++i)
+        bbs.push_back(func.create<BasicBlock>());
+    //
+    std::mt19937 gen{42};
+    std::vector<std::pair<std::size_t, std::size_t>> edges{};
+    for (std::size_t i = 0; i + 1 < blocks_num; ++i) {
+        edges.emplace_back(i, i + 1);
+        if (i % 4 == 0)
+            edges.emplace_back(i, std::min(blocks_num - 1, i + 2 + gen() % 6));
+        if (i % 16 == 15) edges.emplace_back(i, i - 1 - gen() % 8);
+    }
+    std::shuffle(edges.begin(), edges.end(), gen);
+    for (auto&& [from, to] : edges) BasicBlock::link_blocks(bbs[to], bbs[from]);
+}
+
+template <typename GraphTy>
+void run(const std::string& name, const GraphTy& graph, std::size_t rounds) {
+    using DomBuilder = jj_vm::graph::dom3_impl::DomTreeBuilder<GraphTy>;
+    using LoopBuilder = jj_vm::analysis::loop::LoopTreeBuilder<GraphTy>;
+    //
+    auto dfs_ms = jj_vm::bench::measure_ms([&] {
+        for (std::size_t i = 0; i < rounds; ++i) {
+            auto rpo = jj_vm::graph::deep_first_search_reverse_postoder(graph);
+            jj_vm::bench::do_not_optimize(rpo.size());
+        }
+    });
+    jj_vm::bench::report(name + " dfs rpo", dfs_ms);
+    //
+    auto dom_ms = jj_vm::bench::measure_ms([&] {
+        jj_vm::bench::do_not_optimize(DomBuilder::build(graph).size());
+    });
+    jj_vm::bench::report(name + " dom tree", dom_ms);
+    //
+    //! NOTE: queries between blocks of the RPO, they are O(1)
+    auto dom = DomBuilder::build(graph);
+    auto rpo = jj_vm::graph::deep_first_search_reverse_postoder(graph);
+    std::mt19937 gen{42};
+    auto query_ms = jj_vm::bench::measure_ms([&] {
+        std::size_t dominated = 0;
+        for (std::size_t i = 0; i < kQueries; ++i)
+            dominated += dom.dominates(rpo[gen() % rpo.size()],
+                                       rpo[gen() % rpo.size()]);
+        jj_vm::bench::do_not_optimize(dominated);
+    });
+    jj_vm::bench::report(name + " 1M dominates", query_ms);
+    //
+    auto loop_ms = jj_vm::bench::measure_ms([&] {
+        jj_vm::bench::do_not_optimize(LoopBuilder::build(graph).size());
+    });
+    jj_vm::bench::report(name + " loop tree", loop_ms);
+}
+
+void run_all(std::size_t blocks_num, std::size_t rounds) {
+    Function func{};
+    make_cfg(func, blocks_num);
+    //
+    std::printf("%zu blocks, %zu dfs rounds\n", blocks_num, rounds);
+    auto bb_graph = func.bb_graph();
+    run("BBGraph", bb_graph, rounds);
+    //
+    auto build_ms = jj_vm::bench::measure_ms([&] {
+        jj_vm::graph::CSRGraph graph{func};
+        jj_vm::bench::do_not_optimize(graph.edges_num());
+    });
+    jj_vm::bench::report("CSRGraph build", build_ms);
+    jj_vm::graph::CSRGraph csr_graph{func};
+    run("CSRGraph", csr_graph, rounds);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto rounds = jj_vm::bench::arg_or(argc, argv, 2, 5);
+    if (argc > 1) {
+        run_all(jj_vm::bench::arg_or(argc, argv, 1, 0), rounds);
+        return 0;
+    }
+    for (std::size_t blocks_num : {10'000, 100'000, 1'000'000})
+        run_all(blocks_num, rounds);
+    return 0;
+}
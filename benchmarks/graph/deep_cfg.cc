@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "bench.hh"
+//
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "analysis/loop_analyzer.hh"
+#include "graph/bb_graph.hh"
+#include "graph/csr_graph.hh"
+#include "graph/dfs.hh"
+#include "graph/dom3.hh"
+
+/**
+ * @brief Analyses of machine-generated deep CFGs: the chain closed by the
+ *        back edge (DFS & dominator trees are as deep as the CFG, the loop
+ *        search walks all of it) & the ladder of two rails with rungs (DSU
+ *        paths of the rail without dominators)
+ *
+ *        usage: deep_cfg_bench [blocks_num]
+ *               (1M blocks by default)
+ */
+namespace {
+
+using namespace jj_vm::ir;
+
+std::vector<BasicBlock*> make_blocks(Function& func, std::size_t blocks_num) {
+    std::vector<BasicBlock*> bbs{};
+    bbs.reserve(blocks_num);
+    for (std::size_t i = 0; i < blocks_num; ++i)
+        bbs.push_back(func.create<BasicBlock>());
+    return bbs;
+}
+
+/// 0 -> 1 -> ... -> N - 1 -> 1
+void make_chain(Function& func, std::size_t blocks_num) {
+    auto bbs = make_blocks(func, blocks_num);
+    for (std::size_t i = 0; i + 1 < blocks_num; ++i)
+        BasicBlock::link_blocks(bbs[i + 1], bbs[i]);
+    BasicBlock::link_blocks(bbs[1], bbs.back());
+}
+
+/// Entry -> x_0, y_0; x_i -> x_i+1, y_i+1; y_i -> y_i+1; x_last -> x_0
+void make_ladder(Function& func, std::size_t blocks_num) {
+    auto bbs = make_blocks(func, blocks_num / 2 * 2 + 1);
+    const auto x = [&](std::size_t idx) { return bbs[2 * idx + 1]; };
+    const auto y = [&](std::size_t idx) { return bbs[2 * idx + 2]; };
+    const auto rungs = blocks_num / 2;
+    //
+    BasicBlock::link_blocks(x(0), bbs.front());
+    BasicBlock::link_blocks(y(0), bbs.front());
+    for (std::size_t i = 0; i + 1 < rungs; ++i) {
+        BasicBlock::link_blocks(x(i + 1), x(i));
+        BasicBlock::link_blocks(y(i + 1), x(i));
+        BasicBlock::link_blocks(y(i + 1), y(i));
+    }
+    BasicBlock::link_blocks(x(0), x(rungs - 1));
+}
+
+template <typename GraphTy>
+void run(const std::string& name, const GraphTy& graph) {
+    using DomBuilder = jj_vm::graph::dom3_impl::DomTreeBuilder<GraphTy>;
+    using LoopBuilder = jj_vm::analysis::loop::LoopTreeBuilder<GraphTy>;
+    //
+    auto dfs_ms = jj_vm::bench::measure_ms([&] {
+        auto rpo = jj_vm::graph::deep_first_search_reverse_postoder(graph);
+        jj_vm::bench::do_not_optimize(rpo.size());
+    });
+    jj_vm::bench::report(name + " dfs rpo", dfs_ms);
+    //
+    auto dom_ms = jj_vm::bench::measure_ms([&] {
+        jj_vm::bench::do_not_optimize(DomBuilder::build(graph).size());
+    });
+    jj_vm::bench::report(name + " dom tree", dom_ms);
+    //
+    auto loop_ms = jj_vm::bench::measure_ms([&] {
+        jj_vm::bench::do_not_optimize(LoopBuilder::build(graph).size());
+    });
+    jj_vm::bench::report(name + " loop tree", loop_ms);
+}
+
+template <typename MakeFn>
+void run_all(const std::string& shape, std::size_t blocks_num,
+             MakeFn make_cfg) {
+    Function func{};
+    make_cfg(func, blocks_num);
+    //
+    std::printf("%s, %zu blocks\n", shape.c_str(), blocks_num);
+    run("BBGraph", func.bb_graph());
+    run("CSRGraph", jj_vm::graph::CSRGraph{func});
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto blocks_num = jj_vm::bench::arg_or(argc, argv, 1, 1'000'000);
+    run_all("chain", blocks_num, make_chain);
+    run_all("ladder", blocks_num, make_ladder);
+    return 0;
+}
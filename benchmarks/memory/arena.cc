@@ -0,0 +1,82 @@
+#include "bench.hh"
+//
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+#include "memory/arena.hh"
+
+/**
+ * @brief Build & destroy a long chain of binary instructions with
+ *        heap allocated nodes (ilist + new/delete) and arena allocated nodes
+ *
+ *        usage: arena_bench [instr_num]
+ */
+namespace {
+
+using namespace jj_vm::ir;
+
+void heap_path(std::size_t size) {
+    jj_vm::ilist<Instr> list{};
+    //
+    Value* prev = &jj_vm::emplace_back<ConstI64>(list, 1);
+    Value* step = &jj_vm::emplace_back<ConstI64>(list, 2);
+    for (std::size_t i = 0; i < size; ++i)
+        prev = &jj_vm::emplace_back<BinInstr>(list, Opcode::ADD, prev, step);
+    //
+    jj_vm::bench::do_not_optimize(prev);
+}
+
+void arena_path(std::size_t size) {
+    jj_vm::memory::Arena arena{};
+    jj_vm::ilist_arena<Instr> list{};
+    //
+    Value* prev = &jj_vm::emplace_back<ConstI64>(list, arena, 1);
+    Value* step = &jj_vm::emplace_back<ConstI64>(list, arena, 2);
+    for (std::size_t i = 0; i < size; ++i)
+        prev = &jj_vm::emplace_back<BinInstr>(list, arena, Opcode::ADD, prev,
+                                              step);
+    //
+    jj_vm::bench::do_not_optimize(prev);
+}
+
+void function_path(std::size_t size) {
+    Function func{Type::create<TypeId::I64>(), "chain"};
+    IRBuilder builder{};
+    builder.set_insert_point(func.create<BasicBlock>());
+    //
+    Value* prev = builder.create<ConstI64>(1);
+    Value* step = builder.create<ConstI64>(2);
+    for (std::size_t i = 0; i < size; ++i)
+        prev = builder.create<BinInstr>(Opcode::ADD, prev, step);
+    builder.create<RetInstr>(prev);
+    //
+    jj_vm::bench::do_not_optimize(prev);
+}
+
+struct Case {
+    const char* name;
+    void (*fn)(std::size_t);
+    long rss = 0;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto size = jj_vm::bench::arg_or(argc, argv, 1, 1'000'000);
+    std::printf("build + destroy %zu instructions\n", size);
+    //
+    Case cases[] = {{"heap ilist (new/delete)", heap_path},
+                    {"arena ilist", arena_path},
+                    {"function (arena + IRBuilder)", function_path}};
+
+    //! NOTE: measure RSS before timings, while parent process is still small
+    for (auto&& cur : cases)
+        cur.rss = jj_vm::bench::isolated_peak_rss_kb([&] { cur.fn(size); });
+    //
+    for (auto&& cur : cases) {
+        auto ms = jj_vm::bench::measure_ms([&] { cur.fn(size); });
+        jj_vm::bench::report(cur.name, ms,
+                             "peak rss " + std::to_string(cur.rss) + " KiB");
+    }
+    return 0;
+}
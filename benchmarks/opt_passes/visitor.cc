@@ -0,0 +1,123 @@
+#include "bench.hh"
+//
+#include "IR/function.hh"
+#include "IR/inst_visitor.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+
+/**
+ * @brief Per-instruction dispatch cost of the pass: virtual visit_instr +
+ *        switch over opcode + static_cast (former PassVisitor scheme) vs
+ *        statically dispatched InstVisitor
+ *
+ *        usage: visitor_bench [blocks_num] [instrs_per_block]
+ */
+namespace {
+
+using namespace jj_vm::ir;
+
+//! NOTE: minimal model of the former PassVisitor
+class LegacyVisitor {
+public:
+    virtual ~LegacyVisitor() = default;
+
+    virtual void visit_block(BasicBlock& bb) {
+        for (auto& instr : bb) visit_instr(instr);
+    }
+
+    virtual void visit_instr(Instr&) {}
+};
+
+class LegacyCounter final : public LegacyVisitor {
+public:
+    std::size_t m_sum = 0;
+
+    void visit_instr(Instr& instr) override {
+        switch (instr.opcode()) {
+            case Opcode::ADD:
+            case Opcode::MUL: {
+                auto& bin = static_cast<BinInstr&>(instr);
+                m_sum += bin.lhs() != bin.rhs();
+                break;
+            }
+            case Opcode::NEG:
+                m_sum += static_cast<UnaryInstr&>(instr).num_inputs();
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+class Counter final : public InstVisitor<Counter> {
+public:
+    std::size_t m_sum = 0;
+
+    void visit_add(BinInstr& instr) { m_sum += instr.lhs() != instr.rhs(); }
+    void visit_mul(BinInstr& instr) { m_sum += instr.lhs() != instr.rhs(); }
+    void visit_neg(UnaryInstr& instr) { m_sum += instr.num_inputs(); }
+};
+
+void make_ir(Function& func, std::size_t blocks_num,
+             std::size_t instrs_per_block) {
+    IRBuilder builder{};
+    std::vector<BasicBlock*> blocks{};
+    for (std::size_t i = 0; i < blocks_num; ++i)
+        blocks.push_back(func.create<BasicBlock>());
+    //
+    builder.set_insert_point(blocks.front());
+    Instr* prev = builder.create<ConstI64>(1);
+    auto* step = builder.create<ConstI64>(2);
+    for (std::size_t i = 0; i < blocks_num; ++i) {
+        builder.set_insert_point(blocks[i]);
+        for (std::size_t j = 0; j < instrs_per_block; ++j) {
+            switch (j % 4) {
+                case 0:
+                    prev = builder.create<BinInstr>(Opcode::ADD, prev, step);
+                    break;
+                case 1:
+                    prev = builder.create<BinInstr>(Opcode::MUL, prev, step);
+                    break;
+                case 2:
+                    prev = builder.create<UnaryInstr>(Opcode::NEG, prev);
+                    break;
+                default:
+                    prev = builder.create<BinInstr>(Opcode::SUB, prev, step);
+                    break;
+            }
+        }
+        //
+        if (i + 1 != blocks_num)
+            builder.create<BranchInstr>(blocks[i + 1]);
+        else
+            builder.create<RetInstr>(prev);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto blocks_num = jj_vm::bench::arg_or(argc, argv, 1, 1'000);
+    auto instrs_per_block = jj_vm::bench::arg_or(argc, argv, 2, 1'000);
+    //
+    Function func{Type::create<TypeId::I64>(), "visitor"};
+    make_ir(func, blocks_num, instrs_per_block);
+    std::printf("%zu blocks x %zu instructions\n", blocks_num,
+                instrs_per_block);
+
+    jj_vm::bench::report("virtual visitor + switch",
+                         jj_vm::bench::measure_ms([&] {
+                             LegacyCounter counter{};
+                             //! NOTE: passes were called through Pass*,
+                             //!       so the type is unknown at call site
+                             LegacyVisitor* volatile visitor = &counter;
+                             for (auto&& bb : func) visitor->visit_block(bb);
+                             jj_vm::bench::do_not_optimize(counter.m_sum);
+                         }));
+    jj_vm::bench::report("InstVisitor", jj_vm::bench::measure_ms([&] {
+                             Counter counter{};
+                             for (auto&& bb : func) counter.visit(bb);
+                             jj_vm::bench::do_not_optimize(counter.m_sum);
+                         }));
+    return 0;
+}
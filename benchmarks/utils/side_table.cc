@@ -0,0 +1,58 @@
+#include <unordered_map>
+#include <vector>
+
+#include "bench.hh"
+//
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+#include "utils/side_table.hh"
+
+/**
+ * @brief Analysis data lookup keyed by IR value:
+ *        std::unordered_map<Value*, T> vs utils::SideTable<Value*, T>
+ *
+ *        usage: side_table_bench [values_num] [rounds]
+ */
+namespace {
+
+using namespace jj_vm::ir;
+
+template <typename MapTy>
+double fill_and_lookup(const std::vector<Value*>& values, std::size_t rounds) {
+    return jj_vm::bench::measure_ms([&] {
+        MapTy table{};
+        for (auto* val : values) table[val] = val->id();
+        //
+        std::size_t sum = 0;
+        for (std::size_t i = 0; i < rounds; ++i)
+            for (auto* val : values) sum += table.find(val)->second;
+        jj_vm::bench::do_not_optimize(sum);
+    });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto values_num = jj_vm::bench::arg_or(argc, argv, 1, 100'000);
+    auto rounds = jj_vm::bench::arg_or(argc, argv, 2, 20);
+    //
+    Function func{Type::create<TypeId::I64>(), "side_table"};
+    IRBuilder builder{};
+    builder.set_insert_point(func.create<BasicBlock>());
+    //
+    std::vector<Value*> values{};
+    for (std::size_t i = 0; i < values_num; ++i)
+        values.push_back(builder.create<ConstI64>(static_cast<int64_t>(i)));
+
+    std::printf("%zu values, fill + %zu lookup rounds\n", values_num, rounds);
+    jj_vm::bench::report(
+        "unordered_map",
+        fill_and_lookup<std::unordered_map<Value*, std::size_t>>(values,
+                                                                 rounds));
+    jj_vm::bench::report(
+        "SideTable",
+        fill_and_lookup<jj_vm::utils::SideTable<Value*, std::size_t>>(values,
+                                                                      rounds));
+    return 0;
+}
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 //
 #include <iterator>
+#include <limits>
 #include <ostream>
 #include <type_traits>
 #include <utility>
@@ -12,6 +15,7 @@
 #include "instructions.hh"
 #include "intrusive_list/ilist.hh"
 #include "opcodes.hh"
+#include "utils/iterator_range.hh"
 
 namespace jj_vm::ir {
 
@@ -69,7 +73,7 @@ std::ostream& operator<<(std::ostream& in, const LiveInterval& data) {
  */
 class BasicBlock final : public ilist_detail::ilist_node {
 public:
-    using InstrList = ilist<Instr>;
+    using InstrList = ilist_arena<Instr>;
     //
     using iterator = InstrList::iterator;
     using const_iterator = InstrList::const_iterator;
@@ -87,8 +91,13 @@ private:
     //
     Function* m_parent = nullptr;
     //
-    LiveInterval m_interval;
+    //! NOTE: phis are the prefix of the block, it's the end of the prefix
+    Instr* m_last_phi = nullptr;
     //
+    //! NOTE: instructions order numbers are assigned lazily
+    mutable bool m_order_valid = false;
+    //
+    static constexpr std::uint32_t kOrderStep = 16;
 
     //! NOTE: it should be hidden in private due access to private data & dumb
     //!       func naming
@@ -116,27 +125,20 @@ public:
     }
 #endif
 
-    static void link_blocks(BasicBlock* succ, BasicBlock* pred) noexcept {
-        assert(succ && "Link basic blocks got nullptr successor");
-        assert(succ && "Link basic blocks got nullptr predcessor");
-        //
-        pred->add_succ(succ);
-        succ->add_pred(pred);
-    }
+    //! NOTE: CFG edits are recorded in the journal of pred parent function,
+    //!       so they are defined in function.hh
+    static void link_blocks(BasicBlock* succ, BasicBlock* pred);
 
-    static void remove_link(BasicBlock* succ, BasicBlock* pred) noexcept {
-        auto& preds = succ->m_preds;
-        preds.erase(std::find(preds.begin(), preds.end(), pred));
-        //
-        auto& succs = pred->m_succs;
-        succs.erase(std::find(succs.begin(), succs.end(), succ));
-    }
+    static void remove_link(BasicBlock* succ, BasicBlock* pred);
 
     /**
      * @brief Getters
      */
     id_type bb_id() const noexcept { return m_bb_id; }
 
+    /// Dense per-function index, see utils::SideTable
+    id_type id() const noexcept { return m_bb_id; }
+
     auto size() const noexcept { return m_instr.size(); }
 
     auto empty() const noexcept { return m_instr.empty(); }
@@ -147,45 +149,79 @@ public:
     auto& preds() const noexcept { return m_preds; }
     auto& succs() const noexcept { return m_succs; }
 
-    auto interval() const noexcept { return m_interval; }
-
     Function* parent() noexcept { return m_parent; }
     const Function* parent() const noexcept { return m_parent; }
 
+    /// Journal of the parent function, nullptr if edits aren't recorded
+    Journal* journal() const noexcept;
+
+    /**
+     * @brief Check if instruction lhs is placed before rhs in this block.
+     *        O(1) while order is valid, first query after invalidation
+     *        renumbers the whole block
+     */
+    bool comes_before(const Instr* lhs, const Instr* rhs) const {
+        assert(lhs->parent() == this && rhs->parent() == this &&
+               "Error: instructions from another basic block");
+        if (!m_order_valid) renumber();
+        return lhs->m_order < rhs->m_order;
+    }
+
+    bool is_order_valid() const noexcept { return m_order_valid; }
+
     /**
-     * @brief Setters
+     * @brief Phis are kept as contiguous prefix of the block, so they are
+     *        visited w/o scanning the rest of instructions. O(1)
      */
-    auto set_interval(LiveInterval other) noexcept { m_interval = other; }
+    iterator phis_end() noexcept {
+        return m_last_phi != nullptr ? std::next(iterator{m_last_phi})
+                                     : begin();
+    }
+    const_iterator phis_end() const noexcept {
+        return m_last_phi != nullptr ? std::next(const_iterator{m_last_phi})
+                                     : begin();
+    }
+
+    auto phis() noexcept { return utils::make_range(begin(), phis_end()); }
+    auto phis() const noexcept {
+        return utils::make_range(begin(), phis_end());
+    }
+
+    bool has_phis() const noexcept { return m_last_phi != nullptr; }
+
+    /// Index of the pred in preds(), preds_num() if it isn't a pred. O(preds)
+    std::size_t pred_index(const BasicBlock* pred) const noexcept {
+        return static_cast<std::size_t>(
+            std::find(m_preds.begin(), m_preds.end(), pred) - m_preds.begin());
+    }
 
     /**
      * @brief Modifiers
      */
-    auto erase(Instr* instr) { return m_instr.erase(iterator{instr}); }
+    //! NOTE: removal keeps order of remaining instructions valid.
+    //!       Erased node is destroyed, so it is defined in function.hh to
+    //!       drop it from the constant pool
+    iterator erase(Instr* instr);
+
+    /// Attach detached instruction before pos. Phi is placed at the end of
+    /// phis, other instruction isn't placed before phis
+    void insert(iterator pos, Instr* instr);
 
     void replace_instr(Instr* old_instr, Instr* new_instr) {
         assert(old_instr->parent() == this);
         new_instr->replace_users(*old_instr);
-        m_instr.insert(erase(old_instr), new_instr);
-        new_instr->set_parent(this);
+        insert(erase(old_instr), new_instr);
     }
 
     void splice(iterator pos, BasicBlock& other) {
         splice(pos, other.begin(), other.end());
     }
 
-    void splice(iterator pos, iterator first, iterator last) {
-        std::for_each(first, last, [this](jj_vm::ir::Instr& instr) {
-            instr.set_parent(this);
-        });
-        bool is_end = (pos == m_instr.end());
-
-        m_instr.splice(pos, first, last);
-
-        if (is_end) update();
-    }
+    void splice(iterator pos, iterator first, iterator last);
 
     void update() {
-        for (auto succ : m_succs) remove_link(this, succ);
+        auto succs = m_succs;
+        for (auto* succ : succs) remove_link(succ, this);
         if (m_instr.empty())
             return;
         else {
@@ -198,6 +234,10 @@ public:
                 const auto& if_instr = static_cast<const IfInstr&>(last_instr);
                 link_blocks(if_instr.true_bb(), this);
                 link_blocks(if_instr.false_bb(), this);
+            } else if (last_instr.opcode() == Opcode::SWITCH) {
+                const auto& switch_instr =
+                    static_cast<const SwitchInstr&>(last_instr);
+                for (auto* succ : switch_instr.succs()) link_blocks(succ, this);
             }
         }
     }
@@ -233,56 +273,92 @@ public:
     auto rend() { return std::reverse_iterator{begin()}; }
     auto rend() const { return std::reverse_iterator{begin()}; }
 
-    ///
-    void dump(std::ostream& os) {
-        os << "bb id = " << m_bb_id << std::endl;
-        for (auto&& instr : m_instr) instr.dump(os);
-    }
-
 private:
     void set_parent(Function* parent) noexcept { m_parent = parent; }
-    void set_id(id_type id) { m_bb_id = id; }
 
-    template <typename T, class... Args>
-    auto push_back(Args&&... args) {
-        //
-        static_assert(std::is_base_of<Instr, T>::value,
-                      "Error: expected Instruction derived type");
-        //
-        auto* const inserted = static_cast<T*>(
-            &emplace_back<T>(m_instr, std::forward<Args>(args)...));
-        //
-        if constexpr (std::is_same_v<IfInstr, T>) {
-            link_blocks(inserted->true_bb(), this);
-            link_blocks(inserted->false_bb(), this);
-        } else if constexpr (std::is_same_v<BranchInstr, T>)
-            link_blocks(inserted->dst(), this);
-        //
-        inserted->set_parent(this);
-        return inserted;
+    void invalidate_order() const noexcept { m_order_valid = false; }
+
+    /// Position of the new instruction, which keeps phis the prefix
+    iterator fix_position(iterator pos, const Instr* instr) noexcept {
+        auto phis_end = this->phis_end();
+        if (instr->opcode() == Opcode::PHI) {
+            bool after_phis =
+                pos != begin() && std::prev(pos)->opcode() != Opcode::PHI;
+            return after_phis ? phis_end : pos;
+        }
+        return (pos != end() && pos->opcode() == Opcode::PHI) ? phis_end : pos;
     }
 
-    template <typename T, class... Args>
-    auto push_front(Args&&... args) {
-        //
-        static_assert(std::is_base_of<Instr, T>::value,
-                      "Error:expected Instruction derived type");
+    /// Track the end of phis after the instruction is linked
+    void phi_inserted(Instr* instr) noexcept {
+        if (instr->opcode() != Opcode::PHI) return;
+        auto next = std::next(iterator{instr});
+        if (next == end() || next->opcode() != Opcode::PHI) m_last_phi = instr;
+    }
+
+    /// Track the end of phis before the instruction is unlinked
+    void phi_erased(Instr* instr) noexcept {
+        if (instr != m_last_phi) return;
+        iterator it{instr};
+        m_last_phi = (it != begin() && std::prev(it)->opcode() == Opcode::PHI)
+                         ? &*std::prev(it)
+                         : nullptr;
+    }
+
+    /// Recompute the end of phis after bulk list edits. O(phis)
+    void update_phis() noexcept {
+        m_last_phi = nullptr;
+        for (auto&& instr : m_instr) {
+            if (instr.opcode() != Opcode::PHI) break;
+            m_last_phi = &instr;
+        }
+    }
+
+    void renumber() const {
+        std::uint32_t order = 0;
+        for (auto&& instr : m_instr)
+            const_cast<Instr&>(instr).m_order = order += kOrderStep;
+        m_order_valid = true;
+    }
+
+    /**
+     * @brief Give newly inserted instruction a number between its neighbours.
+     *        Order is invalidated only if there is no gap between them
+     */
+    void update_order(Instr* instr) noexcept {
+        if (!m_order_valid) return;
         //
-        auto* const inserted = static_cast<T*>(
-            &emplace_front<T>(m_instr, std::forward<Args>(args)...));
+        iterator it{instr};
+        std::uint32_t prev =
+            (it == m_instr.begin()) ? 0 : std::prev(it)->m_order;
         //
-        // if constexpr (std::is_same_v<IfInstr, T>) {
-        //     link_blocks(inserted->true_bb(), this);
-        //     link_blocks(inserted->false_bb(), this);
-        // } else if constexpr (std::is_same_v<BranchInstr, T>)
-        //     link_blocks(inserted->dst(), this);
+        auto next_it = std::next(it);
+        constexpr auto kMaxOrder = std::numeric_limits<std::uint32_t>::max();
+        std::uint32_t next = (next_it == m_instr.end())
+                                 ? (prev <= kMaxOrder - 2 * kOrderStep
+                                        ? prev + 2 * kOrderStep
+                                        : kMaxOrder)
+                                 : next_it->m_order;
         //
-        inserted->set_parent(this);
-        return inserted;
+        if (next - prev < 2)
+            invalidate_order();
+        else
+            instr->m_order = prev + (next - prev) / 2;
     }
+    void set_id(id_type id) { m_bb_id = id; }
+
+    //! NOTE: instructions are allocated in the arena of the parent function,
+    //!       therefore definitions are placed in function.hh
+    template <typename T, class... Args>
+    T* push_back(Args&&... args);
+
+    template <typename T, class... Args>
+    T* push_front(Args&&... args);
 
     //
     friend IRBuilder;
+    friend Function;
+    friend Journal;
 };
 
 void erase(BasicBlock* bb, Instr* instr) {
@@ -0,0 +1,655 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "basic_block.hh"
+#include "compact_function.hh"
+#include "function.hh"
+#include "instructions.hh"
+#include "ir_builder.hh"
+#include "opcodes.hh"
+#include "utils/iterator_range.hh"
+#include "utils/mapped_file.hh"
+
+namespace jj_vm::ir::compact {
+
+/**
+ * @brief Binary module format. Image is the set of CompactFunction pools
+ *        written as is, so it's loaded by mmap w/o per-node decoding:
+ *
+ *          FileHeader
+ *          FuncHeader[funcs_num]
+ *          sections of every function (8 bytes aligned)
+ *          strings (names of functions, params & callees)
+ *
+ *        All references are offsets from the image start or 32-bit handles,
+ *        so the image is position independent.
+ *        NOTE: image is native endian, the tag in the header rejects foreign
+ *              one
+ */
+namespace binary {
+
+inline constexpr char kMagic[8] = {'J', 'J', 'V', 'M', 'I', 'R', '\0', '\0'};
+inline constexpr std::uint32_t kVersion = 1;
+inline constexpr std::uint32_t kEndianTag = 0x01020304;
+inline constexpr std::size_t kAlign = 8;
+
+enum class Section : std::uint32_t {
+    INSTRS,
+    BLOCKS,
+    PARAMS,
+    OPERANDS,
+    TARGETS,
+    CONSTANTS,
+    SYMBOLS,
+    PREDS,
+    SUCCS,
+    PREDS_OFFSETS,
+    SUCCS_OFFSETS,
+    NUM
+};
+
+inline constexpr std::size_t kSectionsNum = static_cast<std::size_t>(Section::NUM);
+
+struct SectionRef final {
+    std::uint64_t offset = 0;
+    std::uint64_t count = 0;
+};
+
+struct StringRef final {
+    std::uint32_t offset = 0;
+    std::uint32_t size = 0;
+};
+
+struct FileHeader final {
+    char magic[8] = {};
+    std::uint32_t version = 0;
+    std::uint32_t endian_tag = 0;
+    std::uint32_t funcs_num = 0;
+    std::uint32_t reserved = 0;
+    std::uint64_t file_size = 0;
+    SectionRef strings{};
+};
+
+struct FuncHeader final {
+    StringRef name{};
+    TypeId ret_type = TypeId::NONE;
+    std::uint8_t reserved[7] = {};
+    SectionRef sections[kSectionsNum]{};
+};
+
+//! NOTE: no implicit padding, so images are byte-identical for the same IR
+static_assert(sizeof(FileHeader) == 48, "Unexpected FileHeader layout");
+static_assert(sizeof(FuncHeader) == 16 + 16 * kSectionsNum,
+              "Unexpected FuncHeader layout");
+
+class FormatError final : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Count or offset written as 32 bits. Module which doesn't fit the
+ *        format is rejected instead of truncated
+ */
+inline std::uint32_t narrow(std::size_t val, const char* what) {
+    if (val > std::numeric_limits<std::uint32_t>::max())
+        throw FormatError{std::string{what} + " exceeds 32 bits"};
+    return static_cast<std::uint32_t>(val);
+}
+
+/**
+ * @brief Typed read-only array inside the image
+ */
+template <typename T>
+class ArrayRef final {
+    const T* m_data = nullptr;
+    std::size_t m_size = 0;
+
+public:
+    ArrayRef() = default;
+    ArrayRef(const T* data, std::size_t size) : m_data(data), m_size(size) {}
+
+    const T& operator[](std::size_t idx) const {
+        assert(idx < m_size);
+        return m_data[idx];
+    }
+
+    const T* data() const noexcept { return m_data; }
+    std::size_t size() const noexcept { return m_size; }
+    const T* begin() const noexcept { return m_data; }
+    const T* end() const noexcept { return m_data + m_size; }
+};
+
+}  // namespace binary
+
+/**
+ * @brief Read-only view of the serialized function. Mirrors read interface of
+ *        CompactFunction, all accessors are O(1) loads from the image
+ */
+class FunctionImage final {
+public:
+    using inputs_range = CompactFunction::inputs_range;
+    using blocks_range = CompactFunction::blocks_range;
+
+private:
+    template <typename T>
+    using ArrayRef = binary::ArrayRef<T>;
+
+    std::string_view m_name{};
+    Type m_func_ty{};
+    //
+    ArrayRef<InstrNode> m_instrs{};
+    ArrayRef<BlockNode> m_blocks{};
+    ArrayRef<InstrHandle> m_params{};
+    ArrayRef<InstrHandle> m_operands{};
+    ArrayRef<BlockHandle> m_targets{};
+    ArrayRef<std::int64_t> m_constants{};
+    ArrayRef<binary::StringRef> m_symbols{};
+    ArrayRef<BlockHandle> m_preds{};
+    ArrayRef<BlockHandle> m_succs{};
+    ArrayRef<std::uint32_t> m_preds_offsets{};
+    ArrayRef<std::uint32_t> m_succs_offsets{};
+    //
+    std::string_view m_strings{};
+
+    friend class ModuleImage;
+
+public:
+    /**
+     * @brief Getters
+     */
+    std::string_view name() const noexcept { return m_name; }
+    Type func_ty() const noexcept { return m_func_ty; }
+
+    std::size_t instrs_num() const noexcept { return m_instrs.size(); }
+    std::size_t blocks_num() const noexcept { return m_blocks.size(); }
+
+    const InstrNode& get(InstrHandle instr) const { return m_instrs[instr.idx()]; }
+    const BlockNode& get(BlockHandle bb) const { return m_blocks[bb.idx()]; }
+
+    Opcode opcode(InstrHandle instr) const { return get(instr).opcode; }
+    TypeId type(InstrHandle instr) const { return get(instr).type; }
+    BlockHandle parent(InstrHandle instr) const { return get(instr).parent; }
+
+    InstrHandle front(BlockHandle bb) const { return get(bb).first; }
+    InstrHandle back(BlockHandle bb) const { return get(bb).last; }
+    InstrHandle next(InstrHandle instr) const { return get(instr).next; }
+    InstrHandle prev(InstrHandle instr) const { return get(instr).prev; }
+
+    inputs_range inputs(InstrHandle instr) const {
+        const auto& node = get(instr);
+        const auto* first = m_operands.data() + node.inputs;
+        return {first, first + node.num_inputs};
+    }
+
+    InstrHandle get_input(InstrHandle instr, std::size_t id) const {
+        assert(id < get(instr).num_inputs);
+        return m_operands[get(instr).inputs + id];
+    }
+
+    std::int64_t constant(InstrHandle instr) const {
+        assert(opcode(instr) == Opcode::CONST);
+        return m_constants[get(instr).payload];
+    }
+
+    BlockHandle target(InstrHandle instr, std::size_t id) const {
+        return m_targets[get(instr).payload + id];
+    }
+
+    std::string_view symbol(InstrHandle instr) const {
+        const auto& ref = m_symbols[get(instr).payload];
+        return m_strings.substr(ref.offset, ref.size);
+    }
+
+    utils::IteratorRange<const InstrHandle*> params() const noexcept {
+        return {m_params.begin(), m_params.end()};
+    }
+
+    blocks_range preds(BlockHandle bb) const {
+        const auto* base = m_preds.data();
+        return {base + m_preds_offsets[bb.idx()],
+                base + m_preds_offsets[bb.idx() + 1]};
+    }
+
+    blocks_range succs(BlockHandle bb) const {
+        const auto* base = m_succs.data();
+        return {base + m_succs_offsets[bb.idx()],
+                base + m_succs_offsets[bb.idx() + 1]};
+    }
+};
+
+/**
+ * @brief Serializer of functions into the binary module image
+ */
+class ModuleWriter final {
+    std::vector<CompactFunction> m_funcs{};
+
+public:
+    void add(const Function& func) {
+        m_funcs.push_back(CompactFunction::build(func));
+    }
+
+    void add(CompactFunction func) { m_funcs.push_back(std::move(func)); }
+
+    std::size_t size() const noexcept { return m_funcs.size(); }
+
+    /// Image in memory, it's loadable by ModuleImage as is
+    std::string serialize() const;
+
+    void write(std::ostream& os) const {
+        auto image = serialize();
+        os.write(image.data(), static_cast<std::streamsize>(image.size()));
+    }
+
+    /// Throws FormatError if the file can't be written
+    void write(const std::filesystem::path& path) const {
+        std::ofstream os{path, std::ios::binary | std::ios::trunc};
+        write(os);
+        if (!os) throw binary::FormatError{"can't write " + path.string()};
+    }
+
+private:
+    template <typename T>
+    static binary::SectionRef append(std::string& image,
+                                     const std::vector<T>& pool) {
+        image.resize((image.size() + binary::kAlign - 1) & ~(binary::kAlign - 1),
+                     '\0');
+        binary::SectionRef ref{image.size(), pool.size()};
+        image.append(reinterpret_cast<const char*>(pool.data()),
+                     pool.size() * sizeof(T));
+        return ref;
+    }
+};
+
+/**
+ * @brief Loaded binary module. Image is validated once (header & bounds of
+ *        sections, O(functions)), then functions are served as views over it.
+ *        NOTE: contents of the records are trusted, image is expected to be
+ *              written by ModuleWriter
+ */
+class ModuleImage final {
+    utils::MappedFile m_file{};
+    std::string_view m_data{};
+    std::vector<FunctionImage> m_funcs{};
+
+public:
+    ModuleImage() = default;
+
+    /// Image in memory, buffer should outlive the module
+    explicit ModuleImage(std::string_view data) : m_data(data) { validate(); }
+
+    /// Map the file, the mapping is the backing store of the module
+    static ModuleImage load(const std::filesystem::path& path) {
+        ModuleImage image{};
+        image.m_file = utils::MappedFile{path};
+        image.m_data = image.m_file.view();
+        image.validate();
+        return image;
+    }
+
+    std::size_t size() const noexcept { return m_funcs.size(); }
+    const FunctionImage& operator[](std::size_t idx) const {
+        return m_funcs[idx];
+    }
+
+    auto begin() const noexcept { return m_funcs.begin(); }
+    auto end() const noexcept { return m_funcs.end(); }
+
+    /// Size of the image in bytes
+    std::size_t image_size() const noexcept { return m_data.size(); }
+
+private:
+    void validate();
+
+    template <typename T>
+    binary::ArrayRef<T> section(const binary::FuncHeader& header,
+                                binary::Section sec) const {
+        const auto& ref = header.sections[static_cast<std::size_t>(sec)];
+        if (ref.offset % alignof(T) != 0 || ref.offset > m_data.size() ||
+            ref.count > (m_data.size() - ref.offset) / sizeof(T))
+            throw binary::FormatError{"section is out of the image"};
+        //
+        //! NOTE: records are trivially copyable, image is used in place
+        return {reinterpret_cast<const T*>(m_data.data() + ref.offset),
+                static_cast<std::size_t>(ref.count)};
+    }
+};
+
+/**
+ * @brief Decoder of the serialized function into pointer based Function
+ */
+class FunctionDecoder final {
+    const FunctionImage& m_image;
+    Function& m_func;
+    IRBuilder m_builder{};
+    //
+    std::vector<Value*> m_values{};
+    std::vector<BasicBlock*> m_blocks{};
+    std::vector<InstrHandle> m_phis{};
+    std::deque<Value> m_placeholders{};
+    std::vector<bool> m_defined{};
+
+public:
+    FunctionDecoder(const FunctionImage& image, Function& func)
+        : m_image(image), m_func(func) {}
+
+    /**
+     * @brief Function with params & w/o body
+     */
+    static std::unique_ptr<Function> decode_header(const FunctionImage& image) {
+        auto func =
+            std::make_unique<Function>(image.func_ty(), std::string{image.name()});
+        for (auto param : image.params())
+            func->create<Param, Type>(image.type(param));
+        return func;
+    }
+
+    /**
+     * @brief Decode body into the function created by decode_header
+     *
+     * @param[in] resolve - callee by its name: Function*(std::string_view)
+     */
+    template <typename ResolverTy>
+    void decode_body(ResolverTy&& resolve) {
+        assert(m_func.empty() && "Error: function body is already decoded");
+        m_values.assign(m_image.instrs_num(), nullptr);
+        m_defined.assign(m_image.instrs_num(), false);
+        //
+        auto arg = m_func.args().begin();
+        for (auto param : m_image.params()) m_values[param.idx()] = &*arg++;
+        //
+        for (std::size_t i = 0; i < m_image.blocks_num(); ++i)
+            m_blocks.push_back(m_func.create<BasicBlock>());
+        //
+        for (std::size_t i = 0; i < m_image.blocks_num(); ++i) {
+            m_builder.set_insert_point(m_blocks[i]);
+            for (auto instr = m_image.front(BlockHandle(to_index(i))); instr;
+                 instr = m_image.next(instr))
+                define(instr, decode(instr, resolve));
+        }
+        //
+        //! NOTE: all values are known at this point
+        for (auto handle : m_phis) {
+            auto* phi = static_cast<PhiInstr*>(m_values[handle.idx()]);
+            std::size_t id = 0;
+            for (auto input : m_image.inputs(handle))
+                phi->add_node({static_cast<Instr*>(m_values[input.idx()]),
+                               m_blocks[m_image.target(handle, id++).idx()]});
+        }
+        m_placeholders.clear();
+        m_func.renumber();
+    }
+
+private:
+    template <typename ResolverTy>
+    Instr* decode(InstrHandle instr, ResolverTy& resolve) {
+        auto opc = m_image.opcode(instr);
+        auto type = m_image.type(instr);
+        switch (opc) {
+            case Opcode::CONST:
+                return m_builder.create_const(type, m_image.constant(instr));
+            case Opcode::BRANCH:
+                return m_builder.create<BranchInstr>(block(instr, 0));
+            case Opcode::IF:
+                return m_builder.create<IfInstr>(block(instr, 0),
+                                                 block(instr, 1), input(instr, 0));
+            case Opcode::RET:
+                return m_builder.create<RetInstr>(input(instr, 0));
+            case Opcode::PHI:
+                m_phis.push_back(instr);
+                return m_builder.create<PhiInstr>(type);
+            case Opcode::CAST:
+                return m_builder.create<CastInstr>(type, input(instr, 0));
+            case Opcode::PARAM:
+                return m_builder.create<ParamInstr>(
+                    std::string{m_image.symbol(instr)}, type);
+            case Opcode::CALL: {
+                auto* callee = resolve(m_image.symbol(instr));
+                if (callee == nullptr)
+                    throw binary::FormatError{"unresolved callee " +
+                                              std::string{m_image.symbol(instr)}};
+                auto* call = m_builder.create<CallInstr>(type, callee);
+                for (std::size_t id = 0; id < m_image.get(instr).num_inputs; ++id)
+                    call->add_arg(input(instr, id));
+                return call;
+            }
+            case Opcode::SPLAT:
+                return m_builder.create<SplatInstr>(type, input(instr, 0));
+            case Opcode::EXTRACT:
+                return m_builder.create<ExtractLaneInstr>(
+                    input(instr, 0), const_input(instr, 1));
+            case Opcode::INSERT:
+                return m_builder.create<InsertLaneInstr>(
+                    input(instr, 0), input(instr, 1), const_input(instr, 2));
+            case Opcode::ALLOC:
+                return m_builder.create<AllocInstr>(input(instr, 0));
+            case Opcode::LOAD:
+                return m_builder.create<LoadInstr>(type, input(instr, 0));
+            case Opcode::STORE:
+                return m_builder.create<StoreInstr>(input(instr, 0),
+                                                    input(instr, 1));
+            case Opcode::GEP:
+                return m_builder.create<GepInstr>(input(instr, 0),
+                                                  input(instr, 1));
+            case Opcode::SELECT:
+                return m_builder.create<SelectInstr>(
+                    input(instr, 0), input(instr, 1), input(instr, 2));
+            case Opcode::SWITCH: {
+                std::vector<SwitchInstr::Case> cases{};
+                //! NOTE: target of the case follows the default one
+                auto num_inputs = m_image.get(instr).num_inputs;
+                for (std::size_t id = 1; id < num_inputs; ++id)
+                    cases.emplace_back(const_input(instr, id),
+                                       block(instr, id));
+                return m_builder.create<SwitchInstr>(input(instr, 0),
+                                                     block(instr, 0), cases);
+            }
+            default:
+                break;
+        }
+        //
+        if (arity(opc) == 1)
+            return m_builder.create<UnaryInstr>(opc, input(instr, 0));
+        assert(arity(opc) == 2);
+        return m_builder.create<BinInstr>(opc, input(instr, 0), input(instr, 1));
+    }
+
+    BasicBlock* block(InstrHandle instr, std::size_t id) {
+        return m_blocks[m_image.target(instr, id).idx()];
+    }
+
+    //! NOTE: lane index & case value are constants defined above in the
+    //!       layout
+    Instr* const_input(InstrHandle instr, std::size_t id) {
+        auto handle = m_image.get_input(instr, id);
+        if (m_image.opcode(handle) != Opcode::CONST || !m_defined[handle.idx()])
+            throw binary::FormatError{
+                "constant operand isn't defined above"};
+        return static_cast<Instr*>(m_values[handle.idx()]);
+    }
+
+    //! NOTE: operand defined below in the layout is a typed placeholder
+    Value* input(InstrHandle instr, std::size_t id) {
+        auto handle = m_image.get_input(instr, id);
+        auto*& val = m_values[handle.idx()];
+        if (val == nullptr)
+            val = &m_placeholders.emplace_back(Type{m_image.type(handle)});
+        return val;
+    }
+
+    void define(InstrHandle handle, Instr* instr) {
+        auto*& val = m_values[handle.idx()];
+        if (val != nullptr) instr->replace_users(*val);
+        val = instr;
+        m_defined[handle.idx()] = true;
+    }
+};
+
+/**
+ * @brief Decode all functions of the module, calls are resolved inside it
+ */
+inline std::vector<std::unique_ptr<Function>> decode(const ModuleImage& image) {
+    std::vector<std::unique_ptr<Function>> funcs{};
+    std::unordered_map<std::string_view, Function*> symbols{};
+    for (auto&& func : image) {
+        funcs.push_back(FunctionDecoder::decode_header(func));
+        symbols.emplace(func.name(), funcs.back().get());
+    }
+    //
+    auto resolve = [&symbols](std::string_view name) -> Function* {
+        auto found = symbols.find(name);
+        return found != symbols.end() ? found->second : nullptr;
+    };
+    for (std::size_t i = 0; i < image.size(); ++i)
+        FunctionDecoder{image[i], *funcs[i]}.decode_body(resolve);
+    return funcs;
+}
+
+inline std::string ModuleWriter::serialize() const {
+    using namespace binary;
+    //
+    std::string image(sizeof(FileHeader) + m_funcs.size() * sizeof(FuncHeader),
+                      '\0');
+    std::string strings{};
+    auto intern = [&strings](std::string_view str) {
+        StringRef ref{narrow(strings.size(), "strings offset"),
+                      narrow(str.size(), "string size")};
+        strings.append(str);
+        return ref;
+    };
+    //
+    for (std::size_t i = 0; i < m_funcs.size(); ++i) {
+        const auto& func = m_funcs[i];
+        func.ensure_cfg();
+        //
+        FuncHeader header{};
+        header.name = intern(func.name());
+        header.ret_type = func.func_ty().type();
+        //
+        std::vector<StringRef> symbols{};
+        symbols.reserve(func.m_symbols.size());
+        for (auto&& symbol : func.m_symbols) symbols.push_back(intern(symbol));
+        //
+        auto* sections = header.sections;
+        sections[static_cast<std::size_t>(Section::INSTRS)] =
+            append(image, func.m_instrs);
+        sections[static_cast<std::size_t>(Section::BLOCKS)] =
+            append(image, func.m_blocks);
+        sections[static_cast<std::size_t>(Section::PARAMS)] =
+            append(image, func.m_params);
+        sections[static_cast<std::size_t>(Section::OPERANDS)] =
+            append(image, func.m_operands);
+        sections[static_cast<std::size_t>(Section::TARGETS)] =
+            append(image, func.m_targets);
+        sections[static_cast<std::size_t>(Section::CONSTANTS)] =
+            append(image, func.m_constants);
+        sections[static_cast<std::size_t>(Section::SYMBOLS)] =
+            append(image, symbols);
+        sections[static_cast<std::size_t>(Section::PREDS)] =
+            append(image, func.m_preds);
+        sections[static_cast<std::size_t>(Section::SUCCS)] =
+            append(image, func.m_succs);
+        sections[static_cast<std::size_t>(Section::PREDS_OFFSETS)] =
+            append(image, func.m_preds_offsets);
+        sections[static_cast<std::size_t>(Section::SUCCS_OFFSETS)] =
+            append(image, func.m_succs_offsets);
+        //
+        std::memcpy(image.data() + sizeof(FileHeader) + i * sizeof(FuncHeader),
+                    &header, sizeof(header));
+    }
+    //
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.endian_tag = kEndianTag;
+    header.funcs_num = narrow(m_funcs.size(), "functions number");
+    header.strings = {image.size(), strings.size()};
+    image.append(strings);
+    header.file_size = image.size();
+    std::memcpy(image.data(), &header, sizeof(header));
+    return image;
+}
+
+inline void ModuleImage::validate() {
+    using namespace binary;
+    //
+    //! NOTE: sections are aligned relative to the image start
+    if (reinterpret_cast<std::uintptr_t>(m_data.data()) % kAlign != 0)
+        throw FormatError{"image is not aligned"};
+    if (m_data.size() < sizeof(FileHeader))
+        throw FormatError{"image is too small"};
+    //
+    FileHeader header{};
+    std::memcpy(&header, m_data.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+        throw FormatError{"not a module image"};
+    if (header.endian_tag != kEndianTag)
+        throw FormatError{"foreign byte order"};
+    if (header.version != kVersion)
+        throw FormatError{"unsupported version " +
+                          std::to_string(header.version)};
+    if (header.file_size != m_data.size())
+        throw FormatError{"image is truncated"};
+    if (header.funcs_num >
+        (m_data.size() - sizeof(FileHeader)) / sizeof(FuncHeader))
+        throw FormatError{"function headers are out of the image"};
+    if (header.strings.offset > m_data.size() ||
+        header.strings.count > m_data.size() - header.strings.offset)
+        throw FormatError{"strings are out of the image"};
+    //
+    auto strings = m_data.substr(header.strings.offset, header.strings.count);
+    const auto* headers =
+        reinterpret_cast<const FuncHeader*>(m_data.data() + sizeof(FileHeader));
+    //
+    m_funcs.clear();
+    m_funcs.reserve(header.funcs_num);
+    for (std::size_t i = 0; i < header.funcs_num; ++i) {
+        const auto& func_header = headers[i];
+        FunctionImage func{};
+        if (std::uint64_t{func_header.name.offset} + func_header.name.size >
+            strings.size())
+            throw FormatError{"function name is out of the image"};
+        func.m_name = strings.substr(func_header.name.offset,
+                                     func_header.name.size);
+        func.m_func_ty = Type{func_header.ret_type};
+        func.m_strings = strings;
+        //
+        func.m_instrs = section<InstrNode>(func_header, Section::INSTRS);
+        func.m_blocks = section<BlockNode>(func_header, Section::BLOCKS);
+        func.m_params = section<InstrHandle>(func_header, Section::PARAMS);
+        func.m_operands = section<InstrHandle>(func_header, Section::OPERANDS);
+        func.m_targets = section<BlockHandle>(func_header, Section::TARGETS);
+        func.m_constants =
+            section<std::int64_t>(func_header, Section::CONSTANTS);
+        func.m_symbols = section<StringRef>(func_header, Section::SYMBOLS);
+        func.m_preds = section<BlockHandle>(func_header, Section::PREDS);
+        func.m_succs = section<BlockHandle>(func_header, Section::SUCCS);
+        func.m_preds_offsets =
+            section<std::uint32_t>(func_header, Section::PREDS_OFFSETS);
+        func.m_succs_offsets =
+            section<std::uint32_t>(func_header, Section::SUCCS_OFFSETS);
+        //
+        if (func.m_preds_offsets.size() != func.m_blocks.size() + 1 ||
+            func.m_succs_offsets.size() != func.m_blocks.size() + 1)
+            throw FormatError{"CFG of " + std::string{func.m_name} +
+                              " doesn't match its blocks"};
+        m_funcs.push_back(func);
+    }
+}
+
+}  // namespace jj_vm::ir::compact
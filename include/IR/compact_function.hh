@@ -0,0 +1,474 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "function.hh"
+#include "instructions.hh"
+#include "opcodes.hh"
+#include "utils/iterator_range.hh"
+#include "utils/side_table.hh"
+
+namespace jj_vm::ir::compact {
+
+/**
+ * @brief 32-bit index into one of the typed pools of CompactFunction.
+ *        Tag prevents mixing up handles of different pools
+ */
+template <typename Tag>
+class Handle final {
+public:
+    using index_type = std::uint32_t;
+    static constexpr index_type kInvalid =
+        std::numeric_limits<index_type>::max();
+
+private:
+    index_type m_idx = kInvalid;
+
+public:
+    constexpr Handle() = default;
+    constexpr explicit Handle(index_type idx) : m_idx(idx) {}
+
+    constexpr index_type idx() const noexcept { return m_idx; }
+    constexpr bool valid() const noexcept { return m_idx != kInvalid; }
+    constexpr explicit operator bool() const noexcept { return valid(); }
+
+    friend constexpr bool operator==(Handle lhs, Handle rhs) noexcept {
+        return lhs.m_idx == rhs.m_idx;
+    }
+    friend constexpr bool operator!=(Handle lhs, Handle rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+
+/**
+ * @brief Checked narrowing of pool sizes and offsets to 32-bit index.
+ *        All-ones value is reserved for invalid handle
+ */
+inline std::uint32_t to_index(std::size_t val) {
+    assert(val < std::numeric_limits<std::uint32_t>::max() &&
+           "Error: compact pool exceeds 32-bit index");
+    return static_cast<std::uint32_t>(val);
+}
+
+struct InstrTag;
+struct BlockTag;
+
+using InstrHandle = Handle<InstrTag>;
+using BlockHandle = Handle<BlockTag>;
+
+/**
+ * @brief Instruction record. Function params are stored as PARAM records
+ *        without parent, so every operand is an InstrHandle.
+ *
+ *        Meaning of payload depends on opcode:
+ *          CONST         - index into constants pool
+ *          BRANCH/IF/PHI - index of the first target (incoming) block in
+ *                          targets pool
+ *          SWITCH        - same, default block goes before case targets
+ *          CALL/PARAM    - index into symbols pool (callee/param name)
+ */
+struct InstrNode final {
+    Opcode opcode = Opcode::NONE;
+    TypeId type = TypeId::NONE;
+    //! NOTE: explicit padding, records are serialized byte by byte
+    std::uint8_t reserved = 0;
+    std::uint32_t num_inputs = 0;
+    //
+    BlockHandle parent{};
+    InstrHandle prev{};
+    InstrHandle next{};
+    //
+    std::uint32_t inputs = 0;
+    std::uint32_t payload = InstrHandle::kInvalid;
+};
+
+struct BlockNode final {
+    InstrHandle first{};
+    InstrHandle last{};
+};
+
+static_assert(sizeof(InstrNode) == 28, "Unexpected InstrNode layout");
+static_assert(sizeof(BlockNode) == 8, "Unexpected BlockNode layout");
+
+/**
+ * @brief Compact storage mode of the function: instructions, blocks and
+ *        operands live in per-function typed pools and refer to each other by
+ *        32-bit handles. Instruction costs sizeof(InstrNode) + 4 bytes per
+ *        operand, pools are walked sequentially.
+ *
+ *        It is built from pointer based Function or appended directly.
+ *        NOTE: use-lists are not kept, this mode is meant for analyses,
+ *              serialization and other read-mostly users
+ */
+class CompactFunction final {
+public:
+    using inputs_range = utils::IteratorRange<const InstrHandle*>;
+    using blocks_range = utils::IteratorRange<const BlockHandle*>;
+
+private:
+    std::vector<InstrNode> m_instrs{};
+    std::vector<BlockNode> m_blocks{};
+    std::vector<InstrHandle> m_params{};
+    //
+    std::vector<InstrHandle> m_operands{};
+    std::vector<BlockHandle> m_targets{};
+    std::vector<std::int64_t> m_constants{};
+    std::vector<std::string> m_symbols{};
+    //
+    //! NOTE: CFG edges (succ, pred) in insertion order and CSR built lazily
+    //!       from them
+    std::vector<std::pair<BlockHandle, BlockHandle>> m_edges{};
+    mutable std::vector<BlockHandle> m_preds{};
+    mutable std::vector<BlockHandle> m_succs{};
+    mutable std::vector<std::uint32_t> m_preds_offsets{};
+    mutable std::vector<std::uint32_t> m_succs_offsets{};
+    mutable bool m_cfg_valid = false;
+    //
+    Type m_func_ty{};
+    std::string m_name{};
+
+    friend class ModuleWriter;
+
+public:
+    CompactFunction() = default;
+    CompactFunction(Type func_ty, std::string_view name)
+        : m_func_ty(func_ty), m_name(name) {}
+
+    /**
+     * @brief Build compact copy of the function. Blocks and instructions
+     *        keep layout order, handles follow it
+     */
+    static CompactFunction build(const Function& func);
+
+    /**
+     * @brief Getters
+     */
+    std::string_view name() const noexcept { return m_name; }
+    Type func_ty() const noexcept { return m_func_ty; }
+
+    std::size_t instrs_num() const noexcept { return m_instrs.size(); }
+    std::size_t blocks_num() const noexcept { return m_blocks.size(); }
+
+    const InstrNode& get(InstrHandle instr) const {
+        assert(instr.idx() < m_instrs.size());
+        return m_instrs[instr.idx()];
+    }
+
+    const BlockNode& get(BlockHandle bb) const {
+        assert(bb.idx() < m_blocks.size());
+        return m_blocks[bb.idx()];
+    }
+
+    Opcode opcode(InstrHandle instr) const { return get(instr).opcode; }
+    TypeId type(InstrHandle instr) const { return get(instr).type; }
+    BlockHandle parent(InstrHandle instr) const { return get(instr).parent; }
+
+    InstrHandle front(BlockHandle bb) const { return get(bb).first; }
+    InstrHandle back(BlockHandle bb) const { return get(bb).last; }
+    InstrHandle next(InstrHandle instr) const { return get(instr).next; }
+    InstrHandle prev(InstrHandle instr) const { return get(instr).prev; }
+
+    inputs_range inputs(InstrHandle instr) const {
+        const auto& node = get(instr);
+        const auto* first = m_operands.data() + node.inputs;
+        return {first, first + node.num_inputs};
+    }
+
+    InstrHandle get_input(InstrHandle instr, std::size_t id) const {
+        assert(id < get(instr).num_inputs);
+        return m_operands[get(instr).inputs + id];
+    }
+
+    std::int64_t constant(InstrHandle instr) const {
+        assert(opcode(instr) == Opcode::CONST);
+        return m_constants[get(instr).payload];
+    }
+
+    BlockHandle target(InstrHandle instr, std::size_t id) const {
+        return m_targets[get(instr).payload + id];
+    }
+
+    std::string_view symbol(InstrHandle instr) const {
+        return m_symbols[get(instr).payload];
+    }
+
+    const std::vector<InstrHandle>& params() const noexcept { return m_params; }
+
+    blocks_range preds(BlockHandle bb) const {
+        ensure_cfg();
+        const auto* base = m_preds.data();
+        return {base + m_preds_offsets[bb.idx()],
+                base + m_preds_offsets[bb.idx() + 1]};
+    }
+
+    blocks_range succs(BlockHandle bb) const {
+        ensure_cfg();
+        const auto* base = m_succs.data();
+        return {base + m_succs_offsets[bb.idx()],
+                base + m_succs_offsets[bb.idx() + 1]};
+    }
+
+    /// Total size of the pools in bytes
+    std::size_t memory_usage() const noexcept;
+
+    /**
+     * @brief Modifiers
+     */
+    BlockHandle create_block() {
+        m_blocks.emplace_back();
+        m_cfg_valid = false;
+        return BlockHandle(to_index(m_blocks.size() - 1));
+    }
+
+    InstrHandle create_param(TypeId type) {
+        auto param = create_instr(Opcode::PARAM, type, {});
+        m_params.push_back(param);
+        return param;
+    }
+
+    /// Append instruction to the end of the block
+    InstrHandle append(BlockHandle bb, Opcode opc, TypeId type,
+                       std::initializer_list<InstrHandle> inputs) {
+        auto instr = create_instr(opc, type, inputs);
+        link_back(bb, instr);
+        return instr;
+    }
+
+    InstrHandle append_const(BlockHandle bb, TypeId type, std::int64_t val) {
+        auto instr = append(bb, Opcode::CONST, type, {});
+        m_instrs[instr.idx()].payload = to_index(m_constants.size());
+        m_constants.push_back(val);
+        return instr;
+    }
+
+    /// Append terminator and add CFG edges to its targets
+    InstrHandle append_branch(BlockHandle bb, BlockHandle dst) {
+        auto instr = append(bb, Opcode::BRANCH, TypeId::NONE, {});
+        set_targets(instr, {dst});
+        link_blocks(dst, bb);
+        return instr;
+    }
+
+    InstrHandle append_if(BlockHandle bb, InstrHandle cond, BlockHandle true_bb,
+                          BlockHandle false_bb) {
+        auto instr = append(bb, Opcode::IF, TypeId::NONE, {cond});
+        set_targets(instr, {true_bb, false_bb});
+        link_blocks(true_bb, bb);
+        link_blocks(false_bb, bb);
+        return instr;
+    }
+
+    void link_blocks(BlockHandle succ, BlockHandle pred) {
+        m_edges.emplace_back(succ, pred);
+        m_cfg_valid = false;
+    }
+
+    /// Unlink instruction from its block. O(1), record stays in the pool
+    void erase(InstrHandle instr) {
+        auto& node = m_instrs[instr.idx()];
+        auto& bb = m_blocks[node.parent.idx()];
+        //
+        if (node.prev)
+            m_instrs[node.prev.idx()].next = node.next;
+        else
+            bb.first = node.next;
+        //
+        if (node.next)
+            m_instrs[node.next.idx()].prev = node.prev;
+        else
+            bb.last = node.prev;
+        //
+        node.prev = node.next = InstrHandle{};
+        node.parent = BlockHandle{};
+    }
+
+private:
+    InstrHandle create_instr(Opcode opc, TypeId type,
+                             std::initializer_list<InstrHandle> inputs) {
+        InstrNode node{};
+        node.opcode = opc;
+        node.type = type;
+        node.num_inputs = to_index(inputs.size());
+        node.inputs = to_index(m_operands.size());
+        m_operands.insert(m_operands.end(), inputs.begin(), inputs.end());
+        //
+        m_instrs.push_back(node);
+        return InstrHandle(to_index(m_instrs.size() - 1));
+    }
+
+    void link_back(BlockHandle bb, InstrHandle instr) {
+        auto& block = m_blocks[bb.idx()];
+        auto& node = m_instrs[instr.idx()];
+        //
+        node.parent = bb;
+        node.prev = block.last;
+        if (block.last)
+            m_instrs[block.last.idx()].next = instr;
+        else
+            block.first = instr;
+        block.last = instr;
+    }
+
+    void set_targets(InstrHandle instr,
+                     std::initializer_list<BlockHandle> targets) {
+        m_instrs[instr.idx()].payload = to_index(m_targets.size());
+        m_targets.insert(m_targets.end(), targets.begin(), targets.end());
+    }
+
+    std::uint32_t add_symbol(std::string_view name) {
+        m_symbols.emplace_back(name);
+        return to_index(m_symbols.size() - 1);
+    }
+
+    /**
+     * @brief Build CSR arrays of preds & succs from edges list. O(V + E)
+     */
+    void ensure_cfg() const {
+        if (m_cfg_valid) return;
+        //
+        const auto blocks_num = m_blocks.size();
+        m_preds_offsets.assign(blocks_num + 1, 0);
+        m_succs_offsets.assign(blocks_num + 1, 0);
+        //
+        for (auto&& [succ, pred] : m_edges) {
+            ++m_preds_offsets[succ.idx() + 1];
+            ++m_succs_offsets[pred.idx() + 1];
+        }
+        for (std::size_t i = 0; i < blocks_num; ++i) {
+            m_preds_offsets[i + 1] += m_preds_offsets[i];
+            m_succs_offsets[i + 1] += m_succs_offsets[i];
+        }
+        //
+        //! NOTE: fill with moving cursors, edges order is preserved
+        std::vector<std::uint32_t> preds_pos(m_preds_offsets.begin(),
+                                             m_preds_offsets.end() - 1);
+        std::vector<std::uint32_t> succs_pos(m_succs_offsets.begin(),
+                                             m_succs_offsets.end() - 1);
+        m_preds.resize(m_edges.size());
+        m_succs.resize(m_edges.size());
+        for (auto&& [succ, pred] : m_edges) {
+            m_preds[preds_pos[succ.idx()]++] = pred;
+            m_succs[succs_pos[pred.idx()]++] = succ;
+        }
+        m_cfg_valid = true;
+    }
+};
+
+inline std::size_t CompactFunction::memory_usage() const noexcept {
+    std::size_t bytes = m_instrs.capacity() * sizeof(InstrNode) +
+                        m_blocks.capacity() * sizeof(BlockNode) +
+                        m_params.capacity() * sizeof(InstrHandle) +
+                        m_operands.capacity() * sizeof(InstrHandle) +
+                        m_targets.capacity() * sizeof(BlockHandle) +
+                        m_constants.capacity() * sizeof(std::int64_t) +
+                        m_edges.capacity() * sizeof(m_edges.front()) +
+                        (m_preds.capacity() + m_succs.capacity()) *
+                            sizeof(BlockHandle) +
+                        (m_preds_offsets.capacity() +
+                         m_succs_offsets.capacity()) *
+                            sizeof(std::uint32_t);
+    for (auto&& symbol : m_symbols) bytes += sizeof(symbol) + symbol.capacity();
+    return bytes;
+}
+
+inline CompactFunction CompactFunction::build(const Function& func) {
+    CompactFunction compact{func.func_ty(), func.name()};
+    //
+    utils::SideTable<const Value*, InstrHandle> values{func.values_num()};
+    utils::SideTable<const BasicBlock*, BlockHandle> blocks{func.blocks_num()};
+
+    //! NOTE: first pass assigns handles in layout order
+    for (auto&& arg : func.args())
+        values[&arg] = compact.create_param(arg.type());
+    //
+    std::size_t instrs_num = 0;
+    for (auto&& bb : func) {
+        blocks[&bb] = compact.create_block();
+        instrs_num += bb.size();
+    }
+    compact.m_instrs.reserve(compact.m_instrs.size() + instrs_num);
+    //
+    std::size_t next_idx = compact.m_instrs.size();
+    for (auto&& bb : func)
+        for (auto&& instr : bb)
+            values[&instr] = InstrHandle(to_index(next_idx++));
+
+    //! NOTE: second pass fills records, operands are already known
+    for (auto&& bb : func) {
+        auto bb_handle = blocks.at(&bb);
+        for (auto&& instr : bb) {
+            InstrNode node{};
+            node.opcode = instr.opcode();
+            node.type = instr.type();
+            node.num_inputs = to_index(instr.num_inputs());
+            node.inputs = to_index(compact.m_operands.size());
+            for (auto* input : instr.inputs())
+                compact.m_operands.push_back(values.at(input));
+            //
+            switch (instr.opcode()) {
+                case Opcode::CONST:
+                    node.payload = to_index(compact.m_constants.size());
+                    compact.m_constants.push_back(const_value(instr));
+                    break;
+                case Opcode::BRANCH:
+                    node.payload = to_index(compact.m_targets.size());
+                    compact.m_targets.push_back(blocks.at(
+                        static_cast<const BranchInstr&>(instr).dst()));
+                    break;
+                case Opcode::IF: {
+                    const auto& if_instr = static_cast<const IfInstr&>(instr);
+                    node.payload = to_index(compact.m_targets.size());
+                    compact.m_targets.push_back(blocks.at(if_instr.true_bb()));
+                    compact.m_targets.push_back(blocks.at(if_instr.false_bb()));
+                    break;
+                }
+                case Opcode::SWITCH: {
+                    const auto& switch_instr =
+                        static_cast<const SwitchInstr&>(instr);
+                    node.payload = to_index(compact.m_targets.size());
+                    compact.m_targets.push_back(
+                        blocks.at(switch_instr.default_bb()));
+                    for (std::size_t idx = 0; idx < switch_instr.cases_num();
+                         ++idx)
+                        compact.m_targets.push_back(
+                            blocks.at(switch_instr.case_target(idx)));
+                    break;
+                }
+                case Opcode::PHI:
+                    node.payload = to_index(compact.m_targets.size());
+                    for (auto&& [val, pred] :
+                         static_cast<const PhiInstr&>(instr).vars())
+                        compact.m_targets.push_back(blocks.at(pred));
+                    break;
+                case Opcode::CALL:
+                    node.payload = compact.add_symbol(
+                        static_cast<const CallInstr&>(instr).callee()->name());
+                    break;
+                case Opcode::PARAM:
+                    node.payload = compact.add_symbol(
+                        static_cast<const ParamInstr&>(instr).name());
+                    break;
+                default:
+                    break;
+            }
+            //
+            compact.m_instrs.push_back(node);
+            compact.link_back(bb_handle, values.at(&instr));
+        }
+        //
+        for (auto* succ : bb.succs())
+            compact.link_blocks(blocks.at(succ), bb_handle);
+    }
+    //
+    return compact;
+}
+
+}  // namespace jj_vm::ir::compact
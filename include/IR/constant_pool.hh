@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include "instruction.hh"
+#include "instructions.hh"
+
+namespace jj_vm::ir {
+
+/**
+ * @brief Per-function table of canonical constants keyed by (TypeId, value).
+ *        Values are stored extended to int64_t (see ir::const_value), so
+ *        lookup doesn't depend on the c++ type of the constant.
+ *        Pool doesn't own nodes, they are allocated in the function arena
+ */
+class ConstantPool final {
+public:
+    using key_type = std::pair<TypeId, std::int64_t>;
+
+private:
+    struct KeyHash final {
+        std::size_t operator()(const key_type& key) const noexcept {
+            auto type = static_cast<std::uint64_t>(key.first);
+            return std::hash<std::uint64_t>{}(
+                static_cast<std::uint64_t>(key.second) ^ (type << 56));
+        }
+    };
+
+    std::unordered_map<key_type, Instr*, KeyHash> m_consts{};
+
+public:
+    /**
+     * @brief Canonical node for the (type, value) or nullptr
+     */
+    Instr* find(TypeId type, std::int64_t val) const {
+        auto found = m_consts.find({type, val});
+        return found == m_consts.end() ? nullptr : found->second;
+    }
+
+    void insert(TypeId type, std::int64_t val, Instr* node) {
+        m_consts[{type, val}] = node;
+    }
+
+    /// Forget the node if it is canonical one (e.g. it's erased)
+    void erase(const Instr* node) {
+        auto found = m_consts.find({node->type(), const_value(*node)});
+        if (found != m_consts.end() && found->second == node)
+            m_consts.erase(found);
+    }
+
+    /// Forget all nodes, e.g. when they are moved to another function
+    void clear() noexcept { m_consts.clear(); }
+
+    std::size_t size() const noexcept { return m_consts.size(); }
+    bool empty() const noexcept { return m_consts.empty(); }
+};
+
+}  // namespace jj_vm::ir
@@ -1,11 +1,18 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
 #include <string_view>
 #include <type_traits>
+#include <utility>
+#include <variant>
 
 #include "basic_block.hh"
+#include "constant_pool.hh"
 #include "graph/bb_graph.hh"
 #include "instruction.hh"
+#include "journal.hh"
+#include "memory/arena.hh"
 
 namespace jj_vm::ir {
 
@@ -13,7 +20,19 @@ using namespace ilist_detail;
 
 class Param : public Value, public ilist_node {
 public:
-    Param(Type type) : Value(type) {}
+    Param(Type type) : Value(type) { m_is_param = true; }
+};
+
+class Function;
+
+/**
+ * @brief Source of the function body, which is decoded on the first access
+ *        to the blocks of the function (e.g. from the serialized module)
+ */
+class BodyMaterializer {
+public:
+    virtual ~BodyMaterializer() = default;
+    virtual void materialize(Function& func) = 0;
 };
 
 /**
@@ -22,19 +41,33 @@ public:
  */
 class Function final {
 public:
-    using BasicBlockList = ilist<BasicBlock>;
-    using ParamList = ilist<Param>;
+    using BasicBlockList = ilist_arena<BasicBlock>;
+    using ParamList = ilist_arena<Param>;
     //
     using iterator = BasicBlockList::iterator;
     using const_iterator = BasicBlockList::const_iterator;
 
 private:
+    //! NOTE: arena should outlive every IR node, so it is declared first
+    memory::Arena m_arena;
+    //
     BasicBlockList m_basic_blocks;
     ParamList m_args;
+    ConstantPool m_consts;
     //
     Type m_func_ty{};
     std::string m_func_name{};
     //
+    //! NOTE: counters of dense ids for values & basic blocks
+    Value::id_type m_values_num = 0;
+    BasicBlock::id_type m_blocks_num = 0;
+    //
+    //! NOTE: not owned, pending until the body is accessed
+    mutable BodyMaterializer* m_materializer = nullptr;
+    //
+    //! NOTE: not owned, set while edits are recorded
+    Journal* m_journal = nullptr;
+    //
 public:
     Function() = default;
     Function(Type func_ty, const std::string& func_name)
@@ -48,11 +81,13 @@ public:
         //
         if constexpr (sizeof...(Args) > 0) {
             if constexpr (std::is_same_v<T, BasicBlock>)
-                emplace_back<T>(cur_func->m_basic_blocks,
+                emplace_back<T>(cur_func->m_basic_blocks, cur_func->m_arena,
                                 std::forward<Args>(args)...);
             //
             else if constexpr (std::is_same_v<T, Param>)
-                emplace_back<T>(cur_func->m_args, std::forward<Args>(args)...);
+                cur_func->number(&emplace_back<T>(cur_func->m_args,
+                                                  cur_func->m_arena,
+                                                  std::forward<Args>(args)...));
             //
         }
         //
@@ -62,55 +97,264 @@ public:
     template <typename T, typename... Args>
     T* create(Args&&... args);
 
+    /**
+     * @brief Canonical constant node of the value. Equal constants requested
+     *        through the pool are pointer-equal. The node is placed at the
+     *        head of the entry block, so it dominates every possible use
+     */
+    template <typename T>
+    Constant<T>* get_const(T val);
+
+    /// Same as above for the constant of the runtime type
+    Instr* get_const(TypeId type, std::int64_t val);
+
     /**
      * @brief BasicBlock iterator forwarding functions
      * @return iterator
      */
-    iterator begin() { return m_basic_blocks.begin(); }
-    const_iterator begin() const { return m_basic_blocks.begin(); }
+    iterator begin() {
+        materialize();
+        return m_basic_blocks.begin();
+    }
+    const_iterator begin() const {
+        materialize();
+        return m_basic_blocks.begin();
+    }
     //
-    iterator end() { return m_basic_blocks.end(); }
-    const_iterator end() const { return m_basic_blocks.end(); }
+    iterator end() {
+        materialize();
+        return m_basic_blocks.end();
+    }
+    const_iterator end() const {
+        materialize();
+        return m_basic_blocks.end();
+    }
 
     /// O(n)
-    size_t size() const { return m_basic_blocks.size(); }
+    size_t size() const {
+        materialize();
+        return m_basic_blocks.size();
+    }
 
     /// O(1)
-    bool empty() const { return m_basic_blocks.empty(); }
+    bool empty() const {
+        materialize();
+        return m_basic_blocks.empty();
+    }
     //
 
     /**
      * @brief Accessors methods to basic block into function
      * @return const/non const BasicBlock&
      */
-    const BasicBlock& front() const { return m_basic_blocks.front(); }
-    BasicBlock& front() { return m_basic_blocks.front(); }
+    const BasicBlock& front() const {
+        materialize();
+        return m_basic_blocks.front();
+    }
+    BasicBlock& front() {
+        materialize();
+        return m_basic_blocks.front();
+    }
 
-    const BasicBlock& back() const { return m_basic_blocks.back(); }
-    BasicBlock& back() { return m_basic_blocks.back(); }
+    const BasicBlock& back() const {
+        materialize();
+        return m_basic_blocks.back();
+    }
+    BasicBlock& back() {
+        materialize();
+        return m_basic_blocks.back();
+    }
     //
 
+    /**
+     * @brief Lazy body. Materializer is called once on the first access to
+     *        blocks, afterwards the function is an ordinary one
+     */
+    void set_materializer(BodyMaterializer* materializer) noexcept {
+        assert(m_basic_blocks.empty() && "Error: function already has body");
+        m_materializer = materializer;
+    }
+
+    bool is_materialized() const noexcept { return m_materializer == nullptr; }
+
+    /// Function w/o body, e.g. interned by the call (see Module)
+    bool is_declaration() const noexcept {
+        return is_materialized() && m_basic_blocks.empty();
+    }
+
+    //! NOTE: body is the same one observed w/o laziness, so it's const
+    void materialize() const {
+        if (m_materializer == nullptr) return;
+        std::exchange(m_materializer, nullptr)
+            ->materialize(const_cast<Function&>(*this));
+    }
+
+    /// Upper bound of dense ids, it's the capacity for utils::SideTable
+    Value::id_type values_num() const noexcept { return m_values_num; }
+    BasicBlock::id_type blocks_num() const noexcept { return m_blocks_num; }
+
     std::string_view name() const noexcept { return m_func_name; }
     Type func_ty() const noexcept { return m_func_ty; }
 
-    auto bb_graph() noexcept {
+    ParamList& args() noexcept { return m_args; }
+    const ParamList& args() const noexcept { return m_args; }
+
+    const ConstantPool& consts() const noexcept { return m_consts; }
+
+    /// Journal which records edits of the function, see Journal::attach
+    Journal* journal() const noexcept { return m_journal; }
+
+    /// Arena which owns memory of every block, param & instruction
+    memory::Arena& arena() noexcept { return m_arena; }
+    const memory::Arena& arena() const noexcept { return m_arena; }
+
+    auto bb_graph() {
+        materialize();
         assert(!m_basic_blocks.empty() &&
                "Error : function hasn't any basic blocks to create graph");
         return jj_vm::graph::BBGraph{&m_basic_blocks.front(),
                                      m_basic_blocks.size()};
     }
 
+    /// Move block of this function before pos. O(1)
+    void move(iterator pos, BasicBlock* bb) {
+        assert(bb->parent() == this);
+        if (m_journal != nullptr)
+            m_journal->record(journal::MoveBlocks{bb, bb, this, next_of(bb)});
+        m_basic_blocks.splice(pos, iterator{bb});
+    }
+
     void erase(BasicBlock* to_erase) {
-        m_basic_blocks.erase(iterator{to_erase});
+        iterator it{to_erase};
+        if (m_journal == nullptr) {
+            m_basic_blocks.erase(it);
+            return;
+        }
+        //! NOTE: block is destroyed by the commit
+        m_journal->record(journal::EraseBlock{to_erase, this, next_of(to_erase)});
+        m_basic_blocks.remove(it);
+        to_erase->set_parent(nullptr);
     }
 
     void splice(iterator pos, Function& src) {
+        src.materialize();
+        if (src.m_basic_blocks.empty()) return;
+        //
+        if (m_journal != nullptr) {
+            m_journal->record(journal::MoveBlocks{&src.front(), &src.back(),
+                                                  &src, nullptr,
+                                                  m_journal->ids_mark()});
+            m_journal->record(
+                journal::PoolClear{&src, m_journal->save_pool(src.m_consts)});
+        }
+        //! NOTE: ids of src function would collide with ours
+        for (auto&& bb : src.m_basic_blocks) {
+            if (m_journal != nullptr) m_journal->save_id(bb.id());
+            bb.set_parent(this);
+            bb.set_id(m_blocks_num++);
+            for (auto&& instr : bb) {
+                if (m_journal != nullptr) m_journal->save_id(instr.id());
+                number(&instr);
+            }
+        }
+        //
+        //! NOTE: moved blocks still live in the arena of src function
+        m_arena.share(src.m_arena);
         m_basic_blocks.splice(pos, src.m_basic_blocks);
+        //
+        //! NOTE: src constants aren't placed in our entry block anymore
+        src.m_consts.clear();
     }
+
+    /**
+     * @brief Reassign dense ids: blocks in layout order, then params and
+     *        instructions. It packs ids after erasing and keeps block ids
+     *        equal to the layout position
+     */
+    void renumber() {
+        if (m_journal != nullptr) {
+            m_journal->record(journal::Renumber{this, m_journal->ids_mark()});
+            for_each_id([this](std::uint32_t& id) { m_journal->save_id(id); });
+        }
+        m_values_num = 0;
+        m_blocks_num = 0;
+        //
+        for (auto&& bb : m_basic_blocks) bb.set_id(m_blocks_num++);
+        for (auto&& arg : m_args) number(&arg);
+        for (auto&& bb : m_basic_blocks)
+            for (auto&& instr : bb) number(&instr);
+    }
+
+private:
+    void number(Value* val) noexcept { val->m_id = m_values_num++; }
+
+    BasicBlock* next_of(BasicBlock* bb) noexcept {
+        auto next = std::next(iterator{bb});
+        return next == m_basic_blocks.end() ? nullptr : &*next;
+    }
+
+    /// Counters & ids in the order of renumber(), see Journal
+    template <typename Fn>
+    void for_each_id(Fn&& fn) {
+        fn(m_values_num);
+        fn(m_blocks_num);
+        for (auto&& bb : m_basic_blocks) fn(bb.m_bb_id);
+        for (auto&& arg : m_args) fn(static_cast<Value&>(arg).m_id);
+        for (auto&& bb : m_basic_blocks)
+            for (auto&& instr : bb) fn(static_cast<Value&>(instr).m_id);
+    }
+
+    friend BasicBlock;
+    friend Journal;
 };
 
+/**
+ * @brief Create detached instruction in the function arena.
+ *        It should be inserted into some basic block afterwards
+ *        (e.g. BasicBlock::replace_instr)
+ */
 template <typename T, typename... Args>
-T* Function::create(Args&&... args) {}
+T* Function::create(Args&&... args) {
+    static_assert(std::is_base_of<Instr, T>::value,
+                  "Error: expected Instruction derived type");
+    auto* created = m_arena.create<T>(std::forward<Args>(args)...);
+    number(created);
+    if (m_journal != nullptr) m_journal->record(journal::InsertInstr{created});
+    return created;
+}
+
+template <typename T>
+Constant<T>* Function::get_const(T val) {
+    constexpr auto type = Constant<T>::kTypeId;
+    auto* found = static_cast<Constant<T>*>(m_consts.find(type, val));
+    if (found == nullptr) {
+        found = create<Constant<T>>(val);
+        m_consts.insert(type, val, found);
+        if (m_journal != nullptr)
+            m_journal->record(journal::PoolInsert{this, found});
+        front().insert(front().begin(), found);
+    }
+    return found;
+}
+
+inline Instr* Function::get_const(TypeId type, std::int64_t val) {
+    switch (type) {
+        case TypeId::I1:
+            return get_const<bool>(val != 0);
+        case TypeId::I8:
+            return get_const(static_cast<std::int8_t>(val));
+        case TypeId::I16:
+            return get_const(static_cast<std::int16_t>(val));
+        case TypeId::I32:
+            return get_const(static_cast<std::int32_t>(val));
+        case TypeId::I64:
+            return get_const(val);
+        default:
+            break;
+    }
+    assert(false && "Error: constant without scalar type");
+    return nullptr;
+}
 
 /**
  * @brief Append function
@@ -118,15 +362,472 @@ T* Function::create(Args&&... args) {}
 
 template <>
 BasicBlock* Function::create<BasicBlock>() {
-    uint32_t bb_id =
-        m_basic_blocks.empty() ? 0 : m_basic_blocks.back().bb_id() + 1;
-    //
-    return &emplace_back<BasicBlock>(m_basic_blocks, bb_id, this);
+    //! NOTE: new block is appended after the lazy body
+    materialize();
+    auto* created = &emplace_back<BasicBlock>(m_basic_blocks, m_arena,
+                                              m_blocks_num++, this);
+    if (m_journal != nullptr) m_journal->record(journal::InsertBlock{created});
+    return created;
 }
 
 template <>
 Param* Function::create<Param>(Type&& type) {
-    return &emplace_back<Param>(m_args, type);
+    auto* created = &emplace_back<Param>(m_args, m_arena, type);
+    number(created);
+    return created;
+}
+
+inline Journal* BasicBlock::journal() const noexcept {
+    return m_parent != nullptr ? m_parent->journal() : nullptr;
+}
+
+inline Journal* Instr::journal() const noexcept {
+    return m_parent != nullptr ? m_parent->journal() : nullptr;
+}
+
+inline BasicBlock::iterator BasicBlock::erase(Instr* instr) {
+    iterator it{instr};
+    auto* journal = this->journal();
+    if (journal == nullptr) {
+        if (instr->opcode() == Opcode::CONST && m_parent != nullptr)
+            m_parent->m_consts.erase(instr);
+        phi_erased(instr);
+        return m_instr.erase(it);
+    }
+    //
+    if (instr->opcode() == Opcode::CONST &&
+        m_parent->m_consts.find(instr->type(), const_value(*instr)) == instr) {
+        journal->record(journal::PoolErase{m_parent, instr});
+        m_parent->m_consts.erase(instr);
+    }
+    //! NOTE: instruction is destroyed by the commit
+    phi_erased(instr);
+    auto next = std::next(it);
+    journal->record(journal::EraseInstr{
+        instr, this, next == m_instr.end() ? nullptr : &*next});
+    m_instr.remove(it);
+    instr->set_parent(nullptr);
+    return it;
+}
+
+inline void BasicBlock::insert(iterator pos, Instr* instr) {
+    assert(instr->parent() == nullptr &&
+           "Error: instruction is already placed in some basic block");
+    m_instr.insert(fix_position(pos, instr), instr);
+    instr->set_parent(this);
+    phi_inserted(instr);
+    update_order(instr);
+    if (auto* journal = this->journal())
+        journal->record(journal::InsertInstr{instr});
+}
+
+inline void BasicBlock::splice(iterator pos, iterator first, iterator last) {
+    if (first == last) return;
+    //
+    auto* src = first->parent();
+    if (auto* journal = this->journal()) {
+        journal->record(journal::MoveInstrs{
+            &*first, &*std::prev(last), src,
+            last == src->end() ? nullptr : &*last});
+    }
+    std::for_each(first, last,
+                  [this](jj_vm::ir::Instr& instr) { instr.set_parent(this); });
+    bool is_end = (pos == m_instr.end());
+
+    m_instr.splice(pos, first, last);
+    invalidate_order();
+    src->invalidate_order();
+    update_phis();
+    src->update_phis();
+
+    if (is_end) update();
+}
+
+inline void BasicBlock::link_blocks(BasicBlock* succ, BasicBlock* pred) {
+    assert(succ && "Link basic blocks got nullptr successor");
+    assert(pred && "Link basic blocks got nullptr predcessor");
+    //
+    if (auto* journal = pred->journal())
+        journal->record(journal::LinkBlocks{succ, pred});
+    pred->add_succ(succ);
+    succ->add_pred(pred);
+    //
+    //! NOTE: phi input of the new pred takes its index
+    for (auto&& phi : succ->phis())
+        static_cast<PhiInstr&>(phi).pred_linked(pred);
+}
+
+inline void BasicBlock::remove_link(BasicBlock* succ, BasicBlock* pred) {
+    auto& preds = succ->m_preds;
+    auto pred_it = std::find(preds.begin(), preds.end(), pred);
+    //
+    auto& succs = pred->m_succs;
+    auto succ_it = std::find(succs.begin(), succs.end(), succ);
+    //
+    if (auto* journal = pred->journal())
+        journal->record(journal::UnlinkBlocks{
+            succ, pred, static_cast<std::size_t>(pred_it - preds.begin()),
+            static_cast<std::size_t>(succ_it - succs.begin())});
+    auto pred_pos = static_cast<std::size_t>(pred_it - preds.begin());
+    preds.erase(pred_it);
+    succs.erase(succ_it);
+    //
+    //! NOTE: inputs of the following preds are shifted
+    for (auto&& phi : succ->phis())
+        static_cast<PhiInstr&>(phi).reindex(pred_pos);
+}
+
+inline void PhiInstr::add_node(const std::pair<Instr*, BasicBlock*> input) {
+    auto idx = num_inputs();
+    set_incoming_block(idx, input.second);
+    add_input(input.first);
+    place(idx);
+}
+
+inline void PhiInstr::replace_incoming(
+    const BasicBlock* old_bb, const std::pair<Instr*, BasicBlock*> input) {
+    for (std::size_t idx = 0; idx < num_inputs(); ++idx)
+        if (m_blocks[idx] == old_bb) {
+            set_input(idx, input.first);
+            set_incoming_block(idx, input.second);
+            return place(idx);
+        }
+    assert(false && "Error: phi has no input from the block");
+}
+
+inline Value* PhiInstr::incoming(std::size_t pred_idx) const {
+    if (is_indexed(pred_idx)) return get_input(pred_idx);
+    return incoming(parent()->preds().at(pred_idx));
+}
+
+inline Value* PhiInstr::incoming(const BasicBlock* pred) const {
+    auto pred_idx = parent()->pred_index(pred);
+    if (is_indexed(pred_idx)) return get_input(pred_idx);
+    //
+    for (std::size_t idx = 0; idx < num_inputs(); ++idx)
+        if (m_blocks[idx] == pred) return get_input(idx);
+    return nullptr;
+}
+
+inline bool PhiInstr::is_indexed(std::size_t idx) const {
+    const auto* parent = this->parent();
+    return parent != nullptr && idx < num_inputs() &&
+           idx < parent->preds_num() && m_blocks[idx] == parent->preds()[idx];
+}
+
+inline void PhiInstr::set_incoming_block(std::size_t idx, BasicBlock* bb) {
+    if (idx >= m_blocks.size()) m_blocks.resize(idx + 1, nullptr);
+    if (auto* journal = this->journal())
+        journal->record(journal::SetIncoming{this, idx, m_blocks[idx]});
+    m_blocks[idx] = bb;
+}
+
+inline void PhiInstr::swap_inputs(std::size_t lhs, std::size_t rhs) {
+    auto* lhs_val = get_input(lhs);
+    set_input(lhs, get_input(rhs));
+    set_input(rhs, lhs_val);
+    //
+    auto* lhs_bb = m_blocks[lhs];
+    set_incoming_block(lhs, m_blocks[rhs]);
+    set_incoming_block(rhs, lhs_bb);
+}
+
+inline void PhiInstr::place(std::size_t idx) {
+    if (parent() == nullptr) return;
+    //
+    //! NOTE: every swap puts one input to its final slot
+    while (!is_indexed(idx)) {
+        auto pred_idx = parent()->pred_index(m_blocks[idx]);
+        if (pred_idx >= parent()->preds_num() || pred_idx >= num_inputs() ||
+            is_indexed(pred_idx))
+            return;
+        swap_inputs(idx, pred_idx);
+    }
+}
+
+inline void PhiInstr::pred_linked(const BasicBlock* pred) {
+    for (std::size_t idx = 0; idx < num_inputs(); ++idx)
+        if (m_blocks[idx] == pred && !is_indexed(idx)) return place(idx);
+}
+
+inline void PhiInstr::reindex(std::size_t first) {
+    for (auto idx = first; idx < num_inputs(); ++idx) place(idx);
+}
+
+inline void Instr::set_input(std::size_t id, Value* val) {
+    assert(id < m_num_operands && "Error: operand index out of range");
+    if (auto* journal = this->journal())
+        journal->record(journal::SetOperand{this, id, m_operands[id].get()});
+    m_operands[id].set(val);
+}
+
+inline void Instr::clean_inputs() {
+    if (auto* journal = this->journal()) {
+        journal->record(journal::ResizeOperands{this, m_num_operands});
+        for (std::size_t id = 0; id < m_num_operands; ++id)
+            journal->record(
+                journal::SetOperand{this, id, m_operands[id].get()});
+    }
+    for (auto&& use : *this) use.set(nullptr);
+    m_num_operands = 0;
+}
+
+inline void VariadicInstr::add_input(Value* val) {
+    if (auto* journal = this->journal())
+        journal->record(journal::ResizeOperands{this, m_num_operands});
+    //
+    //! NOTE: slots released by clean_inputs are reused, so they stay valid
+    //!       for the rollback
+    if (m_num_operands < m_operands_storage.size())
+        m_operands_storage[m_num_operands].set(val);
+    else
+        m_operands_storage.emplace_back(this, val);
+    reset_operands(m_operands_storage.data(), m_num_operands + 1);
+}
+
+inline void Value::replace_users(Value& other) {
+    if (this == &other) return;
+    //
+    while (other.m_uses != nullptr) {
+        auto* use = other.m_uses;
+        auto* user = use->user();
+        if (auto* journal = user->journal())
+            journal->record(journal::SetOperand{
+                user, static_cast<std::size_t>(use - user->begin()), &other});
+        use->set(this);
+    }
+}
+
+inline void Journal::attach(Function& func) {
+    //! NOTE: decoding of the body isn't an edit
+    func.materialize();
+    assert(func.m_journal == nullptr &&
+           "Error: function is already attached to some journal");
+    m_funcs.push_back({&func, func.m_values_num, func.m_blocks_num});
+    func.m_journal = this;
+}
+
+inline void Journal::commit() {
+    for (auto&& change : m_changes) {
+        if (auto* erased = std::get_if<journal::EraseInstr>(&change))
+            m_dropped_instrs.push_back(erased->m_instr);
+        else if (auto* erased_bb = std::get_if<journal::EraseBlock>(&change))
+            m_dropped_blocks.push_back(erased_bb->m_bb);
+    }
+    destroy_dropped();
+    detach();
+}
+
+inline void Journal::rollback() {
+    std::for_each(m_changes.rbegin(), m_changes.rend(), [this](auto&& change) {
+        std::visit([this](auto&& undone) { undo(undone); }, change);
+    });
+    //
+    for (auto&& attached : m_funcs) {
+        attached.m_func->m_values_num = attached.m_values_num;
+        attached.m_func->m_blocks_num = attached.m_blocks_num;
+    }
+    destroy_dropped();
+    detach();
+}
+
+inline void Journal::detach() noexcept {
+    for (auto&& attached : m_funcs) attached.m_func->m_journal = nullptr;
+    m_funcs.clear();
+    m_changes.clear();
+    m_ids.clear();
+    m_pools.clear();
+}
+
+inline void Journal::destroy_dropped() {
+    //! NOTE: node could be dropped several times, & it is destroyed only if
+    //!       no edit placed it back
+    auto dedup = [](auto& nodes) {
+        std::sort(nodes.begin(), nodes.end());
+        nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    };
+    dedup(m_dropped_instrs);
+    dedup(m_dropped_blocks);
+    //
+    for (auto* instr : m_dropped_instrs)
+        if (instr->parent() == nullptr) instr->~Instr();
+    for (auto* bb : m_dropped_blocks)
+        if (bb->parent() == nullptr) bb->~BasicBlock();
+    //
+    m_dropped_instrs.clear();
+    m_dropped_blocks.clear();
+}
+
+inline void Journal::undo(const journal::InsertInstr& change) {
+    auto* instr = change.m_instr;
+    if (auto* bb = instr->parent()) {
+        BasicBlock::iterator it{instr};
+        bb->m_instr.remove(it);
+        bb->invalidate_order();
+        bb->update_phis();
+        instr->set_parent(nullptr);
+    }
+    m_dropped_instrs.push_back(instr);
+}
+
+inline void Journal::undo(const journal::EraseInstr& change) {
+    auto* bb = change.m_bb;
+    auto pos = change.m_next != nullptr ? BasicBlock::iterator{change.m_next}
+                                        : bb->m_instr.end();
+    bb->m_instr.insert(pos, change.m_instr);
+    bb->invalidate_order();
+    bb->update_phis();
+    change.m_instr->set_parent(bb);
+}
+
+inline void Journal::undo(const journal::MoveInstrs& change) {
+    auto* dst = change.m_first->parent();
+    auto* src = change.m_src;
+    auto pos = change.m_src_next != nullptr
+                   ? BasicBlock::iterator{change.m_src_next}
+                   : src->m_instr.end();
+    BasicBlock::iterator first{change.m_first};
+    auto last = std::next(BasicBlock::iterator{change.m_last});
+    //
+    std::for_each(first, last, [src](Instr& instr) { instr.set_parent(src); });
+    src->m_instr.splice(pos, first, last);
+    src->invalidate_order();
+    dst->invalidate_order();
+    src->update_phis();
+    dst->update_phis();
+}
+
+inline void Journal::undo(const journal::SetIncoming& change) {
+    change.m_phi->m_blocks[change.m_idx] = change.m_old;
+}
+
+inline void Journal::undo(const journal::SetOperand& change) {
+    //! NOTE: slot could be out of the current operands (see clean_inputs)
+    change.m_instr->m_operands[change.m_idx].set(change.m_old);
+}
+
+inline void Journal::undo(const journal::ResizeOperands& change) {
+    auto* instr = change.m_instr;
+    for (auto idx = change.m_num; idx < instr->m_num_operands; ++idx)
+        instr->m_operands[idx].set(nullptr);
+    instr->m_num_operands = change.m_num;
+}
+
+inline void Journal::undo(const journal::LinkBlocks& change) {
+    assert(change.m_pred->m_succs.back() == change.m_succ);
+    assert(change.m_succ->m_preds.back() == change.m_pred);
+    change.m_pred->m_succs.pop_back();
+    change.m_succ->m_preds.pop_back();
+}
+
+inline void Journal::undo(const journal::UnlinkBlocks& change) {
+    auto& preds = change.m_succ->m_preds;
+    preds.insert(preds.begin() + change.m_pred_pos, change.m_pred);
+    auto& succs = change.m_pred->m_succs;
+    succs.insert(succs.begin() + change.m_succ_pos, change.m_succ);
+}
+
+inline void Journal::undo(const journal::InsertBlock& change) {
+    auto* bb = change.m_bb;
+    Function::iterator it{bb};
+    bb->parent()->m_basic_blocks.remove(it);
+    bb->set_parent(nullptr);
+    m_dropped_blocks.push_back(bb);
+}
+
+inline void Journal::undo(const journal::EraseBlock& change) {
+    auto& blocks = change.m_func->m_basic_blocks;
+    auto pos = change.m_next != nullptr ? Function::iterator{change.m_next}
+                                        : blocks.end();
+    blocks.insert(pos, change.m_bb);
+    change.m_bb->set_parent(change.m_func);
+}
+
+inline void Journal::undo(const journal::MoveBlocks& change) {
+    auto* src = change.m_src;
+    auto pos = change.m_src_next != nullptr
+                   ? Function::iterator{change.m_src_next}
+                   : src->m_basic_blocks.end();
+    Function::iterator first{change.m_first};
+    auto last = std::next(Function::iterator{change.m_last});
+    //
+    auto ids = change.m_ids;
+    for (auto it = first; it != last; ++it) {
+        it->set_parent(src);
+        if (ids == journal::kNoIds) continue;
+        //
+        it->m_bb_id = m_ids[ids++];
+        for (auto&& instr : *it) instr.m_id = m_ids[ids++];
+    }
+    src->m_basic_blocks.splice(pos, first, last);
+}
+
+inline void Journal::undo(const journal::Renumber& change) {
+    auto ids = change.m_ids;
+    change.m_func->for_each_id(
+        [this, &ids](std::uint32_t& id) { id = m_ids[ids++]; });
+}
+
+inline void Journal::undo(const journal::PoolInsert& change) {
+    change.m_func->m_consts.erase(change.m_instr);
+}
+
+inline void Journal::undo(const journal::PoolErase& change) {
+    auto* instr = change.m_instr;
+    change.m_func->m_consts.insert(instr->type(), const_value(*instr), instr);
+}
+
+inline void Journal::undo(const journal::PoolClear& change) {
+    change.m_func->m_consts = std::move(m_pools[change.m_pool]);
+}
+
+template <typename T, class... Args>
+T* BasicBlock::push_back(Args&&... args) {
+    //
+    static_assert(std::is_base_of<Instr, T>::value,
+                  "Error: expected Instruction derived type");
+    assert(m_parent && "Error: basic block without function can't allocate");
+    //
+    auto* const inserted =
+        m_parent->arena().template create<T>(std::forward<Args>(args)...);
+    m_instr.insert(fix_position(end(), inserted), inserted);
+    if (auto* journal = this->journal())
+        journal->record(journal::InsertInstr{inserted});
+    //
+    if constexpr (std::is_same_v<IfInstr, T>) {
+        link_blocks(inserted->true_bb(), this);
+        link_blocks(inserted->false_bb(), this);
+    } else if constexpr (std::is_same_v<BranchInstr, T>) {
+        link_blocks(inserted->dst(), this);
+    } else if constexpr (std::is_same_v<SwitchInstr, T>) {
+        for (auto* succ : inserted->succs()) link_blocks(succ, this);
+    }
+    //
+    inserted->set_parent(this);
+    phi_inserted(inserted);
+    m_parent->number(inserted);
+    update_order(inserted);
+    return inserted;
+}
+
+template <typename T, class... Args>
+T* BasicBlock::push_front(Args&&... args) {
+    //
+    static_assert(std::is_base_of<Instr, T>::value,
+                  "Error:expected Instruction derived type");
+    assert(m_parent && "Error: basic block without function can't allocate");
+    //
+    auto* const inserted =
+        m_parent->arena().template create<T>(std::forward<Args>(args)...);
+    m_instr.insert(fix_position(begin(), inserted), inserted);
+    if (auto* journal = this->journal())
+        journal->record(journal::InsertInstr{inserted});
+    //
+    inserted->set_parent(this);
+    phi_inserted(inserted);
+    m_parent->number(inserted);
+    update_order(inserted);
+    return inserted;
 }
 
 BasicBlock* split_bb_after(BasicBlock* block, Instr* instr) {
@@ -140,18 +841,50 @@ BasicBlock* split_bb_after(BasicBlock* block, Instr* instr) {
     return new_block;
 }
 
-class CallInstr final : public Instr {
+/**
+ * @brief Inputs of phis from the old preds of the block are replaced by
+ *        inputs from the new ones, the CFG is already updated. Every new pred
+ *        takes the value of the first old one, so values from old preds are
+ *        expected to be equal. Phis are rebuilt: inputs can't be removed
+ */
+inline void redirect_phis(BasicBlock* bb,
+                          const std::vector<BasicBlock*>& old_preds,
+                          const std::vector<BasicBlock*>& new_preds) {
+    auto is_old = [&old_preds](const BasicBlock* pred) {
+        return std::find(old_preds.begin(), old_preds.end(), pred) !=
+               old_preds.end();
+    };
+    std::vector<Instr*> phis{};
+    for (auto&& phi : bb->phis()) phis.push_back(&phi);
+    //
+    for (auto* old_phi : phis) {
+        auto* phi = bb->parent()->create<PhiInstr>(old_phi->type());
+        bb->insert(bb->phis_end(), phi);
+        Instr* val = nullptr;
+        for (auto&& [input, incoming] :
+             static_cast<PhiInstr*>(old_phi)->vars()) {
+            if (!is_old(incoming))
+                phi->add_node({input, incoming});
+            else if (val == nullptr)
+                val = input;
+        }
+        if (val != nullptr)
+            for (auto* pred : new_preds) phi->add_node({val, pred});
+        phi->replace_users(*old_phi);
+        erase(old_phi);
+    }
+}
+
+class CallInstr final : public VariadicInstr {
     jj_vm::ir::Function* m_callee{};
 
 public:
     explicit CallInstr(Type type, jj_vm::ir::Function* callee)
-        : Instr(type, jj_vm::ir::Opcode::CALL), m_callee(callee) {}
+        : VariadicInstr(type, jj_vm::ir::Opcode::CALL), m_callee(callee) {}
 
     void add_arg(Value* arg) { add_input(arg); }
 
     jj_vm::ir::Function* callee() const { return m_callee; }
-
-    /// Override dump
-    void dump(std::ostream& os) override {}
+    void set_callee(jj_vm::ir::Function* callee) { m_callee = callee; }
 };
 }  // namespace jj_vm::ir
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cassert>
+#include <iterator>
+#include <type_traits>
+
+#include "basic_block.hh"
+#include "function.hh"
+#include "graph/dfs.hh"
+#include "instructions.hh"
+#include "opcodes.hh"
+
+namespace jj_vm::ir {
+
+/**
+ * @brief Mapping of opcode to the handler & the class of the instruction:
+ *        HANDLER(opcode, handler name, instruction class, fallback handler)
+ */
+#define JJ_VM_INST_HANDLERS(HANDLER)                            \
+    HANDLER(ADD, add, BinInstr, bin)                            \
+    HANDLER(SUB, sub, BinInstr, bin)                            \
+    HANDLER(MUL, mul, BinInstr, bin)                            \
+    HANDLER(DIV, div, BinInstr, bin)                            \
+    HANDLER(SHR, shr, BinInstr, bin)                            \
+    HANDLER(XOR, xor, BinInstr, bin)                            \
+    HANDLER(EQ, eq, BinInstr, bin)                              \
+    HANDLER(LE, le, BinInstr, bin)                              \
+    HANDLER(GE, ge, BinInstr, bin)                              \
+    HANDLER(NEG, neg, UnaryInstr, unary)                        \
+    HANDLER(RET, ret, RetInstr, terminator)                     \
+    HANDLER(BRANCH, branch, BranchInstr, terminator)            \
+    HANDLER(IF, if, IfInstr, terminator)                        \
+    HANDLER(PHI, phi, PhiInstr, instr)                          \
+    HANDLER(CAST, cast, CastInstr, instr)                       \
+    HANDLER(CONST, const, Instr, instr)                         \
+    HANDLER(PARAM, param, ParamInstr, instr)                    \
+    HANDLER(CALL, call, CallInstr, instr)                       \
+    HANDLER(BOUNDS_CHECK, bounds_check, BinInstr, check)        \
+    HANDLER(NULL_CHECK, null_check, UnaryInstr, check)          \
+    HANDLER(SPLAT, splat, SplatInstr, instr)                    \
+    HANDLER(EXTRACT, extract, ExtractLaneInstr, instr)          \
+    HANDLER(INSERT, insert, InsertLaneInstr, instr)             \
+    HANDLER(ALLOC, alloc, AllocInstr, instr)                    \
+    HANDLER(LOAD, load, LoadInstr, instr)                       \
+    HANDLER(STORE, store, StoreInstr, instr)                    \
+    HANDLER(GEP, gep, GepInstr, instr)                          \
+    HANDLER(SELECT, select, SelectInstr, instr)                 \
+    HANDLER(SWITCH, switch, SwitchInstr, terminator)
+
+/**
+ * @brief Statically dispatched instruction visitor (CRTP).
+ *        visit(Instr&) switches over the opcode once and calls strongly typed
+ *        handler of Derived, e.g. visit_add(BinInstr&). Handlers which are
+ *        not defined in Derived fall back to the group one:
+ *            visit_add -> visit_bin -> visit_instr
+ *        All calls are non-virtual, so they could be inlined
+ *
+ *        NOTE: handler may erase the visited instruction
+ *
+ * @tparam Derived
+ * @tparam RetTy - return type of every handler
+ */
+template <typename Derived, typename RetTy = void>
+class InstVisitor {
+public:
+    /**
+     * @brief Visit blocks of the function in reverse post order
+     */
+    void visit(Function& func) {
+        auto rpo =
+            jj_vm::graph::deep_first_search_reverse_postoder(func.bb_graph());
+        for (auto* bb : rpo) derived().visit(*bb);
+    }
+
+    void visit(BasicBlock& bb) {
+        for (auto it = bb.begin(), end = bb.end(); it != end;) {
+            //! NOTE: iterator is moved forward before the handler erases instr
+            auto& instr = *it++;
+            derived().visit(instr);
+        }
+    }
+
+    RetTy visit(Instr& instr) {
+        switch (instr.opcode()) {
+#define INST_DELEGATE(opc, name, cls, fallback) \
+    case Opcode::opc:                           \
+        return derived().visit_##name(as<cls>(instr));
+            JJ_VM_INST_HANDLERS(INST_DELEGATE)
+#undef INST_DELEGATE
+            case Opcode::NONE:
+                break;
+            default:
+                assert(false && "Error: unknown opcode");
+                return RetTy();
+        }
+        assert(false && "Error: instruction without opcode");
+        return RetTy();
+    }
+
+    /**
+     * @brief Default handlers
+     */
+#define INST_FALLBACK(opc, name, cls, fallback) \
+    RetTy visit_##name(cls& instr) { return derived().visit_##fallback(instr); }
+    JJ_VM_INST_HANDLERS(INST_FALLBACK)
+#undef INST_FALLBACK
+
+    RetTy visit_bin(BinInstr& instr) { return derived().visit_instr(instr); }
+    RetTy visit_unary(UnaryInstr& instr) { return derived().visit_instr(instr); }
+    RetTy visit_terminator(Instr& instr) { return derived().visit_instr(instr); }
+    RetTy visit_check(Instr& instr) { return derived().visit_instr(instr); }
+
+    RetTy visit_instr(Instr&) { return RetTy(); }
+
+private:
+    Derived& derived() noexcept { return static_cast<Derived&>(*this); }
+
+    //! NOTE: CONST is handled as plain Instr, it needs no cast
+    template <typename InstrTy>
+    static InstrTy& as(Instr& instr) noexcept {
+        if constexpr (std::is_same_v<InstrTy, Instr>)
+            return instr;
+        else
+            return static_cast<InstrTy&>(instr);
+    }
+};
+
+#define INST_COUNT(opc, name, cls, fallback) +1
+//! NOTE: every opcode except NONE has its handler
+static_assert(0 JJ_VM_INST_HANDLERS(INST_COUNT) + 1 == kOpcodesNum,
+              "Error: opcode without InstVisitor handler");
+#undef INST_COUNT
+
+}  // namespace jj_vm::ir
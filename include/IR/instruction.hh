@@ -1,10 +1,19 @@
 #pragma once
 
-#include <unordered_set>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "intrusive_list/ilist.hh"
 #include "opcodes.hh"
+#include "utils/iterator_range.hh"
 //
 #include <algorithm>
 #include <iostream>
@@ -22,11 +31,117 @@ enum class TypeId : uint8_t {
     I16,
     I32,
     I64,
+    //! NOTE: fixed-width vectors, operations are applied lane-wise
+    V4I32,
+    V2I64,
+    V8I32,
+    V4I64,
+    //! NOTE: opaque address of the memory, offsets are in bytes
+    PTR,
 };
 
+/// Textual name of the type, e.g. "i32", "v4i32"
+constexpr std::string_view type_name(TypeId type) noexcept {
+    switch (type) {
+        case TypeId::NONE:
+            return "none";
+        case TypeId::I1:
+            return "i1";
+        case TypeId::I8:
+            return "i8";
+        case TypeId::I16:
+            return "i16";
+        case TypeId::I32:
+            return "i32";
+        case TypeId::I64:
+            return "i64";
+        case TypeId::V4I32:
+            return "v4i32";
+        case TypeId::V2I64:
+            return "v2i64";
+        case TypeId::V8I32:
+            return "v8i32";
+        case TypeId::V4I64:
+            return "v4i64";
+        case TypeId::PTR:
+            return "ptr";
+        default:
+            break;
+    }
+    return {};
+}
+
+/**
+ * @brief Vector types: 128-bit ones (v4i32, v2i64) are SSE registers,
+ *        256-bit ones (v8i32, v4i64) are AVX2 registers
+ */
+constexpr bool is_vector(TypeId type) noexcept {
+    return type >= TypeId::V4I32 && type <= TypeId::V4I64;
+}
+
+/// Type of the lane, scalar type is the lane of itself
+constexpr TypeId element_type(TypeId type) noexcept {
+    switch (type) {
+        case TypeId::V4I32:
+        case TypeId::V8I32:
+            return TypeId::I32;
+        case TypeId::V2I64:
+        case TypeId::V4I64:
+            return TypeId::I64;
+        default:
+            return type;
+    }
+}
+
+/// Number of lanes, scalar type has the only one
+constexpr std::size_t lanes(TypeId type) noexcept {
+    switch (type) {
+        case TypeId::V2I64:
+            return 2;
+        case TypeId::V4I32:
+        case TypeId::V4I64:
+            return 4;
+        case TypeId::V8I32:
+            return 8;
+        default:
+            return 1;
+    }
+}
+
+/// Width of the scalar type or of the whole vector in bits
+constexpr std::size_t type_bits(TypeId type) noexcept {
+    switch (element_type(type)) {
+        case TypeId::I1:
+            return 1;
+        case TypeId::I8:
+            return 8;
+        case TypeId::I16:
+            return 16;
+        case TypeId::I32:
+            return 32 * lanes(type);
+        case TypeId::I64:
+            return 64 * lanes(type);
+        case TypeId::PTR:
+            return 64;
+        default:
+            return 0;
+    }
+}
+
+/// Vector of lanes of the scalar type, NONE if there is no such type
+constexpr TypeId vector_type(TypeId elem, std::size_t lanes_num) noexcept {
+    for (auto type :
+         {TypeId::V4I32, TypeId::V2I64, TypeId::V8I32, TypeId::V4I64})
+        if (element_type(type) == elem && lanes(type) == lanes_num)
+            return type;
+    return TypeId::NONE;
+}
+
 class IRBuilder;
 class Instr;
 class BasicBlock;
+class Function;
+class Journal;
 
 /**
  * @brief Type enum wrapper for standart jj_vm types, which described in Typeid
@@ -49,32 +164,323 @@ public:
     }
 };
 
-/***/
+class Use;
+
+/**
+ * @brief Iterator over intrusive use-list of the value
+ *
+ * @tparam IsUser - dereference to user instruction instead of the Use itself
+ */
+template <bool IsUser>
+class UseIteratorImpl final {
+public:
+    using value_type = std::conditional_t<IsUser, Instr*, Use>;
+    using reference = std::conditional_t<IsUser, Instr*, Use&>;
+    using pointer = value_type*;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+
+private:
+    Use* m_use = nullptr;
+
+public:
+    UseIteratorImpl() = default;
+    explicit UseIteratorImpl(Use* use) : m_use(use) {}
+
+    reference operator*() const noexcept;
+
+    UseIteratorImpl& operator++() noexcept;
+    UseIteratorImpl operator++(int) noexcept {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    Use* get_use() const noexcept { return m_use; }
+
+    friend bool operator==(const UseIteratorImpl& lhs,
+                           const UseIteratorImpl& rhs) noexcept {
+        return lhs.m_use == rhs.m_use;
+    }
+
+    friend bool operator!=(const UseIteratorImpl& lhs,
+                           const UseIteratorImpl& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+
+using use_iterator = UseIteratorImpl<false>;
+using user_iterator = UseIteratorImpl<true>;
+
+/**
+ * @brief Value is anything which could be used as an instruction input.
+ *        It keeps intrusive list of its uses, so adding/removing a use is O(1)
+ *        and no memory is allocated
+ */
 class Value {
+public:
+    using id_type = std::uint32_t;
+    static constexpr id_type kInvalidId = std::numeric_limits<id_type>::max();
+
 protected:
     Type m_type{};
-    std::unordered_set<Instr*> m_users;
+    Use* m_uses = nullptr;
+    //
+    //! NOTE: dense index inside parent function, it's assigned by Function
+    id_type m_id = kInvalidId;
+    //! NOTE: it's set by Param, other values are instructions
+    bool m_is_param = false;
 
 public:
     Value() = default;
     explicit Value(Type type) : m_type(type) {}
 
-    auto& users() const { return m_users; }
-    auto& users() { return m_users; }
+    //! NOTE: no copy semantic due to intrusive use-list
+    Value(const Value&) = delete;
+    Value& operator=(const Value&) = delete;
+
+    ~Value();
 
-    void remove_user(Instr* instr) { m_users.erase(instr); }
+    /**
+     * @brief Ranges over use-list of the value
+     *        NOTE: user is met so many times as it uses the value
+     */
+    auto uses() const noexcept {
+        return utils::make_range(use_iterator{m_uses}, use_iterator{});
+    }
+
+    auto users() const noexcept {
+        return utils::make_range(user_iterator{m_uses}, user_iterator{});
+    }
+
+    bool has_users() const noexcept { return m_uses != nullptr; }
+
+    /**
+     * @brief Replace all uses of other value with this one. O(uses of other)
+     *        NOTE: it's defined in function.hh to record rewrites in journal
+     */
     void replace_users(Value& other);
     //
     /**
      * @brief Getters
      */
     TypeId type() const noexcept { return m_type.type(); }
+
+    /// Dense per-function index, see utils::SideTable
+    id_type id() const noexcept { return m_id; }
+
+    /// Param of the function, it isn't Instr: it has no parent & opcode
+    bool is_param() const noexcept { return m_is_param; }
+
+    friend Use;
+    friend Function;
+};
+
+/**
+ * @brief Operand slot of an instruction. It points to the used value and
+ *        is linked into the use-list of that value
+ */
+class Use final {
+    Value* m_val = nullptr;
+    Instr* m_user = nullptr;
+    //
+    Use* m_next = nullptr;
+    //! NOTE: address of the pointer which points to this use
+    Use** m_prev = nullptr;
+
+public:
+    Use() = default;
+    explicit Use(Instr* user, Value* val = nullptr) : m_user(user) { set(val); }
+
+    Use(const Use&) = delete;
+    Use& operator=(const Use&) = delete;
+
+    //! NOTE: moving keeps position in the use-list (vector relocation)
+    Use(Use&& other) noexcept : m_val(other.m_val), m_user(other.m_user) {
+        take_links(other);
+    }
+
+    Use& operator=(Use&& other) noexcept {
+        if (this != &other) {
+            unlink();
+            m_val = other.m_val;
+            m_user = other.m_user;
+            take_links(other);
+        }
+        return *this;
+    }
+
+    ~Use() { unlink(); }
+
+    /**
+     * @brief Getters
+     */
+    Value* get() const noexcept { return m_val; }
+    Instr* user() const noexcept { return m_user; }
+    Use* next() const noexcept { return m_next; }
+
+    /**
+     * @brief Setters
+     */
+    void set(Value* val) noexcept {
+        unlink();
+        m_val = val;
+        if (val == nullptr) return;
+        //
+        m_next = val->m_uses;
+        if (m_next != nullptr) m_next->m_prev = &m_next;
+        m_prev = &val->m_uses;
+        val->m_uses = this;
+    }
+
+    void set_user(Instr* user) noexcept { m_user = user; }
+
+private:
+    void unlink() noexcept {
+        if (m_prev != nullptr) {
+            *m_prev = m_next;
+            if (m_next != nullptr) m_next->m_prev = m_prev;
+        }
+        m_next = nullptr;
+        m_prev = nullptr;
+    }
+
+    void take_links(Use& other) noexcept {
+        m_next = std::exchange(other.m_next, nullptr);
+        m_prev = std::exchange(other.m_prev, nullptr);
+        other.m_val = nullptr;
+        //
+        if (m_prev != nullptr) *m_prev = this;
+        if (m_next != nullptr) m_next->m_prev = &m_next;
+    }
+
+    friend Value;
+};
+
+inline Value::~Value() {
+    //! NOTE: detach dangling uses, so users could be destroyed later
+    while (m_uses != nullptr) {
+        auto* use = m_uses;
+        m_uses = use->m_next;
+        //
+        use->m_val = nullptr;
+        use->m_next = nullptr;
+        use->m_prev = nullptr;
+    }
+}
+
+template <bool IsUser>
+typename UseIteratorImpl<IsUser>::reference UseIteratorImpl<IsUser>::operator*()
+    const noexcept {
+    if constexpr (IsUser)
+        return m_use->user();
+    else
+        return *m_use;
+}
+
+template <bool IsUser>
+UseIteratorImpl<IsUser>& UseIteratorImpl<IsUser>::operator++() noexcept {
+    m_use = m_use->next();
+    return *this;
+}
+
+/**
+ * @brief Random access iterator over operand slots, which yields used values
+ */
+class OperandIterator final {
+public:
+    using value_type = Value*;
+    using reference = Value*;
+    using pointer = Value* const*;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::random_access_iterator_tag;
+
+private:
+    const Use* m_use = nullptr;
+
+public:
+    OperandIterator() = default;
+    explicit OperandIterator(const Use* use) : m_use(use) {}
+
+    reference operator*() const noexcept { return m_use->get(); }
+    reference operator[](difference_type n) const noexcept {
+        return m_use[n].get();
+    }
+
+    OperandIterator& operator++() noexcept {
+        ++m_use;
+        return *this;
+    }
+    OperandIterator operator++(int) noexcept {
+        return OperandIterator{m_use++};
+    }
+
+    OperandIterator& operator--() noexcept {
+        --m_use;
+        return *this;
+    }
+    OperandIterator operator--(int) noexcept {
+        return OperandIterator{m_use--};
+    }
+
+    OperandIterator& operator+=(difference_type n) noexcept {
+        m_use += n;
+        return *this;
+    }
+    OperandIterator& operator-=(difference_type n) noexcept {
+        m_use -= n;
+        return *this;
+    }
+
+    friend OperandIterator operator+(OperandIterator it, difference_type n) {
+        return it += n;
+    }
+    friend OperandIterator operator+(difference_type n, OperandIterator it) {
+        return it += n;
+    }
+    friend OperandIterator operator-(OperandIterator it, difference_type n) {
+        return it -= n;
+    }
+    friend difference_type operator-(const OperandIterator& lhs,
+                                     const OperandIterator& rhs) {
+        return lhs.m_use - rhs.m_use;
+    }
+
+    friend bool operator==(const OperandIterator& lhs,
+                           const OperandIterator& rhs) {
+        return lhs.m_use == rhs.m_use;
+    }
+    friend bool operator!=(const OperandIterator& lhs,
+                           const OperandIterator& rhs) {
+        return lhs.m_use != rhs.m_use;
+    }
+    friend bool operator<(const OperandIterator& lhs,
+                          const OperandIterator& rhs) {
+        return lhs.m_use < rhs.m_use;
+    }
+    friend bool operator>(const OperandIterator& lhs,
+                          const OperandIterator& rhs) {
+        return rhs < lhs;
+    }
+    friend bool operator<=(const OperandIterator& lhs,
+                           const OperandIterator& rhs) {
+        return !(rhs < lhs);
+    }
+    friend bool operator>=(const OperandIterator& lhs,
+                           const OperandIterator& rhs) {
+        return !(lhs < rhs);
+    }
 };
 
+using operand_range = utils::IteratorRange<OperandIterator>;
+
 /**
  * @brief Base Instruction class
           Instruction inherits Value due provide parameterized type of some
           instructions
+          Operand slots are not owned by the base class: fixed arity
+          instructions keep them inside the node (see FixedArityInstr), Phi and
+          Call keep them in growable buffer (see VariadicInstr)
  *
  */
 class Instr : public Value, public ilist_detail::ilist_node {
@@ -83,10 +489,11 @@ protected:
     Opcode m_opcode = Opcode::NONE;
     BasicBlock* m_parent = nullptr;
     //
-    std::size_t m_live{};
-    std::size_t m_lin{};
+    //! NOTE: sparse position inside parent block, see BasicBlock::comes_before
+    std::uint32_t m_order = 0;
     //
-    std::vector<Value*> m_inputs;
+    Use* m_operands = nullptr;
+    std::size_t m_num_operands = 0;
     //
     Instr() = default;
     //
@@ -96,6 +503,11 @@ protected:
     Instr(Opcode opc, BasicBlock* bb = nullptr) : m_opcode(opc), m_parent(bb) {}
 
     void set_parent(BasicBlock* parent) noexcept { m_parent = parent; }
+
+    void reset_operands(Use* operands, std::size_t num) noexcept {
+        m_operands = operands;
+        m_num_operands = num;
+    }
     //
 public:
     Instr(const Instr&) = delete;
@@ -112,58 +524,75 @@ public:
     const BasicBlock* parent() const { return m_parent; }
     BasicBlock* parent() { return m_parent; }
 
-    auto live() const noexcept { return m_live; }
-    auto lin() const noexcept { return m_lin; }
+    /// Journal of the parent function, nullptr if edits aren't recorded
+    Journal* journal() const noexcept;
 
-    auto inputs() const noexcept { return m_inputs; }
-    Value* get_input(std::size_t id) const { return m_inputs.at(id); }
+    /// Non-owning view of used values, no copies
+    operand_range inputs() const noexcept {
+        return utils::make_range(OperandIterator{m_operands},
+                                 OperandIterator{m_operands + m_num_operands});
+    }
 
-    auto begin() { return m_inputs.begin(); }
-    auto begin() const { return m_inputs.begin(); }
+    std::size_t num_inputs() const noexcept { return m_num_operands; }
 
-    auto end() { return m_inputs.end(); }
-    auto end() const { return m_inputs.end(); }
+    Value* get_input(std::size_t id) const {
+        assert(id < m_num_operands && "Error: operand index out of range");
+        return m_operands[id].get();
+    }
+
+    /// Iterators over operand uses
+    Use* begin() noexcept { return m_operands; }
+    const Use* begin() const noexcept { return m_operands; }
+
+    Use* end() noexcept { return m_operands + m_num_operands; }
+    const Use* end() const noexcept { return m_operands + m_num_operands; }
 
     /**
      * @brief Setters
      */
-    void set_live(std::size_t live) { m_live = live; }
-    void set_lin(std::size_t lin) { m_lin = lin; }
-
-    void add_input(Value* val) {
-        val->users().insert(this);
-        m_inputs.push_back(val);
-    }
+    /// O(1)
+    void set_input(std::size_t id, Value* val);
 
-    void set_input(std::size_t id, Value* val) {
-        auto& inp = m_inputs[id];
+    /// O(inputs)
+    void clean_inputs();
 
-        //! NOTE: check number of inputs
-        if (std::count(m_inputs.begin(), m_inputs.end(), inp) == 1)
-            inp->users().erase(this);
-        //
-        inp = val;
-        inp->users().insert(this);
-    }
+    friend IRBuilder;
+    friend BasicBlock;
+    friend Journal;
+};
 
-    void clean_inputs() {
-        for (auto* input : m_inputs) input->users().erase(this);
+/**
+ * @brief Instruction with operands count known at creation.
+ *        Operand slots are part of the node, so they come from the same arena
+ *        chunk and no heap allocation is performed
+ *
+ * @tparam N - number of operands
+ */
+template <std::size_t N>
+class FixedArityInstr : public Instr {
+    std::array<Use, N> m_operands_storage{};
 
-        m_inputs.clear();
+protected:
+    FixedArityInstr(Type type, Opcode opc, std::array<Value*, N> vals)
+        : Instr(type, opc) {
+        for (std::size_t i = 0; i < N; ++i) {
+            m_operands_storage[i].set_user(this);
+            m_operands_storage[i].set(vals[i]);
+        }
+        reset_operands(m_operands_storage.data(), N);
     }
-
-    virtual void dump(std::ostream& os) = 0;
-    //
-    friend IRBuilder;
-    friend BasicBlock;
 };
 
-void Value::replace_users(Value& other) {
-    auto& cur_users = users();
-    cur_users.merge(other.users());
-    other.users().clear();
+/**
+ * @brief Instruction with growable list of operands (Phi, Call)
+ */
+class VariadicInstr : public Instr {
+    std::vector<Use> m_operands_storage{};
 
-    for (auto* user : cur_users)
-        std::replace(user->begin(), user->end(), &other, this);
-}
+protected:
+    VariadicInstr(Type type, Opcode opc) : Instr(type, opc) {}
+
+    /// O(1) amortized
+    void add_input(Value* val);
+};
 }  // namespace jj_vm::ir
@@ -5,30 +5,28 @@
 #include "instruction.hh"
 #include "opcodes.hh"
 //
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <limits>
 #include <ostream>
+#include <utility>
 #include <vector>
 
 namespace jj_vm::ir {
 
-class IfInstr final : public Instr {
+class IfInstr final : public FixedArityInstr<1> {
     //
     BasicBlock* m_true_bb = nullptr;
     BasicBlock* m_false_bb = nullptr;
-    //
-    Value* m_cond = nullptr;
 
 public:
     IfInstr(BasicBlock* true_bb, BasicBlock* false_bb, Value* cond = nullptr)
-        : Instr(Opcode::IF),
+        : FixedArityInstr(Type{}, Opcode::IF, {cond}),
           m_true_bb(true_bb),
-          m_false_bb(false_bb),
-          m_cond(cond) {
-        add_input(cond);
-    }
+          m_false_bb(false_bb) {}
 
     /**
      * @brief Getters
@@ -36,9 +34,6 @@ public:
     auto true_bb() const noexcept { return m_true_bb; }
     auto false_bb() const noexcept { return m_false_bb; }
     auto cond() const noexcept { return get_input(0); }
-
-    /// Override dump
-    void dump(std::ostream& os) override {}
 };
 
 /**
@@ -56,40 +51,24 @@ public:
      * @brief Getters
      */
     auto dst() const noexcept { return m_dst; }
-
-    /// Override dump
-    void dump(std::ostream& os) override {}
 };
 
-class RetInstr final : public Instr {
-    Value* m_retval{};
-
+class RetInstr final : public FixedArityInstr<1> {
 public:
-    RetInstr(Value* retval) : Instr(Opcode::RET), m_retval(retval) {
-        add_input(retval);
-    }
+    RetInstr(Value* retval) : FixedArityInstr(Type{}, Opcode::RET, {retval}) {}
 
     /**
      * @brief Getters
      */
     auto retval() const noexcept { return get_input(0); }
-
-    /// Override dump
-    void dump(std::ostream& os) override {}
 };
 
-class BinInstr final : public Instr {
-    //
-    Value* m_lhs = nullptr;
-    Value* m_rhs = nullptr;
-
+class BinInstr final : public FixedArityInstr<2> {
 public:
     BinInstr(Opcode opc, Value* lhs, Value* rhs)
-        : Instr(lhs->type(), opc), m_lhs(lhs), m_rhs(rhs) {
+        : FixedArityInstr(lhs->type(), opc, {lhs, rhs}) {
         //
         assert(lhs->type() == rhs->type());
-        add_input(lhs);
-        add_input(rhs);
     }
 
 public:
@@ -98,65 +77,257 @@ public:
      */
     auto lhs() const noexcept { return get_input(0); }
     auto rhs() const noexcept { return get_input(1); }
-
-    /// Override dump
-    void dump(std::ostream& os) override {}
 };
 
-class UnaryInstr final : public Instr {
+class UnaryInstr final : public FixedArityInstr<1> {
 public:
-    UnaryInstr(Opcode opc, Value* val) : Instr(val->type(), opc) {
-        add_input(val);
-    }
+    UnaryInstr(Opcode opc, Value* val)
+        : FixedArityInstr(val->type(), opc, {val}) {}
 
     auto val() const noexcept { return get_input(0); }
-
-    /// Override dump
-    void dump(std::ostream& os) override {}
 };
 
-class PhiInstr final : public Instr {
+/**
+ * @brief Phi keeps its inputs indexed by predecessors: input i comes from
+ *        parent()->preds()[i], so incoming value of the pred is O(1).
+ *        Input added for a block which isn't a pred yet is kept after the
+ *        indexed ones and takes its place once the edge is linked
+ *        (see BasicBlock::link_blocks).
+ *
+ *        NOTE: methods which depend on the parent block are defined in
+ *              function.hh
+ */
+class PhiInstr final : public VariadicInstr {
     //
 public:
     using phi_var_pair = std::pair<Instr*, BasicBlock*>;
 
+    /**
+     * @brief Lazy view of (input, incoming block) pairs, nothing is copied
+     */
+    class VarsRange final {
+        const PhiInstr* m_phi = nullptr;
+
+    public:
+        class iterator final {
+            const PhiInstr* m_phi = nullptr;
+            std::size_t m_idx = 0;
+
+        public:
+            using value_type = phi_var_pair;
+            using reference = phi_var_pair;
+            using pointer = void;
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::input_iterator_tag;
+
+            iterator() = default;
+            iterator(const PhiInstr* phi, std::size_t idx)
+                : m_phi(phi), m_idx(idx) {}
+
+            reference operator*() const { return (*m_phi)[m_idx]; }
+
+            iterator& operator++() noexcept {
+                ++m_idx;
+                return *this;
+            }
+            iterator operator++(int) noexcept { return {m_phi, m_idx++}; }
+
+            friend bool operator==(const iterator& lhs, const iterator& rhs) {
+                return lhs.m_idx == rhs.m_idx;
+            }
+            friend bool operator!=(const iterator& lhs, const iterator& rhs) {
+                return !(lhs == rhs);
+            }
+        };
+
+        explicit VarsRange(const PhiInstr* phi) : m_phi(phi) {}
+
+        iterator begin() const { return {m_phi, 0}; }
+        iterator end() const { return {m_phi, size()}; }
+
+        std::size_t size() const noexcept { return m_phi->num_inputs(); }
+        bool empty() const noexcept { return size() == 0; }
+
+        phi_var_pair operator[](std::size_t idx) const { return (*m_phi)[idx]; }
+    };
+
 private:
-    std::vector<std::pair<Instr*, BasicBlock*>> m_vars;
+    //! NOTE: incoming block of the input with the same index, it is never
+    //!       shrunk, so the journal could restore it
+    std::vector<BasicBlock*> m_blocks;
 
 public:
-    PhiInstr(Type type) : Instr(type, Opcode::PHI) {}
+    PhiInstr(Type type) : VariadicInstr(type, Opcode::PHI) {}
     //
-    void add_node(const std::pair<Instr*, BasicBlock*> input) {
-        m_vars.push_back(input);
-        add_input(input.first);
-    }
+    void add_node(const std::pair<Instr*, BasicBlock*> input);
+
+    /// Input from the old block is taken from the new one, e.g. the edge is
+    /// split or redirected. Input is placed when the new block is linked
+    void replace_incoming(const BasicBlock* old_bb,
+                          const std::pair<Instr*, BasicBlock*> input);
 
     /**
      * @brief Getters
      */
-    auto vars() const noexcept { return m_vars; }
+    BasicBlock* incoming_block(std::size_t idx) const noexcept {
+        assert(idx < num_inputs() && "Error: phi input index out of range");
+        return m_blocks[idx];
+    }
+
+    /// Incoming value from parent()->preds()[pred_idx]. O(1) if inputs are
+    /// indexed by preds, otherwise incoming blocks are searched
+    Value* incoming(std::size_t pred_idx) const;
 
-    /// Override dump
-    void dump(std::ostream& os) override {}
+    /// Same as above for the pred block, nullptr if there is no such input
+    Value* incoming(const BasicBlock* pred) const;
+
+    phi_var_pair operator[](std::size_t idx) const {
+        return {static_cast<Instr*>(get_input(idx)), incoming_block(idx)};
+    }
+
+    VarsRange vars() const noexcept { return VarsRange{this}; }
+
+private:
+    void set_incoming_block(std::size_t idx, BasicBlock* bb);
+    void swap_inputs(std::size_t lhs, std::size_t rhs);
+
+    /// Move input into the slot of its pred, displaced input is placed too
+    void place(std::size_t idx);
+
+    /// Hooks of BasicBlock::link_blocks & BasicBlock::remove_link
+    void pred_linked(const BasicBlock* pred);
+    void reindex(std::size_t first);
+
+    bool is_indexed(std::size_t idx) const;
+
+    friend BasicBlock;
+    friend Journal;
 };
 
 //! NOTE: maybe inherit public UnaryInstr in future ???
-class CastInstr final : public Instr {
-    //
-    Value* m_src_val = nullptr;
-
+class CastInstr final : public FixedArityInstr<1> {
 public:
-    CastInstr(Type ty, Value* val) : Instr(ty, Opcode::CAST), m_src_val(val) {
-        add_input(val);
-    }
+    CastInstr(Type ty, Value* val) : FixedArityInstr(ty, Opcode::CAST, {val}) {}
 
     /**
      * @brief Getters
      */
-    auto src_val() const noexcept { return m_src_val; }
+    auto src_val() const noexcept { return get_input(0); }
+};
+
+/**
+ * @brief Vector with every lane equal to the scalar value
+ */
+class SplatInstr final : public FixedArityInstr<1> {
+public:
+    SplatInstr(Type type, Value* val)
+        : FixedArityInstr(type, Opcode::SPLAT, {val}) {
+        assert(is_vector(type.type()) &&
+               element_type(type.type()) == val->type());
+    }
+
+    auto val() const noexcept { return get_input(0); }
+};
+
+/**
+ * @brief Lane of the vector, lane index is the constant operand
+ */
+class ExtractLaneInstr final : public FixedArityInstr<2> {
+public:
+    ExtractLaneInstr(Value* vec, Instr* lane)
+        : FixedArityInstr(element_type(vec->type()), Opcode::EXTRACT,
+                          {vec, lane}) {
+        assert(is_vector(vec->type()) && lane->opcode() == Opcode::CONST);
+    }
+
+    auto vec() const noexcept { return get_input(0); }
+    auto lane() const noexcept { return get_input(1); }
+};
+
+/**
+ * @brief Copy of the vector with the lane replaced by the scalar value
+ */
+class InsertLaneInstr final : public FixedArityInstr<3> {
+public:
+    InsertLaneInstr(Value* vec, Value* val, Instr* lane)
+        : FixedArityInstr(vec->type(), Opcode::INSERT, {vec, val, lane}) {
+        assert(is_vector(vec->type()) &&
+               element_type(vec->type()) == val->type() &&
+               lane->opcode() == Opcode::CONST);
+    }
 
-    /// Override dump
-    void dump(std::ostream& os) override {}
+    auto vec() const noexcept { return get_input(0); }
+    auto val() const noexcept { return get_input(1); }
+    auto lane() const noexcept { return get_input(2); }
+};
+
+/**
+ * @brief Zero-filled memory of the size (in bytes) which lives until the
+ *        function exits
+ */
+class AllocInstr final : public FixedArityInstr<1> {
+public:
+    explicit AllocInstr(Value* size)
+        : FixedArityInstr(TypeId::PTR, Opcode::ALLOC, {size}) {}
+
+    auto size() const noexcept { return get_input(0); }
+};
+
+class LoadInstr final : public FixedArityInstr<1> {
+public:
+    LoadInstr(Type type, Value* ptr)
+        : FixedArityInstr(type, Opcode::LOAD, {ptr}) {
+        assert(ptr->type() == TypeId::PTR && type.type() != TypeId::NONE);
+    }
+
+    auto ptr() const noexcept { return get_input(0); }
+};
+
+/**
+ * @brief Store of the value, the size of the stored memory is the width of
+ *        the value type
+ */
+class StoreInstr final : public FixedArityInstr<2> {
+public:
+    StoreInstr(Value* ptr, Value* val)
+        : FixedArityInstr(Type{}, Opcode::STORE, {ptr, val}) {
+        assert(ptr->type() == TypeId::PTR);
+    }
+
+    auto ptr() const noexcept { return get_input(0); }
+    auto val() const noexcept { return get_input(1); }
+};
+
+/**
+ * @brief Address of the pointer plus the offset in bytes
+ */
+class GepInstr final : public FixedArityInstr<2> {
+public:
+    GepInstr(Value* ptr, Value* offset)
+        : FixedArityInstr(TypeId::PTR, Opcode::GEP, {ptr, offset}) {
+        assert(ptr->type() == TypeId::PTR && !is_vector(offset->type()));
+    }
+
+    auto ptr() const noexcept { return get_input(0); }
+    auto offset() const noexcept { return get_input(1); }
+};
+
+/**
+ * @brief Value of true_val if the condition isn't zero, of false_val
+ *        otherwise. Both values are computed before, there is no branch
+ */
+class SelectInstr final : public FixedArityInstr<3> {
+public:
+    SelectInstr(Value* cond, Value* true_val, Value* false_val)
+        : FixedArityInstr(true_val->type(), Opcode::SELECT,
+                          {cond, true_val, false_val}) {
+        assert(!is_vector(cond->type()) &&
+               true_val->type() == false_val->type());
+    }
+
+    auto cond() const noexcept { return get_input(0); }
+    auto true_val() const noexcept { return get_input(1); }
+    auto false_val() const noexcept { return get_input(2); }
 };
 
 template <typename Type>
@@ -177,11 +348,11 @@ class Constant : public Instr {
         cstd_ty m_val;                                              \
                                                                     \
     public:                                                         \
+        static constexpr TypeId kTypeId = TypeId::jj_ir_ty;         \
+                                                                    \
         Constant(cstd_ty val)                                       \
             : Instr{TypeId::jj_ir_ty, Opcode::CONST}, m_val(val) {} \
                                                                     \
-        void dump(std::ostream& stream) override {}                 \
-                                                                    \
         cstd_ty val() const { return m_val; }                       \
     };                                                              \
                                                                     \
@@ -195,6 +366,98 @@ CONSTANT_SPEC(int16_t, I16);
 CONSTANT_SPEC(int32_t, I32);
 CONSTANT_SPEC(int64_t, I64);
 
+/**
+ * @brief Value of the CONST instruction extended to int64_t, it allows to
+ *        compare constants w/o switching over their types
+ */
+inline std::int64_t const_value(const Instr& instr) {
+    assert(instr.opcode() == Opcode::CONST && "Error: expected constant");
+    switch (instr.type()) {
+        case TypeId::I1:
+            return static_cast<const ConstI1&>(instr).val();
+        case TypeId::I8:
+            return static_cast<const ConstI8&>(instr).val();
+        case TypeId::I16:
+            return static_cast<const ConstI16&>(instr).val();
+        case TypeId::I32:
+            return static_cast<const ConstI32&>(instr).val();
+        case TypeId::I64:
+            return static_cast<const ConstI64&>(instr).val();
+        default:
+            break;
+    }
+    assert(false && "Error: constant without scalar type");
+    return 0;
+}
+
+/// Lane index of EXTRACT & INSERT, it's the constant operand
+inline std::size_t lane_index(const Value* lane) {
+    return static_cast<std::size_t>(
+        const_value(*static_cast<const Instr*>(lane)));
+}
+
+/**
+ * @brief Multi-way branch. Inputs are the condition & values of cases, the
+ *        values are constants defined above. Control goes to the target of
+ *        the case equal to the condition or to the default block.
+ *
+ *        Every target is linked as the succ once, even if several cases jump
+ *        to it, so phis of the target have the single input from the switch
+ */
+class SwitchInstr final : public VariadicInstr {
+    BasicBlock* m_default_bb = nullptr;
+    //! NOTE: target of the case is indexed like its value input minus one
+    std::vector<BasicBlock*> m_targets{};
+
+public:
+    using Case = std::pair<Instr*, BasicBlock*>;
+
+    SwitchInstr(Value* cond, BasicBlock* default_bb,
+                const std::vector<Case>& cases)
+        : VariadicInstr(Type{}, Opcode::SWITCH), m_default_bb(default_bb) {
+        assert(!is_vector(cond->type()));
+        add_input(cond);
+        for (auto&& [val, target] : cases) {
+            assert(val->opcode() == Opcode::CONST &&
+                   "Error: case value isn't a constant");
+            add_input(val);
+            m_targets.push_back(target);
+        }
+    }
+
+    /**
+     * @brief Getters
+     */
+    auto cond() const noexcept { return get_input(0); }
+    auto default_bb() const noexcept { return m_default_bb; }
+    std::size_t cases_num() const noexcept { return m_targets.size(); }
+
+    std::int64_t case_value(std::size_t idx) const {
+        return const_value(*static_cast<const Instr*>(get_input(idx + 1)));
+    }
+
+    BasicBlock* case_target(std::size_t idx) const {
+        assert(idx < m_targets.size() && "Error: case index out of range");
+        return m_targets[idx];
+    }
+
+    /// Target of the condition value. O(cases)
+    BasicBlock* target(std::int64_t val) const {
+        for (std::size_t idx = 0; idx < m_targets.size(); ++idx)
+            if (case_value(idx) == val) return m_targets[idx];
+        return m_default_bb;
+    }
+
+    /// Distinct targets in the order of the first jump, default is the first
+    std::vector<BasicBlock*> succs() const {
+        std::vector<BasicBlock*> res{m_default_bb};
+        for (auto* target : m_targets)
+            if (std::find(res.begin(), res.end(), target) == res.end())
+                res.push_back(target);
+        return res;
+    }
+};
+
 /**
  * @brief
  */
@@ -206,9 +469,6 @@ public:
         : Instr(type, jj_vm::ir::Opcode::PARAM), m_name(std::move(name)) {}
 
     auto name() const noexcept { return m_name; }
-
-    /// Override dump
-    void dump(std::ostream& os) override {}
 };
 }  // namespace jj_vm::ir
 
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cassert>
+#include <cstdint>
+
 #include "basic_block.hh"
+#include "function.hh"
 #include "instructions.hh"
 
 namespace jj_vm::ir {
@@ -43,6 +47,38 @@ public:
         return created_instr;
     }
 
+    /**
+     * @brief Non-pooled constant of the runtime type (e.g. from the text or
+     *        serialized IR), value is truncated to the type
+     */
+    Instr* create_const(TypeId type, std::int64_t val) {
+        switch (type) {
+            case TypeId::I1:
+                return create<ConstI1>(val != 0);
+            case TypeId::I8:
+                return create<ConstI8>(static_cast<std::int8_t>(val));
+            case TypeId::I16:
+                return create<ConstI16>(static_cast<std::int16_t>(val));
+            case TypeId::I32:
+                return create<ConstI32>(static_cast<std::int32_t>(val));
+            case TypeId::I64:
+                return create<ConstI64>(val);
+            default:
+                break;
+        }
+        assert(false && "Error: constant without scalar type");
+        return nullptr;
+    }
+
+    /**
+     * @brief Canonical constant from the pool of the current function,
+     *        it is placed in the entry block instead of the insert point
+     */
+    template <typename T>
+    Constant<T>* get_const(T val) {
+        return m_bb->parent()->get_const(val);
+    }
+
     /**
      * @brief This specifies that created instructions should be appended to the
      *        end of the specified block.
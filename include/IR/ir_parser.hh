@@ -0,0 +1,629 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "basic_block.hh"
+#include "function.hh"
+#include "instructions.hh"
+#include "ir_builder.hh"
+#include "opcodes.hh"
+#include "utils/mapped_file.hh"
+
+namespace jj_vm::ir {
+
+/**
+ * @brief Error in the textual IR with the line where it was found
+ */
+class ParseError final : public std::runtime_error {
+    std::size_t m_line = 0;
+
+public:
+    ParseError(std::size_t line, const std::string& what)
+        : std::runtime_error("line " + std::to_string(line) + ": " + what),
+          m_line(line) {}
+
+    std::size_t line() const noexcept { return m_line; }
+};
+
+/**
+ * @brief Single pass parser of the textual IR printed by IRPrinter.
+ *        It works over the contiguous buffer (e.g. utils::MappedFile) w/o
+ *        tokens materialization: names vN/bbN are plain indices into vectors,
+ *        instructions are created right into the function arena.
+ *
+ *        Forward references:
+ *          - value used before its definition is a placeholder Value, its
+ *            users are moved to the definition (O(uses))
+ *          - phi inputs are attached when the function body is parsed
+ *          - call of the function defined below creates its declaration
+ *
+ *        Parsed function is renumbered, so ids follow the layout order
+ */
+class IRParser final {
+public:
+    using FunctionList = std::vector<std::unique_ptr<Function>>;
+
+private:
+    enum class ValueState : std::uint8_t { NONE, PLACEHOLDER, DEFINED, PARAM };
+
+    struct PhiInput final {
+        PhiInstr* m_phi = nullptr;
+        std::size_t m_val = 0;
+        std::size_t m_bb = 0;
+        std::size_t m_line = 0;
+    };
+
+    const char* m_cur = nullptr;
+    const char* m_end = nullptr;
+    std::size_t m_line = 1;
+    //
+    //! NOTE: functions are declared before placeholders, so placeholders are
+    //!       destroyed first and don't touch uses of destroyed functions
+    FunctionList m_funcs{};
+    std::unordered_map<std::string_view, std::unique_ptr<Function>>
+        m_declared{};
+    std::unordered_map<std::string_view, Function*> m_symbols{};
+    std::unique_ptr<Function> m_func{};
+    //
+    //! NOTE: per function state
+    IRBuilder m_builder{};
+    bool m_has_block = false;
+    std::vector<Value*> m_values{};
+    std::vector<ValueState> m_states{};
+    std::vector<BasicBlock*> m_blocks{};
+    std::vector<bool> m_defined_blocks{};
+    std::vector<PhiInput> m_phi_inputs{};
+    std::deque<Value> m_placeholders{};
+
+    explicit IRParser(std::string_view text)
+        : m_cur(text.data()), m_end(text.data() + text.size()) {}
+
+public:
+    /**
+     * @brief Parse all functions of the text
+     *        Throws ParseError on malformed input
+     */
+    static FunctionList parse(std::string_view text) {
+        IRParser parser{text};
+        return parser.parse_module();
+    }
+
+    static FunctionList parse_file(const std::filesystem::path& path) {
+        utils::MappedFile file{path};
+        return parse(file.view());
+    }
+
+private:
+    FunctionList parse_module() {
+        for (skip_blank(); m_cur != m_end; skip_blank()) parse_function();
+        //
+        if (!m_declared.empty())
+            error("call of undefined function " +
+                  std::string{m_declared.begin()->first});
+        return std::move(m_funcs);
+    }
+
+    /**
+     * @brief func name(v0: i32, ...) -> i64 { ... }
+     */
+    void parse_function() {
+        expect_word("func");
+        auto name = parse_ident();
+        expect('(');
+        std::vector<std::pair<std::size_t, TypeId>> args{};
+        if (!try_consume(')')) {
+            do {
+                auto id = parse_value_ref();
+                expect(':');
+                args.emplace_back(id, parse_type());
+            } while (try_consume(','));
+            expect(')');
+        }
+        expect('-');
+        expect('>');
+        auto ret_ty = parse_type();
+        expect('{');
+        expect_eol();
+        //
+        start_function(name, ret_ty);
+        for (auto&& [id, type] : args)
+            define(id, m_func->create<Param, Type>(type), ValueState::PARAM);
+        //
+        for (skip_blank(); !try_consume('}'); skip_blank()) {
+            if (m_cur == m_end) error("unexpected end of function body");
+            parse_line();
+        }
+        //! NOTE: errors of the whole body are reported at its closing brace
+        finish_function();
+        expect_eol();
+    }
+
+    void parse_line() {
+        //! NOTE: label bbN:
+        if (peek('b')) {
+            auto id = parse_block_ref();
+            expect(':');
+            expect_eol();
+            define_block(id);
+            return;
+        }
+        //
+        if (!m_has_block) error("instruction outside of basic block");
+        //
+        bool has_name = peek('v');
+        std::size_t id = 0;
+        if (has_name) {
+            id = parse_value_ref();
+            expect('=');
+        }
+        //
+        auto* instr = parse_instr();
+        if (has_name) {
+            if (instr->type() == TypeId::NONE)
+                error("named instruction without type");
+            define(id, instr, ValueState::DEFINED);
+        }
+        expect_eol();
+    }
+
+    Instr* parse_instr() {
+        auto opc = parse_opcode();
+        switch (opc) {
+            case Opcode::BRANCH:
+                return m_builder.create<BranchInstr>(
+                    get_block(parse_block_ref()));
+            case Opcode::IF: {
+                auto* cond = get_value(parse_value_ref(), TypeId::NONE);
+                expect(',');
+                auto* true_bb = get_block(parse_block_ref());
+                expect(',');
+                auto* false_bb = get_block(parse_block_ref());
+                return m_builder.create<IfInstr>(true_bb, false_bb, cond);
+            }
+            case Opcode::SWITCH:
+                return parse_switch();
+            case Opcode::RET:
+                return m_builder.create<RetInstr>(
+                    get_value(parse_value_ref(), m_func->func_ty().type()));
+            case Opcode::STORE: {
+                //! NOTE: store v1, v2 - type is the type of the value
+                auto* ptr = get_typed_value(TypeId::PTR);
+                expect(',');
+                return m_builder.create<StoreInstr>(
+                    ptr, get_value(parse_value_ref(), TypeId::NONE));
+            }
+            default:
+                break;
+        }
+        //
+        auto type = parse_type();
+        switch (opc) {
+            case Opcode::CONST:
+                if (type == TypeId::NONE) error("constant without type");
+                if (is_vector(type)) error("constant of vector type");
+                return m_builder.create_const(type, parse_int());
+            case Opcode::PHI:
+                return parse_phi(type);
+            case Opcode::CALL:
+                return parse_call(type);
+            case Opcode::PARAM: {
+                std::string name{};
+                skip_spaces();
+                if (m_cur != m_end && is_ident_start(*m_cur))
+                    name = parse_ident();
+                return m_builder.create<ParamInstr>(std::move(name), type);
+            }
+            case Opcode::CAST:
+                return m_builder.create<CastInstr>(
+                    type, get_value(parse_value_ref(), TypeId::NONE));
+            case Opcode::SPLAT:
+                if (!is_vector(type)) error("splat of non vector type");
+                return m_builder.create<SplatInstr>(
+                    type, get_typed_value(element_type(type)));
+            case Opcode::EXTRACT: {
+                //! NOTE: extract i32 v1, v2 - type is the type of the lane
+                auto* vec = get_value(parse_value_ref(), TypeId::NONE);
+                expect(',');
+                auto* lane = parse_lane();
+                if (element_type(vec->type()) != type ||
+                    !is_vector(vec->type()))
+                    error("operand type mismatch");
+                return m_builder.create<ExtractLaneInstr>(vec, lane);
+            }
+            case Opcode::INSERT: {
+                if (!is_vector(type)) error("insert into non vector type");
+                auto* vec = get_typed_value(type);
+                expect(',');
+                auto* val = get_typed_value(element_type(type));
+                expect(',');
+                return m_builder.create<InsertLaneInstr>(vec, val,
+                                                         parse_lane());
+            }
+            case Opcode::ALLOC:
+                if (type != TypeId::PTR) error("alloc of non ptr type");
+                return m_builder.create<AllocInstr>(
+                    get_value(parse_value_ref(), TypeId::NONE));
+            case Opcode::LOAD:
+                if (type == TypeId::NONE) error("load without type");
+                return m_builder.create<LoadInstr>(
+                    type, get_typed_value(TypeId::PTR));
+            case Opcode::GEP: {
+                if (type != TypeId::PTR) error("gep of non ptr type");
+                auto* ptr = get_typed_value(TypeId::PTR);
+                expect(',');
+                return m_builder.create<GepInstr>(
+                    ptr, get_value(parse_value_ref(), TypeId::NONE));
+            }
+            case Opcode::SELECT: {
+                //! NOTE: select i32 v1, v2, v3 - type of values, not of cond
+                auto* cond = get_value(parse_value_ref(), TypeId::NONE);
+                if (is_vector(cond->type())) error("select by vector cond");
+                expect(',');
+                auto* true_val = get_typed_value(type);
+                expect(',');
+                return m_builder.create<SelectInstr>(cond, true_val,
+                                                     get_typed_value(type));
+            }
+            default:
+                break;
+        }
+        //
+        if (arity(opc) == 1) {
+            auto* val = get_typed_value(type);
+            return m_builder.create<UnaryInstr>(opc, val);
+        }
+        if (arity(opc) == 2) {
+            auto* lhs = get_typed_value(type);
+            expect(',');
+            auto* rhs = get_typed_value(type);
+            return m_builder.create<BinInstr>(opc, lhs, rhs);
+        }
+        error("unsupported instruction " + std::string{mnemonic(opc)});
+    }
+
+    /// Lane index of extract & insert is the constant defined above
+    Instr* parse_lane() { return parse_const("lane index"); }
+
+    Instr* parse_const(std::string_view what) {
+        auto id = parse_value_ref();
+        if (id >= m_states.size() || m_states[id] != ValueState::DEFINED ||
+            static_cast<Instr*>(m_values[id])->opcode() != Opcode::CONST)
+            error(std::string{what} + " v" + std::to_string(id) +
+                  " isn't a constant defined above");
+        return static_cast<Instr*>(m_values[id]);
+    }
+
+    /// switch v1, bb3, [v2: bb1, v4: bb2] - values are constants defined above
+    Instr* parse_switch() {
+        auto* cond = get_value(parse_value_ref(), TypeId::NONE);
+        if (is_vector(cond->type())) error("switch by vector cond");
+        expect(',');
+        auto* default_bb = get_block(parse_block_ref());
+        expect(',');
+        expect('[');
+        std::vector<SwitchInstr::Case> cases{};
+        skip_spaces();
+        if (!peek(']')) {
+            do {
+                auto* val = parse_const("case value");
+                //! NOTE: cond defined below has no type yet
+                if (cond->type() != TypeId::NONE &&
+                    val->type() != cond->type())
+                    error("case value type differs from cond type");
+                for (auto&& [prev, target] : cases)
+                    if (const_value(*prev) == const_value(*val))
+                        error("duplicate case value");
+                expect(':');
+                cases.emplace_back(val, get_block(parse_block_ref()));
+            } while (try_consume(','));
+        }
+        expect(']');
+        return m_builder.create<SwitchInstr>(cond, default_bb, cases);
+    }
+
+    /// phi i32 [v2, bb0], [v7, bb2]
+    Instr* parse_phi(TypeId type) {
+        auto* phi = m_builder.create<PhiInstr>(type);
+        skip_spaces();
+        if (!peek('[')) return phi;
+        do {
+            expect('[');
+            auto val = parse_value_ref();
+            expect(',');
+            auto bb = parse_block_ref();
+            expect(']');
+            m_phi_inputs.push_back({phi, val, bb, m_line});
+        } while (try_consume(','));
+        return phi;
+    }
+
+    /// call i64 @name(v1, v2)
+    Instr* parse_call(TypeId type) {
+        expect('@');
+        auto* callee = get_function(parse_ident(), type);
+        auto* call = m_builder.create<CallInstr>(type, callee);
+        expect('(');
+        if (!try_consume(')')) {
+            do {
+                call->add_arg(get_value(parse_value_ref(), TypeId::NONE));
+            } while (try_consume(','));
+            expect(')');
+        }
+        return call;
+    }
+
+    /**
+     * @brief Function level state
+     */
+    void start_function(std::string_view name, TypeId ret_ty) {
+        if (m_symbols.count(name) != 0 && m_declared.count(name) == 0)
+            error("redefinition of function " + std::string{name});
+        //
+        auto declared = m_declared.find(name);
+        if (declared != m_declared.end()) {
+            m_func = std::move(declared->second);
+            m_declared.erase(declared);
+            if (m_func->func_ty().type() != ret_ty)
+                error("return type of " + std::string{name} +
+                      " differs from the call");
+        } else {
+            m_func = std::make_unique<Function>(Type{ret_ty}, std::string{name});
+            m_symbols.emplace(m_func->name(), m_func.get());
+        }
+        //
+        m_has_block = false;
+        m_values.clear();
+        m_states.clear();
+        m_blocks.clear();
+        m_defined_blocks.clear();
+    }
+
+    void finish_function() {
+        //! NOTE: all values are known at this point
+        for (auto&& input : m_phi_inputs) {
+            m_line = input.m_line;
+            if (input.m_val >= m_states.size() ||
+                m_states[input.m_val] != ValueState::DEFINED)
+                error("phi input v" + std::to_string(input.m_val) +
+                      " isn't an instruction of the function");
+            //
+            input.m_phi->add_node({static_cast<Instr*>(m_values[input.m_val]),
+                                   get_block(input.m_bb)});
+        }
+        m_phi_inputs.clear();
+        //
+        for (std::size_t id = 0; id < m_states.size(); ++id)
+            if (m_states[id] == ValueState::PLACEHOLDER)
+                error("use of undefined value v" + std::to_string(id));
+        for (std::size_t id = 0; id < m_blocks.size(); ++id)
+            if (m_blocks[id] != nullptr && !m_defined_blocks[id])
+                error("use of undefined block bb" + std::to_string(id));
+        m_placeholders.clear();
+        //
+        if (m_func->empty()) error("function without basic blocks");
+        m_func->renumber();
+        m_funcs.push_back(std::move(m_func));
+    }
+
+    Function* get_function(std::string_view name, TypeId ret_ty) {
+        auto found = m_symbols.find(name);
+        if (found != m_symbols.end()) return found->second;
+        //
+        //! NOTE: declaration is completed by the definition below
+        auto func = std::make_unique<Function>(Type{ret_ty}, std::string{name});
+        auto* declared = func.get();
+        m_symbols.emplace(declared->name(), declared);
+        m_declared.emplace(declared->name(), std::move(func));
+        return declared;
+    }
+
+    /**
+     * @brief Values & blocks by index
+     */
+    void reserve_value(std::size_t id) {
+        //! NOTE: every value takes at least one byte of the text
+        if (id > static_cast<std::size_t>(m_end - m_cur) + m_values.size() +
+                     (1u << 16))
+            error("value index is too large");
+        if (id >= m_values.size()) {
+            //! NOTE: ids mostly grow by one, so tables grow geometrically
+            auto size = std::max(id + 1, 2 * m_values.size());
+            m_values.resize(size, nullptr);
+            m_states.resize(size, ValueState::NONE);
+        }
+    }
+
+    Value* get_value(std::size_t id, TypeId type) {
+        reserve_value(id);
+        if (m_states[id] == ValueState::NONE) {
+            m_values[id] = &m_placeholders.emplace_back(Type{type});
+            m_states[id] = ValueState::PLACEHOLDER;
+        }
+        return m_values[id];
+    }
+
+    Value* get_typed_value(TypeId type) {
+        auto* val = get_value(parse_value_ref(), type);
+        if (val->type() != type) error("operand type mismatch");
+        return val;
+    }
+
+    void define(std::size_t id, Value* val, ValueState state) {
+        reserve_value(id);
+        if (m_states[id] == ValueState::DEFINED ||
+            m_states[id] == ValueState::PARAM)
+            error("redefinition of value v" + std::to_string(id));
+        //
+        if (m_states[id] == ValueState::PLACEHOLDER) {
+            if (m_values[id]->type() != TypeId::NONE &&
+                m_values[id]->type() != val->type())
+                error("type of v" + std::to_string(id) +
+                      " differs from its use");
+            val->replace_users(*m_values[id]);
+        }
+        m_values[id] = val;
+        m_states[id] = state;
+    }
+
+    BasicBlock* get_block(std::size_t id) {
+        if (id >= m_blocks.size()) {
+            if (id > static_cast<std::size_t>(m_end - m_cur) + m_blocks.size())
+                error("block index is too large");
+            m_blocks.resize(id + 1, nullptr);
+            m_defined_blocks.resize(id + 1, false);
+        }
+        if (m_blocks[id] == nullptr)
+            m_blocks[id] = m_func->create<BasicBlock>();
+        return m_blocks[id];
+    }
+
+    void define_block(std::size_t id) {
+        auto* bb = get_block(id);
+        if (m_defined_blocks[id])
+            error("redefinition of block bb" + std::to_string(id));
+        m_defined_blocks[id] = true;
+        //
+        //! NOTE: blocks created by forward references are moved to their
+        //!       place, so layout follows the text
+        m_func->move(m_func->end(), bb);
+        m_builder.set_insert_point(bb);
+        m_has_block = true;
+    }
+
+    /**
+     * @brief Lexing over the raw buffer
+     */
+    [[noreturn]] void error(const std::string& what) const {
+        throw ParseError{m_line, what};
+    }
+
+    static bool is_digit(char c) noexcept { return c >= '0' && c <= '9'; }
+
+    static bool is_ident_start(char c) noexcept {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    static bool is_ident(char c) noexcept {
+        return is_ident_start(c) || is_digit(c) || c == '.';
+    }
+
+    void skip_spaces() noexcept {
+        while (m_cur != m_end && (*m_cur == ' ' || *m_cur == '\t' ||
+                                  *m_cur == '\r'))
+            ++m_cur;
+    }
+
+    void skip_comment() noexcept {
+        if (m_end - m_cur >= 2 && m_cur[0] == '/' && m_cur[1] == '/')
+            while (m_cur != m_end && *m_cur != '\n') ++m_cur;
+    }
+
+    /// Skip spaces, comments & empty lines
+    void skip_blank() noexcept {
+        for (;;) {
+            skip_spaces();
+            skip_comment();
+            if (m_cur == m_end || *m_cur != '\n') return;
+            ++m_cur;
+            ++m_line;
+        }
+    }
+
+    void expect_eol() {
+        skip_spaces();
+        skip_comment();
+        if (m_cur == m_end) return;
+        if (*m_cur != '\n') error("unexpected symbols at the end of line");
+        ++m_cur;
+        ++m_line;
+    }
+
+    bool peek(char c) noexcept {
+        skip_spaces();
+        return m_cur != m_end && *m_cur == c;
+    }
+
+    bool try_consume(char c) noexcept {
+        if (!peek(c)) return false;
+        ++m_cur;
+        return true;
+    }
+
+    void expect(char c) {
+        if (!try_consume(c)) error(std::string{"expected '"} + c + "'");
+    }
+
+    std::string_view parse_ident() {
+        skip_spaces();
+        const auto* begin = m_cur;
+        if (m_cur == m_end || !is_ident_start(*m_cur))
+            error("expected identifier");
+        while (m_cur != m_end && is_ident(*m_cur)) ++m_cur;
+        return {begin, static_cast<std::size_t>(m_cur - begin)};
+    }
+
+    void expect_word(std::string_view word) {
+        if (parse_ident() != word) error("expected " + std::string{word});
+    }
+
+    std::uint64_t parse_uint() {
+        if (m_cur == m_end || !is_digit(*m_cur)) error("expected number");
+        std::uint64_t val = 0;
+        for (; m_cur != m_end && is_digit(*m_cur); ++m_cur) {
+            auto next = val * 10 + static_cast<std::uint64_t>(*m_cur - '0');
+            if (next / 10 != val) error("number is too large");
+            val = next;
+        }
+        return val;
+    }
+
+    std::int64_t parse_int() {
+        skip_spaces();
+        bool neg = m_cur != m_end && *m_cur == '-';
+        if (neg) ++m_cur;
+        auto val = parse_uint();
+        //! NOTE: two's complement wrap covers INT64_MIN
+        return static_cast<std::int64_t>(neg ? ~val + 1 : val);
+    }
+
+    std::size_t parse_value_ref() {
+        expect('v');
+        return parse_uint();
+    }
+
+    std::size_t parse_block_ref() {
+        expect('b');
+        if (m_cur == m_end || *m_cur != 'b') error("expected block name");
+        ++m_cur;
+        return parse_uint();
+    }
+
+    TypeId parse_type() {
+        auto name = parse_ident();
+        for (auto type : {TypeId::I64, TypeId::I32, TypeId::I1, TypeId::I8,
+                          TypeId::I16, TypeId::V4I32, TypeId::V2I64,
+                          TypeId::V8I32, TypeId::V4I64, TypeId::PTR,
+                          TypeId::NONE})
+            if (type_name(type) == name) return type;
+        error("unknown type " + std::string{name});
+    }
+
+    Opcode parse_opcode() {
+        auto name = parse_ident();
+        for (std::size_t i = 1; i < kOpcodesNum; ++i)
+            if (kOpcodesInfo[i].mnemonic == name) return static_cast<Opcode>(i);
+        error("unknown instruction " + std::string{name});
+    }
+};
+
+}  // namespace jj_vm::ir
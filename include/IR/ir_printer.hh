@@ -0,0 +1,148 @@
+#pragma once
+
+#include <ostream>
+#include <string_view>
+
+#include "basic_block.hh"
+#include "function.hh"
+#include "inst_visitor.hh"
+#include "instructions.hh"
+
+namespace jj_vm::ir {
+
+/**
+ * @brief Printer of the textual IR form, which is read back by IRParser:
+ *
+ *        func fact(v0: i32) -> i64 {
+ *        bb0:
+ *            v1 = const i64 1
+ *            jmp bb1
+ *        bb1:
+ *            v3 = phi i32 [v2, bb0], [v7, bb2]
+ *            v4 = le i32 v3, v0
+ *            if v4, bb2, bb3
+ *        ...
+ *        }
+ *
+ *        Values are named by their dense ids (vN), blocks by bb_id (bbN).
+ *        Instruction w/o type has no name
+ */
+class IRPrinter final : public InstVisitor<IRPrinter> {
+    std::ostream& m_os;
+
+public:
+    explicit IRPrinter(std::ostream& os) : m_os(os) {}
+
+    void print(const Function& func) {
+        m_os << "func " << func.name() << '(';
+        const char* sep = "";
+        for (auto&& arg : func.args()) {
+            m_os << sep << 'v' << arg.id() << ": " << type_name(arg.type());
+            sep = ", ";
+        }
+        m_os << ") -> " << type_name(func.func_ty().type()) << " {\n";
+        //
+        for (auto&& bb : func) print(bb);
+        m_os << "}\n";
+    }
+
+    void print(const BasicBlock& bb) {
+        m_os << "bb" << bb.id() << ":\n";
+        for (auto&& instr : bb) print(instr);
+    }
+
+    void print(const Instr& instr) {
+        m_os << "    ";
+        if (instr.type() != TypeId::NONE) m_os << 'v' << instr.id() << " = ";
+        m_os << mnemonic(instr.opcode());
+        //
+        //! NOTE: printer doesn't modify IR, visitor just requires non-const
+        visit(const_cast<Instr&>(instr));
+        m_os << '\n';
+    }
+
+    /**
+     * @brief Operands of instructions after mnemonic
+     */
+    void visit_const(Instr& instr) {
+        print_type(instr);
+        m_os << ' ' << const_value(instr);
+    }
+
+    void visit_phi(PhiInstr& instr) {
+        print_type(instr);
+        const char* sep = " ";
+        for (auto&& [val, bb] : instr.vars()) {
+            m_os << sep << "[v" << val->id() << ", bb" << bb->id() << ']';
+            sep = ", ";
+        }
+    }
+
+    void visit_call(CallInstr& instr) {
+        print_type(instr);
+        m_os << " @" << instr.callee()->name() << '(';
+        print_inputs(instr, "");
+        m_os << ')';
+    }
+
+    void visit_param(ParamInstr& instr) {
+        print_type(instr);
+        if (!instr.name().empty()) m_os << ' ' << instr.name();
+    }
+
+    void visit_branch(BranchInstr& instr) { m_os << " bb" << instr.dst()->id(); }
+
+    void visit_if(IfInstr& instr) {
+        print_inputs(instr, " ");
+        m_os << ", bb" << instr.true_bb()->id() << ", bb"
+             << instr.false_bb()->id();
+    }
+
+    //! NOTE: switch v1, bb3, [v2: bb1, v4: bb2]
+    void visit_switch(SwitchInstr& instr) {
+        m_os << " v" << instr.cond()->id() << ", bb"
+             << instr.default_bb()->id() << ", [";
+        for (std::size_t idx = 0; idx < instr.cases_num(); ++idx)
+            m_os << (idx == 0 ? "" : ", ") << 'v'
+                 << instr.get_input(idx + 1)->id() << ": bb"
+                 << instr.case_target(idx)->id();
+        m_os << ']';
+    }
+
+    void visit_ret(RetInstr& instr) { print_inputs(instr, " "); }
+
+    void visit_store(StoreInstr& instr) { print_inputs(instr, " "); }
+
+    //! NOTE: binary, unary, cast & checks: <type> <inputs>
+    void visit_instr(Instr& instr) {
+        print_type(instr);
+        print_inputs(instr, " ");
+    }
+
+private:
+    void print_type(const Instr& instr) { m_os << ' ' << type_name(instr.type()); }
+
+    void print_inputs(const Instr& instr, const char* sep) {
+        for (auto* input : instr.inputs()) {
+            m_os << sep << 'v' << input->id();
+            sep = ", ";
+        }
+    }
+};
+
+/**
+ * @brief Print helpers
+ */
+inline void print(std::ostream& os, const Function& func) {
+    IRPrinter{os}.print(func);
+}
+
+inline void print(std::ostream& os, const BasicBlock& bb) {
+    IRPrinter{os}.print(bb);
+}
+
+inline void print(std::ostream& os, const Instr& instr) {
+    IRPrinter{os}.print(instr);
+}
+
+}  // namespace jj_vm::ir
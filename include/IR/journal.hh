@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "constant_pool.hh"
+#include "instruction.hh"
+
+namespace jj_vm::ir {
+
+class BasicBlock;
+class Function;
+class PhiInstr;
+
+namespace journal {
+
+inline constexpr std::size_t kNoIds = std::numeric_limits<std::size_t>::max();
+
+/**
+ * @brief Records of single IR edits. Every record keeps only what is needed
+ *        to undo the edit, no node is copied
+ */
+/// Instruction is created or inserted into the block
+struct InsertInstr final {
+    Instr* m_instr = nullptr;
+};
+
+/// Instruction is unlinked from the block, next is nullptr for the end
+struct EraseInstr final {
+    Instr* m_instr = nullptr;
+    BasicBlock* m_bb = nullptr;
+    Instr* m_next = nullptr;
+};
+
+/// Range [first, last] of the src block is moved before some position
+struct MoveInstrs final {
+    Instr* m_first = nullptr;
+    Instr* m_last = nullptr;
+    BasicBlock* m_src = nullptr;
+    Instr* m_src_next = nullptr;
+};
+
+struct SetOperand final {
+    Instr* m_instr = nullptr;
+    std::size_t m_idx = 0;
+    Value* m_old = nullptr;
+};
+
+/// Incoming block of the phi input is changed (see PhiInstr::add_node)
+struct SetIncoming final {
+    PhiInstr* m_phi = nullptr;
+    std::size_t m_idx = 0;
+    BasicBlock* m_old = nullptr;
+};
+
+struct ResizeOperands final {
+    Instr* m_instr = nullptr;
+    std::size_t m_num = 0;
+};
+
+struct LinkBlocks final {
+    BasicBlock* m_succ = nullptr;
+    BasicBlock* m_pred = nullptr;
+};
+
+/// Positions of the removed edge in preds of succ & succs of pred
+struct UnlinkBlocks final {
+    BasicBlock* m_succ = nullptr;
+    BasicBlock* m_pred = nullptr;
+    std::size_t m_pred_pos = 0;
+    std::size_t m_succ_pos = 0;
+};
+
+struct InsertBlock final {
+    BasicBlock* m_bb = nullptr;
+};
+
+struct EraseBlock final {
+    BasicBlock* m_bb = nullptr;
+    Function* m_func = nullptr;
+    BasicBlock* m_next = nullptr;
+};
+
+/// Range [first, last] of src function blocks is moved, ids of moved blocks
+/// & instructions are saved at m_ids if they are reassigned
+struct MoveBlocks final {
+    BasicBlock* m_first = nullptr;
+    BasicBlock* m_last = nullptr;
+    Function* m_src = nullptr;
+    BasicBlock* m_src_next = nullptr;
+    std::size_t m_ids = kNoIds;
+};
+
+/// Counters & ids of the whole function are saved at m_ids
+struct Renumber final {
+    Function* m_func = nullptr;
+    std::size_t m_ids = 0;
+};
+
+struct PoolInsert final {
+    Function* m_func = nullptr;
+    Instr* m_instr = nullptr;
+};
+
+struct PoolErase final {
+    Function* m_func = nullptr;
+    Instr* m_instr = nullptr;
+};
+
+struct PoolClear final {
+    Function* m_func = nullptr;
+    std::size_t m_pool = 0;
+};
+
+using Change =
+    std::variant<InsertInstr, EraseInstr, MoveInstrs, SetOperand,
+                 SetIncoming, ResizeOperands, LinkBlocks, UnlinkBlocks, InsertBlock,
+                 EraseBlock, MoveBlocks, Renumber, PoolInsert, PoolErase,
+                 PoolClear>;
+
+}  // namespace journal
+
+/**
+ * @brief Log of IR edits for speculative transformations.
+ *        While function is attached, its edits (inserts, erases, splices,
+ *        operand rewrites, CFG links, renumbering) are recorded instead of
+ *        being made irreversible: erased nodes are only unlinked. commit()
+ *        destroys them, rollback() undoes the edits in reverse order.
+ *        Both are O(recorded edits), function isn't copied.
+ *
+ *        Edit is recorded in the journal of the function being edited
+ *        (destination one for splices). Uncommitted journal is rolled back
+ *        on destruction.
+ *
+ *        NOTE: lazy body is materialized on attach, it isn't journaled
+ */
+class Journal final {
+    struct Attached final {
+        Function* m_func = nullptr;
+        Value::id_type m_values_num = 0;
+        std::uint32_t m_blocks_num = 0;
+    };
+
+    std::vector<journal::Change> m_changes{};
+    //! NOTE: ids overwritten by renumbering & splicing of functions
+    std::vector<std::uint32_t> m_ids{};
+    std::vector<ConstantPool> m_pools{};
+    //
+    std::vector<Attached> m_funcs{};
+    //
+    //! NOTE: nodes unlinked from IR by commit (erased ones) or by rollback
+    //!       (created ones), they are destroyed at the end
+    std::vector<Instr*> m_dropped_instrs{};
+    std::vector<BasicBlock*> m_dropped_blocks{};
+
+public:
+    Journal() = default;
+
+    template <typename... Funcs>
+    explicit Journal(Funcs&... funcs) {
+        (attach(funcs), ...);
+    }
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    ~Journal() {
+        if (is_active()) rollback();
+    }
+
+    /**
+     * @brief Start recording edits of the function
+     */
+    void attach(Function& func);
+
+    /// Keep the edits, erased nodes are destroyed
+    void commit();
+
+    /// Undo the edits in reverse order, created nodes are destroyed
+    void rollback();
+
+    /**
+     * @brief Getters
+     */
+    bool is_active() const noexcept { return !m_funcs.empty(); }
+    std::size_t size() const noexcept { return m_changes.size(); }
+    bool empty() const noexcept { return m_changes.empty(); }
+
+    /**
+     * @brief Recording interface for IR nodes
+     */
+    template <typename ChangeTy>
+    void record(ChangeTy&& change) {
+        m_changes.emplace_back(std::forward<ChangeTy>(change));
+    }
+
+    std::size_t ids_mark() const noexcept { return m_ids.size(); }
+    void save_id(std::uint32_t id) { m_ids.push_back(id); }
+
+    std::size_t save_pool(ConstantPool pool) {
+        m_pools.push_back(std::move(pool));
+        return m_pools.size() - 1;
+    }
+
+private:
+    void detach() noexcept;
+    void destroy_dropped();
+
+    void undo(const journal::InsertInstr& change);
+    void undo(const journal::EraseInstr& change);
+    void undo(const journal::MoveInstrs& change);
+    void undo(const journal::SetOperand& change);
+    void undo(const journal::SetIncoming& change);
+    void undo(const journal::ResizeOperands& change);
+    void undo(const journal::LinkBlocks& change);
+    void undo(const journal::UnlinkBlocks& change);
+    void undo(const journal::InsertBlock& change);
+    void undo(const journal::EraseBlock& change);
+    void undo(const journal::MoveBlocks& change);
+    void undo(const journal::Renumber& change);
+    void undo(const journal::PoolInsert& change);
+    void undo(const journal::PoolErase& change);
+    void undo(const journal::PoolClear& change);
+};
+
+}  // namespace jj_vm::ir
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "binary_module.hh"
+#include "function.hh"
+
+namespace jj_vm::ir::compact {
+
+/**
+ * @brief Module loaded from the binary image with lazy bodies.
+ *        Headers of functions (name, func_ty, params) are created up front,
+ *        every body is decoded on the first access to the blocks of the
+ *        function (iteration, bb_graph, PassManager::run). Calls are resolved
+ *        to headers, so decoding of the caller doesn't decode callees.
+ *
+ *        NOTE: functions refer to the module, so it isn't movable
+ */
+class LazyModule final {
+    /**
+     * @brief Decoder of the single body
+     */
+    class Materializer final : public BodyMaterializer {
+        LazyModule* m_module = nullptr;
+        std::size_t m_idx = 0;
+
+    public:
+        Materializer(LazyModule* module, std::size_t idx)
+            : m_module(module), m_idx(idx) {}
+
+        void materialize(Function& func) override {
+            ++m_module->m_materialized;
+            FunctionDecoder{m_module->m_image[m_idx], func}.decode_body(
+                [this](std::string_view name) { return m_module->find(name); });
+        }
+    };
+
+    ModuleImage m_image{};
+    std::vector<Materializer> m_materializers{};
+    std::vector<std::unique_ptr<Function>> m_funcs{};
+    std::unordered_map<std::string_view, Function*> m_symbols{};
+    //
+    std::size_t m_materialized = 0;
+
+public:
+    explicit LazyModule(ModuleImage image) : m_image(std::move(image)) {
+        m_materializers.reserve(m_image.size());
+        m_funcs.reserve(m_image.size());
+        for (std::size_t i = 0; i < m_image.size(); ++i) {
+            auto& func = m_funcs.emplace_back(
+                FunctionDecoder::decode_header(m_image[i]));
+            m_symbols.emplace(func->name(), func.get());
+            func->set_materializer(&m_materializers.emplace_back(this, i));
+        }
+    }
+
+    explicit LazyModule(const std::filesystem::path& path)
+        : LazyModule(ModuleImage::load(path)) {}
+
+    LazyModule(const LazyModule&) = delete;
+    LazyModule& operator=(const LazyModule&) = delete;
+
+    /**
+     * @brief Getters
+     */
+    std::size_t size() const noexcept { return m_funcs.size(); }
+    Function& operator[](std::size_t idx) { return *m_funcs[idx]; }
+
+    Function* find(std::string_view name) const {
+        auto found = m_symbols.find(name);
+        return found != m_symbols.end() ? found->second : nullptr;
+    }
+
+    auto begin() const noexcept { return m_funcs.begin(); }
+    auto end() const noexcept { return m_funcs.end(); }
+
+    /**
+     * @brief Counters of decoded bodies
+     */
+    std::size_t materialized_num() const noexcept { return m_materialized; }
+    std::size_t pending_num() const noexcept { return size() - m_materialized; }
+
+    void materialize_all() const {
+        for (auto&& func : m_funcs) func->materialize();
+    }
+};
+
+}  // namespace jj_vm::ir::compact
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "function.hh"
+
+namespace jj_vm::ir {
+
+/**
+ * @brief Set of functions owned together. Every name is interned in the
+ *        symbol table: the same name always resolves to the same Function,
+ *        so CallInstr::callee() identifies the symbol. Call of the function
+ *        which isn't defined yet interns its declaration (function w/o body),
+ *        the definition added later fills it in
+ *
+ *        NOTE: symbol table keys refer to names owned by functions
+ */
+class Module final {
+public:
+    using FunctionList = std::vector<std::unique_ptr<Function>>;
+    //
+    using iterator = FunctionList::const_iterator;
+    using const_iterator = FunctionList::const_iterator;
+
+private:
+    std::string m_name{};
+    FunctionList m_funcs{};
+    std::unordered_map<std::string_view, Function*> m_symbols{};
+    //
+public:
+    Module() = default;
+    explicit Module(std::string name) : m_name(std::move(name)) {}
+
+    /// Adopt functions, e.g. from IRParser::parse or compact::decode
+    Module(std::string name, FunctionList funcs) : Module(std::move(name)) {
+        m_funcs.reserve(funcs.size());
+        for (auto&& func : funcs) add(std::move(func));
+    }
+
+    //! NOTE: functions are referred by pointers, so module isn't copyable
+    Module(const Module&) = delete;
+    Module& operator=(const Module&) = delete;
+
+    Module(Module&&) = default;
+    Module& operator=(Module&&) = default;
+
+    /**
+     * @brief Create new function, name should be unique in the module
+     */
+    Function* create_function(Type func_ty, const std::string& name) {
+        return add(std::make_unique<Function>(func_ty, name));
+    }
+
+    /**
+     * @brief Take ownership of the function. Its body replaces the body of
+     *        interned declaration, so calls resolved to the declaration see
+     *        the definition
+     */
+    Function* add(std::unique_ptr<Function> func) {
+        auto* found = find(func->name());
+        if (found == nullptr) {
+            auto* added = m_funcs.emplace_back(std::move(func)).get();
+            m_symbols.emplace(added->name(), added);
+            return added;
+        }
+        //
+        assert(found->is_declaration() && "Error: function redefinition");
+        assert(found->func_ty().type() == func->func_ty().type() &&
+               "Error: definition type differs from the declaration");
+        //
+        for (auto&& arg : func->args())
+            found->create<Param, Type>(Type{arg.type()})->replace_users(arg);
+        //! NOTE: recursive calls refer to the added function, it's destroyed
+        //!       after the splice
+        for (auto&& bb : *func)
+            for (auto&& instr : bb) {
+                if (instr.opcode() != Opcode::CALL) continue;
+                auto& call = static_cast<CallInstr&>(instr);
+                if (call.callee() == func.get()) call.set_callee(found);
+            }
+        found->splice(found->end(), *func);
+        found->renumber();
+        return found;
+    }
+
+    /**
+     * @brief Interned function of the name, declaration is created if there
+     *        isn't such function yet
+     */
+    Function* get_function(std::string_view name, Type func_ty) {
+        auto* found = find(name);
+        if (found != nullptr) {
+            assert(found->func_ty().type() == func_ty.type() &&
+                   "Error: function type differs from the declaration");
+            return found;
+        }
+        return create_function(func_ty, std::string{name});
+    }
+
+    /**
+     * @brief Getters
+     */
+    std::string_view name() const noexcept { return m_name; }
+
+    Function* find(std::string_view name) const {
+        auto found = m_symbols.find(name);
+        return found != m_symbols.end() ? found->second : nullptr;
+    }
+
+    std::size_t size() const noexcept { return m_funcs.size(); }
+    bool empty() const noexcept { return m_funcs.empty(); }
+
+    Function& operator[](std::size_t idx) const { return *m_funcs[idx]; }
+
+    const_iterator begin() const noexcept { return m_funcs.begin(); }
+    const_iterator end() const noexcept { return m_funcs.end(); }
+};
+
+}  // namespace jj_vm::ir
@@ -1,8 +1,11 @@
 #ifndef OPCODES_HH
 #define OPCODES_HH
 
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <set>
+#include <string_view>
 
 namespace jj_vm::ir {
 
@@ -10,35 +13,156 @@ enum class InstType : uint8_t {
 
 };
 
+/**
+ * @brief Opcode properties flags
+ */
+namespace opcode_flags {
+inline constexpr std::uint8_t kNone = 0;
+inline constexpr std::uint8_t kCommutative = 1 << 0;
+inline constexpr std::uint8_t kSideEffects = 1 << 1;
+inline constexpr std::uint8_t kTerminator = 1 << 2;
+inline constexpr std::uint8_t kCheck = 1 << 3;
+inline constexpr std::uint8_t kFoldable = 1 << 4;
+}  // namespace opcode_flags
+
+/// Arity of instruction with the number of inputs known at creation only
+inline constexpr std::uint8_t kVariadicArity = 0xff;
+
+/**
+ * @brief Single source of opcodes & their properties:
+ *        OPCODE(name, mnemonic, arity, flags)
+ */
+#define JJ_VM_OPCODES(OPCODE)                                              \
+    /*  Default none value  */                                             \
+    OPCODE(NONE, "none", 0, kNone)                                         \
+    /*  Binary instructions */                                             \
+    OPCODE(ADD, "add", 2, kCommutative | kFoldable)                        \
+    OPCODE(SUB, "sub", 2, kFoldable)                                       \
+    OPCODE(MUL, "mul", 2, kCommutative | kFoldable)                        \
+    OPCODE(DIV, "div", 2, kFoldable)                                       \
+    OPCODE(SHR, "shr", 2, kFoldable)                                       \
+    OPCODE(XOR, "xor", 2, kCommutative | kFoldable)                        \
+    /* Signed compares, le & ge are inclusive (see compare) */             \
+    OPCODE(EQ, "eq", 2, kCommutative | kFoldable)                          \
+    OPCODE(LE, "le", 2, kFoldable)                                         \
+    OPCODE(GE, "ge", 2, kFoldable)                                         \
+    /* Unary instructions */                                               \
+    OPCODE(NEG, "neg", 1, kNone)                                           \
+    /* Contorl flow */                                                     \
+    OPCODE(RET, "ret", 1, kTerminator | kSideEffects)                      \
+    OPCODE(BRANCH, "jmp", 0, kTerminator | kSideEffects)                   \
+    OPCODE(IF, "if", 1, kTerminator | kSideEffects)                        \
+    /* Other */                                                            \
+    OPCODE(PHI, "phi", kVariadicArity, kNone)                              \
+    OPCODE(CAST, "cast", 1, kNone)                                         \
+    OPCODE(CONST, "const", 0, kNone)                                       \
+    OPCODE(PARAM, "param", 0, kNone)                                       \
+    OPCODE(CALL, "call", kVariadicArity, kSideEffects)                     \
+    /* Checks Elimiation */                                                \
+    OPCODE(BOUNDS_CHECK, "bounds_check", 2, kCheck | kSideEffects)         \
+    OPCODE(NULL_CHECK, "null_check", 1, kCheck | kSideEffects)             \
+    /* Vector lanes: lane index is the constant operand */                 \
+    OPCODE(SPLAT, "splat", 1, kNone)                                       \
+    OPCODE(EXTRACT, "extract", 2, kNone)                                   \
+    OPCODE(INSERT, "insert", 3, kNone)                                     \
+    /* Memory: addresses are ptr values, GEP offset is in bytes */         \
+    OPCODE(ALLOC, "alloc", 1, kNone)                                       \
+    OPCODE(LOAD, "load", 1, kNone)                                         \
+    OPCODE(STORE, "store", 2, kSideEffects)                                \
+    OPCODE(GEP, "gep", 2, kNone)                                           \
+    /* Branchless choice: select cond, true value, false value */          \
+    OPCODE(SELECT, "select", 3, kNone)                                     \
+    /* Multi-way branch: switch cond, default, [case value: target...] */  \
+    OPCODE(SWITCH, "switch", kVariadicArity, kTerminator | kSideEffects)
+
 enum class Opcode : uint16_t {
-    /*  Default none value  */
-    NONE,
-    /*  Binary instructions */
-    ADD,
-    SUB,
-    MUL,
-    DIV,
-    SHR,
-    XOR,
-    EQ,
-    LE,
-    GE,
-    /* Unary instructions */
-    NEG,
-    /* Contorl flow */
-    RET,
-    BRANCH,
-    IF,
-    /* Other */
-    PHI,
-    CAST,
-    CONST,
-    PARAM,
-    CALL,
-    /* Checks Elimiation */
-    BOUNDS_CHECK,
-    NULL_CHECK
+#define OPCODE_ENUM(name, mnemonic, arity, flags) name,
+    JJ_VM_OPCODES(OPCODE_ENUM)
+#undef OPCODE_ENUM
 };
+
+/**
+ * @brief Compile-time description of the opcode
+ */
+struct OpcodeInfo final {
+    std::string_view mnemonic;
+    std::uint8_t arity;
+    std::uint8_t flags;
+};
+
+inline constexpr OpcodeInfo kOpcodesInfo[] = {
+#define OPCODE_INFO(name, mnemonic, arity, flags) \
+    {mnemonic, arity, [] {                        \
+         using namespace opcode_flags;            \
+         return static_cast<std::uint8_t>(flags); \
+     }()},
+    JJ_VM_OPCODES(OPCODE_INFO)
+#undef OPCODE_INFO
+};
+
+inline constexpr std::size_t kOpcodesNum = std::size(kOpcodesInfo);
+
+/**
+ * @brief Constexpr lookups of opcode properties. O(1), w/o allocations
+ */
+constexpr const OpcodeInfo& info(Opcode opc) noexcept {
+    return kOpcodesInfo[static_cast<std::size_t>(opc)];
+}
+
+constexpr std::string_view mnemonic(Opcode opc) noexcept {
+    return info(opc).mnemonic;
+}
+
+constexpr std::uint8_t arity(Opcode opc) noexcept { return info(opc).arity; }
+
+constexpr bool is_variadic(Opcode opc) noexcept {
+    return arity(opc) == kVariadicArity;
+}
+
+constexpr bool has_flag(Opcode opc, std::uint8_t flag) noexcept {
+    return (info(opc).flags & flag) != 0;
+}
+
+constexpr bool is_commutative(Opcode opc) noexcept {
+    return has_flag(opc, opcode_flags::kCommutative);
+}
+
+constexpr bool has_side_effects(Opcode opc) noexcept {
+    return has_flag(opc, opcode_flags::kSideEffects);
+}
+
+constexpr bool is_terminator(Opcode opc) noexcept {
+    return has_flag(opc, opcode_flags::kTerminator);
+}
+
+constexpr bool is_check(Opcode opc) noexcept {
+    return has_flag(opc, opcode_flags::kCheck);
+}
+
+/**
+ * @brief Semantics of compares: lhs == rhs, lhs <= rhs, lhs >= rhs.
+ *        Folding & lowering passes rely on it
+ */
+template <typename T>
+constexpr bool compare(Opcode opc, T lhs, T rhs) noexcept {
+    switch (opc) {
+        case Opcode::EQ:
+            return lhs == rhs;
+        case Opcode::LE:
+            return lhs <= rhs;
+        case Opcode::GE:
+            return lhs >= rhs;
+        default:
+            return false;
+    }
+}
+
+static_assert(compare(Opcode::LE, 1, 1) && compare(Opcode::GE, 1, 1));
+
+constexpr bool is_foldable(Opcode opc) noexcept {
+    return has_flag(opc, opcode_flags::kFoldable);
+}
+
 }  // namespace jj_vm::ir
 
 #endif  // OPCODES_HH
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "function.hh"
+#include "instructions.hh"
+#include "opcodes.hh"
+#include "utils/iterator_range.hh"
+
+namespace jj_vm::ir {
+class FunctionSnapshot;
+}  // namespace jj_vm::ir
+
+namespace jj_vm::ir::snapshot {
+
+class Block;
+
+/**
+ * @brief Frozen value: param or instruction. Id is copied from the source,
+ *        so side tables keyed by snapshot values don't touch the IR
+ */
+class Value {
+public:
+    using id_type = ir::Value::id_type;
+
+protected:
+    id_type m_id = ir::Value::kInvalidId;
+    TypeId m_type = TypeId::NONE;
+    //! NOTE: to map results back, it isn't dereferenced by the snapshot
+    const ir::Value* m_source = nullptr;
+
+public:
+    Value() = default;
+    Value(id_type id, TypeId type, const ir::Value* source)
+        : m_id(id), m_type(type), m_source(source) {}
+
+    id_type id() const noexcept { return m_id; }
+    TypeId type() const noexcept { return m_type; }
+    const ir::Value* source() const noexcept { return m_source; }
+};
+
+/**
+ * @brief Frozen instruction. Operands (& incoming blocks of phi) are slices
+ *        of flat arrays owned by FunctionSnapshot
+ */
+class Instr final : public Value {
+public:
+    using inputs_range = utils::IteratorRange<const Value* const*>;
+    using phi_var_pair = std::pair<const Value*, Block*>;
+
+private:
+    Opcode m_opcode = Opcode::NONE;
+    Block* m_parent = nullptr;
+    //
+    const Value* const* m_operands = nullptr;
+    Block* const* m_blocks = nullptr;
+    std::uint32_t m_num_operands = 0;
+    //
+    //! NOTE: value of CONST, extended to int64_t (see ir::const_value)
+    std::int64_t m_imm = 0;
+
+public:
+    Instr() = default;
+    Instr(const ir::Instr& source, Block* parent)
+        : Value(source.id(), source.type(), &source),
+          m_opcode(source.opcode()),
+          m_parent(parent),
+          m_num_operands(static_cast<std::uint32_t>(source.num_inputs())),
+          m_imm(source.opcode() == Opcode::CONST ? const_value(source) : 0) {}
+
+    /**
+     * @brief Getters
+     */
+    Opcode opcode() const noexcept { return m_opcode; }
+    Block* parent() const noexcept { return m_parent; }
+    std::int64_t imm() const noexcept { return m_imm; }
+
+    std::size_t num_inputs() const noexcept { return m_num_operands; }
+    const Value* get_input(std::size_t idx) const noexcept {
+        assert(idx < m_num_operands && "Error: operand index out of range");
+        return m_operands[idx];
+    }
+    inputs_range inputs() const noexcept {
+        return {m_operands, m_operands + m_num_operands};
+    }
+
+    /// Incoming block of the phi input with the same index
+    Block* incoming_block(std::size_t idx) const noexcept {
+        assert(m_opcode == Opcode::PHI && idx < m_num_operands);
+        return m_blocks[idx];
+    }
+
+    /// Same as ir::PhiInstr::incoming: inputs are indexed by preds
+    const Value* incoming(std::size_t pred_idx) const noexcept;
+
+    /// Same as ir::PhiInstr::vars
+    std::vector<phi_var_pair> vars() const {
+        std::vector<phi_var_pair> vars{};
+        vars.reserve(m_num_operands);
+        for (std::size_t i = 0; i < m_num_operands; ++i)
+            vars.emplace_back(m_operands[i], m_blocks[i]);
+        return vars;
+    }
+
+private:
+    friend class ir::FunctionSnapshot;
+};
+
+/**
+ * @brief Frozen basic block: instructions are a slice of the flat array,
+ *        preds & succs are slices of CSR adjacency arrays
+ */
+class Block final {
+public:
+    using id_type = BasicBlock::id_type;
+    using iterator = const Instr*;
+    using node_iterator = Block* const*;
+    using nodes_range = utils::IteratorRange<node_iterator>;
+
+private:
+    id_type m_id = 0;
+    const BasicBlock* m_source = nullptr;
+    //
+    const Instr* m_first = nullptr;
+    const Instr* m_phis_end = nullptr;
+    const Instr* m_last = nullptr;
+    //
+    node_iterator m_preds_begin = nullptr;
+    node_iterator m_preds_end = nullptr;
+    node_iterator m_succs_begin = nullptr;
+    node_iterator m_succs_end = nullptr;
+
+public:
+    Block() = default;
+    explicit Block(const BasicBlock& source)
+        : m_id(source.bb_id()), m_source(&source) {}
+
+    /**
+     * @brief Getters
+     */
+    id_type id() const noexcept { return m_id; }
+    id_type bb_id() const noexcept { return m_id; }
+    const BasicBlock* source() const noexcept { return m_source; }
+
+    nodes_range preds() const noexcept { return {m_preds_begin, m_preds_end}; }
+    nodes_range succs() const noexcept { return {m_succs_begin, m_succs_end}; }
+
+    /**
+     * @brief Instructions
+     */
+    iterator begin() const noexcept { return m_first; }
+    iterator end() const noexcept { return m_last; }
+    auto rbegin() const noexcept { return std::reverse_iterator{end()}; }
+    auto rend() const noexcept { return std::reverse_iterator{begin()}; }
+
+    std::size_t size() const noexcept {
+        return static_cast<std::size_t>(m_last - m_first);
+    }
+    bool empty() const noexcept { return m_first == m_last; }
+
+    const Instr& front() const noexcept { return *m_first; }
+    const Instr& back() const noexcept { return *std::prev(m_last); }
+
+    /// Phis are the prefix of the block as in ir::BasicBlock
+    iterator phis_end() const noexcept { return m_phis_end; }
+    auto phis() const noexcept {
+        return utils::make_range(begin(), phis_end());
+    }
+    bool has_phis() const noexcept { return m_first != m_phis_end; }
+
+private:
+    friend class ir::FunctionSnapshot;
+};
+
+inline const Value* Instr::incoming(std::size_t pred_idx) const noexcept {
+    assert(m_opcode == Opcode::PHI && "Error: incoming value of non phi");
+    auto preds = m_parent->preds();
+    assert(pred_idx < preds.size() && "Error: pred index out of range");
+    auto* pred = preds.begin()[pred_idx];
+    if (pred_idx < m_num_operands && m_blocks[pred_idx] == pred)
+        return m_operands[pred_idx];
+    //
+    for (std::size_t idx = 0; idx < m_num_operands; ++idx)
+        if (m_blocks[idx] == pred) return m_operands[idx];
+    return nullptr;
+}
+
+}  // namespace jj_vm::ir::snapshot
+
+namespace jj_vm::ir {
+
+/**
+ * @brief Immutable copy of the function for concurrent read-only analyses.
+ *        Blocks, instructions & operands are packed into flat arrays, CFG is
+ *        stored in CSR form. Snapshot doesn't refer to the IR after it is
+ *        built, so any number of threads could analyze it while the function
+ *        is mutated. Results are expected in side tables keyed by snapshot
+ *        nodes (they have the same ids as the source ones).
+ *
+ *        It satisfies the GraphTy interface of graph::BBGraph, so DomTree,
+ *        LoopTree & Liveness builders are instantiated with it.
+ *
+ *        NOTE: build is O(blocks + instructions + operands), the function
+ *              shouldn't be mutated during the build
+ */
+class FunctionSnapshot final {
+public:
+    using value_type = snapshot::Block;
+    using node_pointer = value_type*;
+    using node_reference = value_type&;
+    using const_node_reference = const value_type&;
+    using size_type = std::size_t;
+    using node_iterator = value_type::node_iterator;
+    //
+    //! NOTE: types of analyses results (see liveness::LivenessAnalyzer)
+    using value_pointer = const snapshot::Value*;
+    using instr_pointer = const snapshot::Instr*;
+    using phi_type = snapshot::Instr;
+
+private:
+    std::vector<snapshot::Block> m_blocks{};
+    std::vector<snapshot::Instr> m_instrs{};
+    std::vector<snapshot::Value> m_params{};
+    //
+    std::vector<const snapshot::Value*> m_operands{};
+    std::vector<snapshot::Block*> m_incoming{};
+    //
+    //! NOTE: CSR adjacency: slices of blocks are referred by blocks
+    std::vector<snapshot::Block*> m_preds{};
+    std::vector<snapshot::Block*> m_succs{};
+    //
+    //! NOTE: source id -> snapshot node
+    std::vector<const snapshot::Value*> m_values{};
+    std::vector<snapshot::Block*> m_blocks_by_id{};
+
+public:
+    explicit FunctionSnapshot(const Function& func) {
+        func.materialize();
+        m_values.resize(func.values_num(), nullptr);
+        m_blocks_by_id.resize(func.blocks_num(), nullptr);
+        //
+        reserve(func);
+        make_nodes(func);
+        make_operands(func);
+        make_edges(func);
+    }
+
+    //! NOTE: nodes refer to each other, moved vectors keep their buffers
+    FunctionSnapshot(const FunctionSnapshot&) = delete;
+    FunctionSnapshot& operator=(const FunctionSnapshot&) = delete;
+
+    FunctionSnapshot(FunctionSnapshot&&) = default;
+    FunctionSnapshot& operator=(FunctionSnapshot&&) = default;
+
+    /**
+     * @brief GraphTy interface
+     */
+    node_pointer head() const noexcept {
+        return m_blocks.empty() ? nullptr
+                                : const_cast<node_pointer>(&m_blocks.front());
+    }
+    size_type size() const noexcept { return m_blocks.size(); }
+
+    node_iterator succs_begin(node_pointer pnode) const noexcept {
+        return pnode->succs().begin();
+    }
+
+    node_iterator succs_end(node_pointer pnode) const noexcept {
+        return pnode->succs().end();
+    }
+
+    node_iterator preds_begin(node_pointer pnode) const noexcept {
+        return pnode->preds().begin();
+    }
+
+    node_iterator preds_end(node_pointer pnode) const noexcept {
+        return pnode->preds().end();
+    }
+
+    /**
+     * @brief Getters
+     */
+    const auto& blocks() const noexcept { return m_blocks; }
+    const auto& instrs() const noexcept { return m_instrs; }
+    const auto& params() const noexcept { return m_params; }
+
+    /// Snapshot node of the source value/block by its id, nullptr if the id
+    /// is out of snapshot (e.g. node is created afterwards)
+    const snapshot::Value* get(Value::id_type id) const noexcept {
+        return id < m_values.size() ? m_values[id] : nullptr;
+    }
+
+    node_pointer get_block(BasicBlock::id_type id) const noexcept {
+        return id < m_blocks_by_id.size() ? m_blocks_by_id[id] : nullptr;
+    }
+
+private:
+    void reserve(const Function& func) {
+        std::size_t instrs_num = 0, operands_num = 0;
+        std::size_t succs_num = 0, preds_num = 0;
+        for (auto&& bb : func) {
+            instrs_num += bb.size();
+            succs_num += bb.succs().size();
+            preds_num += bb.preds().size();
+            for (auto&& instr : bb) operands_num += instr.num_inputs();
+        }
+        //
+        //! NOTE: nodes are referred by pointers, so buffers are never
+        //!       reallocated after that
+        m_blocks.reserve(func.size());
+        m_instrs.reserve(instrs_num);
+        m_params.reserve(func.args().size());
+        m_operands.reserve(operands_num);
+        m_incoming.reserve(operands_num);
+        m_preds.reserve(preds_num);
+        m_succs.reserve(succs_num);
+    }
+
+    void make_nodes(const Function& func) {
+        for (auto&& arg : func.args())
+            register_value(&m_params.emplace_back(arg.id(), arg.type(), &arg));
+        //
+        for (auto&& bb : func) {
+            auto* block = &m_blocks.emplace_back(bb);
+            assert(bb.bb_id() < m_blocks_by_id.size());
+            m_blocks_by_id[bb.bb_id()] = block;
+            //
+            block->m_first = m_instrs.data() + m_instrs.size();
+            for (auto&& instr : bb)
+                register_value(&m_instrs.emplace_back(instr, block));
+            block->m_phis_end = block->m_first + bb.phis().size();
+            block->m_last = m_instrs.data() + m_instrs.size();
+        }
+    }
+
+    void make_operands(const Function& func) {
+        auto* frozen = m_instrs.data();
+        for (auto&& bb : func)
+            for (auto&& instr : bb) {
+                frozen->m_operands = m_operands.data() + m_operands.size();
+                frozen->m_blocks = m_incoming.data() + m_incoming.size();
+                //
+                for (auto* input : instr.inputs())
+                    m_operands.push_back(input != nullptr ? get(input->id())
+                                                          : nullptr);
+                //
+                if (instr.opcode() == Opcode::PHI)
+                    for (auto&& [input, incoming] :
+                         static_cast<const PhiInstr&>(instr).vars())
+                        m_incoming.push_back(
+                            incoming != nullptr ? get_block(incoming->bb_id())
+                                                : nullptr);
+                else
+                    m_incoming.resize(m_operands.size(), nullptr);
+                ++frozen;
+            }
+    }
+
+    void make_edges(const Function& func) {
+        //! NOTE: order of preds & succs is kept, e.g. for phi inputs
+        auto* block = m_blocks.data();
+        for (auto&& bb : func) {
+            block->m_succs_begin = m_succs.data() + m_succs.size();
+            for (auto* succ : bb.succs())
+                m_succs.push_back(get_block(succ->bb_id()));
+            block->m_succs_end = m_succs.data() + m_succs.size();
+            //
+            block->m_preds_begin = m_preds.data() + m_preds.size();
+            for (auto* pred : bb.preds())
+                m_preds.push_back(get_block(pred->bb_id()));
+            block->m_preds_end = m_preds.data() + m_preds.size();
+            ++block;
+        }
+    }
+
+    void register_value(const snapshot::Value* val) {
+        assert(val->id() < m_values.size() && "Error: value without id");
+        m_values[val->id()] = val;
+    }
+};
+
+}  // namespace jj_vm::ir
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "function.hh"
+#include "graph/bb_graph.hh"
+#include "graph/dfs.hh"
+#include "instructions.hh"
+#include "opcodes.hh"
+#include "utils/side_table.hh"
+
+namespace jj_vm::ir {
+
+/**
+ * @brief Canonical encoding of the function body as a stream of words.
+ *        Reachable blocks are visited in RPO (graph::
+ *        deep_first_search_reverse_postoder), blocks & values are referred by
+ *        their canonical numbers: blocks by RPO position, params by position
+ *        and instructions by visit order. So the form doesn't depend on
+ *        pointers, ids or the order of blocks in the function list.
+ *
+ *        Encoded: return & param types, every instruction with its opcode,
+ *        type, inputs, constant value, targets of terminators, (incoming
+ *        block, input) pairs of phis in block order and callee name
+ *        (recursive call is encoded apart, so copies of the recursive
+ *        function are equal). Names of the function & params and unreachable
+ *        blocks are not encoded.
+ *
+ *        Equal forms are equal functions up to renaming, so hash() is a key
+ *        for compilation caches and merging of functions, operator== checks
+ *        the match exactly. Build is O(blocks + instructions + operands).
+ */
+class StructuralForm final {
+public:
+    using word_type = std::uint64_t;
+
+    /// Hasher for unordered containers keyed by forms
+    struct Hash final {
+        std::size_t operator()(const StructuralForm& form) const noexcept {
+            return form.hash();
+        }
+    };
+
+private:
+    static constexpr word_type kUnknown = std::numeric_limits<word_type>::max();
+    //! NOTE: callee of the recursive call
+    static constexpr word_type kSelf = kUnknown - 1;
+
+    std::vector<word_type> m_words{};
+    std::uint64_t m_hash = 0;
+
+public:
+    explicit StructuralForm(const Function& func) {
+        func.materialize();
+        encode(func);
+        //
+        m_hash = kHashSeed;
+        for (auto word : m_words) m_hash = (m_hash ^ mix(word)) * kHashPrime;
+        m_hash = mix(m_hash);
+    }
+
+    /**
+     * @brief Getters
+     */
+    const auto& words() const noexcept { return m_words; }
+    std::uint64_t hash() const noexcept { return m_hash; }
+
+    bool operator==(const StructuralForm& other) const noexcept {
+        return m_hash == other.m_hash && m_words == other.m_words;
+    }
+    bool operator!=(const StructuralForm& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    static constexpr std::uint64_t kHashSeed = 0xcbf29ce484222325ULL;
+    static constexpr std::uint64_t kHashPrime = 0x100000001b3ULL;
+
+    /// splitmix64 finalizer: every bit of the word affects every bit
+    static std::uint64_t mix(std::uint64_t word) noexcept {
+        word ^= word >> 30;
+        word *= 0xbf58476d1ce4e5b9ULL;
+        word ^= word >> 27;
+        word *= 0x94d049bb133111ebULL;
+        word ^= word >> 31;
+        return word;
+    }
+
+    void encode(const Function& func) {
+        emit(static_cast<word_type>(func.func_ty().type()));
+        emit(func.args().size());
+        for (auto&& arg : func.args())
+            emit(static_cast<word_type>(arg.type()));
+        if (func.empty()) return;
+        //
+        //! NOTE: graph is only walked, function isn't modified
+        auto rpo = graph::deep_first_search_reverse_postoder(graph::BBGraph{
+            const_cast<BasicBlock*>(&func.front()), func.size()});
+        emit(rpo.size());
+        //
+        //! NOTE: canonical numbers are assigned first, phis & branches refer
+        //!       forward
+        utils::SideTable<const BasicBlock*, word_type> blocks(
+            func.blocks_num());
+        utils::SideTable<const Value*, word_type> values(func.values_num());
+        word_type num = 0;
+        for (auto&& arg : func.args()) values.insert({&arg, num++});
+        for (std::size_t idx = 0; idx < rpo.size(); ++idx) {
+            blocks.insert({rpo[idx], idx});
+            for (auto&& instr : *rpo[idx]) values.insert({&instr, num++});
+        }
+        //
+        auto block_num = [&blocks](const BasicBlock* bb) {
+            auto found = bb != nullptr ? blocks.find(bb) : blocks.end();
+            return found != blocks.end() ? found->second : kUnknown;
+        };
+        auto value_num = [&values](const Value* val) {
+            auto found = val != nullptr ? values.find(val) : values.end();
+            return found != values.end() ? found->second : kUnknown;
+        };
+        //
+        for (const auto* bb : rpo) {
+            emit(bb->size());
+            for (auto&& instr : *bb) {
+                emit(static_cast<word_type>(instr.opcode()) |
+                     static_cast<word_type>(instr.type()) << 16 |
+                     instr.num_inputs() << 32);
+                if (instr.opcode() == Opcode::PHI)
+                    encode_phi(static_cast<const PhiInstr&>(instr), block_num,
+                               value_num);
+                else
+                    for (const auto* input : instr.inputs())
+                        emit(value_num(input));
+                //
+                encode_payload(func, instr, block_num);
+            }
+        }
+    }
+
+    /// Inputs of phi are ordered by preds, which depend on the order of
+    /// linking, so (block, value) pairs are sorted by canonical block
+    template <typename BlockNumFn, typename ValueNumFn>
+    void encode_phi(const PhiInstr& phi, BlockNumFn&& block_num,
+                    ValueNumFn&& value_num) {
+        std::vector<std::pair<word_type, word_type>> vars{};
+        vars.reserve(phi.num_inputs());
+        for (auto&& [input, incoming] : phi.vars())
+            vars.emplace_back(block_num(incoming), value_num(input));
+        std::sort(vars.begin(), vars.end());
+        //
+        for (auto&& [bb, val] : vars) {
+            emit(bb);
+            emit(val);
+        }
+    }
+
+    template <typename BlockNumFn>
+    void encode_payload(const Function& func, const Instr& instr,
+                        BlockNumFn&& block_num) {
+        switch (instr.opcode()) {
+            case Opcode::CONST:
+                emit(static_cast<word_type>(const_value(instr)));
+                break;
+            case Opcode::BRANCH:
+                emit(block_num(static_cast<const BranchInstr&>(instr).dst()));
+                break;
+            case Opcode::IF: {
+                const auto& if_instr = static_cast<const IfInstr&>(instr);
+                emit(block_num(if_instr.true_bb()));
+                emit(block_num(if_instr.false_bb()));
+                break;
+            }
+            case Opcode::SWITCH: {
+                const auto& switch_instr =
+                    static_cast<const SwitchInstr&>(instr);
+                emit(block_num(switch_instr.default_bb()));
+                for (std::size_t idx = 0; idx < switch_instr.cases_num(); ++idx)
+                    emit(block_num(switch_instr.case_target(idx)));
+                break;
+            }
+            case Opcode::CALL: {
+                const auto* callee =
+                    static_cast<const CallInstr&>(instr).callee();
+                if (callee == nullptr)
+                    emit(kUnknown);
+                else if (callee == &func)
+                    emit(kSelf);
+                else
+                    emit(callee->name());
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    void emit(word_type word) { m_words.push_back(word); }
+
+    /// Length & bytes packed by 8 into words
+    void emit(std::string_view str) {
+        emit(str.size());
+        word_type word = 0;
+        for (std::size_t idx = 0; idx < str.size(); ++idx) {
+            word |= static_cast<word_type>(static_cast<unsigned char>(str[idx]))
+                    << (8 * (idx % 8));
+            if (idx % 8 == 7 || idx + 1 == str.size())
+                emit(std::exchange(word, 0));
+        }
+    }
+};
+
+/**
+ * @brief Canonical hash of the function, see StructuralForm
+ */
+inline std::uint64_t structural_hash(const Function& func) {
+    return StructuralForm{func}.hash();
+}
+
+/**
+ * @brief Exact structural equivalence: functions are the same up to names,
+ *        ids & order of blocks. O(size of both functions)
+ */
+inline bool structurally_equal(const Function& lhs, const Function& rhs) {
+    return StructuralForm{lhs} == StructuralForm{rhs};
+}
+
+}  // namespace jj_vm::ir
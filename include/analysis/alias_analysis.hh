@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "escape_analysis.hh"
+
+namespace jj_vm::analysis::memory {
+
+enum class AliasResult : std::uint8_t { NO_ALIAS, MAY_ALIAS, MUST_ALIAS };
+
+/**
+ * @brief Bytes [offset, offset + size) from the base address. Base is the
+ *        root of GEP chain (alloc, param, load, phi...), offset is unknown
+ *        if some GEP of the chain has non-constant offset
+ */
+struct MemoryLocation final {
+    const ir::Value* m_base = nullptr;
+    std::int64_t m_offset = 0;
+    std::size_t m_size = 0;
+    bool m_exact = true;
+};
+
+/**
+ * @brief Base & offset alias analysis:
+ *        - locations of the same base alias if their bytes overlap,
+ *          they are the same if offsets & sizes are equal
+ *        - different allocs don't alias
+ *        - local alloc (its address doesn't escape, see EscapeAnalysis)
+ *          doesn't alias any other base, calls neither read nor write it
+ *        O(instructions) to build, queries are O(length of GEP chains)
+ */
+class AliasAnalysis final {
+    EscapeAnalysis m_escape;
+
+public:
+    explicit AliasAnalysis(const ir::Function& func)
+        : m_escape(func) {}
+
+    /**
+     * @brief Location accessed by the load or the store
+     */
+    MemoryLocation location(const ir::Instr& access) const {
+        assert(access.opcode() == ir::Opcode::LOAD ||
+               access.opcode() == ir::Opcode::STORE);
+        auto type = access.opcode() == ir::Opcode::LOAD
+                        ? access.type()
+                        : access.get_input(1)->type();
+        auto loc = decompose(access.get_input(0));
+        loc.m_size = std::max<std::size_t>(ir::type_bits(type) / 8, 1);
+        return loc;
+    }
+
+    AliasResult alias(const MemoryLocation& lhs,
+                      const MemoryLocation& rhs) const {
+        if (lhs.m_base != rhs.m_base) {
+            bool both_allocs = is_alloc(lhs.m_base) && is_alloc(rhs.m_base);
+            return both_allocs || is_local(lhs.m_base) || is_local(rhs.m_base)
+                       ? AliasResult::NO_ALIAS
+                       : AliasResult::MAY_ALIAS;
+        }
+        if (!lhs.m_exact || !rhs.m_exact) return AliasResult::MAY_ALIAS;
+        if (lhs.m_offset == rhs.m_offset && lhs.m_size == rhs.m_size)
+            return AliasResult::MUST_ALIAS;
+        //
+        auto lhs_end = lhs.m_offset + static_cast<std::int64_t>(lhs.m_size);
+        auto rhs_end = rhs.m_offset + static_cast<std::int64_t>(rhs.m_size);
+        return lhs_end <= rhs.m_offset || rhs_end <= lhs.m_offset
+                   ? AliasResult::NO_ALIAS
+                   : AliasResult::MAY_ALIAS;
+    }
+
+    AliasResult alias(const ir::Instr& lhs, const ir::Instr& rhs) const {
+        return alias(location(lhs), location(rhs));
+    }
+
+    /**
+     * @brief Could the write of the store or the call change the location
+     */
+    bool may_clobber(const ir::Instr& def, const MemoryLocation& loc) const {
+        switch (def.opcode()) {
+            case ir::Opcode::STORE:
+                return alias(location(def), loc) != AliasResult::NO_ALIAS;
+            case ir::Opcode::CALL:
+                return !is_local(loc.m_base);
+            default:
+                return true;
+        }
+    }
+
+    /**
+     * @brief Alloc which isn't visible outside of the function
+     */
+    bool is_local(const ir::Value* base) const {
+        return !m_escape.escapes(base);
+    }
+
+    bool is_alloc(const ir::Value* base) const {
+        return m_escape.is_alloc(base);
+    }
+
+    const EscapeAnalysis& escape() const noexcept { return m_escape; }
+
+private:
+    MemoryLocation decompose(const ir::Value* ptr) const {
+        MemoryLocation loc{ptr};
+        while (!loc.m_base->is_param()) {
+            const auto* gep = static_cast<const ir::Instr*>(loc.m_base);
+            if (gep->opcode() != ir::Opcode::GEP) break;
+            //
+            const auto* offset = gep->get_input(1);
+            if (!offset->is_param() &&
+                static_cast<const ir::Instr*>(offset)->opcode() ==
+                    ir::Opcode::CONST)
+                loc.m_offset +=
+                    ir::const_value(*static_cast<const ir::Instr*>(offset));
+            else
+                loc.m_exact = false;
+            loc.m_base = gep->get_input(0);
+        }
+        return loc;
+    }
+};
+
+}  // namespace jj_vm::analysis::memory
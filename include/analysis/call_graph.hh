@@ -0,0 +1,307 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "IR/function.hh"
+#include "IR/module.hh"
+#include "graph/dfs.hh"
+#include "utils/iterator_range.hh"
+#include "utils/side_table.hh"
+
+namespace jj_vm::analysis::callgraph {
+
+/**
+ * @brief Function of the call graph with its callers & callees.
+ *        Node with null function is the external one: it calls every
+ *        function of the module, but isn't listed among their callers
+ */
+class CallGraphNode final {
+public:
+    using id_type = std::uint32_t;
+
+private:
+    id_type m_id = 0;
+    ir::Function* m_func = nullptr;
+    //
+    //! NOTE: unique callees & callers, repeated calls are kept in call sites
+    std::vector<CallGraphNode*> m_callees{};
+    std::vector<CallGraphNode*> m_callers{};
+    std::vector<ir::CallInstr*> m_call_sites{};
+
+public:
+    CallGraphNode() = default;
+    CallGraphNode(id_type id, ir::Function* func) : m_id(id), m_func(func) {}
+
+    /**
+     * @brief Getters
+     */
+    /// Dense index inside call graph, see utils::SideTable
+    id_type id() const noexcept { return m_id; }
+
+    ir::Function* function() const noexcept { return m_func; }
+    bool is_external() const noexcept { return m_func == nullptr; }
+
+    const auto& callees() const noexcept { return m_callees; }
+    const auto& callers() const noexcept { return m_callers; }
+    const auto& call_sites() const noexcept { return m_call_sites; }
+
+    bool calls(const CallGraphNode* callee) const noexcept {
+        return std::find(m_callees.begin(), m_callees.end(), callee) !=
+               m_callees.end();
+    }
+
+private:
+    void add_call(CallGraphNode* callee, ir::CallInstr* call) {
+        if (call != nullptr) m_call_sites.push_back(call);
+        if (calls(callee)) return;
+        //
+        m_callees.push_back(callee);
+        if (!is_external()) callee->m_callers.push_back(this);
+    }
+
+    friend class CallGraph;
+};
+
+/**
+ * @brief Strongly connected component of the call graph, i.e. set of
+ *        mutually recursive functions
+ */
+class SCC final {
+public:
+    using node_pointer = CallGraphNode*;
+
+private:
+    std::vector<node_pointer> m_nodes{};
+    bool m_recursive = false;
+
+public:
+    SCC() = default;
+    SCC(std::vector<node_pointer> nodes, bool recursive)
+        : m_nodes(std::move(nodes)), m_recursive(recursive) {}
+
+    /// Some function of the component calls itself (maybe indirectly)
+    bool is_recursive() const noexcept { return m_recursive; }
+
+    std::size_t size() const noexcept { return m_nodes.size(); }
+
+    auto begin() const noexcept { return m_nodes.begin(); }
+    auto end() const noexcept { return m_nodes.end(); }
+};
+
+/**
+ * @brief Call graph of the module. It satisfies the GraphTy interface of
+ *        graph::BBGraph: head() is the external node, which calls every
+ *        function, so graph::deep_first_search_* reach the whole module.
+ *
+ *        SCCs are found by Tarjan's algorithm with explicit stack, so it
+ *        doesn't depend on the depth of call chains. O(functions + calls)
+ *
+ *        NOTE: nodes are referred by pointers, so graph isn't copyable.
+ *              Callees outside the module aren't part of the graph
+ */
+class CallGraph final {
+public:
+    using value_type = CallGraphNode;
+    using node_pointer = value_type*;
+    using node_reference = value_type&;
+    using const_node_reference = const value_type&;
+    using size_type = std::size_t;
+    //
+    using node_iterator = std::vector<node_pointer>::const_iterator;
+    using scc_iterator = std::vector<SCC>::const_iterator;
+    using scc_reverse_iterator = std::vector<SCC>::const_reverse_iterator;
+
+private:
+    //! NOTE: the external node is the first one
+    std::vector<value_type> m_nodes{};
+    std::unordered_map<const ir::Function*, node_pointer> m_func_nodes{};
+    //
+    //! NOTE: components in bottom-up order (callees before callers)
+    std::vector<SCC> m_sccs{};
+    utils::SideTable<node_pointer, std::size_t> m_scc_ids{};
+
+public:
+    explicit CallGraph(const ir::Module& module) {
+        m_nodes.reserve(module.size() + 1);
+        m_nodes.emplace_back(0, nullptr);
+        //
+        for (auto&& func : module) {
+            auto* node = &m_nodes.emplace_back(
+                static_cast<CallGraphNode::id_type>(m_nodes.size()),
+                func.get());
+            m_func_nodes.emplace(func.get(), node);
+            head()->add_call(node, nullptr);
+        }
+        //
+        for (auto&& node : m_nodes)
+            if (!node.is_external()) collect_calls(&node);
+        //
+        build_sccs();
+    }
+
+    CallGraph(const CallGraph&) = delete;
+    CallGraph& operator=(const CallGraph&) = delete;
+
+    CallGraph(CallGraph&&) = default;
+    CallGraph& operator=(CallGraph&&) = default;
+
+    /**
+     * @brief GraphTy interface
+     */
+    node_pointer head() noexcept { return &m_nodes.front(); }
+    node_pointer head() const noexcept {
+        return const_cast<node_pointer>(&m_nodes.front());
+    }
+    size_type size() const noexcept { return m_nodes.size(); }
+
+    node_iterator succs_begin(node_pointer pnode) const noexcept {
+        return pnode->callees().begin();
+    }
+
+    node_iterator succs_end(node_pointer pnode) const noexcept {
+        return pnode->callees().end();
+    }
+
+    node_iterator preds_begin(node_pointer pnode) const noexcept {
+        return pnode->callers().begin();
+    }
+
+    node_iterator preds_end(node_pointer pnode) const noexcept {
+        return pnode->callers().end();
+    }
+
+    /**
+     * @brief Node of the function, nullptr if it isn't in the module
+     */
+    node_pointer get_node(const ir::Function* func) const {
+        auto found = m_func_nodes.find(func);
+        return found != m_func_nodes.end() ? found->second : nullptr;
+    }
+
+    /**
+     * @brief Strongly connected components
+     */
+    const SCC& get_scc(const ir::Function* func) const {
+        return m_sccs[m_scc_ids.at(get_node(func))];
+    }
+
+    std::size_t sccs_num() const noexcept { return m_sccs.size(); }
+
+    /// Callees are visited before callers, e.g. for inlining
+    auto bottom_up() const noexcept {
+        return utils::make_range(m_sccs.cbegin(), m_sccs.cend());
+    }
+
+    /// Callers are visited before callees, e.g. for argument propagation
+    auto top_down() const noexcept {
+        return utils::make_range(m_sccs.crbegin(), m_sccs.crend());
+    }
+
+    /// Same orders flattened to functions
+    std::vector<ir::Function*> bottom_up_functions() const {
+        return flatten(bottom_up());
+    }
+
+    std::vector<ir::Function*> top_down_functions() const {
+        return flatten(top_down());
+    }
+
+private:
+    void collect_calls(node_pointer node) {
+        for (auto&& bb : *node->function())
+            for (auto&& instr : bb) {
+                if (instr.opcode() != ir::Opcode::CALL) continue;
+                //
+                auto& call = static_cast<ir::CallInstr&>(instr);
+                auto* callee = get_node(call.callee());
+                if (callee != nullptr) node->add_call(callee, &call);
+            }
+    }
+
+    /**
+     * @brief Tarjan's algorithm. Components are completed in reverse
+     *        topological order, which is exactly the bottom-up one
+     */
+    void build_sccs() {
+        constexpr auto kUnvisited = std::numeric_limits<std::size_t>::max();
+        //
+        std::vector<std::size_t> index(m_nodes.size(), kUnvisited);
+        std::vector<std::size_t> lowlink(m_nodes.size(), 0);
+        std::vector<bool> on_stack(m_nodes.size(), false);
+        //
+        std::vector<node_pointer> scc_stack{};
+        std::vector<std::pair<node_pointer, node_iterator>> call_stack{};
+        std::size_t counter = 0;
+        //
+        auto discover = [&](node_pointer node) {
+            index[node->id()] = lowlink[node->id()] = counter++;
+            scc_stack.push_back(node);
+            on_stack[node->id()] = true;
+            call_stack.emplace_back(node, succs_begin(node));
+        };
+        //
+        for (auto root_it = succs_begin(head()); root_it != succs_end(head());
+             ++root_it) {
+            if (index[(*root_it)->id()] != kUnvisited) continue;
+            discover(*root_it);
+            //
+            while (!call_stack.empty()) {
+                auto& [node, succ_it] = call_stack.back();
+                //
+                if (succ_it != succs_end(node)) {
+                    auto* succ = *succ_it++;
+                    if (index[succ->id()] == kUnvisited)
+                        discover(succ);
+                    else if (on_stack[succ->id()])
+                        lowlink[node->id()] =
+                            std::min(lowlink[node->id()], index[succ->id()]);
+                    continue;
+                }
+                //
+                auto* finished = node;
+                call_stack.pop_back();
+                if (!call_stack.empty()) {
+                    auto parent_id = call_stack.back().first->id();
+                    lowlink[parent_id] =
+                        std::min(lowlink[parent_id], lowlink[finished->id()]);
+                }
+                //
+                if (lowlink[finished->id()] == index[finished->id()])
+                    pop_scc(finished, scc_stack, on_stack);
+            }
+        }
+    }
+
+    void pop_scc(node_pointer root, std::vector<node_pointer>& scc_stack,
+                 std::vector<bool>& on_stack) {
+        std::vector<node_pointer> nodes{};
+        node_pointer cur = nullptr;
+        do {
+            cur = scc_stack.back();
+            scc_stack.pop_back();
+            on_stack[cur->id()] = false;
+            m_scc_ids[cur] = m_sccs.size();
+            nodes.push_back(cur);
+        } while (cur != root);
+        //
+        bool recursive = nodes.size() > 1 || root->calls(root);
+        m_sccs.emplace_back(std::move(nodes), recursive);
+    }
+
+    template <typename RangeTy>
+    static std::vector<ir::Function*> flatten(const RangeTy& sccs) {
+        std::vector<ir::Function*> funcs{};
+        for (auto&& scc : sccs)
+            for (auto* node : scc) funcs.push_back(node->function());
+        return funcs;
+    }
+};
+
+}  // namespace jj_vm::analysis::callgraph
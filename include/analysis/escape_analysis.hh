@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "utils/side_table.hh"
+
+namespace jj_vm::analysis::memory {
+
+/**
+ * @brief Flow-insensitive escape analysis of allocs. Address escapes if it
+ *        could be observed outside of the memory accesses of the function:
+ *        users of the alloc & of GEPs derived from it are scanned
+ *        - load & store through the address, GEP of the address and
+ *          null check without users keep it local
+ *        - store of the address as the value, call, ret, phi and any other
+ *          instruction let it escape
+ *        O(users of allocs & their GEPs)
+ */
+class EscapeAnalysis final {
+    std::vector<ir::Instr*> m_allocs{};
+    //! NOTE: alloc -> does its address escape
+    utils::SideTable<const ir::Value*, bool> m_escaped{};
+
+public:
+    explicit EscapeAnalysis(const ir::Function& func)
+        : m_escaped(func.values_num()) {
+        for (auto&& bb : func)
+            for (auto&& instr : bb)
+                if (instr.opcode() == ir::Opcode::ALLOC) {
+                    auto* alloc = const_cast<ir::Instr*>(&instr);
+                    m_allocs.push_back(alloc);
+                    m_escaped.insert({alloc, escapes_impl(alloc)});
+                }
+    }
+
+    /**
+     * @brief Getters
+     */
+    const std::vector<ir::Instr*>& allocs() const noexcept { return m_allocs; }
+
+    bool is_alloc(const ir::Value* val) const {
+        return m_escaped.find(val) != m_escaped.end();
+    }
+
+    /// Values other than allocs are treated as escaped
+    bool escapes(const ir::Value* val) const {
+        auto found = m_escaped.find(val);
+        return found == m_escaped.end() || found->second;
+    }
+
+private:
+    static bool escapes_impl(const ir::Instr* alloc) {
+        std::vector<const ir::Value*> worklist{alloc};
+        while (!worklist.empty()) {
+            const auto* ptr = worklist.back();
+            worklist.pop_back();
+            for (const auto* user : ptr->users()) {
+                switch (user->opcode()) {
+                    case ir::Opcode::LOAD:
+                        break;
+                    case ir::Opcode::STORE:
+                        if (user->get_input(1) == ptr) return true;
+                        break;
+                    case ir::Opcode::GEP:
+                        if (user->get_input(1) == ptr) return true;
+                        worklist.push_back(user);
+                        break;
+                    case ir::Opcode::NULL_CHECK:
+                        if (user->has_users()) return true;
+                        break;
+                    default:
+                        return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+}  // namespace jj_vm::analysis::memory
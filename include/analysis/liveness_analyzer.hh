@@ -4,12 +4,14 @@
 #include "IR/instruction.hh"
 #include "linear_order.hh"
 #include "loop_analyzer.hh"
+#include "utils/side_table.hh"
 //
 #include <cassert>
+#include <cstddef>
 //
 #include <optional>
 #include <set>
-#include <unordered_map>
+#include <type_traits>
 #include <unordered_set>
 #include <vector>
 
@@ -23,16 +25,31 @@ class LivenessAnalyzer final {
 public:
     using value_type = typename GraphTy::value_type;
     using node_pointer = typename GraphTy::node_pointer;
+    //
+    //! NOTE: results are keyed by nodes of the graph (IR or its snapshot)
+    using value_pointer = typename GraphTy::value_pointer;
+    using instr_pointer = typename GraphTy::instr_pointer;
+    //
     using LiveIntevalTy = jj_vm::ir::LiveInterval;
-    using LiveSetTy = std::unordered_set<ir::Value *>;
+    using LiveSetTy = std::unordered_set<value_pointer>;
     using OrderTy =
         typename jj_ir::analysis::order::LinearOrderBuilder<GraphTy>::OrderTy;
+    //
+    using IntervalsTy = utils::SideTable<value_pointer, LiveIntevalTy>;
+    using LiveSetsTy = utils::SideTable<node_pointer, LiveSetTy>;
+    using BlockIntervalsTy = utils::SideTable<node_pointer, LiveIntevalTy>;
+    using NumsTy = utils::SideTable<instr_pointer, std::size_t>;
 
 private:
     friend LivenessBuilder<GraphTy>;
 
-    std::unordered_map<jj_vm::ir::Value *, LiveIntevalTy> m_intervals;
-    std::unordered_map<node_pointer, LiveSetTy> m_live_sets;
+    IntervalsTy m_intervals;
+    LiveSetsTy m_live_sets;
+    //
+    //! NOTE: linear & live numbers of instructions, intervals of blocks
+    NumsTy m_lin_nums;
+    NumsTy m_live_nums;
+    BlockIntervalsTy m_bb_intervals;
     //
 public:
     LivenessAnalyzer() = default;
@@ -45,12 +62,24 @@ public:
 
     auto live_sets() const noexcept { return m_live_sets; }
 
-    const LiveIntevalTy *get_interval(jj_vm::ir::Value *val) const {
+    const LiveIntevalTy *get_interval(value_pointer val) const {
         auto find_res = m_intervals.find(val);
         if (find_res == m_intervals.end()) return nullptr;
 
         return &(find_res->second);
     }
+
+    std::size_t live(instr_pointer instr) const {
+        return m_live_nums.at(instr);
+    }
+
+    std::size_t lin(instr_pointer instr) const {
+        return m_lin_nums.at(instr);
+    }
+
+    LiveIntevalTy interval(node_pointer node) const {
+        return m_bb_intervals.at(node);
+    }
 };
 
 template <typename GraphTy>
@@ -58,23 +87,37 @@ class LivenessBuilder {
 public:
     using value_type = typename GraphTy::value_type;
     using node_pointer = typename GraphTy::node_pointer;
+    using value_pointer = typename GraphTy::value_pointer;
+    using instr_type =
+        std::remove_pointer_t<typename GraphTy::instr_pointer>;
+    using phi_type = typename GraphTy::phi_type;
     //
     using OrderTy = typename LivenessAnalyzer<GraphTy>::OrderTy;
     using LiveSetTy = typename LivenessAnalyzer<GraphTy>::LiveSetTy;
     using LiveIntevalTy = typename LivenessAnalyzer<GraphTy>::LiveIntevalTy;
+    using IntervalsTy = typename LivenessAnalyzer<GraphTy>::IntervalsTy;
+    using LiveSetsTy = typename LivenessAnalyzer<GraphTy>::LiveSetsTy;
+    using BlockIntervalsTy =
+        typename LivenessAnalyzer<GraphTy>::BlockIntervalsTy;
+    using NumsTy = typename LivenessAnalyzer<GraphTy>::NumsTy;
 
 private:
     loop::LoopTree<GraphTy> m_loop_tree{};
     OrderTy order{};
     //
-    std::unordered_map<ir::Value *, LiveIntevalTy> m_intervals;
-    std::unordered_map<node_pointer, LiveSetTy> m_live_sets;
+    IntervalsTy m_intervals;
+    LiveSetsTy m_live_sets;
+    //
+    NumsTy m_lin_nums;
+    NumsTy m_live_nums;
+    BlockIntervalsTy m_bb_intervals;
     //
     static constexpr std::size_t kLinStep = 1;
     static constexpr std::size_t kLiveStep = 2;
 
 public:
-    LivenessBuilder(const GraphTy &graph) {
+    LivenessBuilder(const GraphTy &graph)
+        : m_live_sets(graph.size()), m_bb_intervals(graph.size()) {
         m_loop_tree =
             jj_vm::analysis::loop::LoopTreeBuilder<GraphTy>::build(graph);
         order = jj_ir::analysis::order::LinearOrderBuilder<GraphTy>::build(
@@ -106,13 +149,13 @@ private:
 
                 if (!is_phi) live += kLiveStep;
                 //
-                inst.set_lin(lin);
-                inst.set_live(is_phi ? bb_live : live);
+                m_lin_nums[&inst] = lin;
+                m_live_nums[&inst] = is_phi ? bb_live : live;
                 //
                 lin += kLinStep;
             }
             //
-            bb->set_interval(LiveIntevalTy{bb_live, live += kLiveStep});
+            m_bb_intervals[bb] = LiveIntevalTy{bb_live, live += kLiveStep};
         }
     }
 
@@ -122,7 +165,7 @@ private:
      * @param[in] value
      * @param[in] interval
      */
-    void set_live_interval(jj_vm::ir::Value *value,
+    void set_live_interval(value_pointer value,
                            const LiveIntevalTy &interval) {
         auto [pair, insert_res] =
             m_intervals.insert(std::make_pair(value, interval));
@@ -143,11 +186,12 @@ private:
         if (loop_base && loop_base->header() == node &&
             loop_base->is_reducible()) {
             auto &&cur_interval = m_live_sets[node];
-            std::size_t loop_end = 0, loop_start = node->interval().begin();
+            std::size_t loop_end = 0,
+                        loop_start = m_bb_intervals[node].begin();
 
             //! NOTE: Getting loop end
             for (auto *loop_node : *loop_base)
-                loop_end = std::max(loop_end, loop_node->interval().end());
+                loop_end = std::max(loop_end, m_bb_intervals[loop_node].end());
 
             for (auto *value : set)
                 set_live_interval(value, LiveIntevalTy{loop_start, loop_end});
@@ -157,13 +201,14 @@ private:
     /**
      * @brief Function to process each input of every instruction in basic block
      */
-    void process_inputs(const jj_vm::ir::Instr &instr, LiveSetTy &set,
+    void process_inputs(instr_type &instr, LiveSetTy &set,
                         std::size_t bb_start) {
         for (auto *input : instr.inputs()) {
             assert(input != nullptr &&
                    "Error: input of instruction equals nullptr");
             set.insert(input);
-            set_live_interval(input, LiveIntevalTy{bb_start, instr.live()});
+            set_live_interval(input,
+                              LiveIntevalTy{bb_start, m_live_nums[&instr]});
         }
     }
 
@@ -179,7 +224,7 @@ private:
 
             if (instr.opcode() == jj_vm::ir::Opcode::PHI) return;
 
-            auto live_num = instr.live();
+            auto live_num = m_live_nums[&instr];
             auto [pair, insert_res] = m_intervals.insert(std::make_pair(
                 &instr, LiveIntevalTy{live_num, live_num + kLiveStep}));
 
@@ -187,7 +232,7 @@ private:
             set.erase(&instr);
 
             //! NOTE: there are should be no PHI instr
-            process_inputs(instr, set, node->interval().begin());
+            process_inputs(instr, set, m_bb_intervals[node].begin());
         }
     }
 
@@ -210,13 +255,17 @@ private:
             auto &succ_live_set = found_res->second;
             live_set.insert(succ_live_set.begin(), succ_live_set.end());
 
-            for (auto &instr : *succ_it) {
-                if (instr.opcode() == jj_vm::ir::Opcode::PHI) {
+            //! NOTE: only phis of succ are visited, their inputs are indexed
+            //!       by preds of succ
+            const auto &preds = succ_it->preds();
+            for (std::size_t idx = 0; idx < preds.size(); ++idx) {
+                if (preds.begin()[idx] != node) continue;
+                //
+                for (auto &instr : succ_it->phis()) {
                     const auto &phi_node =
-                        static_cast<const ir::PhiInstr &>(instr);
-                    //
-                    for (const auto &[phi_inp, phi_bb] : phi_node.vars())
-                        if (phi_bb == node) live_set.insert(phi_inp);
+                        static_cast<const phi_type &>(instr);
+                    if (auto *phi_inp = phi_node.incoming(idx))
+                        live_set.insert(phi_inp);
                 }
             }
         }
@@ -229,13 +278,8 @@ private:
      *
      * @param[in] instr
      */
-    bool is_empty_life_range(const jj_vm::ir::Instr &instr) {
-        std::set<jj_vm::ir::Opcode> no_inputs_opcodes{jj_vm::ir::Opcode::BRANCH,
-                                                      jj_vm::ir::Opcode::RET,
-                                                      jj_vm::ir::Opcode::IF};
-        //
-        return no_inputs_opcodes.find(instr.opcode()) !=
-               no_inputs_opcodes.end();
+    bool is_empty_life_range(instr_type &instr) {
+        return jj_vm::ir::is_terminator(instr.opcode());
     }
 
     /**
@@ -243,7 +287,7 @@ private:
      * instructions
      */
     void calc_life_ranges() {
-        std::vector<jj_vm::ir::Instr *> no_inputs_instrs{};
+        std::vector<value_pointer> no_inputs_instrs{};
         //
         for (auto it = order.rbegin(); it != order.rend(); ++it) {
             //
@@ -252,19 +296,17 @@ private:
             auto &initial_live_set = init_live_set(pnode);
 
             for (auto &val : initial_live_set)
-                set_live_interval(val, block.interval());
+                set_live_interval(val, m_bb_intervals[pnode]);
 
             //! NOTE: Process each instructions
             process_instrs(pnode, initial_live_set);
 
             //! NOTE: Remove phi in cur block lock from liveset
-            //! TODO: Add into BasicBlock vector of PHI nodes
-            for (auto &instr : block) {
-                if (instr.opcode() == jj_vm::ir::Opcode::PHI)
-                    initial_live_set.erase(&instr);
-                if (is_empty_life_range(instr))
-                    no_inputs_instrs.push_back(&instr);
-            }
+            for (auto &instr : block.phis()) initial_live_set.erase(&instr);
+            //
+            //! NOTE: terminator could be the last instruction only
+            if (!block.empty() && is_empty_life_range(block.back()))
+                no_inputs_instrs.push_back(&block.back());
 
             //! NOTE: Process loops
             process_loop(pnode, initial_live_set);
@@ -285,6 +327,9 @@ public:
         //
         analyzer.m_intervals = std::move(builder.m_intervals);
         analyzer.m_live_sets = std::move(builder.m_live_sets);
+        analyzer.m_lin_nums = std::move(builder.m_lin_nums);
+        analyzer.m_live_nums = std::move(builder.m_live_nums);
+        analyzer.m_bb_intervals = std::move(builder.m_bb_intervals);
 
         return analyzer;
     }
@@ -5,8 +5,10 @@
 #include "loop_base.hh"
 //
 #include <list>
-#include <unordered_map>
 #include <vector>
+//
+#include "utils/dense_set.hh"
+#include "utils/side_table.hh"
 
 namespace jj_vm::analysis::loop {
 
@@ -31,7 +33,7 @@ public:
 private:
     friend LoopTreeBuilder<GraphTy>;
 
-    std::unordered_map<node_pointer, loop_base_pointer> m_data{};
+    utils::SideTable<node_pointer, loop_base_pointer> m_data{};
     std::list<loop_base> m_loops;
 
 public:
@@ -114,18 +116,22 @@ private:
     //
     dom_tree m_dom3{};
     std::vector<node_pointer> m_dfs_nodes{};
-    std::unordered_map<node_pointer, graph::dfs_impl::DFSColors> m_marked{};
+    //! NOTE: blocks reached by the loop search & its worklist
+    utils::DenseSet<node_pointer> m_marked{};
+    std::vector<node_pointer> m_worklist{};
     //
     //! NOTE: internals of loop tree
-    std::unordered_map<node_pointer, loop_base_pointer> m_data{};
+    utils::SideTable<node_pointer, loop_base_pointer> m_data{};
     std::list<loop_base> m_loops;
     //
 public:
     LoopTreeBuilder() = default;
 
     explicit LoopTreeBuilder(const GraphTy& graph)
-        : m_dom3{
-              jj_vm::graph::dom3_impl::DomTreeBuilder<GraphTy>::build(graph)} {
+        : m_dom3{jj_vm::graph::dom3_impl::DomTreeBuilder<GraphTy>::build(
+              graph)},
+          m_marked(graph.size()),
+          m_data(graph.size()) {
         //
         std::vector<node_pointer> free_loop_nodes{};
         //
@@ -155,14 +161,14 @@ public:
         const dom_tree& m_dom3;
         std::vector<node_pointer>& m_dfs_nodes;
         std::vector<node_pointer>& m_free_loop_nodes;
-        std::unordered_map<node_pointer, loop_base_pointer>& m_data{};
+        utils::SideTable<node_pointer, loop_base_pointer>& m_data{};
         std::list<loop_base>& m_loops;
 
     public:
         LoopAnalyzerVisitor(
             const dom_tree& dom3, std::vector<node_pointer>& dfs_nodes,
             std::vector<node_pointer>& free_loop_nodes,
-            std::unordered_map<node_pointer, loop_base_pointer>& data,
+            utils::SideTable<node_pointer, loop_base_pointer>& data,
             std::list<loop_base>& loops)
             : m_dom3(dom3),
               m_dfs_nodes(dfs_nodes),
@@ -191,8 +197,10 @@ public:
             }
 
             //! NOTE: anyway tie current loop with src node
-            m_data[src] = cur_loop;
-            cur_loop->add_back_edge(src);
+            //!       (copy the pointer, insertion may relocate side table)
+            auto* loop = cur_loop;
+            m_data[src] = loop;
+            loop->add_back_edge(src);
         }
 
         //
@@ -229,14 +237,14 @@ public:
                 auto&& cur_header = cur_loop->header();
 
                 //! NOTE: header block is marked firstly to stop search on it
-                m_marked[cur_header] = graph::dfs_impl::DFSColors::BLACK;
+                m_marked.insert(cur_header);
 
                 //! NOTE: dfs from src of back edges to find block in the loop
                 for (auto* be_src : cur_loop->back_edges())
-                    loop_search(be_src, cur_loop);
+                    loop_search(graph, be_src, cur_loop);
 
                 //! NOTE: unmark header
-                m_marked[cur_header] = graph::dfs_impl::DFSColors::WHITE;
+                m_marked.erase(cur_header);
 
             } else {
                 //! NOTE: append all src of back edges in the loop
@@ -250,33 +258,38 @@ public:
     }
 
     //
-    void loop_search(node_pointer cur_node, loop_base_pointer cur_loop) {
-        auto cur_found = m_marked.find(cur_node);
-        if (cur_found != m_marked.end() &&
-            cur_found->second == graph::dfs_impl::DFSColors::BLACK)
-            return;
+    void loop_search(const GraphTy& graph, node_pointer be_src,
+                     loop_base_pointer cur_loop) {
+        //! NOTE: preorder of the search over preds, the worklist is
+        //!       used instead of recursion, chains of preds may be long
+        m_worklist.assign(1, be_src);
+        while (!m_worklist.empty()) {
+            auto cur_node = m_worklist.back();
+            m_worklist.pop_back();
+            if (m_marked.contains(cur_node)) continue;
+
+            m_marked.insert(cur_node);
+            //
+            auto be_loop_it = m_data.find(cur_node);
 
-        m_marked[cur_node] = graph::dfs_impl::DFSColors::BLACK;
-        //
-        auto be_loop_it = m_data.find(cur_node);
+            //! NOTE: if block without loop => add to the current loop
+            if (be_loop_it == m_data.end()) {
+                cur_loop->add_node(cur_node);
+                m_data[cur_node] = cur_loop;
+            }
+            //! NOTE: if block in other loop (inner) link outer and inner loop
+            else {
+                auto inner_loop = be_loop_it->second;
 
-        //! NOTE: if block without loop => add to the current loop
-        if (be_loop_it == m_data.end()) {
-            cur_loop->add_node(cur_node);
-            m_data[cur_node] = cur_loop;
-        }
-        //! NOTE: if block in other loop (inner) link outer and inner loop
-        else {
-            auto inner_loop = be_loop_it->second;
+                if (inner_loop != cur_loop && inner_loop->outer() == nullptr)
+                    cur_loop->add_inner(inner_loop);
+            }
 
-            if (inner_loop != cur_loop && inner_loop->outer() == nullptr)
-                cur_loop->add_inner(inner_loop);
+            //! NOTE: search runs for all it preds, the first one is on top
+            auto begin = graph.preds_begin(cur_node),
+                 cur_it = graph.preds_end(cur_node);
+            while (cur_it != begin) m_worklist.push_back(*--cur_it);
         }
-
-        auto cur_it = cur_node->preds().begin(), end = cur_node->preds().end();
-
-        //! NOTE: search runs for all it preds
-        for (; cur_it != end; ++cur_it) loop_search(*cur_it, cur_loop);
     }
 
     //
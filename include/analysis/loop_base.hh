@@ -42,11 +42,11 @@ public:
     //
     auto is_root() const noexcept { return m_root; }
     //
-    auto loop_body() const noexcept { return m_loop_body; }
+    const auto& loop_body() const noexcept { return m_loop_body; }
     //
-    auto back_edges() const noexcept { return m_back_edges; }
+    const auto& back_edges() const noexcept { return m_back_edges; }
     //
-    auto inners() const noexcept { return m_inners; }
+    const auto& inners() const noexcept { return m_inners; }
     //
     auto outer() const noexcept { return m_outer; }
 
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "alias_analysis.hh"
+#include "graph/bb_graph.hh"
+#include "graph/dfs.hh"
+#include "graph/dom3.hh"
+#include "utils/side_table.hh"
+
+namespace jj_vm::analysis::memory {
+
+/**
+ * @brief Kinds of memory accesses:
+ *        - LIVE_ON_ENTRY: memory state at the function entry
+ *        - DEF: store or call, it produces the new memory state
+ *        - USE: load, it reads the memory state
+ *        - PHI: merge of states at the join block, inputs are indexed by
+ *               preds of the block
+ */
+enum class AccessKind : std::uint8_t { LIVE_ON_ENTRY, DEF, USE, PHI };
+
+class MemoryAccess final {
+    AccessKind m_kind = AccessKind::LIVE_ON_ENTRY;
+    ir::Instr* m_instr = nullptr;
+    ir::BasicBlock* m_bb = nullptr;
+    //
+    //! NOTE: state read by USE or overwritten by DEF
+    MemoryAccess* m_defining = nullptr;
+    std::vector<MemoryAccess*> m_incoming{};
+    std::vector<MemoryAccess*> m_users{};
+
+public:
+    MemoryAccess(AccessKind kind, ir::Instr* instr, ir::BasicBlock* bb)
+        : m_kind(kind), m_instr(instr), m_bb(bb) {}
+
+    /**
+     * @brief Getters
+     */
+    AccessKind kind() const noexcept { return m_kind; }
+    bool is_def() const noexcept { return m_kind == AccessKind::DEF; }
+    bool is_use() const noexcept { return m_kind == AccessKind::USE; }
+    bool is_phi() const noexcept { return m_kind == AccessKind::PHI; }
+    bool is_live_on_entry() const noexcept {
+        return m_kind == AccessKind::LIVE_ON_ENTRY;
+    }
+
+    ir::Instr* instr() const noexcept { return m_instr; }
+    ir::BasicBlock* block() const noexcept { return m_bb; }
+    MemoryAccess* defining() const noexcept { return m_defining; }
+    const auto& incoming() const noexcept { return m_incoming; }
+    const auto& users() const noexcept { return m_users; }
+
+private:
+    void set_defining(MemoryAccess* def) {
+        m_defining = def;
+        def->m_users.push_back(this);
+    }
+
+    void set_incoming(std::size_t idx, MemoryAccess* def) {
+        m_incoming[idx] = def;
+        def->m_users.push_back(this);
+    }
+
+    void remove_user(const MemoryAccess* user) {
+        auto it = std::find(m_users.begin(), m_users.end(), user);
+        if (it != m_users.end()) m_users.erase(it);
+    }
+
+    friend class MemorySSA;
+};
+
+/**
+ * @brief Memory SSA form of the function: every load, store & call has its
+ *        access, which refers to the reaching memory state. Whole memory is
+ *        the single variable, so phis are placed at the iterated dominance
+ *        frontier of blocks with DEFs and states are renamed over the
+ *        dominator tree (dom3_impl::DomTree). O(blocks + instructions + DF)
+ *
+ *        Precise reaching state for the location is found by the walker
+ *        (clobbering()), which skips DEFs not aliasing the location.
+ *
+ *        NOTE: unreachable blocks have no accesses, memory instructions
+ *              inserted after the build aren't tracked
+ */
+class MemorySSA final {
+public:
+    using GraphTy = graph::BBGraph;
+    using DomTreeTy = graph::dom3_impl::DomTree<GraphTy>;
+
+private:
+    ir::Function* m_func = nullptr;
+    DomTreeTy m_dom{};
+    std::list<MemoryAccess> m_accesses{};
+    MemoryAccess* m_live_on_entry = nullptr;
+    //
+    utils::SideTable<const ir::Value*, MemoryAccess*> m_instr_access{};
+    utils::SideTable<const ir::BasicBlock*, MemoryAccess*> m_phis{};
+    std::vector<MemoryAccess*> m_exit_states{};
+
+public:
+    explicit MemorySSA(ir::Function& func)
+        : m_func(&func),
+          m_instr_access(func.values_num()),
+          m_phis(func.blocks_num()) {
+        m_live_on_entry = &m_accesses.emplace_back(
+            AccessKind::LIVE_ON_ENTRY, nullptr, nullptr);
+        if (func.empty()) return;
+        //
+        auto graph = func.bb_graph();
+        m_dom = graph::dom3_impl::DomTreeBuilder<GraphTy>::build(graph);
+        auto rpo = graph::deep_first_search_reverse_postoder(graph);
+        //
+        std::vector<ir::BasicBlock*> def_blocks{};
+        for (auto* bb : rpo)
+            for (auto&& instr : *bb) {
+                auto kind = access_kind(instr);
+                if (!kind.has_value()) continue;
+                m_instr_access.insert(
+                    {&instr, &m_accesses.emplace_back(*kind, &instr, bb)});
+                if (*kind == AccessKind::DEF &&
+                    (def_blocks.empty() || def_blocks.back() != bb))
+                    def_blocks.push_back(bb);
+            }
+        //
+        place_phis(rpo, def_blocks);
+        rename(rpo);
+    }
+
+    MemorySSA(const MemorySSA&) = delete;
+    MemorySSA& operator=(const MemorySSA&) = delete;
+
+    /**
+     * @brief Getters
+     */
+    MemoryAccess* live_on_entry() const noexcept { return m_live_on_entry; }
+
+    /// Access of the load, store or call, nullptr for other instructions
+    MemoryAccess* access(const ir::Instr* instr) const {
+        auto found = m_instr_access.find(instr);
+        return found != m_instr_access.end() ? found->second : nullptr;
+    }
+
+    MemoryAccess* phi(const ir::BasicBlock* bb) const {
+        auto found = m_phis.find(bb);
+        return found != m_phis.end() ? found->second : nullptr;
+    }
+
+    /// States of the memory at returns, they are visible to the caller
+    const auto& exit_states() const noexcept { return m_exit_states; }
+
+    bool is_exit_state(const MemoryAccess* access) const {
+        return std::find(m_exit_states.begin(), m_exit_states.end(),
+                         access) != m_exit_states.end();
+    }
+
+    const DomTreeTy& dom_tree() const noexcept { return m_dom; }
+
+    /**
+     * @brief Does lhs execute before rhs on every path to rhs
+     */
+    bool dominates(const MemoryAccess* lhs, const MemoryAccess* rhs) const {
+        if (lhs == rhs || lhs->is_live_on_entry()) return true;
+        if (rhs->is_live_on_entry()) return false;
+        if (lhs->block() != rhs->block())
+            return m_dom.dominates(lhs->block(), rhs->block());
+        if (lhs->is_phi()) return true;
+        return !rhs->is_phi() &&
+               lhs->block()->comes_before(lhs->instr(), rhs->instr());
+    }
+
+    /**
+     * @brief Nearest access above which could change the location: DEFs
+     *        which don't alias it are skipped. Result is DEF, PHI or
+     *        LIVE_ON_ENTRY. O(skipped DEFs)
+     */
+    MemoryAccess* clobbering(const MemoryAccess* access,
+                             const MemoryLocation& loc,
+                             const AliasAnalysis& aa) const {
+        auto* cur = access->defining();
+        while (cur->is_def() && !aa.may_clobber(*cur->instr(), loc))
+            cur = cur->defining();
+        return cur;
+    }
+
+    /**
+     * @brief Drop the access of the instruction being erased, its users
+     *        are rewired to the state it refers to
+     */
+    void remove(MemoryAccess* access) {
+        assert(access->is_def() || access->is_use());
+        auto* def = access->defining();
+        def->remove_user(access);
+        for (auto* user : access->m_users) {
+            if (user->m_defining == access) user->set_defining(def);
+            for (std::size_t idx = 0; idx < user->m_incoming.size(); ++idx)
+                if (user->m_incoming[idx] == access)
+                    user->set_incoming(idx, def);
+        }
+        for (auto&& state : m_exit_states)
+            if (state == access) state = def;
+        //
+        access->m_users.clear();
+        m_instr_access.erase(access->instr());
+    }
+
+private:
+    static std::optional<AccessKind> access_kind(const ir::Instr& instr) {
+        switch (instr.opcode()) {
+            case ir::Opcode::LOAD:
+                return AccessKind::USE;
+            case ir::Opcode::STORE:
+            case ir::Opcode::CALL:
+                return AccessKind::DEF;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    ir::BasicBlock* idom(const ir::BasicBlock* bb) const {
+        return m_dom.idom(bb);
+    }
+
+    /// Phis at the iterated dominance frontier of DEF blocks, frontiers are
+    /// found walking from preds of join blocks up to their idom (Cooper)
+    void place_phis(const std::vector<ir::BasicBlock*>& rpo,
+                    const std::vector<ir::BasicBlock*>& def_blocks) {
+        utils::SideTable<const ir::BasicBlock*, bool> reachable(
+            m_func->blocks_num());
+        for (auto* bb : rpo) reachable.insert({bb, true});
+        //
+        utils::SideTable<const ir::BasicBlock*, std::vector<ir::BasicBlock*>>
+            frontiers(m_func->blocks_num());
+        for (auto* bb : rpo) {
+            if (bb->preds_num() < 2) continue;
+            auto* bb_idom = idom(bb);
+            for (auto* pred : bb->preds()) {
+                if (reachable.find(pred) == reachable.end()) continue;
+                for (auto* runner = pred;
+                     runner != nullptr && runner != bb_idom;
+                     runner = idom(runner)) {
+                    auto& frontier = frontiers[runner];
+                    if (frontier.empty() || frontier.back() != bb)
+                        frontier.push_back(bb);
+                }
+            }
+        }
+        //
+        std::vector<ir::BasicBlock*> worklist{def_blocks};
+        while (!worklist.empty()) {
+            auto* bb = worklist.back();
+            worklist.pop_back();
+            auto found = frontiers.find(bb);
+            if (found == frontiers.end()) continue;
+            for (auto* join : found->second) {
+                if (phi(join) != nullptr) continue;
+                auto* phi_access =
+                    &m_accesses.emplace_back(AccessKind::PHI, nullptr, join);
+                phi_access->m_incoming.assign(join->preds_num(), nullptr);
+                m_phis.insert({join, phi_access});
+                worklist.push_back(join);
+            }
+        }
+    }
+
+    /// Reaching state is passed down the dominator tree
+    void rename(const std::vector<ir::BasicBlock*>& rpo) {
+        std::vector<std::pair<ir::BasicBlock*, MemoryAccess*>> stack{
+            {rpo.front(), m_live_on_entry}};
+        while (!stack.empty()) {
+            auto [bb, cur] = stack.back();
+            stack.pop_back();
+            //
+            if (auto* bb_phi = phi(bb)) cur = bb_phi;
+            for (auto&& instr : *bb) {
+                auto* instr_access = access(&instr);
+                if (instr_access == nullptr) continue;
+                instr_access->set_defining(cur);
+                if (instr_access->is_def()) cur = instr_access;
+            }
+            if (bb->back().opcode() == ir::Opcode::RET)
+                m_exit_states.push_back(cur);
+            //
+            for (auto* succ : bb->succs())
+                if (auto* succ_phi = phi(succ))
+                    for (std::size_t idx = 0; idx < succ->preds_num(); ++idx)
+                        if (succ->preds()[idx] == bb &&
+                            succ_phi->m_incoming[idx] == nullptr)
+                            succ_phi->set_incoming(idx, cur);
+            //
+            for (auto* child : m_dom.children(bb))
+                stack.emplace_back(child, cur);
+        }
+        //
+        //! NOTE: inputs from unreachable preds
+        for (auto&& [bb, bb_phi] : m_phis)
+            for (std::size_t idx = 0; idx < bb_phi->m_incoming.size(); ++idx)
+                if (bb_phi->m_incoming[idx] == nullptr)
+                    bb_phi->set_incoming(idx, m_live_on_entry);
+    }
+};
+
+}  // namespace jj_vm::analysis::memory
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "liveness_analyzer.hh"
+#include "utils/side_table.hh"
 //
 #include <algorithm>
 #include <cstddef>
@@ -39,7 +40,7 @@ private:
     jj_vm::analysis::liveness::LivenessAnalyzer<GraphTy> m_liveness;
     //
     std::vector<RegIdTy> m_reg_pool;
-    std::unordered_map<jj_vm::ir::Value*, Location> m_regmap;
+    utils::SideTable<jj_vm::ir::Value*, Location> m_regmap;
     std::unordered_map<LiveIntevalTy*, jj_vm::ir::Value*> m_range2val;
     //
     std::vector<std::pair<jj_vm::ir::Value*, LiveIntevalTy*>> m_data;
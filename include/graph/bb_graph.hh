@@ -27,6 +27,11 @@ public:
     //
     //! NOTE: basically it should be iterator over succs and preds
     using node_iterator = std::vector<jj_vm::ir::BasicBlock*>::const_iterator;
+    //
+    //! NOTE: types of analyses results (see liveness::LivenessAnalyzer)
+    using value_pointer = jj_vm::ir::Value*;
+    using instr_pointer = const jj_vm::ir::Instr*;
+    using phi_type = jj_vm::ir::PhiInstr;
 
     // std::vector<jj_vm::ir::BasicBlock*>::iterator;
     // using const_node_iterator = // std::vector<jj_vm::ir::BasicBlock*>::const_iterator;
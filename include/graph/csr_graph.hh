@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+
+namespace jj_vm::graph {
+
+/**
+ * @brief Compressed sparse row snapshot of the graph of basic blocks.
+ *        Succs & preds of all blocks are copied into two contiguous arrays,
+ *        row of the block is found by its dense id, so traversals don't
+ *        touch vectors scattered over blocks. It provides the same
+ *        interface as BBGraph (DFS, DomTreeBuilder, LoopTreeBuilder...),
+ *        order of succs & preds is kept.
+ *
+ *        Snapshot is O(blocks + edges) to build & it isn't updated, so it
+ *        should be rebuilt after the CFG is changed
+ */
+class CSRGraph final {
+public:
+    using value_type = jj_vm::ir::BasicBlock;
+    using node_pointer = value_type*;
+    using node_reference = value_type&;
+    using const_node_reference = const value_type&;
+    using size_type = std::size_t;
+    //
+    //! NOTE: iterator over the row of succs or preds, rows are addressed by
+    //!       unsigned offsets from the start of the array
+    using node_iterator = const node_pointer*;
+    //
+    //! NOTE: types of analyses results (see liveness::LivenessAnalyzer)
+    using value_pointer = jj_vm::ir::Value*;
+    using instr_pointer = const jj_vm::ir::Instr*;
+    using phi_type = jj_vm::ir::PhiInstr;
+
+private:
+    //! NOTE: row of the block with id i is [offsets[i], offsets[i + 1]),
+    //!       ids of erased blocks have empty rows
+    struct Rows final {
+        std::vector<size_type> m_offsets{};
+        std::vector<node_pointer> m_nodes{};
+    };
+
+    node_pointer m_head{};
+    size_type m_size{};
+    Rows m_succs{};
+    Rows m_preds{};
+
+public:
+    explicit CSRGraph(jj_vm::ir::Function& func) {
+        auto graph = func.bb_graph();
+        m_head = graph.head();
+        m_size = graph.size();
+        //
+        size_type ids_num = 0;
+        for (auto&& bb : func)
+            ids_num = std::max<size_type>(ids_num, bb.id() + 1);
+        m_succs.m_offsets.assign(ids_num + 1, 0);
+        m_preds.m_offsets.assign(ids_num + 1, 0);
+        for (auto&& bb : func) {
+            m_succs.m_offsets[bb.id() + 1] = bb.succs().size();
+            m_preds.m_offsets[bb.id() + 1] = bb.preds().size();
+        }
+        fill(func, m_succs, [](const value_type& bb) -> auto& {
+            return bb.succs();
+        });
+        fill(func, m_preds, [](const value_type& bb) -> auto& {
+            return bb.preds();
+        });
+    }
+
+    node_pointer head() const noexcept { return m_head; }
+    size_type size() const noexcept { return m_size; }
+    size_type edges_num() const noexcept { return m_succs.m_nodes.size(); }
+
+    node_iterator succs_begin(node_pointer pnode) const noexcept {
+        return row_begin(m_succs, pnode);
+    }
+
+    node_iterator preds_begin(node_pointer pnode) const noexcept {
+        return row_begin(m_preds, pnode);
+    }
+
+    node_iterator succs_end(node_pointer pnode) const noexcept {
+        return row_end(m_succs, pnode);
+    }
+
+    node_iterator preds_end(node_pointer pnode) const noexcept {
+        return row_end(m_preds, pnode);
+    }
+
+private:
+    /// Lengths of rows are turned into offsets, then rows are copied
+    template <typename NeighboursFn>
+    static void fill(jj_vm::ir::Function& func, Rows& rows,
+                     NeighboursFn neighbours) {
+        for (size_type idx = 1; idx < rows.m_offsets.size(); ++idx)
+            rows.m_offsets[idx] += rows.m_offsets[idx - 1];
+        rows.m_nodes.resize(rows.m_offsets.back());
+        for (auto&& bb : func) {
+            const auto& nodes = neighbours(bb);
+            std::copy(nodes.begin(), nodes.end(),
+                      rows.m_nodes.data() + rows.m_offsets[bb.id()]);
+        }
+    }
+
+    static node_iterator row_begin(const Rows& rows,
+                                   node_pointer pnode) noexcept {
+        return rows.m_nodes.data() + rows.m_offsets[pnode->id()];
+    }
+
+    static node_iterator row_end(const Rows& rows,
+                                 node_pointer pnode) noexcept {
+        return rows.m_nodes.data() + rows.m_offsets[pnode->id() + 1];
+    }
+};
+
+}  // namespace jj_vm::graph
@@ -2,12 +2,12 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <stack>
 #include <type_traits>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "utils/dense_set.hh"
+
 namespace jj_vm::graph::dfs_impl {
 //
 
@@ -20,14 +20,23 @@ public:
     using node_iterator = typename GraphTy::node_iterator;
 
     DFSImpl(const GraphTy& graph, DFSVisitorTy vis)
-        : m_graph(graph), m_vis{vis} {}
+        : m_graph(graph),
+          m_vis{vis},
+          m_discovered(graph.size()),
+          m_finished(graph.size()) {
+        m_stack.reserve(graph.size());
+    }
     //
 private:
-    GraphTy m_graph;
+    //! NOTE: pass lives inside the search call, so graph outlives it
+    const GraphTy& m_graph;
     DFSVisitorTy m_vis;
     //
-    std::unordered_map<node_pointer, DFSColors> m_visited;
-    std::stack<std::pair<node_iterator, node_pointer>> m_stack;
+    //! NOTE: colors are kept by two bits of the node: grey nodes are
+    //!       discovered only, black ones are finished too
+    utils::DenseSet<node_pointer> m_discovered;
+    utils::DenseSet<node_pointer> m_finished;
+    std::vector<std::pair<node_iterator, node_pointer>> m_stack;
     //
 
     /**
@@ -37,13 +46,25 @@ private:
      * @param[in] color
      */
     void put_color(node_pointer pnode, DFSColors color) {
-        m_visited[pnode] = color;
+        if (color == DFSColors::WHITE) {
+            m_discovered.erase(pnode);
+            m_finished.erase(pnode);
+            return;
+        }
+        m_discovered.insert(pnode);
+        if (color == DFSColors::BLACK) m_finished.insert(pnode);
+    }
+
+    DFSColors get_color(node_pointer pnode) const noexcept {
+        if (!m_discovered.contains(pnode)) return DFSColors::WHITE;
+        return m_finished.contains(pnode) ? DFSColors::BLACK
+                                          : DFSColors::GREY;
     }
 
     void visit_node(node_pointer pnode, DFSColors color) {
         put_color(pnode, color);
         m_vis.discover_node(pnode);
-        m_stack.push(std::make_pair(m_graph.succs_begin(pnode), pnode));
+        m_stack.emplace_back(m_graph.succs_begin(pnode), pnode);
     }
 
 public:
@@ -55,27 +76,26 @@ public:
         visit_node(head, DFSColors::GREY);
         //
         while (!m_stack.empty()) {
-            auto top_pair = m_stack.top();
-            m_stack.pop();
-            //
-            auto parent = top_pair.second;
-            auto succ_end = m_graph.succs_end(parent), cur_it = top_pair.first;
+            auto [cur_it, parent] = m_stack.back();
+            auto succ_end = m_graph.succs_end(parent);
 
             for (; cur_it != succ_end; ++cur_it) {
-                const auto found = m_visited.find(*cur_it);
-                if (found == m_visited.end()) break;
-                if (found->second == DFSColors::GREY)
-                    m_vis.back_edge(parent, found->first);
+                const auto color = get_color(*cur_it);
+                if (color == DFSColors::WHITE) break;
+                if (color == DFSColors::GREY)
+                    m_vis.back_edge(parent, *cur_it);
             }
             //
             if (cur_it == succ_end) {
+                m_stack.pop_back();
                 put_color(parent, DFSColors::BLACK);
                 m_vis.finish_node(parent);
                 continue;
             }
             //
+            //! NOTE: the search continues after the node when it's finished
             const auto pnode = *cur_it;
-            m_stack.push(std::make_pair(std::next(cur_it), parent));
+            m_stack.back().first = std::next(cur_it);
             //
             visit_node(pnode, DFSColors::GREY);
         }
@@ -1,27 +1,54 @@
 #pragma once
 
-#include <stack>
+#include <cstddef>
+#include <utility>
+#include <vector>
 
 #include "IR/basic_block.hh"
 #include "dfs.hh"
 #include "dom3_base.hh"
 #include "dsu.hh"
+#include "utils/side_table.hh"
 
 namespace jj_vm::graph::dom3_impl {
 //
 
 using BBDom3Node = dom3_impl::Dom3NodeBase<jj_vm::ir::BasicBlock>;
 
+/**
+ * @brief Dominator tree. Nodes are numbered in the preorder of the tree when
+ *        it's built, so the subtree of the node is the range of numbers
+ *        [enter, exit] & dominance query is two comparisons. O(1) queries
+ *        of idom, depth & children.
+ *
+ *        NOTE: unreachable nodes aren't in the tree, they dominate &
+ *              are dominated by themselves only
+ *
+ * @tparam GraphTy
+ */
 template <class GraphTy>
 class DomTree final {
 public:
     using value_type = typename GraphTy::value_type;
     using node_pointer = typename GraphTy::node_pointer;
+    using const_node_pointer = const value_type *;
     using node_iterator = typename GraphTy::node_iterator;
     using id_type = typename GraphTy::value_type::id_type;
+    using size_type = std::size_t;
+    using node_type = Dom3NodeBase<value_type>;
     //
 private:
-    std::unordered_map<id_type, Dom3NodeBase<value_type>> m_data{};
+    //! NOTE: idom of the root is nullptr, depth of the root is 0
+    struct Numbering final {
+        node_pointer m_idom{nullptr};
+        size_type m_depth{0};
+        size_type m_enter{0};
+        size_type m_exit{0};
+    };
+
+    //! NOTE: nodes which dominate others, keyed by the dominator
+    utils::SideTable<const_node_pointer, node_type> m_data{};
+    utils::SideTable<const_node_pointer, Numbering> m_numbers{};
 
     template <typename T>
     friend class DomTreeBuilder;
@@ -29,55 +56,56 @@ private:
 public:
     DomTree() = default;
 
-    bool dominates(node_pointer dominator,
-                   node_pointer dominatee) const {
+    bool dominates(const_node_pointer dominator,
+                   const_node_pointer dominatee) const {
         if (dominator == dominatee) return true;
-
-        std::stack<id_type> stack{};
-        stack.push(dominator->bb_id());
         //
-        while (!stack.empty()) {
-            auto cur_id = stack.top();
-            stack.pop();
+        auto lhs = m_numbers.find(dominator);
+        auto rhs = m_numbers.find(dominatee);
+        if (lhs == m_numbers.end() || rhs == m_numbers.end()) return false;
+        //
+        return lhs->second.m_enter <= rhs->second.m_enter &&
+               rhs->second.m_enter <= lhs->second.m_exit;
+    }
+
+    /**
+     * @brief Immediate dominator, nullptr for the root & unreachable nodes
+     */
+    node_pointer idom(const_node_pointer node) const {
+        auto found = m_numbers.find(node);
+        return found != m_numbers.end() ? found->second.m_idom : nullptr;
+    }
 
-            auto res = m_data.find(cur_id);
+    /**
+     * @brief Number of dominators of the node (except itself)
+     */
+    size_type depth(const_node_pointer node) const {
+        auto found = m_numbers.find(node);
+        return found != m_numbers.end() ? found->second.m_depth : 0;
+    }
 
-            if (res == m_data.end()) continue;
+    /**
+     * @brief Immediately dominated nodes in the order of the DFS over graph
+     */
+    const std::vector<node_pointer> &children(
+        const_node_pointer node) const {
+        static const std::vector<node_pointer> kLeaf{};
+        auto found = m_data.find(node);
+        return found != m_data.end() ? found->second.idommed() : kLeaf;
+    }
 
-            for (auto &&imm_dominated : res->second.idommed()) {
-                if (dominatee == imm_dominated) return true;
-                //
-                stack.push(imm_dominated->bb_id());
-            }
-        }
-        return false;
+    bool contains(const_node_pointer node) const {
+        return m_numbers.contains(node);
     }
 
     auto size() const noexcept { return m_data.size(); }
 
-    auto insert(const std::pair<id_type, Dom3NodeBase<value_type>> &val) {
+    auto insert(const std::pair<const_node_pointer, node_type> &val) {
         return m_data.insert(val);
     }
 
     auto begin() const noexcept { return m_data.begin(); }
     auto end() const noexcept { return m_data.end(); }
-
-private:
-    node_iterator succs_begin(node_pointer pnode) const noexcept {
-        return pnode->succs().begin();
-    }
-
-    node_iterator preds_begin(node_pointer pnode) const noexcept {
-        return pnode->preds().begin();
-    }
-
-    node_iterator succs_end(node_pointer pnode) const noexcept {
-        return pnode->succs().end();
-    }
-
-    node_iterator preds_end(node_pointer pnode) const noexcept {
-        return pnode->preds().end();
-    }
 };
 
 /**
@@ -96,6 +124,8 @@ public:
     //using node_pointer = typename GraphTy::node_pointer;
     using node_iterator = typename GraphTy::node_iterator;
     //
+    using size_type = std::size_t;
+    //
     using DSUTy = typename jj_vm::graph::dsu_impl::DSU<GraphTy>;
 
 private:
@@ -110,12 +140,12 @@ private:
     //! time (id number after DFS) of node in
     std::vector<node_pointer> m_dfs_nodes{};
 
-    //! NOTE: mapping of node id to DFS time (cost of arrival that based on
+    //! NOTE: mapping of node to DFS time (cost of arrival that based on
     //! order)
-    std::unordered_map<id_type, id_type> m_dfs_labels{};
+    utils::SideTable<node_pointer, id_type> m_dfs_labels{};
 
     //! NOTE: parent of node i in dfs tree
-    std::unordered_map<id_type, node_pointer> m_dfs_parents{};
+    utils::SideTable<node_pointer, node_pointer> m_dfs_parents{};
 
     //! NOTE: label of immediate-dominator of the i’th node
     std::vector<id_type> m_idoms{};
@@ -123,22 +153,30 @@ private:
     //! NOTE: label of semi-dominator of the i’th node
     std::vector<id_type> m_sdoms{};
 
-    //! NOTE: For a vertex i, it stores a list of vertices for which i is the
-    //! semi-dominator
+    //! NOTE: For a vertex i (DFS label), it stores a list of vertices for
+    //! which i is the semi-dominator
     std::vector<std::vector<node_pointer>> m_sdommed_bucket{};
 
     DomTree<GraphTy> m_tree;
 
+    //! NOTE: builder lives inside the build call, so graph outlives it,
+    //!       preds are taken from it (e.g. rows of CSRGraph)
+    const GraphTy &m_graph;
+
     explicit DomTreeBuilder(const GraphTy &graph)
-        : m_idoms(graph.size()),
+        : m_dfs_labels(graph.size()),
+          m_dfs_parents(graph.size()),
+          m_idoms(graph.size()),
           m_sdoms(graph.size()),
-          m_sdommed_bucket(graph.size()) {
+          m_sdommed_bucket(graph.size()),
+          m_graph(graph) {
         //
         m_dfs_nodes.reserve(graph.size());
         //
         make_dfs(graph);
         build_sdoms();
         build_idoms();
+        number_tree();
     }
 
     void reset() {
@@ -150,24 +188,38 @@ private:
         m_sdommed_bucket.clear();
     }
 
+    //! NOTE: parent in the DFS tree is the node on the top of the search
+    //!       path when the node is discovered
+    class DFSTreeVisitor final : public dfs_impl::IVisitor<GraphTy> {
+        DomTreeBuilder &m_builder;
+        std::vector<node_pointer> &m_path;
+
+    public:
+        DFSTreeVisitor(DomTreeBuilder &builder,
+                       std::vector<node_pointer> &path)
+            : m_builder(builder), m_path(path) {}
+
+        void discover_node(node_pointer node) override {
+            const auto dfs_cost = m_builder.m_dfs_nodes.size();
+            //
+            m_builder.m_dfs_nodes.push_back(node);
+            //
+            m_builder.m_dfs_labels[node] = dfs_cost;
+            m_builder.m_sdoms[dfs_cost] = dfs_cost;
+            m_builder.m_idoms[dfs_cost] = dfs_cost;
+
+            m_builder.m_dfs_parents[node] =
+                m_path.empty() ? node : m_path.back();
+            m_path.push_back(node);
+        }
+
+        void finish_node(node_pointer) override { m_path.pop_back(); }
+    };
+
     void make_dfs(const GraphTy &graph) {
-        //
-        auto dom3_visitor =
-            [this, prev_node = graph.head()](node_pointer node) mutable {
-                const auto dfs_cost = m_dfs_nodes.size();
-                const auto id = node->bb_id();
-                //
-                m_dfs_nodes.push_back(node);
-                //
-                m_dfs_labels[id] = dfs_cost;
-                m_sdoms[dfs_cost] = dfs_cost;
-                m_idoms[dfs_cost] = dfs_cost;
-
-                m_dfs_parents[id] = prev_node;
-                prev_node = node;
-            };
-        //
-        jj_vm::graph::dfs_impl::deep_first_search_preoder(graph, dom3_visitor);
+        std::vector<node_pointer> path{};
+        jj_vm::graph::dfs_impl::deep_first_search(
+            graph, DFSTreeVisitor{*this, path});
     }
 
     /**
@@ -177,13 +229,15 @@ private:
      * @return auto
      */
     auto min_sdom(node_pointer node, DSUTy &dsu) {
-        const auto node_dfs_cost = m_dfs_labels[node->bb_id()];
+        const auto node_dfs_cost = m_dfs_labels[node];
         auto &sdom = m_sdoms[node_dfs_cost];
         //
-        auto cur_it = m_tree.preds_begin(node), end = m_tree.preds_end(node);
+        auto cur_it = m_graph.preds_begin(node), end = m_graph.preds_end(node);
 
         for (; cur_it != end; ++cur_it) {
-            auto found_neighb = m_dfs_labels[dsu.find(*cur_it)->bb_id()];
+            //! NOTE: unreachable preds aren't labeled
+            if (!m_dfs_labels.contains(*cur_it)) continue;
+            auto found_neighb = m_dfs_labels[dsu.find(*cur_it)];
             sdom = std::min(sdom, m_sdoms[found_neighb]);
         }
 
@@ -206,14 +260,15 @@ private:
             bool isnt_first = (node != m_dfs_nodes.front());
             //
             if (isnt_first)
-                m_sdommed_bucket[m_dfs_nodes[sdom]->bb_id()].push_back(node);
+                m_sdommed_bucket[sdom].push_back(node);
 
             //! NOTE: Initialization
-            for (const auto &dominatee : m_sdommed_bucket[node->bb_id()]) {
+            for (const auto &dominatee :
+                 m_sdommed_bucket[m_dfs_labels[node]]) {
                 const auto min_semi_dom = dsu.find(dominatee);
 
-                auto sdomin_id = m_dfs_labels[dominatee->bb_id()];
-                auto min_sdomin_id = m_dfs_labels[min_semi_dom->bb_id()];
+                auto sdomin_id = m_dfs_labels[dominatee];
+                auto min_sdomin_id = m_dfs_labels[min_semi_dom];
                 auto dominatee_sdom_id = m_sdoms[sdomin_id];
 
                 if (dominatee_sdom_id == m_sdoms[min_sdomin_id])
@@ -222,7 +277,7 @@ private:
                     m_idoms[sdomin_id] = min_sdomin_id;
             }
 
-            if (isnt_first) dsu.merge(node, m_dfs_parents[node->bb_id()]);
+            if (isnt_first) dsu.merge(node, m_dfs_parents[node]);
         }
     }
 
@@ -248,18 +303,49 @@ private:
             auto idom_node = m_dfs_nodes[idom_dist_cost];
 
             const auto res = m_tree.insert(
-                std::make_pair(idom_node->bb_id(), Dom3NodeBase{idom_node}));
+                std::make_pair(idom_node, Dom3NodeBase{idom_node}));
 
             res.first->second.push_idom(node);
         }
     }
 
+    /**
+     * @brief Preorder numbering of the tree, numbers of the subtree of the
+     *        node are [enter, exit]. O(N)
+     */
+    void number_tree() {
+        if (m_dfs_nodes.empty()) return;
+        //
+        auto &numbers = m_tree.m_numbers;
+        numbers.reserve(m_dfs_nodes.size());
+        size_type time = 0;
+        numbers[m_dfs_nodes.front()].m_enter = time++;
+        //
+        std::vector<std::pair<node_pointer, size_type>> stack{
+            {m_dfs_nodes.front(), 0}};
+        while (!stack.empty()) {
+            auto [node, child_idx] = stack.back();
+            const auto &children = m_tree.children(node);
+            if (child_idx == children.size()) {
+                numbers[node].m_exit = time - 1;
+                stack.pop_back();
+                continue;
+            }
+            //
+            ++stack.back().second;
+            auto child = children[child_idx];
+            auto depth = numbers[node].m_depth + 1;
+            numbers[child] = {node, depth, time++, 0};
+            stack.emplace_back(child, 0);
+        }
+    }
+
     auto tree() const noexcept { return m_tree; }
 
 public:
     static auto build(const GraphTy &graph) {
         DomTreeBuilder<GraphTy> builder{graph};
-        return builder.tree();
+        return std::move(builder.m_tree);
     }
 };
 
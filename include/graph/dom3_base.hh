@@ -34,7 +34,7 @@ public:
     void set_idom(node_pointer pnode) const noexcept { m_idom = pnode; }
 
     auto idom() const noexcept { return m_idom; }
-    auto idommed() const noexcept { return m_idommed; }
+    const auto& idommed() const noexcept { return m_idommed; }
 
     auto push_idom(node_pointer pnode) { m_idommed.push_back(pnode); }
 };
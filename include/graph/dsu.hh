@@ -1,8 +1,9 @@
 #pragma once
 
-#include <unordered_map>
 #include <vector>
 
+#include "utils/side_table.hh"
+
 namespace jj_vm::graph::dsu_impl {
 
 template <class GraphTy>
@@ -16,7 +17,7 @@ public:
 
 private:
     const std::vector<id_type> &m_sdoms;
-    const std::unordered_map<id_type, id_type> &m_dfs_labels;
+    const utils::SideTable<node_pointer, id_type> &m_dfs_labels;
 
     //! NOTE: parent of i’th node in the forest maintained during step 2 of the
     //! algorithm
@@ -26,9 +27,12 @@ private:
     //! lying on path from i to the root of the (dsu) tree in which node i lies
     std::vector<node_pointer> m_labels;
 
+    //! NOTE: worklist of the path compression
+    std::vector<node_pointer> m_path{};
+
 public:
     DSU(const std::vector<id_type> &sdoms,
-        const std::unordered_map<id_type, id_type> &dfs_labels,
+        const utils::SideTable<node_pointer, id_type> &dfs_labels,
         const std::vector<node_pointer> &dfs_nodes)
         : m_sdoms(sdoms),
           m_dfs_labels(dfs_labels),
@@ -55,31 +59,50 @@ public:
         access_label(node) = label;
     }
 
+    /**
+     * @brief Node with the minimal sdom on the path from the needle to the
+     *        root of its tree (the root itself is excluded). Path is
+     *        compressed, so it's O(log N) amortized
+     */
     node_pointer find(node_pointer needle) {
-        auto &parent_node = access_parent(needle);
-        //
-        if (needle == parent_node) return needle;
-
-        auto res = find(parent_node);
-        auto parent_label = label(parent_node);
-        auto &needle_label = access_label(needle);
-
-        if (sdom_id(parent_label) < sdom_id(needle_label))
-            needle_label = parent_label;
-
-        parent_node = res;
-        //
-        return needle_label;
+        if (needle == parent(needle)) return needle;
+        compress(needle);
+        return label(needle);
     }
 
+    //! NOTE: the node is linked to its parent in the DFS tree: labels are
+    //!       minimums over paths of this tree, so union by rank would break
+    //!       them (the simple version of Lengauer-Tarjan)
     void merge(node_pointer node, node_pointer parent) {
         set_parent(node, parent);
     }
 
 private:
+    /**
+     * @brief Links nodes on the path to the child of the root, labels are
+     *        updated by labels of their parents from the top of the path.
+     *        Path is kept in the worklist, it may be as long as the graph
+     */
+    void compress(node_pointer node) {
+        m_path.clear();
+        for (; parent(parent(node)) != parent(node); node = parent(node))
+            m_path.push_back(node);
+        //
+        const auto top = node;
+        for (auto cur_it = m_path.rbegin(); cur_it != m_path.rend(); ++cur_it) {
+            auto &parent_node = access_parent(*cur_it);
+            auto parent_label = label(parent_node);
+            auto &node_label = access_label(*cur_it);
+            if (sdom_id(parent_label) < sdom_id(node_label))
+                node_label = parent_label;
+            //
+            parent_node = top;
+        }
+    }
+
     //
     auto node_cost(node_pointer node) const {
-        return m_dfs_labels.at(node->bb_id());
+        return m_dfs_labels.at(node);
     }
 
     auto sdom_id(node_pointer node) const {
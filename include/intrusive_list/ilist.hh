@@ -5,6 +5,7 @@
 #include "ilist_base.hh"
 #include "ilist_iterator.hh"
 #include "ilist_node.hh"
+#include "memory/arena.hh"
 
 namespace jj_vm {
 namespace ilist_detail {
@@ -44,6 +45,17 @@ struct ilist_noalloca_traits {
     static void dealloc(NodeTy *node) {}
 };
 
+/**
+ * @brief Traits for nodes which are allocated in memory::Arena.
+ *        Node is destroyed, but its memory is released with the whole arena.
+ *
+ * @tparam NodeTy
+ */
+template <typename NodeTy>
+struct ilist_arena_traits {
+    static void dealloc(NodeTy *node) { node->~NodeTy(); }
+};
+
 /**
  * @brief Simple intrusive list implementation
  *        This intrusive takes ownership of anything insertet in it according
@@ -171,6 +183,10 @@ template <class T>
 using ilist_view =
     ilist_detail::ilist_impl<T, ilist_detail::ilist_noalloca_traits<T>>;
 
+template <class T>
+using ilist_arena =
+    ilist_detail::ilist_impl<T, ilist_detail::ilist_arena_traits<T>>;
+
 template <class T, class... Args, class NodeTy>
 auto &emplace_back(ilist<NodeTy> &ilist, Args &&...args) {
     auto *to_emplace = new T{std::forward<Args>(args)...};
@@ -184,4 +200,20 @@ auto &emplace_front(ilist<NodeTy> &ilist, Args &&...args) {
     ilist.push_front(to_emplace);
     return *to_emplace;
 }
+
+template <class T, class... Args, class NodeTy>
+auto &emplace_back(ilist_arena<NodeTy> &ilist, memory::Arena &arena,
+                   Args &&...args) {
+    auto *to_emplace = arena.create<T>(std::forward<Args>(args)...);
+    ilist.push_back(to_emplace);
+    return *to_emplace;
+}
+
+template <class T, class... Args, class NodeTy>
+auto &emplace_front(ilist_arena<NodeTy> &ilist, memory::Arena &arena,
+                    Args &&...args) {
+    auto *to_emplace = arena.create<T>(std::forward<Args>(args)...);
+    ilist.push_front(to_emplace);
+    return *to_emplace;
+}
 }  // namespace jj_vm
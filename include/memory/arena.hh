@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace jj_vm::memory {
+
+/**
+ * @brief Bump pointer arena
+ *        Memory is carved out of slabs of growing size and it is released
+ *        only when every arena that refers to the slab is destroyed.
+ *        NOTE: arena never calls destructors, owner of the object should do it
+ *              (e.g. via ilist_arena_traits)
+ */
+class Arena final {
+public:
+    using size_type = std::size_t;
+    using SlabTy = std::shared_ptr<std::byte[]>;
+
+    static constexpr size_type kInitSlabSize = 4096;
+    static constexpr size_type kMaxSlabSize = size_type{1} << 20;
+
+private:
+    std::vector<SlabTy> m_slabs{};
+    //
+    std::byte* m_cur = nullptr;
+    std::byte* m_end = nullptr;
+    //
+    size_type m_next_slab_size = kInitSlabSize;
+    size_type m_allocated = 0;
+    size_type m_reserved = 0;
+
+public:
+    Arena() = default;
+
+    //! NOTE: no copy semantic
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    Arena(Arena&& other) noexcept
+        : m_slabs(std::move(other.m_slabs)),
+          m_cur(std::exchange(other.m_cur, nullptr)),
+          m_end(std::exchange(other.m_end, nullptr)),
+          m_next_slab_size(
+              std::exchange(other.m_next_slab_size, kInitSlabSize)),
+          m_allocated(std::exchange(other.m_allocated, 0)),
+          m_reserved(std::exchange(other.m_reserved, 0)) {}
+
+    Arena& operator=(Arena&& other) noexcept {
+        if (this != &other) {
+            Arena tmp{std::move(other)};
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    ~Arena() = default;
+
+    void swap(Arena& other) noexcept {
+        std::swap(m_slabs, other.m_slabs);
+        std::swap(m_cur, other.m_cur);
+        std::swap(m_end, other.m_end);
+        std::swap(m_next_slab_size, other.m_next_slab_size);
+        std::swap(m_allocated, other.m_allocated);
+        std::swap(m_reserved, other.m_reserved);
+    }
+
+    /**
+     * @brief Allocate raw aligned memory. O(1) amortized
+     */
+    void* allocate(size_type size, size_type align = alignof(std::max_align_t)) {
+        assert(align != 0 && (align & (align - 1)) == 0 &&
+               "Error: alignment should be power of two");
+        //
+        auto* ptr = align_up(m_cur, align);
+        if (m_cur == nullptr || ptr + size > m_end) {
+            new_slab(size + align);
+            ptr = align_up(m_cur, align);
+        }
+        //
+        m_cur = ptr + size;
+        m_allocated += size;
+        return ptr;
+    }
+
+    /**
+     * @brief Allocate and construct object of type T inside the arena
+     */
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        auto* mem = allocate(sizeof(T), alignof(T));
+        return new (mem) T{std::forward<Args>(args)...};
+    }
+
+    /**
+     * @brief Make sure that next `size` bytes could be allocated without a
+     *        new slab (useful when the number of nodes is known in advance)
+     */
+    void reserve(size_type size) {
+        if (static_cast<size_type>(m_end - m_cur) < size) new_slab(size);
+    }
+
+    /**
+     * @brief Share ownership of all slabs of other arena.
+     *        Nodes allocated in the other arena stay alive until both arenas
+     *        are destroyed, so they could be moved between owners safely.
+     *        O(slabs of both arenas)
+     */
+    void share(const Arena& other) {
+        std::unordered_set<const std::byte*> owned{};
+        owned.reserve(m_slabs.size() + other.m_slabs.size());
+        for (auto&& slab : m_slabs) owned.insert(slab.get());
+        for (auto&& slab : other.m_slabs)
+            if (owned.insert(slab.get()).second) m_slabs.push_back(slab);
+    }
+
+    /**
+     * @brief Getters
+     */
+    size_type allocated() const noexcept { return m_allocated; }
+    size_type reserved() const noexcept { return m_reserved; }
+    size_type slabs_num() const noexcept { return m_slabs.size(); }
+
+private:
+    static std::byte* align_up(std::byte* ptr, size_type align) noexcept {
+        auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+        addr = (addr + align - 1) & ~(align - 1);
+        return reinterpret_cast<std::byte*>(addr);
+    }
+
+    void new_slab(size_type min_size) {
+        auto size = std::max(m_next_slab_size, min_size);
+        m_next_slab_size = std::min(m_next_slab_size * 2, kMaxSlabSize);
+        //
+        SlabTy slab{new std::byte[size]};
+        m_cur = slab.get();
+        m_end = m_cur + size;
+        m_reserved += size;
+        //
+        m_slabs.push_back(std::move(slab));
+    }
+};
+
+}  // namespace jj_vm::memory
@@ -6,53 +6,130 @@
 #include <memory>
 #include <unordered_map>
 //
+#include "IR/inst_visitor.hh"
 #include "pass_manager.hh"
-#include "pass_visitor.hh"
 
 namespace jj_vm::passes {
 
-class ConstantFold : Pass, PassVisitor {
+class ConstantFold : Pass, public jj_vm::ir::InstVisitor<ConstantFold> {
 public:
     using OpcodeTy = jj_vm::ir::Opcode;
     using GraphTy = jj_vm::graph::BBGraph;
     using node_pointer = typename GraphTy::node_pointer;
     using node_iterator = typename GraphTy::node_iterator;
 
-private:
-    std::vector<std::reference_wrapper<jj_vm::ir::Instr>> m_instrs{};
-    //
-    std::set<OpcodeTy> unfoldable_set{OpcodeTy::NONE,   OpcodeTy::RET,
-                                      OpcodeTy::BRANCH, OpcodeTy::IF,
-                                      OpcodeTy::PHI,    OpcodeTy::CONST};
-
-    std::set<OpcodeTy> bin_op_set{OpcodeTy::ADD, OpcodeTy::SUB, OpcodeTy::MUL,
-                                  OpcodeTy::DIV, OpcodeTy::SHR, OpcodeTy::XOR,
-                                  OpcodeTy::EQ,  OpcodeTy::LE,  OpcodeTy::GE};
-
 public:
     void run(jj_vm::ir::Function* func) override {
-        visit_func(func);
-        optimize();
+        visit(*func);
     }
 
-    void visit_instr(jj_vm::ir::Instr& instr) override {
-        auto find_res = unfoldable_set.find(instr.opcode());
+    //! NOTE: only binary operations & lanes of vectors are foldable right now
+    void visit_bin(jj_vm::ir::BinInstr& instr) {
+        if (!jj_vm::ir::is_foldable(instr.opcode())) return;
+        if (jj_vm::ir::is_vector(instr.type()))
+            return fold_vector_operation(instr);
+        if (!is_really_need_folding(instr)) return;
+
+        auto* optimized_instr = fold_binary_operation(instr);
+        if (optimized_instr == nullptr) return;
 
-        if (find_res == unfoldable_set.end()) m_instrs.push_back(instr);
+        //! NOTE: folded value is the pooled constant from the entry block
+        optimized_instr->replace_users(instr);
+        jj_vm::ir::erase(&instr);
     }
 
-    bool is_really_need_folding(jj_vm::ir::Instr& instr) {
-        for (auto* input : instr.inputs()) {
-            auto* cur_input = static_cast<jj_vm::ir::Instr*>(input);
-            if (cur_input->opcode() != OpcodeTy::CONST) return false;
+    /**
+     * @brief Lane-wise operation over splatted constants is the splat of
+     *        the folded constant: op(splat a, splat b) -> splat(op(a, b))
+     */
+    void fold_vector_operation(jj_vm::ir::BinInstr& instr) {
+        auto* lhs = splatted_const(instr.lhs());
+        auto* rhs = splatted_const(instr.rhs());
+        if (lhs == nullptr || rhs == nullptr) return;
+        //
+        auto* func = instr.parent()->parent();
+        auto* folded = fold_binary_operation(
+            func, jj_vm::ir::element_type(instr.type()), instr.opcode(), lhs,
+            rhs);
+        if (folded == nullptr) return;
+        //
+        auto* splat = func->create<jj_vm::ir::SplatInstr>(instr.type(), folded);
+        instr.parent()->insert(jj_vm::ir::BasicBlock::iterator{&instr}, splat);
+        splat->replace_users(instr);
+        jj_vm::ir::erase(&instr);
+    }
+
+    /**
+     * @brief Lane of known vector:
+     *          extract(splat x, k) -> x
+     *          extract(insert(v, x, k), k) -> x
+     *          extract(insert(v, x, j), k) -> extract(v, k)
+     */
+    void visit_extract(jj_vm::ir::ExtractLaneInstr& instr) {
+        auto lane = jj_vm::ir::lane_index(instr.lane());
+        auto* vec = lane_source(instr.vec());
+        while (vec != nullptr && vec->opcode() == OpcodeTy::INSERT &&
+               jj_vm::ir::lane_index(vec->get_input(2)) != lane) {
+            instr.set_input(0, vec->get_input(0));
+            vec = lane_source(instr.vec());
         }
+        //
+        //! NOTE: lanes of a vector param are unknown
+        if (vec == nullptr) return;
+        jj_vm::ir::Value* known = nullptr;
+        if (vec->opcode() == OpcodeTy::SPLAT)
+            known = vec->get_input(0);
+        else if (vec->opcode() == OpcodeTy::INSERT)
+            known = vec->get_input(1);
+        if (known == nullptr) return;
+        //
+        known->replace_users(instr);
+        jj_vm::ir::erase(&instr);
+    }
+
+    /**
+     * @brief Select by the known condition is its arm:
+     *          select(c, x, y) -> c ? x : y
+     */
+    void visit_select(jj_vm::ir::SelectInstr& instr) {
+        const auto* cond = constant(instr.cond());
+        if (cond == nullptr) return;
+        auto* arm = jj_vm::ir::const_value(*cond) != 0 ? instr.true_val()
+                                                       : instr.false_val();
+        arm->replace_users(instr);
+        jj_vm::ir::erase(&instr);
+    }
+
+    static const jj_vm::ir::Instr* constant(const jj_vm::ir::Value* val) {
+        if (val->is_param()) return nullptr;
+        const auto* instr = static_cast<const jj_vm::ir::Instr*>(val);
+        return instr->opcode() == OpcodeTy::CONST ? instr : nullptr;
+    }
+
+    static jj_vm::ir::Instr* lane_source(jj_vm::ir::Value* val) {
+        if (val->is_param()) return nullptr;
+        return static_cast<jj_vm::ir::Instr*>(val);
+    }
+
+    const jj_vm::ir::Instr* splatted_const(const jj_vm::ir::Value* val) {
+        if (val->is_param()) return nullptr;
+        const auto* splat = static_cast<const jj_vm::ir::Instr*>(val);
+        if (splat->opcode() != OpcodeTy::SPLAT) return nullptr;
+        //
+        return constant(splat->get_input(0));
+    }
+
+    bool is_really_need_folding(jj_vm::ir::Instr& instr) {
+        for (auto* input : instr.inputs())
+            if (constant(input) == nullptr) return false;
         return true;
     }
 
     template <typename Type>
-    std::unique_ptr<jj_vm::ir::Instr> eval_binary_operation(
-        const jj_vm::ir::Instr* l_instr, const jj_vm::ir::Instr* r_instr,
-        OpcodeTy opc) {
+    jj_vm::ir::Instr* eval_binary_operation(jj_vm::ir::Function* func,
+                                            const jj_vm::ir::Instr* l_instr,
+                                            const jj_vm::ir::Instr* r_instr,
+                                            OpcodeTy opc) {
         const auto* lhs =
             static_cast<const jj_vm::ir::Constant<Type>*>(l_instr);
         const auto* rhs =
@@ -93,13 +170,9 @@ public:
                 result = lval ^ rval;
                 break;
             case OpcodeTy::EQ:
-                result = lval == rval;
-                break;
             case OpcodeTy::LE:
-                result = lval < rval;
-                break;
             case OpcodeTy::GE:
-                result = lval > rval;
+                result = jj_vm::ir::compare(opc, lval, rval);
                 break;
             default: {
                 //! NOTE: I don't want to process all issues with div ....
@@ -108,52 +181,41 @@ public:
             }
         }
 
-        return std::make_unique<jj_vm::ir::Constant<Type>>(result);
+        return func->get_const<Type>(result);
     }
 
-    std::unique_ptr<jj_vm::ir::Instr> fold_binary_operation(
-        jj_vm::ir::Instr& instr) {
+    jj_vm::ir::Instr* fold_binary_operation(jj_vm::ir::Instr& instr) {
         auto* lhs = static_cast<const jj_vm::ir::Instr*>(instr.get_input(0));
         auto* rhs = static_cast<const jj_vm::ir::Instr*>(instr.get_input(1));
         //
-        auto type = instr.type();
-        auto opcode = instr.opcode();
+        return fold_binary_operation(instr.parent()->parent(), instr.type(),
+                                     instr.opcode(), lhs, rhs);
+    }
 
+    jj_vm::ir::Instr* fold_binary_operation(jj_vm::ir::Function* func,
+                                            jj_vm::ir::TypeId type,
+                                            OpcodeTy opcode,
+                                            const jj_vm::ir::Instr* lhs,
+                                            const jj_vm::ir::Instr* rhs) {
         switch (type) {
             case jj_vm::ir::TypeId::I1:
-                return eval_binary_operation<bool>(lhs, rhs, opcode);
+                return eval_binary_operation<bool>(func, lhs, rhs, opcode);
             case jj_vm::ir::TypeId::I8:
-                return eval_binary_operation<std::int8_t>(lhs, rhs, opcode);
+                return eval_binary_operation<std::int8_t>(func, lhs, rhs,
+                                                          opcode);
             case jj_vm::ir::TypeId::I16:
-                return eval_binary_operation<std::int16_t>(lhs, rhs, opcode);
+                return eval_binary_operation<std::int16_t>(func, lhs, rhs,
+                                                           opcode);
             case jj_vm::ir::TypeId::I32:
-                return eval_binary_operation<std::int32_t>(lhs, rhs, opcode);
+                return eval_binary_operation<std::int32_t>(func, lhs, rhs,
+                                                           opcode);
             case jj_vm::ir::TypeId::I64:
-                return eval_binary_operation<std::int64_t>(lhs, rhs, opcode);
-            case jj_vm::ir::TypeId::NONE:
+                return eval_binary_operation<std::int64_t>(func, lhs, rhs,
+                                                           opcode);
+            default:
                 assert(false && "Error: uknown folding type");
         }
-    }
-
-    std::unique_ptr<jj_vm::ir::Instr> fold_operation(jj_vm::ir::Instr& instr) {
-        auto is_bin_op = bin_op_set.find(instr.opcode()) != bin_op_set.end();
-
-        //! TODO: suuport unary, cast operations folding
-        if (is_bin_op) return fold_binary_operation(instr);
-    }
-
-    void optimize() {
-        for (auto ref_instr : m_instrs) {
-            auto& instr = ref_instr.get();
-
-            if (!is_really_need_folding(instr)) continue;
-
-            auto optimized_instr = fold_operation(instr);
-            auto* parent = instr.parent();
-            //
-            instr.clean_inputs();
-            parent->replace_instr(&instr, optimized_instr.release());
-        }
+        return nullptr;
     }
 };
 }  // namespace jj_vm::passes
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+//
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "analysis/alias_analysis.hh"
+#include "analysis/memory_ssa.hh"
+#include "pass_manager.hh"
+
+namespace jj_vm::passes {
+
+/**
+ * @brief Dead store elimination over Memory SSA. The store is dead if its
+ *        location isn't read on any path from it: accesses reached from
+ *        its DEF through Memory SSA users are scanned
+ *        - load which may alias the location reads it
+ *        - call reads every location except local allocs
+ *        - store which covers all bytes of the location kills it on the path
+ *        - other stores & phis pass the state further
+ *        Location which isn't local is read after the function returns
+ */
+class DeadStoreElimination : Pass {
+public:
+    using MemoryAccess = jj_vm::analysis::memory::MemoryAccess;
+
+private:
+    std::size_t m_eliminated = 0;
+
+public:
+    void run(jj_vm::ir::Function* func) override {
+        if (func->empty()) return;
+        const jj_vm::analysis::memory::AliasAnalysis aa{*func};
+        jj_vm::analysis::memory::MemorySSA mssa{*func};
+        //
+        std::vector<jj_vm::ir::Instr*> stores{};
+        for (auto&& bb : *func)
+            for (auto&& instr : bb)
+                if (instr.opcode() == jj_vm::ir::Opcode::STORE &&
+                    mssa.access(&instr) != nullptr)
+                    stores.push_back(&instr);
+        //
+        for (auto* store : stores) {
+            auto* access = mssa.access(store);
+            if (is_read(aa, mssa, access, aa.location(*store))) continue;
+            mssa.remove(access);
+            jj_vm::ir::erase(store);
+            ++m_eliminated;
+        }
+    }
+
+    /**
+     * @brief Getters
+     */
+    std::size_t eliminated() const noexcept { return m_eliminated; }
+
+private:
+    static bool is_read(const jj_vm::analysis::memory::AliasAnalysis& aa,
+                        const jj_vm::analysis::memory::MemorySSA& mssa,
+                        const MemoryAccess* def,
+                        const jj_vm::analysis::memory::MemoryLocation& loc) {
+        bool is_local = aa.is_local(loc.m_base);
+        std::vector<const MemoryAccess*> worklist{def};
+        std::unordered_set<const MemoryAccess*> visited{def};
+        while (!worklist.empty()) {
+            const auto* cur = worklist.back();
+            worklist.pop_back();
+            if (!is_local && mssa.is_exit_state(cur)) return true;
+            //
+            for (const auto* user : cur->users()) {
+                if (!visited.insert(user).second) continue;
+                if (user->is_phi()) {
+                    worklist.push_back(user);
+                    continue;
+                }
+                //
+                const auto& instr = *user->instr();
+                switch (instr.opcode()) {
+                    case jj_vm::ir::Opcode::LOAD:
+                        if (aa.alias(aa.location(instr), loc) !=
+                            jj_vm::analysis::memory::AliasResult::NO_ALIAS)
+                            return true;
+                        break;
+                    case jj_vm::ir::Opcode::STORE:
+                        if (!covers(aa.location(instr), loc))
+                            worklist.push_back(user);
+                        break;
+                    default:
+                        if (!is_local) return true;
+                        worklist.push_back(user);
+                        break;
+                }
+            }
+        }
+        return false;
+    }
+
+    static bool covers(const jj_vm::analysis::memory::MemoryLocation& outer,
+                       const jj_vm::analysis::memory::MemoryLocation& inner) {
+        return outer.m_base == inner.m_base && outer.m_exact &&
+               inner.m_exact && outer.m_offset <= inner.m_offset &&
+               outer.m_offset + static_cast<std::int64_t>(outer.m_size) >=
+                   inner.m_offset + static_cast<std::int64_t>(inner.m_size);
+    }
+};
+
+}  // namespace jj_vm::passes
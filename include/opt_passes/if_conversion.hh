@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <vector>
+//
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "graph/bb_graph.hh"
+#include "graph/dom3.hh"
+#include "pass_manager.hh"
+
+namespace jj_vm::passes {
+
+/**
+ * @brief If-conversion of small hammocks. The head ends with the if, arms
+ *        are blocks with the single pred (head) & the single succ (join):
+ *        - diamond: head -> true arm, false arm -> join
+ *        - triangle: head -> arm -> join & head -> join
+ *        Arms are hoisted to the head, phis of the join become selects by
+ *        the condition of the if, arm blocks are erased & the join is
+ *        merged into the head, so nested hammocks collapse bottom-up.
+ *
+ *        Arm instructions are executed speculatively, so they mustn't have
+ *        side effects or trap (div, load...). Cost of the hammock is the
+ *        number of hoisted instructions & selects, it is limited by the
+ *        threshold. Heads are visited bottom-up over the dominator tree:
+ *        inner hammocks are converted before the outer ones
+ */
+class IfConversion : Pass {
+public:
+    using GraphTy = jj_vm::graph::BBGraph;
+    using DomTreeTy = jj_vm::graph::dom3_impl::DomTree<GraphTy>;
+
+    static constexpr std::size_t kMaxCost = 8;
+
+private:
+    struct Hammock final {
+        jj_vm::ir::BasicBlock* m_head = nullptr;
+        //! NOTE: nullptr if the edge goes from the head to the join
+        jj_vm::ir::BasicBlock* m_true_arm = nullptr;
+        jj_vm::ir::BasicBlock* m_false_arm = nullptr;
+        jj_vm::ir::BasicBlock* m_join = nullptr;
+    };
+
+    std::size_t m_max_cost = kMaxCost;
+    std::size_t m_converted = 0;
+
+public:
+    explicit IfConversion(std::size_t max_cost = kMaxCost)
+        : m_max_cost(max_cost) {}
+
+    void run(jj_vm::ir::Function* func) override {
+        if (func->empty()) return;
+        auto graph = func->bb_graph();
+        auto dom =
+            jj_vm::graph::dom3_impl::DomTreeBuilder<GraphTy>::build(graph);
+        //
+        for (auto* head : bottom_up(*func, dom)) {
+            auto hammock = match(head);
+            if (!hammock.has_value() || cost(*hammock) > m_max_cost ||
+                !dom.dominates(head, hammock->m_join))
+                continue;
+            convert(func, *hammock);
+            ++m_converted;
+        }
+    }
+
+    /**
+     * @brief Getters
+     */
+    std::size_t converted() const noexcept { return m_converted; }
+
+private:
+    /// Reversed preorder of the dominator tree: every block goes after
+    /// blocks it dominates, so erased ones are never visited again
+    static std::vector<jj_vm::ir::BasicBlock*> bottom_up(
+        jj_vm::ir::Function& func, const DomTreeTy& dom) {
+        std::vector<jj_vm::ir::BasicBlock*> order{};
+        std::vector<jj_vm::ir::BasicBlock*> stack{&func.front()};
+        while (!stack.empty()) {
+            auto* bb = stack.back();
+            stack.pop_back();
+            order.push_back(bb);
+            const auto& children = dom.children(bb);
+            stack.insert(stack.end(), children.begin(), children.end());
+        }
+        return {order.rbegin(), order.rend()};
+    }
+
+    static std::optional<Hammock> match(jj_vm::ir::BasicBlock* head) {
+        if (head->empty() || head->back().opcode() != jj_vm::ir::Opcode::IF)
+            return std::nullopt;
+        const auto& cond = static_cast<const jj_vm::ir::IfInstr&>(head->back());
+        auto* true_bb = cond.true_bb();
+        auto* false_bb = cond.false_bb();
+        if (true_bb == false_bb) return std::nullopt;
+        //
+        Hammock hammock{head};
+        if (is_arm(head, true_bb) && is_arm(head, false_bb) &&
+            succ(true_bb) == succ(false_bb))
+            hammock = {head, true_bb, false_bb, succ(true_bb)};
+        else if (is_arm(head, true_bb) && succ(true_bb) == false_bb)
+            hammock = {head, true_bb, nullptr, false_bb};
+        else if (is_arm(head, false_bb) && succ(false_bb) == true_bb)
+            hammock = {head, nullptr, false_bb, true_bb};
+        else
+            return std::nullopt;
+        //
+        //! NOTE: all phi inputs of the join come from the hammock
+        auto* join = hammock.m_join;
+        if (join == head || join->preds_num() != 2) return std::nullopt;
+        return hammock;
+    }
+
+    static bool is_arm(const jj_vm::ir::BasicBlock* head,
+                       jj_vm::ir::BasicBlock* bb) {
+        if (bb == head || bb->preds_num() != 1 || bb->succs_num() != 1 ||
+            bb->back().opcode() != jj_vm::ir::Opcode::BRANCH)
+            return false;
+        for (auto it = bb->begin(); it != std::prev(bb->end()); ++it)
+            if (!is_speculatable(it->opcode())) return false;
+        return true;
+    }
+
+    static jj_vm::ir::BasicBlock* succ(const jj_vm::ir::BasicBlock* bb) {
+        return bb->succs().front();
+    }
+
+    static bool is_speculatable(jj_vm::ir::Opcode opc) noexcept {
+        switch (opc) {
+            //! NOTE: div by zero, load of invalid address & allocs
+            case jj_vm::ir::Opcode::DIV:
+            case jj_vm::ir::Opcode::LOAD:
+            case jj_vm::ir::Opcode::ALLOC:
+            case jj_vm::ir::Opcode::PHI:
+            case jj_vm::ir::Opcode::PARAM:
+                return false;
+            default:
+                return !jj_vm::ir::has_side_effects(opc);
+        }
+    }
+
+    static std::size_t cost(const Hammock& hammock) {
+        std::size_t res = 0;
+        for (auto* arm : {hammock.m_true_arm, hammock.m_false_arm})
+            if (arm != nullptr) res += arm->size() - 1;
+        for ([[maybe_unused]] auto&& phi : hammock.m_join->phis()) ++res;
+        return res;
+    }
+
+    static void convert(jj_vm::ir::Function* func, const Hammock& hammock) {
+        auto* head = hammock.m_head;
+        auto* join = hammock.m_join;
+        auto* cond_instr = &head->back();
+        auto* cond = cond_instr->get_input(0);
+        auto* true_src =
+            hammock.m_true_arm != nullptr ? hammock.m_true_arm : head;
+        auto* false_src =
+            hammock.m_false_arm != nullptr ? hammock.m_false_arm : head;
+        //
+        //! NOTE: phi values are taken before edges are changed
+        std::vector<std::pair<jj_vm::ir::Instr*,
+                              std::pair<jj_vm::ir::Value*, jj_vm::ir::Value*>>>
+            phis{};
+        for (auto&& phi : join->phis()) {
+            const auto& phi_instr = static_cast<jj_vm::ir::PhiInstr&>(phi);
+            phis.push_back({&phi,
+                            {phi_instr.incoming(true_src),
+                             phi_instr.incoming(false_src)}});
+        }
+        //
+        jj_vm::ir::BasicBlock::iterator pos{cond_instr};
+        for (auto* arm : {hammock.m_true_arm, hammock.m_false_arm})
+            if (arm != nullptr)
+                head->splice(pos, arm->begin(), std::prev(arm->end()));
+        for (auto&& [phi, vals] : phis) {
+            auto* val = vals.first;
+            if (vals.first != vals.second) {
+                val = func->create<jj_vm::ir::SelectInstr>(cond, vals.first,
+                                                           vals.second);
+                head->insert(pos, static_cast<jj_vm::ir::Instr*>(val));
+            }
+            val->replace_users(*phi);
+            jj_vm::ir::erase(phi);
+        }
+        //
+        auto head_succs = head->succs();
+        for (auto* bb : head_succs)
+            jj_vm::ir::BasicBlock::remove_link(bb, head);
+        for (auto* arm : {hammock.m_true_arm, hammock.m_false_arm}) {
+            if (arm == nullptr) continue;
+            jj_vm::ir::BasicBlock::remove_link(join, arm);
+            jj_vm::ir::erase(&arm->back());
+            func->erase(arm);
+        }
+        jj_vm::ir::erase(cond_instr);
+        merge(func, head, join);
+    }
+
+    /// Join isn't reached anymore, it is appended to the head & phis of its
+    /// succs take inputs from the head
+    static void merge(jj_vm::ir::Function* func, jj_vm::ir::BasicBlock* head,
+                      jj_vm::ir::BasicBlock* join) {
+        auto join_succs = join->succs();
+        for (auto* bb : join_succs) {
+            for (auto&& phi : bb->phis()) {
+                auto& phi_instr = static_cast<jj_vm::ir::PhiInstr&>(phi);
+                phi_instr.replace_incoming(
+                    join, {static_cast<jj_vm::ir::Instr*>(
+                               phi_instr.incoming(join)),
+                           head});
+            }
+            jj_vm::ir::BasicBlock::remove_link(bb, join);
+        }
+        //! NOTE: splice to the end links the head with succs of the join
+        head->splice(head->end(), *join);
+        func->erase(join);
+    }
+};
+
+}  // namespace jj_vm::passes
@@ -9,47 +9,45 @@
 #include <functional>
 #include <memory>
 //
+#include "IR/inst_visitor.hh"
 #include "pass_manager.hh"
-#include "pass_visitor.hh"
 
 namespace jj_vm::passes {
 
-class Inlining : Pass, PassVisitor {
+class Inlining : Pass, public jj_vm::ir::InstVisitor<Inlining> {
 public:
     using GraphTy = jj_vm::graph::BBGraph;
     using node_pointer = typename GraphTy::node_pointer;
     using node_iterator = typename GraphTy::node_iterator;
 
 private:
-    std::vector<std::reference_wrapper<jj_vm::ir::Instr>> m_instrs{};
+    std::vector<jj_vm::ir::CallInstr*> m_calls{};
     jj_vm::ir::IRBuilder m_builder{};
     //
     node_pointer m_callee_head{};
+    //
+    std::size_t m_max_caller_size{};
 
     static constexpr std::size_t kInlineInstrSize = 100;
+    static constexpr std::size_t kMaxCallerSize = 1000;
 
 public:
+    /**
+     * @brief Inlining is speculative: it is rolled back if caller grows
+     *        beyond max_caller_size instructions
+     */
+    explicit Inlining(std::size_t max_caller_size = kMaxCallerSize)
+        : m_max_caller_size(max_caller_size) {}
+
     //
     void run(jj_vm::ir::Function* func) override {
-        visit_func(func);
+        //! NOTE: inlining changes CFG, so calls are collected beforehand
+        visit(*func);
 
-        for (auto& ref_inst : m_instrs) {
-            auto& call_instr =
-                static_cast<jj_vm::ir::CallInstr&>(ref_inst.get());
-            optimize(func, call_instr);
-        }
+        for (auto* call_instr : m_calls) optimize(func, *call_instr);
     }
 
-    void visit_instr(jj_vm::ir::Instr& instr) override {
-        switch (instr.opcode()) {
-            case jj_vm::ir::Opcode::CALL: {
-                m_instrs.push_back(instr);
-                break;
-            }
-            default:
-                break;
-        }
-    }
+    void visit_call(jj_vm::ir::CallInstr& instr) { m_calls.push_back(&instr); }
 
     /**
      * @brief Function to update data flow for input parameters
@@ -102,7 +100,6 @@ public:
         m_callee_head = graph.head();
         auto rpo = jj_vm::graph::deep_first_search_reverse_postoder(graph);
 
-        //! NOTE: try move it into PassVisitor
         for (auto* bb : rpo) {
             auto& block = *bb;
             auto* last_instr = &block.back();
@@ -118,6 +115,8 @@ public:
             auto* phi_node =
                 m_builder.emplace_front<jj_vm::ir::PhiInstr>(callee->func_ty());
             //
+            //! NOTE: rets aren't preds yet, inputs take slots of their preds
+            //!       once branches below are created
             for (auto* ret : callee_return)
                 phi_node->add_node(std::make_pair(
                     static_cast<jj_vm::ir::Instr*>(ret->retval()),
@@ -145,6 +144,18 @@ public:
         //! NOTE: add flow bettwen terminate bb of caller func & next
         //! after first bb of callee func
         parent->splice(parent->end(), *callee_head);
+        //
+        //! NOTE: edges of the callee head are taken by the caller bb
+        auto succs = callee_head->succs();
+        for (auto* succ : succs) {
+            for (auto&& phi : succ->phis()) {
+                auto& phi_instr = static_cast<jj_vm::ir::PhiInstr&>(phi);
+                auto* input = static_cast<jj_vm::ir::Instr*>(
+                    phi_instr.incoming(callee_head));
+                phi_instr.replace_incoming(callee_head, {input, parent});
+            }
+            jj_vm::ir::BasicBlock::remove_link(succ, callee_head);
+        }
         callee->erase(callee_head);
     }
 
@@ -156,19 +167,18 @@ public:
         jj_vm::ir::erase(parent, &instr);
         caller->splice(ir::Function::iterator{call_cont_bb}, *callee);
         //
-        ir::BasicBlock::id_type new_id = 0;
-        for (auto&& bb : *caller) {
-            m_builder.set_bb_id(&bb, new_id);
-            ++new_id;
-        }
+        //! NOTE: keep ids dense and blocks numbered in layout order
+        caller->renumber();
     }
 
-    bool is_really_need_inlining(jj_vm::ir::Function* callee) {
-        std::size_t callee_instr_size = 0;
-
-        for (auto&& bb : *callee) callee_instr_size += bb.size();
+    static std::size_t instr_size(const jj_vm::ir::Function& func) {
+        std::size_t size = 0;
+        for (auto&& bb : func) size += bb.size();
+        return size;
+    }
 
-        return callee_instr_size < kInlineInstrSize;
+    bool is_really_need_inlining(jj_vm::ir::Function* callee) {
+        return instr_size(*callee) < kInlineInstrSize;
     }
 
     void optimize(jj_vm::ir::Function* caller, jj_vm::ir::CallInstr& instr) {
@@ -178,6 +188,9 @@ public:
         if (!is_really_need_inlining(callee)) return;
 
         auto* parent = instr.parent();
+        //
+        //! NOTE: both functions are restored if the result is too large
+        jj_vm::ir::Journal journal{*caller, *callee};
 
         //! NOTE: split block with a call instruction into call_block &
         //! call_cont_block
@@ -188,6 +201,11 @@ public:
         merge(instr);
         //
         make_inline(caller, instr, call_cont_bb);
+        //
+        if (instr_size(*caller) > m_max_caller_size)
+            journal.rollback();
+        else
+            journal.commit();
     }
 };
 }  // namespace jj_vm::passes
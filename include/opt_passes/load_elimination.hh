@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+//
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "analysis/alias_analysis.hh"
+#include "analysis/memory_ssa.hh"
+#include "graph/dfs.hh"
+#include "pass_manager.hh"
+
+namespace jj_vm::passes {
+
+/**
+ * @brief Redundant load elimination over Memory SSA. The load is replaced
+ *        - by the value of the store, which is its clobbering access and
+ *          writes the same location with the same type
+ *        - by the dominating load of the same location & type, which has
+ *          the same clobbering access (memory hasn't changed in between)
+ *        Blocks are visited in RPO, so dominating loads are seen first
+ */
+class LoadElimination : Pass {
+    struct Available final {
+        jj_vm::analysis::memory::MemoryLocation m_loc{};
+        jj_vm::ir::Instr* m_load = nullptr;
+    };
+
+    std::size_t m_eliminated = 0;
+
+public:
+    void run(jj_vm::ir::Function* func) override {
+        if (func->empty()) return;
+        const jj_vm::analysis::memory::AliasAnalysis aa{*func};
+        jj_vm::analysis::memory::MemorySSA mssa{*func};
+        //
+        std::vector<jj_vm::ir::Instr*> loads{};
+        for (auto* bb :
+             jj_vm::graph::deep_first_search_reverse_postoder(func->bb_graph()))
+            for (auto&& instr : *bb)
+                if (instr.opcode() == jj_vm::ir::Opcode::LOAD)
+                    loads.push_back(&instr);
+        //
+        //! NOTE: loads are keyed by their clobbering access, only loads of
+        //!       the same memory state are candidates
+        std::unordered_map<const jj_vm::analysis::memory::MemoryAccess*,
+                           std::vector<Available>>
+            available{};
+        for (auto* load : loads) {
+            auto* access = mssa.access(load);
+            auto loc = aa.location(*load);
+            auto* clobber = mssa.clobbering(access, loc, aa);
+            //
+            auto* known = forwarded(aa, *clobber, loc, load->type());
+            auto& same_state = available[clobber];
+            for (auto&& prev : same_state) {
+                if (known != nullptr) break;
+                if (prev.m_load->type() == load->type() &&
+                    aa.alias(prev.m_loc, loc) ==
+                        jj_vm::analysis::memory::AliasResult::MUST_ALIAS &&
+                    mssa.dominates(mssa.access(prev.m_load), access))
+                    known = prev.m_load;
+            }
+            if (known == nullptr) {
+                same_state.push_back({loc, load});
+                continue;
+            }
+            //
+            known->replace_users(*load);
+            mssa.remove(access);
+            jj_vm::ir::erase(load);
+            ++m_eliminated;
+        }
+    }
+
+    /**
+     * @brief Getters
+     */
+    std::size_t eliminated() const noexcept { return m_eliminated; }
+
+private:
+    /// Value of the store to the same location
+    static jj_vm::ir::Value* forwarded(
+        const jj_vm::analysis::memory::AliasAnalysis& aa,
+        const jj_vm::analysis::memory::MemoryAccess& clobber,
+        const jj_vm::analysis::memory::MemoryLocation& loc,
+        jj_vm::ir::TypeId type) {
+        if (!clobber.is_def() ||
+            clobber.instr()->opcode() != jj_vm::ir::Opcode::STORE)
+            return nullptr;
+        auto* val = clobber.instr()->get_input(1);
+        bool is_same = val->type() == type &&
+                       aa.alias(aa.location(*clobber.instr()), loc) ==
+                           jj_vm::analysis::memory::AliasResult::MUST_ALIAS;
+        return is_same ? val : nullptr;
+    }
+};
+
+}  // namespace jj_vm::passes
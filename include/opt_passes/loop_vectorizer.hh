@@ -0,0 +1,427 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <vector>
+//
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+#include "analysis/loop_analyzer.hh"
+#include "pass_manager.hh"
+#include "utils/side_table.hh"
+
+namespace jj_vm::passes {
+
+/**
+ * @brief Vectorizer of innermost counted loops with the single latch:
+ *
+ *        header:
+ *            i = phi [start, pre], [i_next, latch]
+ *            r = phi [init, pre], [r_next, latch]    (reductions)
+ *            c = le i, n                             (or ge n, i)
+ *            if c, latch, exit
+ *        latch:
+ *            ...lane-wise operations of i & invariants...
+ *            r_next = add r, x                       (add, mul, xor)
+ *            i_next = add i, step                    (constant step > 0)
+ *            jmp header
+ *
+ *        Vector loop runs VF iterations at once while the last of them
+ *        passes the check: i is the vector <i, i + step, ...>, invariants
+ *        are splatted before the loop, reductions are accumulated lane-wise
+ *        and combined after it. Original loop is left as the epilogue, it
+ *        runs the rest iterations from the values of the vector loop.
+ *
+ *        VF is the register width (128 bits of SSE, 256 bits of AVX2)
+ *        divided by the widest type of the loop, every type of the loop
+ *        should have the vector type of VF lanes.
+ *
+ *        NOTE: induction variable is expected not to overflow
+ */
+class LoopVectorizer : Pass {
+public:
+    using GraphTy = jj_vm::graph::BBGraph;
+    using node_pointer = typename GraphTy::node_pointer;
+    using LoopTy = jj_vm::analysis::loop::LoopNodeBase<GraphTy>;
+
+    static constexpr std::size_t kSSEBits = 128;
+    static constexpr std::size_t kAVX2Bits = 256;
+
+private:
+    using Value = jj_vm::ir::Value;
+    using Instr = jj_vm::ir::Instr;
+    using BasicBlock = jj_vm::ir::BasicBlock;
+    using PhiInstr = jj_vm::ir::PhiInstr;
+    using BinInstr = jj_vm::ir::BinInstr;
+    using TypeId = jj_vm::ir::TypeId;
+    using Opcode = jj_vm::ir::Opcode;
+
+    struct Reduction final {
+        PhiInstr* m_phi = nullptr;
+        BinInstr* m_next = nullptr;
+    };
+
+    struct Candidate final {
+        BasicBlock* m_pre = nullptr;
+        BasicBlock* m_header = nullptr;
+        BasicBlock* m_latch = nullptr;
+        //
+        PhiInstr* m_iv = nullptr;
+        Instr* m_iv_next = nullptr;
+        std::int64_t m_step = 0;
+        BinInstr* m_cond = nullptr;
+        std::vector<Reduction> m_reductions{};
+        //
+        std::size_t m_vf = 0;
+    };
+
+    std::size_t m_vector_bits = kSSEBits;
+    std::size_t m_vectorized = 0;
+
+public:
+    explicit LoopVectorizer(std::size_t vector_bits = kSSEBits)
+        : m_vector_bits(vector_bits) {}
+
+    void run(jj_vm::ir::Function* func) override {
+        if (func->empty()) return;
+        auto tree = jj_vm::analysis::loop::LoopTreeBuilder<GraphTy>::build(
+            func->bb_graph());
+        //
+        //! NOTE: loops are analyzed before any change, candidates are
+        //!       innermost, so they don't share blocks
+        std::vector<Candidate> candidates{};
+        for (auto&& [bb, loop] : tree)
+            if (loop->header() == bb)
+                if (auto cand = analyze(*loop)) candidates.push_back(*cand);
+        //
+        for (auto&& cand : candidates) vectorize(*func, cand);
+    }
+
+    /**
+     * @brief Getters
+     */
+    std::size_t vectorized() const noexcept { return m_vectorized; }
+    std::size_t vector_bits() const noexcept { return m_vector_bits; }
+
+private:
+    static bool is_widenable(Opcode opc) noexcept {
+        switch (opc) {
+            case Opcode::ADD:
+            case Opcode::SUB:
+            case Opcode::MUL:
+            case Opcode::DIV:
+            case Opcode::SHR:
+            case Opcode::XOR:
+            case Opcode::EQ:
+            case Opcode::LE:
+            case Opcode::GE:
+            case Opcode::NEG:
+            case Opcode::CAST:
+            case Opcode::CONST:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static bool is_reduction(Opcode opc) noexcept {
+        return opc == Opcode::ADD || opc == Opcode::MUL || opc == Opcode::XOR;
+    }
+
+    static bool is_only_user(const Value* val, const Instr* user) {
+        for (const auto* cur : val->users())
+            if (cur != user) return false;
+        return true;
+    }
+
+    bool is_invariant(const Candidate& cand, const Value* val) const {
+        if (val->is_param()) return true;
+        const auto* parent = static_cast<const Instr*>(val)->parent();
+        return parent != cand.m_header && parent != cand.m_latch;
+    }
+
+    /// Positive constant step of i_next = add i, step (or add step, i)
+    std::optional<std::int64_t> step_of(const PhiInstr* phi,
+                                        const Instr* next) const {
+        if (next->opcode() != Opcode::ADD) return std::nullopt;
+        const auto* step = next->get_input(0) == phi ? next->get_input(1)
+                                                     : next->get_input(0);
+        if ((next->get_input(0) != phi && next->get_input(1) != phi) ||
+            step->is_param())
+            return std::nullopt;
+        const auto* step_instr = static_cast<const Instr*>(step);
+        if (step_instr->opcode() != Opcode::CONST) return std::nullopt;
+        auto val = jj_vm::ir::const_value(*step_instr);
+        if (val <= 0) return std::nullopt;
+        return val;
+    }
+
+    std::optional<Candidate> analyze(const LoopTy& loop) const {
+        if (loop.is_root() || !loop.is_reducible() || !loop.inners().empty() ||
+            loop.back_edges().size() != 1)
+            return std::nullopt;
+        //
+        Candidate cand{};
+        cand.m_header = loop.header();
+        cand.m_latch = *loop.back_edges().begin();
+        auto body = loop.loop_body();
+        if (cand.m_latch == cand.m_header || body.size() != 1 ||
+            body.front() != cand.m_latch || cand.m_latch->preds_num() != 1 ||
+            cand.m_header->preds_num() != 2)
+            return std::nullopt;
+        //
+        auto* header = cand.m_header;
+        auto* latch = cand.m_latch;
+        cand.m_pre = header->preds()[header->preds()[0] == latch ? 1 : 0];
+        if (cand.m_pre->back().opcode() != Opcode::BRANCH) return std::nullopt;
+        //
+        //! NOTE: header is phis, check & if
+        auto check_it = header->phis_end();
+        if (check_it == header->end() || std::next(check_it) == header->end())
+            return std::nullopt;
+        auto& check = *check_it;
+        auto& term = *std::next(check_it);
+        if (term.opcode() != Opcode::IF ||
+            std::next(BasicBlock::iterator{&term}) != header->end())
+            return std::nullopt;
+        auto& if_instr = static_cast<jj_vm::ir::IfInstr&>(term);
+        if (if_instr.cond() != &check || if_instr.true_bb() != latch ||
+            if_instr.false_bb() == header || !is_only_user(&check, &term))
+            return std::nullopt;
+        //
+        //! NOTE: check is "le i, n" or "ge n, i"
+        if (check.opcode() != Opcode::LE && check.opcode() != Opcode::GE)
+            return std::nullopt;
+        cand.m_cond = static_cast<BinInstr*>(&check);
+        bool is_le = check.opcode() == Opcode::LE;
+        auto* iv = is_le ? check.get_input(0) : check.get_input(1);
+        auto* bound = is_le ? check.get_input(1) : check.get_input(0);
+        if (!is_invariant(cand, bound)) return std::nullopt;
+        //
+        for (auto&& instr : header->phis()) {
+            auto* phi = static_cast<PhiInstr*>(&instr);
+            auto* val = phi->incoming(latch);
+            if (val == nullptr || val->is_param()) return std::nullopt;
+            auto* next = static_cast<Instr*>(val);
+            if (next->parent() != latch || !is_only_user(next, phi))
+                return std::nullopt;
+            //
+            if (phi == iv) {
+                auto step = step_of(phi, next);
+                if (!step.has_value()) return std::nullopt;
+                cand.m_iv = phi;
+                cand.m_iv_next = next;
+                cand.m_step = *step;
+                continue;
+            }
+            //
+            //! NOTE: reduction is used in the loop by its update only
+            if (!is_reduction(next->opcode()) ||
+                next->get_input(0) == next->get_input(1) ||
+                (next->get_input(0) != phi && next->get_input(1) != phi))
+                return std::nullopt;
+            for (const auto* user : phi->users())
+                if (user != next && (user->parent() == header ||
+                                     user->parent() == latch))
+                    return std::nullopt;
+            cand.m_reductions.push_back({phi, static_cast<BinInstr*>(next)});
+        }
+        if (cand.m_iv == nullptr) return std::nullopt;
+        //
+        //! NOTE: vectorization factor is limited by the widest type,
+        //!       operands are widened too (e.g. sources of casts)
+        std::size_t max_bits = jj_vm::ir::type_bits(check.type());
+        for (auto&& instr : *latch) {
+            if (instr.opcode() == Opcode::BRANCH) continue;
+            if (!is_widenable(instr.opcode())) return std::nullopt;
+            max_bits = std::max(max_bits, jj_vm::ir::type_bits(instr.type()));
+            for (const auto* input : instr.inputs())
+                max_bits =
+                    std::max(max_bits, jj_vm::ir::type_bits(input->type()));
+        }
+        if (max_bits == 0 || m_vector_bits / max_bits < 2)
+            return std::nullopt;
+        cand.m_vf = m_vector_bits / max_bits;
+        //
+        auto has_vector = [vf = cand.m_vf](TypeId type) {
+            return jj_vm::ir::vector_type(type, vf) != TypeId::NONE;
+        };
+        if (!has_vector(check.type())) return std::nullopt;
+        for (auto&& instr : *latch) {
+            if (instr.opcode() == Opcode::BRANCH) continue;
+            if (!has_vector(instr.type())) return std::nullopt;
+            for (const auto* input : instr.inputs())
+                if (!has_vector(input->type())) return std::nullopt;
+        }
+        //
+        return cand;
+    }
+
+    /**
+     * @brief Vector loop is placed between the preheader & the header:
+     *        pre -> vpre -> vheader <-> vbody, vheader -> vexit -> header
+     */
+    void vectorize(jj_vm::ir::Function& func, const Candidate& cand) {
+        auto* vpre = func.create<BasicBlock>();
+        auto* vheader = func.create<BasicBlock>();
+        auto* vbody = func.create<BasicBlock>();
+        auto* vexit = func.create<BasicBlock>();
+        for (auto* bb : {vpre, vheader, vbody, vexit})
+            func.move(jj_vm::ir::Function::iterator{cand.m_header}, bb);
+        //
+        auto* iv = cand.m_iv;
+        auto* start = static_cast<Instr*>(iv->incoming(cand.m_pre));
+        auto iv_type = iv->type();
+        auto vf = cand.m_vf;
+        auto vec_type = [vf](TypeId type) {
+            return jj_vm::ir::Type{jj_vm::ir::vector_type(type, vf)};
+        };
+        auto lane = [&func](std::size_t idx) {
+            return func.get_const(TypeId::I32, static_cast<std::int64_t>(idx));
+        };
+        //
+        //! NOTE: preheader jumps to the vector loop instead of the header
+        jj_vm::ir::erase(&cand.m_pre->back());
+        BasicBlock::remove_link(cand.m_header, cand.m_pre);
+        jj_vm::ir::IRBuilder builder{cand.m_pre};
+        builder.create<jj_vm::ir::BranchInstr>(vpre);
+        //
+        //! NOTE: values of the scalar loop mapped to the vector ones,
+        //!       invariants are splatted in vpre
+        jj_vm::ir::IRBuilder pre_builder{vpre};
+        jj_vm::utils::SideTable<const Value*, Instr*> widened(
+            func.values_num());
+        auto splat = [&](Value* val) {
+            auto& res = widened[val];
+            if (res == nullptr)
+                res = pre_builder.create<jj_vm::ir::SplatInstr>(
+                    vec_type(val->type()), val);
+            return res;
+        };
+        //
+        //! NOTE: vi0 = splat(start) + <0, step, 2 * step, ...>
+        Instr* offsets = pre_builder.create<jj_vm::ir::SplatInstr>(
+            vec_type(iv_type), func.get_const(iv_type, 0));
+        for (std::size_t idx = 1; idx < vf; ++idx)
+            offsets = pre_builder.create<jj_vm::ir::InsertLaneInstr>(
+                offsets,
+                func.get_const(iv_type,
+                               cand.m_step * static_cast<std::int64_t>(idx)),
+                lane(idx));
+        auto* vi0 = pre_builder.create<BinInstr>(
+            Opcode::ADD,
+            pre_builder.create<jj_vm::ir::SplatInstr>(vec_type(iv_type), start),
+            offsets);
+        //
+        //! NOTE: accumulator is <init, id, id, ...>
+        std::vector<Instr*> vr0{};
+        for (auto&& red : cand.m_reductions) {
+            auto type = red.m_phi->type();
+            auto* identity = func.get_const(
+                type, red.m_next->opcode() == Opcode::MUL ? 1 : 0);
+            auto* init = static_cast<Instr*>(red.m_phi->incoming(cand.m_pre));
+            vr0.push_back(pre_builder.create<jj_vm::ir::InsertLaneInstr>(
+                pre_builder.create<jj_vm::ir::SplatInstr>(vec_type(type),
+                                                          identity),
+                init, lane(0)));
+        }
+        //
+        //! NOTE: vector loop runs while the last of VF iterations passes
+        builder.set_insert_point(vheader);
+        auto* scalar_iv = builder.create<PhiInstr>(iv_type);
+        auto* vi = builder.create<PhiInstr>(vec_type(iv_type));
+        widened[iv] = vi;
+        std::vector<PhiInstr*> vr{};
+        for (auto&& red : cand.m_reductions) {
+            vr.push_back(
+                builder.create<PhiInstr>(vec_type(red.m_phi->type())));
+            widened[red.m_phi] = vr.back();
+        }
+        auto* last = builder.create<BinInstr>(
+            Opcode::ADD, scalar_iv,
+            func.get_const(iv_type,
+                           cand.m_step * static_cast<std::int64_t>(vf - 1)));
+        bool is_le = cand.m_cond->opcode() == Opcode::LE;
+        auto* bound = is_le ? cand.m_cond->rhs() : cand.m_cond->lhs();
+        auto* cond = builder.create<BinInstr>(cand.m_cond->opcode(),
+                                              is_le ? last : bound,
+                                              is_le ? bound : last);
+        builder.create<jj_vm::ir::IfInstr>(vbody, vexit, cond);
+        //
+        builder.set_insert_point(vbody);
+        auto widen = [&](Value* val) -> Instr* {
+            if (is_invariant(cand, val)) return splat(val);
+            return widened.at(val);
+        };
+        for (auto&& instr : *cand.m_latch) {
+            if (&instr == cand.m_iv_next || instr.opcode() == Opcode::BRANCH)
+                continue;
+            Instr* res = nullptr;
+            switch (instr.opcode()) {
+                case Opcode::CONST:
+                    res = splat(func.get_const(instr.type(),
+                                               jj_vm::ir::const_value(instr)));
+                    break;
+                case Opcode::NEG:
+                    res = builder.create<jj_vm::ir::UnaryInstr>(
+                        Opcode::NEG, widen(instr.get_input(0)));
+                    break;
+                case Opcode::CAST:
+                    res = builder.create<jj_vm::ir::CastInstr>(
+                        vec_type(instr.type()), widen(instr.get_input(0)));
+                    break;
+                default:
+                    res = builder.create<BinInstr>(instr.opcode(),
+                                                   widen(instr.get_input(0)),
+                                                   widen(instr.get_input(1)));
+                    break;
+            }
+            widened.insert({&instr, res});
+        }
+        auto vf_step = cand.m_step * static_cast<std::int64_t>(vf);
+        auto* vi_next = builder.create<BinInstr>(
+            Opcode::ADD, vi, splat(func.get_const(iv_type, vf_step)));
+        auto* scalar_next = builder.create<BinInstr>(
+            Opcode::ADD, scalar_iv, func.get_const(iv_type, vf_step));
+        builder.create<jj_vm::ir::BranchInstr>(vheader);
+        //
+        scalar_iv->add_node({start, vpre});
+        scalar_iv->add_node({scalar_next, vbody});
+        vi->add_node({vi0, vpre});
+        vi->add_node({vi_next, vbody});
+        for (std::size_t idx = 0; idx < vr.size(); ++idx) {
+            vr[idx]->add_node({vr0[idx], vpre});
+            vr[idx]->add_node({widened.at(cand.m_reductions[idx].m_next),
+                               vbody});
+        }
+        //
+        //! NOTE: lanes of accumulators are combined, scalar loop continues
+        //!       from the vector one
+        builder.set_insert_point(vexit);
+        iv->replace_incoming(cand.m_pre, {scalar_iv, vexit});
+        for (std::size_t idx = 0; idx < vr.size(); ++idx) {
+            auto opc = cand.m_reductions[idx].m_next->opcode();
+            Instr* acc =
+                builder.create<jj_vm::ir::ExtractLaneInstr>(vr[idx], lane(0));
+            for (std::size_t k = 1; k < vf; ++k)
+                acc = builder.create<BinInstr>(
+                    opc, acc,
+                    builder.create<jj_vm::ir::ExtractLaneInstr>(vr[idx],
+                                                                lane(k)));
+            cand.m_reductions[idx].m_phi->replace_incoming(cand.m_pre,
+                                                           {acc, vexit});
+        }
+        builder.create<jj_vm::ir::BranchInstr>(cand.m_header);
+        pre_builder.create<jj_vm::ir::BranchInstr>(vheader);
+        //
+        ++m_vectorized;
+    }
+};
+
+}  // namespace jj_vm::passes
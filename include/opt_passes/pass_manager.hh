@@ -26,6 +26,8 @@ public:
 
     //
     void run() {
+        //! NOTE: lazy body is decoded once before passes
+        m_fn->materialize();
         for (auto &&pass : m_passes) pass->run(m_fn);
     }
 };
@@ -5,123 +5,71 @@
 #include <memory>
 #include <unordered_map>
 
+#include "IR/inst_visitor.hh"
 #include "pass_manager.hh"
-#include "pass_visitor.hh"
 //
 
 namespace jj_vm::passes {
-class Peephole : Pass, PassVisitor {
+class Peephole : Pass, public jj_vm::ir::InstVisitor<Peephole> {
 public:
     using GraphTy = jj_vm::graph::BBGraph;
     using node_pointer = typename GraphTy::node_pointer;
     using node_iterator = typename GraphTy::node_iterator;
 
-private:
-    std::vector<std::reference_wrapper<jj_vm::ir::Instr>> m_instrs{};
-
 public:
-    void run(jj_vm::ir::Function* func) override {
-        visit_func(func);
-        optimize();
+    void run(jj_vm::ir::Function* func) override { visit(*func); }
+
+    void visit_mul(jj_vm::ir::BinInstr& instr) {
+        if (prepare(instr)) process_mul(instr);
     }
 
-    void visit_instr(jj_vm::ir::Instr& instr) override {
-        switch (instr.opcode()) {
-            case jj_vm::ir::Opcode::MUL:
-            case jj_vm::ir::Opcode::SHR:
-            case jj_vm::ir::Opcode::XOR: {
-                m_instrs.push_back(instr);
-                break;
-            }
-            default: {
-                break;
-            }
-        }
+    void visit_shr(jj_vm::ir::BinInstr& instr) {
+        if (prepare(instr)) process_shr(instr);
     }
 
-    bool is_really_need_peephole(jj_vm::ir::Instr& instr) {
-        return !instr.users().empty();
+    void visit_xor(jj_vm::ir::BinInstr& instr) {
+        if (prepare(instr)) process_xor(instr);
     }
 
-    void optimize() {
-        for (auto ref_instr : m_instrs) {
-            auto& instr = ref_instr.get();
-
-            if (!is_really_need_peephole(instr)) continue;
-
-            switch (instr.opcode()) {
-                case jj_vm::ir::Opcode::MUL: {
-                    process_mul(instr);
-                    break;
-                }
-                case jj_vm::ir::Opcode::SHR: {
-                    process_shr(instr);
-                    break;
-                }
-                case jj_vm::ir::Opcode::XOR: {
-                    process_xor(instr);
-                    break;
-                }
-                default: {
-                    break;
-                }
-            }
-        }
+    void visit_select(jj_vm::ir::SelectInstr& instr) {
+        if (is_really_need_peephole(instr)) process_select(instr);
     }
 
-    template <typename ConstTy, ConstTy const_value>
-    bool compare_val(const jj_vm::ir::Instr* instr) {
-        return static_cast<const jj_vm::ir::Constant<ConstTy>*>(instr)->val() ==
-               const_value;
+    bool is_really_need_peephole(jj_vm::ir::Instr& instr) {
+        return instr.has_users();
     }
 
-    template <typename ConstTy>
-    bool compare_val(const jj_vm::ir::Instr* lhs, const jj_vm::ir::Instr* rhs) {
-        return static_cast<const jj_vm::ir::Constant<ConstTy>*>(lhs)->val() ==
-               static_cast<const jj_vm::ir::Constant<ConstTy>*>(rhs)->val();
+    bool prepare(jj_vm::ir::Instr& instr) {
+        if (!is_really_need_peephole(instr)) return false;
+
+        //! NOTE: patterns below expect constant as rhs operand
+        if (jj_vm::ir::is_commutative(instr.opcode()))
+            canonicalize_operands(instr);
+        return true;
+    }
+
+    void canonicalize_operands(jj_vm::ir::Instr& instr) {
+        auto* lval = instr.get_input(0);
+        auto* rval = instr.get_input(1);
+        //
+        if (is_const(lval) && !is_const(rval)) {
+            instr.set_input(0, rval);
+            instr.set_input(1, lval);
+        }
     }
 
     template <int const_value>
     bool check_const_val(const jj_vm::ir::Instr* instr) {
-        switch (instr->type()) {
-            case jj_vm::ir::TypeId::I1:
-                return compare_val<bool, static_cast<bool>(const_value)>(instr);
-            case jj_vm::ir::TypeId::I8:
-                return compare_val<int8_t, int8_t{const_value}>(instr);
-            case jj_vm::ir::TypeId::I16:
-                return compare_val<int16_t, int16_t{const_value}>(instr);
-            case jj_vm::ir::TypeId::I32:
-                return compare_val<int32_t, int32_t{const_value}>(instr);
-            case jj_vm::ir::TypeId::I64:
-                return compare_val<int64_t, int64_t{const_value}>(instr);
-            default: {
-                assert(false && "Error: unsupported constant type in peephole");
-                return false;
-            }
-        }
+        return jj_vm::ir::const_value(*instr) == const_value;
     }
 
+    //! NOTE: constants from the pool are pointer-equal, other ones are
+    //!       compared by value
     bool compare_const_val(const jj_vm::ir::Instr* lhs,
                            const jj_vm::ir::Instr* rhs) {
-        bool same_type = lhs->type() == rhs->type();
-        if (!same_type) return false;
-
-        switch (lhs->type()) {
-            case jj_vm::ir::TypeId::I1:
-                return compare_val<bool>(lhs, rhs);
-            case jj_vm::ir::TypeId::I8:
-                return compare_val<int8_t>(lhs, rhs);
-            case jj_vm::ir::TypeId::I16:
-                return compare_val<int16_t>(lhs, rhs);
-            case jj_vm::ir::TypeId::I32:
-                return compare_val<int32_t>(lhs, rhs);
-            case jj_vm::ir::TypeId::I64:
-                return compare_val<int64_t>(lhs, rhs);
-            default: {
-                assert(false && "Error: unsupported constant type in peephole");
-                return false;
-            }
-        }
+        if (lhs == rhs) return true;
+        return lhs->type() == rhs->type() &&
+               jj_vm::ir::const_value(*lhs) == jj_vm::ir::const_value(*rhs);
     }
 
     void process_mul(jj_vm::ir::Instr& instr) {
@@ -130,11 +78,11 @@ public:
 
         // Pattern 1:
         // MUL v0, 1 -> v0
-        auto* const_instr = static_cast<jj_vm::ir::Instr*>(rval);
-        if (const_instr->opcode() == jj_vm::ir::Opcode::CONST &&
-            check_const_val<1>(const_instr)) {
+        if (is_const(rval) &&
+            check_const_val<1>(static_cast<jj_vm::ir::Instr*>(rval))) {
             lval->replace_users(instr);
             jj_vm::ir::erase(&instr);
+            return;
         }
     }
 
@@ -145,11 +93,11 @@ public:
 
         // Pattern 1, zero shift
         // SHR v0, 1 -> v0
-        auto* const_instr = static_cast<jj_vm::ir::Instr*>(rval);
-        if (const_instr->opcode() == jj_vm::ir::Opcode::CONST &&
-            check_const_val<0>(const_instr)) {
+        if (is_const(rval) &&
+            check_const_val<0>(static_cast<jj_vm::ir::Instr*>(rval))) {
             lval->replace_users(instr);
             jj_vm::ir::erase(&instr);
+            return;
         }
 
         // Pattern 2, commulative two sequantially shify
@@ -162,6 +110,35 @@ public:
         //! TODO: implementation in progress
     }
 
+    //
+    void process_select(jj_vm::ir::SelectInstr& instr) {
+        // Pattern 1, same arms
+        // SELECT c, v0, v0 -> v0
+        jj_vm::ir::Value* same = nullptr;
+        if (instr.true_val() == instr.false_val()) same = instr.true_val();
+
+        // Pattern 2, select of the flag
+        // SELECT i1 c, 1, 0 -> c
+        if (instr.type() == jj_vm::ir::TypeId::I1 &&
+            instr.cond()->type() == jj_vm::ir::TypeId::I1 &&
+            is_const(instr.true_val()) && is_const(instr.false_val()) &&
+            check_const_val<1>(
+                static_cast<jj_vm::ir::Instr*>(instr.true_val())) &&
+            check_const_val<0>(
+                static_cast<jj_vm::ir::Instr*>(instr.false_val())))
+            same = instr.cond();
+        //
+        if (same == nullptr) return;
+        same->replace_users(instr);
+        jj_vm::ir::erase(&instr);
+    }
+
+    static bool is_const(const jj_vm::ir::Value* val) {
+        return !val->is_param() &&
+               static_cast<const jj_vm::ir::Instr*>(val)->opcode() ==
+                   jj_vm::ir::Opcode::CONST;
+    }
+
     //
     void process_xor(jj_vm::ir::Instr& instr) {
         auto* lval = instr.get_input(0);
@@ -169,11 +146,11 @@ public:
 
         // Pattern 1:
         // XOR v0, 0 -> v0
-        auto* const_instr = static_cast<jj_vm::ir::Instr*>(rval);
-        if (const_instr->opcode() == jj_vm::ir::Opcode::CONST &&
-            check_const_val<0>(const_instr)) {
+        if (is_const(rval) &&
+            check_const_val<0>(static_cast<jj_vm::ir::Instr*>(rval))) {
             lval->replace_users(instr);
             jj_vm::ir::erase(&instr);
+            return;
         }
 
         // Pattern 2, same registers
@@ -185,18 +162,18 @@ public:
         // v1 = i64 1
         // XOR v0, v1 -> 0
 
-        auto* lval_instr = static_cast<jj_vm::ir::Instr*>(lval);
-        auto* rval_instr = static_cast<jj_vm::ir::Instr*>(rval);
-        bool both_const = lval_instr->opcode() == jj_vm::ir::Opcode::CONST &&
-                          rval_instr->opcode() == jj_vm::ir::Opcode::CONST;
+        bool both_const = is_const(lval) && is_const(rval);
         //
         bool is_equal_vals =
-            both_const && compare_const_val(lval_instr, rval_instr);
+            both_const &&
+            compare_const_val(static_cast<jj_vm::ir::Instr*>(lval),
+                              static_cast<jj_vm::ir::Instr*>(rval));
 
         if (lval == rval || is_equal_vals) {
-            std::unique_ptr<jj_vm::ir::Instr> const_zero{
-                new jj_vm::ir::Constant<int64_t>{0}};
-            instr.parent()->replace_instr(&instr, const_zero.release());
+            auto* func = instr.parent()->parent();
+            auto* const_zero = func->get_const(instr.type(), 0);
+            const_zero->replace_users(instr);
+            jj_vm::ir::erase(&instr);
         }
     }
 };
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+//
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+#include "analysis/alias_analysis.hh"
+#include "analysis/memory_ssa.hh"
+#include "pass_manager.hh"
+
+namespace jj_vm::passes {
+
+/**
+ * @brief Scalar replacement of allocs. Bytes of the local alloc are split
+ *        into slots by offsets of its loads & stores, every slot becomes
+ *        the SSA value:
+ *        - load takes the value of the reaching store of its slot
+ *        - phis are created on demand at the Memory SSA phis
+ *        - slot which isn't stored since the alloc is zero (the alloc in
+ *          the loop gives fresh memory on every iteration)
+ *        Stores, GEPs & null checks of the alloc (it is never null) are
+ *        erased with the alloc itself.
+ *
+ *        Alloc is replaced if its address doesn't escape, its size & all
+ *        offsets are constant, slots lie within the alloc & don't overlap,
+ *        accesses of the slot have the same type. Run it after Inlining:
+ *        allocs passed to inlined callees (e.g. constructors) don't escape
+ *        anymore
+ */
+class ScalarReplacement : Pass {
+public:
+    using MemoryAccess = jj_vm::analysis::memory::MemoryAccess;
+    using MemoryLocation = jj_vm::analysis::memory::MemoryLocation;
+
+private:
+    struct Slot final {
+        MemoryLocation m_loc{};
+        jj_vm::ir::TypeId m_type = jj_vm::ir::TypeId::NONE;
+        //! NOTE: memory phi -> phi of the slot value
+        std::unordered_map<const MemoryAccess*, jj_vm::ir::PhiInstr*>
+            m_phis{};
+        //! NOTE: memory phi -> the only value it merges
+        std::unordered_map<const MemoryAccess*, const MemoryAccess*>
+            m_folded{};
+    };
+
+    //! NOTE: instructions using the address of the alloc
+    struct Users final {
+        std::vector<jj_vm::ir::Instr*> m_loads{};
+        std::vector<jj_vm::ir::Instr*> m_stores{};
+        //! NOTE: GEPs & null checks, each one after its base
+        std::vector<jj_vm::ir::Instr*> m_addrs{};
+    };
+
+    jj_vm::ir::Function* m_func = nullptr;
+    const jj_vm::analysis::memory::MemorySSA* m_mssa = nullptr;
+    //! NOTE: the alloc being replaced
+    const jj_vm::ir::Instr* m_alloc = nullptr;
+    std::size_t m_replaced = 0;
+
+public:
+    void run(jj_vm::ir::Function* func) override {
+        if (func->empty()) return;
+        m_func = func;
+        const jj_vm::analysis::memory::AliasAnalysis aa{*func};
+        jj_vm::analysis::memory::MemorySSA mssa{*func};
+        m_mssa = &mssa;
+        //
+        for (auto* alloc : aa.escape().allocs())
+            if (!aa.escape().escapes(alloc) && replace(aa, mssa, alloc))
+                ++m_replaced;
+    }
+
+    /**
+     * @brief Getters
+     */
+    std::size_t replaced() const noexcept { return m_replaced; }
+
+private:
+    bool replace(const jj_vm::analysis::memory::AliasAnalysis& aa,
+                 jj_vm::analysis::memory::MemorySSA& mssa,
+                 jj_vm::ir::Instr* alloc) {
+        m_alloc = alloc;
+        auto users = collect(alloc);
+        std::vector<Slot> slots{};
+        for (auto* access : users.m_loads)
+            if (!add_slot(aa, mssa, *access, access->type(), slots))
+                return false;
+        for (auto* access : users.m_stores)
+            if (!add_slot(aa, mssa, *access, access->get_input(1)->type(),
+                          slots))
+                return false;
+        if (!are_disjoint(slots) || !fit(*alloc, slots)) return false;
+        //
+        for (auto* load : users.m_loads)
+            if (!collect_phis(aa, slot_of(aa, slots, *load),
+                              mssa.access(load)->defining()))
+                return false;
+        for (auto&& slot : slots)
+            if (!fold_phis(aa, slot)) return false;
+        for (auto&& slot : slots) create_phis(aa, slot);
+        //
+        for (auto* load : users.m_loads) {
+            auto* access = mssa.access(load);
+            auto& slot = slot_of(aa, slots, *load);
+            value_of(slot, source(aa, slot, access->defining()))
+                ->replace_users(*load);
+            mssa.remove(access);
+            jj_vm::ir::erase(load);
+        }
+        for (auto* store : users.m_stores) {
+            mssa.remove(mssa.access(store));
+            jj_vm::ir::erase(store);
+        }
+        std::for_each(users.m_addrs.rbegin(), users.m_addrs.rend(),
+                      [](auto* addr) { jj_vm::ir::erase(addr); });
+        jj_vm::ir::erase(alloc);
+        return true;
+    }
+
+    static Users collect(jj_vm::ir::Instr* alloc) {
+        Users users{};
+        std::vector<jj_vm::ir::Instr*> worklist{alloc};
+        while (!worklist.empty()) {
+            auto* ptr = worklist.back();
+            worklist.pop_back();
+            for (auto* user : ptr->users())
+                switch (user->opcode()) {
+                    case jj_vm::ir::Opcode::LOAD:
+                        users.m_loads.push_back(user);
+                        break;
+                    case jj_vm::ir::Opcode::STORE:
+                        users.m_stores.push_back(user);
+                        break;
+                    case jj_vm::ir::Opcode::GEP:
+                        worklist.push_back(user);
+                        [[fallthrough]];
+                    default:
+                        users.m_addrs.push_back(user);
+                        break;
+                }
+        }
+        return users;
+    }
+
+    //! NOTE: accesses of unreachable blocks aren't in Memory SSA
+    static bool add_slot(const jj_vm::analysis::memory::AliasAnalysis& aa,
+                         const jj_vm::analysis::memory::MemorySSA& mssa,
+                         const jj_vm::ir::Instr& access,
+                         jj_vm::ir::TypeId type, std::vector<Slot>& slots) {
+        auto loc = aa.location(access);
+        if (!loc.m_exact || mssa.access(&access) == nullptr) return false;
+        for (auto&& slot : slots)
+            if (slot.m_loc.m_offset == loc.m_offset)
+                return slot.m_type == type;
+        slots.push_back({loc, type});
+        return true;
+    }
+
+    static bool are_disjoint(std::vector<Slot>& slots) {
+        std::sort(slots.begin(), slots.end(),
+                  [](const Slot& lhs, const Slot& rhs) {
+                      return lhs.m_loc.m_offset < rhs.m_loc.m_offset;
+                  });
+        for (std::size_t idx = 1; idx < slots.size(); ++idx) {
+            const auto& prev = slots[idx - 1].m_loc;
+            if (prev.m_offset + static_cast<std::int64_t>(prev.m_size) >
+                slots[idx].m_loc.m_offset)
+                return false;
+        }
+        return true;
+    }
+
+    //! NOTE: slots are sorted, they must lie within [0, size) of the alloc
+    //!       of the constant size
+    static bool fit(const jj_vm::ir::Instr& alloc,
+                    const std::vector<Slot>& slots) {
+        const auto* size = alloc.get_input(0);
+        if (size->is_param()) return false;
+        const auto& instr = static_cast<const jj_vm::ir::Instr&>(*size);
+        if (instr.opcode() != jj_vm::ir::Opcode::CONST) return false;
+        if (slots.empty()) return true;
+        const auto& last = slots.back().m_loc;
+        return slots.front().m_loc.m_offset >= 0 &&
+               last.m_offset + static_cast<std::int64_t>(last.m_size) <=
+                   jj_vm::ir::const_value(instr);
+    }
+
+    static Slot& slot_of(const jj_vm::analysis::memory::AliasAnalysis& aa,
+                         std::vector<Slot>& slots,
+                         const jj_vm::ir::Instr& access) {
+        auto offset = aa.location(access).m_offset;
+        return *std::find_if(slots.begin(), slots.end(), [offset](auto& slot) {
+            return slot.m_loc.m_offset == offset;
+        });
+    }
+
+    /// Nearest access at or above the given one, which writes the slot.
+    /// States before the alloc are live on entry: the slot is fresh there
+    MemoryAccess* reaching(const jj_vm::analysis::memory::AliasAnalysis& aa,
+                           const Slot& slot, MemoryAccess* access) const {
+        while (!is_fresh(access) && access->is_def() &&
+               !aa.may_clobber(*access->instr(), slot.m_loc))
+            access = access->defining();
+        return is_fresh(access) ? m_mssa->live_on_entry() : access;
+    }
+
+    /// State which isn't dominated by the alloc
+    bool is_fresh(const MemoryAccess* access) const {
+        if (access->is_live_on_entry()) return true;
+        auto* alloc_bb = m_alloc->parent();
+        if (alloc_bb != access->block())
+            return !m_mssa->dom_tree().dominates(alloc_bb, access->block());
+        return access->is_phi() ||
+               !alloc_bb->comes_before(m_alloc, access->instr());
+    }
+
+    /// Memory phis reached from the state are recorded for the slot,
+    /// zero is the scalar constant only
+    bool collect_phis(const jj_vm::analysis::memory::AliasAnalysis& aa,
+                      Slot& slot, MemoryAccess* state) const {
+        std::vector<MemoryAccess*> worklist{state};
+        while (!worklist.empty()) {
+            auto* access = reaching(aa, slot, worklist.back());
+            worklist.pop_back();
+            if (access->is_live_on_entry() && !is_scalar(slot.m_type))
+                return false;
+            if (!access->is_phi() ||
+                !slot.m_phis.emplace(access, nullptr).second)
+                continue;
+            for (auto* incoming : access->incoming())
+                worklist.push_back(incoming);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Phis which merge the single value (besides themselves) are
+     *        folded to it. Remaining ones can't take params: phi inputs are
+     *        instructions
+     */
+    bool fold_phis(const jj_vm::analysis::memory::AliasAnalysis& aa,
+                   Slot& slot) const {
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (auto&& [mem_phi, phi] : slot.m_phis) {
+                if (slot.m_folded.count(mem_phi) != 0) continue;
+                const MemoryAccess* same = nullptr;
+                bool is_trivial = true;
+                for (auto* incoming : mem_phi->incoming()) {
+                    auto* src = source(aa, slot, incoming);
+                    if (src == mem_phi) continue;
+                    is_trivial = same == nullptr || is_same(same, src);
+                    if (!is_trivial) break;
+                    same = src;
+                }
+                if (!is_trivial || same == nullptr) continue;
+                slot.m_folded.emplace(mem_phi, same);
+                changed = true;
+            }
+        }
+        for (auto&& [mem_phi, phi] : slot.m_phis) {
+            if (slot.m_folded.count(mem_phi) != 0) continue;
+            for (auto* incoming : mem_phi->incoming()) {
+                auto* src = source(aa, slot, incoming);
+                if (src->is_def() && src->instr()->get_input(1)->is_param())
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void create_phis(const jj_vm::analysis::memory::AliasAnalysis& aa,
+                     Slot& slot) {
+        for (auto&& [mem_phi, phi] : slot.m_phis)
+            if (slot.m_folded.count(mem_phi) == 0) {
+                jj_vm::ir::IRBuilder builder{mem_phi->block()};
+                phi = builder.create<jj_vm::ir::PhiInstr>(slot.m_type);
+            }
+        for (auto&& [mem_phi, phi] : slot.m_phis) {
+            if (phi == nullptr) continue;
+            const auto& preds = mem_phi->block()->preds();
+            for (std::size_t idx = 0; idx < preds.size(); ++idx) {
+                auto* val = value_of(
+                    slot, source(aa, slot, mem_phi->incoming()[idx]));
+                phi->add_node(
+                    {static_cast<jj_vm::ir::Instr*>(val), preds[idx]});
+            }
+        }
+    }
+
+    /// Store, live on entry or not folded phi, which gives the value of
+    /// the slot at the state
+    const MemoryAccess* source(
+        const jj_vm::analysis::memory::AliasAnalysis& aa, const Slot& slot,
+        MemoryAccess* state) const {
+        const MemoryAccess* src = reaching(aa, slot, state);
+        for (auto found = slot.m_folded.find(src);
+             found != slot.m_folded.end(); found = slot.m_folded.find(src))
+            src = found->second;
+        return src;
+    }
+
+    static bool is_same(const MemoryAccess* lhs, const MemoryAccess* rhs) {
+        if (lhs == rhs) return true;
+        return lhs->is_def() && rhs->is_def() &&
+               lhs->instr()->get_input(1) == rhs->instr()->get_input(1);
+    }
+
+    jj_vm::ir::Value* value_of(const Slot& slot,
+                               const MemoryAccess* src) const {
+        if (src->is_live_on_entry()) return m_func->get_const(slot.m_type, 0);
+        if (src->is_phi()) return slot.m_phis.at(src);
+        return src->instr()->get_input(1);
+    }
+
+    static bool is_scalar(jj_vm::ir::TypeId type) noexcept {
+        return !jj_vm::ir::is_vector(type) && type != jj_vm::ir::TypeId::PTR;
+    }
+};
+
+}  // namespace jj_vm::passes
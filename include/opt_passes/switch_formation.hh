@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+//
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+#include "graph/dfs.hh"
+#include "pass_manager.hh"
+
+namespace jj_vm::passes {
+
+/**
+ * @brief Chains of compares of the same value with constants become
+ *        switches:
+ *            bb0: v2 = eq v0, 1; if v2, bb5, bb1
+ *            bb1: v3 = eq v0, 4; if v3, bb6, bb2
+ *            bb2: v4 = eq v0, 9; if v4, bb7, bb8
+ *        ->
+ *            bb0: switch v0, bb8, [1: bb5, 4: bb6, 9: bb7]
+ *        Blocks of the chain after the head have the single pred (previous
+ *        one) & only constants besides the compare, they are erased.
+ *        Constants are moved to the head.
+ *
+ *        Several edges of the chain could lead to the same target, then
+ *        its phis must take the same values from them: the switch jumps
+ *        there once. Chain is cut before the first repeated value
+ */
+class SwitchFormation : Pass {
+public:
+    static constexpr std::size_t kMinCases = 3;
+
+private:
+    //! NOTE: (target, source) of the edge leaving the chain
+    using Edge = std::pair<jj_vm::ir::BasicBlock*, jj_vm::ir::BasicBlock*>;
+
+    struct Chain final {
+        jj_vm::ir::Value* m_cond = nullptr;
+        //! NOTE: head is the first one
+        std::vector<jj_vm::ir::BasicBlock*> m_blocks{};
+        std::vector<jj_vm::ir::SwitchInstr::Case> m_cases{};
+    };
+
+    jj_vm::ir::Function* m_func = nullptr;
+    std::vector<const jj_vm::ir::BasicBlock*> m_taken{};
+    std::size_t m_min_cases = kMinCases;
+    std::size_t m_formed = 0;
+
+public:
+    explicit SwitchFormation(std::size_t min_cases = kMinCases)
+        : m_min_cases(min_cases) {}
+
+    void run(jj_vm::ir::Function* func) override {
+        if (func->empty()) return;
+        m_func = func;
+        //! NOTE: chains are disjoint & don't affect each other, so they are
+        //!       found before blocks are erased
+        std::vector<Chain> chains{};
+        m_taken.clear();
+        auto rpo =
+            jj_vm::graph::deep_first_search_reverse_postoder(func->bb_graph());
+        for (auto* bb : rpo) {
+            if (is_taken(bb)) continue;
+            auto chain = match(bb);
+            if (!chain.has_value()) continue;
+            m_taken.insert(m_taken.end(), chain->m_blocks.begin(),
+                           chain->m_blocks.end());
+            chains.push_back(std::move(*chain));
+        }
+        for (auto&& chain : chains) form(chain);
+        m_formed += chains.size();
+    }
+
+    /**
+     * @brief Getters
+     */
+    std::size_t formed() const noexcept { return m_formed; }
+
+private:
+    std::optional<Chain> match(jj_vm::ir::BasicBlock* head) const {
+        Chain chain{};
+        chain.m_blocks.push_back(head);
+        if (!add_case(chain, head)) return std::nullopt;
+        //
+        for (auto* bb = false_bb(head); is_link(chain, bb); bb = false_bb(bb))
+            if (!add_case(chain, bb)) break;
+        //
+        //! NOTE: the shorter chain could be still formed
+        while (chain.m_cases.size() >= m_min_cases && !are_phis_equal(chain)) {
+            chain.m_blocks.pop_back();
+            chain.m_cases.pop_back();
+        }
+        if (chain.m_cases.size() < m_min_cases) return std::nullopt;
+        return chain;
+    }
+
+    /// Compare of the block is appended to the chain
+    bool add_case(Chain& chain, jj_vm::ir::BasicBlock* bb) const {
+        auto* cmp = compare(bb);
+        if (cmp == nullptr) return false;
+        //
+        auto* lhs = cmp->get_input(0);
+        auto* rhs = cmp->get_input(1);
+        if (is_const(lhs)) std::swap(lhs, rhs);
+        if (is_const(lhs) || !is_const(rhs)) return false;
+        if (chain.m_cond == nullptr) chain.m_cond = lhs;
+        if (chain.m_cond != lhs) return false;
+        //
+        auto* val = static_cast<jj_vm::ir::Instr*>(rhs);
+        for (auto&& [prev, target] : chain.m_cases)
+            if (jj_vm::ir::const_value(*prev) ==
+                jj_vm::ir::const_value(*val))
+                return false;
+        if (bb != chain.m_blocks.front()) chain.m_blocks.push_back(bb);
+        chain.m_cases.emplace_back(val, true_bb(bb));
+        return true;
+    }
+
+    /// Block after the head: the single pred & only constants besides the
+    /// compare, which is used by the if only
+    bool is_link(const Chain& chain, jj_vm::ir::BasicBlock* bb) const {
+        if (bb->preds_num() != 1 || bb == chain.m_blocks.front() ||
+            is_taken(bb) || compare(bb) == nullptr)
+            return false;
+        auto* cmp = compare(bb);
+        if (cmp->users().size() != 1) return false;
+        for (auto&& instr : *bb)
+            if (&instr != cmp && &instr != &bb->back() &&
+                instr.opcode() != jj_vm::ir::Opcode::CONST)
+                return false;
+        return true;
+    }
+
+    /// EQ, which is the condition of the terminator
+    jj_vm::ir::Instr* compare(jj_vm::ir::BasicBlock* bb) const {
+        if (bb->back().opcode() != jj_vm::ir::Opcode::IF) return nullptr;
+        const auto& term = static_cast<const jj_vm::ir::IfInstr&>(bb->back());
+        if (term.true_bb() == term.false_bb() || term.cond()->is_param())
+            return nullptr;
+        auto* cmp = static_cast<jj_vm::ir::Instr*>(term.cond());
+        return cmp->opcode() == jj_vm::ir::Opcode::EQ ? cmp : nullptr;
+    }
+
+    /// Target reached from several edges of the chain takes the same values
+    static bool are_phis_equal(const Chain& chain) {
+        auto edges = edges_of(chain);
+        for (auto it = edges.begin(); it != edges.end(); ++it)
+            for (auto prev = edges.begin(); prev != it; ++prev) {
+                if (prev->first != it->first) continue;
+                for (auto&& phi : it->first->phis()) {
+                    const auto& phi_instr =
+                        static_cast<const jj_vm::ir::PhiInstr&>(phi);
+                    if (phi_instr.incoming(prev->second) !=
+                        phi_instr.incoming(it->second))
+                        return false;
+                }
+            }
+        return true;
+    }
+
+    /// Edges of cases & the default one
+    static std::vector<Edge> edges_of(const Chain& chain) {
+        std::vector<Edge> edges{};
+        for (std::size_t idx = 0; idx < chain.m_blocks.size(); ++idx)
+            edges.emplace_back(chain.m_cases[idx].second, chain.m_blocks[idx]);
+        edges.emplace_back(false_bb(chain.m_blocks.back()),
+                           chain.m_blocks.back());
+        return edges;
+    }
+
+    void form(const Chain& chain) {
+        auto* head = chain.m_blocks.front();
+        auto edges = edges_of(chain);
+        auto* default_bb = edges.back().first;
+        //
+        for (auto* bb : chain.m_blocks) {
+            auto succs = bb->succs();
+            for (auto* succ : succs)
+                jj_vm::ir::BasicBlock::remove_link(succ, bb);
+        }
+        auto* head_cmp = compare(head);
+        jj_vm::ir::erase(&head->back());
+        if (!head_cmp->has_users()) jj_vm::ir::erase(head_cmp);
+        //
+        for (auto it = std::next(chain.m_blocks.begin());
+             it != chain.m_blocks.end(); ++it) {
+            auto* bb = *it;
+            auto* cmp = compare(bb);
+            jj_vm::ir::erase(&bb->back());
+            jj_vm::ir::erase(cmp);
+            head->splice(head->end(), bb->begin(), bb->end());
+            m_func->erase(bb);
+        }
+        //
+        jj_vm::ir::IRBuilder builder{head};
+        auto* term = builder.create<jj_vm::ir::SwitchInstr>(
+            chain.m_cond, default_bb, chain.m_cases);
+        for (auto* succ : term->succs()) {
+            std::vector<jj_vm::ir::BasicBlock*> sources{};
+            for (auto&& [target, src] : edges)
+                if (target == succ) sources.push_back(src);
+            jj_vm::ir::redirect_phis(succ, sources, {head});
+        }
+    }
+
+    static jj_vm::ir::BasicBlock* true_bb(const jj_vm::ir::BasicBlock* bb) {
+        return static_cast<const jj_vm::ir::IfInstr&>(bb->back()).true_bb();
+    }
+
+    static jj_vm::ir::BasicBlock* false_bb(const jj_vm::ir::BasicBlock* bb) {
+        return static_cast<const jj_vm::ir::IfInstr&>(bb->back()).false_bb();
+    }
+
+    bool is_taken(const jj_vm::ir::BasicBlock* bb) const {
+        return std::find(m_taken.begin(), m_taken.end(), bb) != m_taken.end();
+    }
+
+    static bool is_const(const jj_vm::ir::Value* val) {
+        return !val->is_param() &&
+               static_cast<const jj_vm::ir::Instr*>(val)->opcode() ==
+                   jj_vm::ir::Opcode::CONST;
+    }
+};
+
+}  // namespace jj_vm::passes
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+//
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+#include "pass_manager.hh"
+
+namespace jj_vm::passes {
+
+enum class SwitchStrategy : std::uint8_t {
+    JUMP_TABLE,
+    BIT_TESTS,
+    BINARY_SEARCH
+};
+
+/**
+ * @brief Lowering of switches by the density of cases (ones jumping to the
+ *        default are ignored):
+ *        - bit tests: cases lie in 64 values & go to few targets, every
+ *          target has the mask of its cases, which is shifted by the offset
+ *          of the condition from the lowest case
+ *        - jump table: many cases fill at least kMinDensity percent of
+ *          their range, the switch is kept, jump_table() gives the table
+ *          for the backend: the IR has no indirect branch
+ *        - binary search: the range of sorted cases is split by "le" until
+ *          few cases are left, they are checked by the chain of "eq"
+ *        O(log(cases)) compares instead of O(cases) of the chain
+ */
+class SwitchLowering : Pass {
+public:
+    using Case = jj_vm::ir::SwitchInstr::Case;
+
+    /// Target of the condition value v is m_targets[v - m_min]
+    struct JumpTable final {
+        std::int64_t m_min = 0;
+        std::vector<jj_vm::ir::BasicBlock*> m_targets{};
+    };
+
+    static constexpr std::size_t kMinTableCases = 4;
+    static constexpr std::uint64_t kMinDensity = 40;
+    static constexpr std::size_t kMinBitTestCases = 3;
+    static constexpr std::size_t kMaxBitTestTargets = 3;
+    static constexpr std::uint64_t kBitTestRange = 64;
+    static constexpr std::size_t kMaxLinearCases = 3;
+
+private:
+    //! NOTE: (target, source) of the edge created by the lowering
+    using Edge = std::pair<jj_vm::ir::BasicBlock*, jj_vm::ir::BasicBlock*>;
+    using CaseIt = std::vector<Case>::const_iterator;
+
+    jj_vm::ir::Function* m_func = nullptr;
+    jj_vm::ir::Value* m_cond = nullptr;
+    //! NOTE: new blocks are placed before it, after the switch block
+    jj_vm::ir::Function::iterator m_pos{};
+    std::vector<Edge> m_edges{};
+    std::size_t m_lowered = 0;
+    std::size_t m_tables = 0;
+
+public:
+    void run(jj_vm::ir::Function* func) override {
+        if (func->empty()) return;
+        m_func = func;
+        std::vector<jj_vm::ir::BasicBlock*> switches{};
+        for (auto&& bb : *func)
+            if (bb.back().opcode() == jj_vm::ir::Opcode::SWITCH)
+                switches.push_back(&bb);
+        //
+        for (auto* bb : switches) {
+            const auto& term =
+                static_cast<const jj_vm::ir::SwitchInstr&>(bb->back());
+            if (choose(term) == SwitchStrategy::JUMP_TABLE) {
+                ++m_tables;
+                continue;
+            }
+            lower(bb);
+            ++m_lowered;
+        }
+    }
+
+    static SwitchStrategy choose(const jj_vm::ir::SwitchInstr& term) {
+        auto cases = sorted_cases(term);
+        if (cases.empty()) return SwitchStrategy::BINARY_SEARCH;
+        auto range = range_of(cases);
+        //
+        std::vector<const jj_vm::ir::BasicBlock*> targets{};
+        for (auto&& [val, target] : cases)
+            if (std::find(targets.begin(), targets.end(), target) ==
+                targets.end())
+                targets.push_back(target);
+        if (range <= kBitTestRange && cases.size() >= kMinBitTestCases &&
+            targets.size() <= kMaxBitTestTargets)
+            return SwitchStrategy::BIT_TESTS;
+        //! NOTE: cases * 100 >= range * density without overflow
+        if (cases.size() >= kMinTableCases &&
+            cases.size() * 100 / kMinDensity >= range)
+            return SwitchStrategy::JUMP_TABLE;
+        return SwitchStrategy::BINARY_SEARCH;
+    }
+
+    static JumpTable jump_table(const jj_vm::ir::SwitchInstr& term) {
+        assert(choose(term) == SwitchStrategy::JUMP_TABLE &&
+               "Error: cases of the switch are sparse");
+        auto cases = sorted_cases(term);
+        JumpTable table{value(cases.front())};
+        table.m_targets.assign(range_of(cases), term.default_bb());
+        for (auto&& cur : cases)
+            table.m_targets[offset(value(cur), table.m_min)] = cur.second;
+        return table;
+    }
+
+    /**
+     * @brief Getters
+     */
+    std::size_t lowered() const noexcept { return m_lowered; }
+    std::size_t tables() const noexcept { return m_tables; }
+
+private:
+    /// Cases which don't jump to the default, sorted by values
+    static std::vector<Case> sorted_cases(const jj_vm::ir::SwitchInstr& term) {
+        std::vector<Case> cases{};
+        for (std::size_t idx = 0; idx < term.cases_num(); ++idx)
+            if (term.case_target(idx) != term.default_bb())
+                cases.emplace_back(
+                    static_cast<jj_vm::ir::Instr*>(term.get_input(idx + 1)),
+                    term.case_target(idx));
+        std::sort(cases.begin(), cases.end(),
+                  [](const Case& lhs, const Case& rhs) {
+                      return value(lhs) < value(rhs);
+                  });
+        return cases;
+    }
+
+    static std::int64_t value(const Case& cur) {
+        return jj_vm::ir::const_value(*cur.first);
+    }
+
+    static std::uint64_t offset(std::int64_t val, std::int64_t min) {
+        return static_cast<std::uint64_t>(val) -
+               static_cast<std::uint64_t>(min);
+    }
+
+    //! NOTE: the full 64-bit range wraps to zero, it is the largest one
+    static std::uint64_t range_of(const std::vector<Case>& cases) {
+        auto range = offset(value(cases.back()), value(cases.front())) + 1;
+        return range == 0 ? UINT64_MAX : range;
+    }
+
+    void lower(jj_vm::ir::BasicBlock* bb) {
+        const auto& term =
+            static_cast<const jj_vm::ir::SwitchInstr&>(bb->back());
+        auto strategy = choose(term);
+        auto cases = sorted_cases(term);
+        auto* default_bb = term.default_bb();
+        auto succs = term.succs();
+        m_cond = term.cond();
+        m_pos = std::next(jj_vm::ir::Function::iterator{bb});
+        m_edges.clear();
+        //
+        for (auto* succ : succs) jj_vm::ir::BasicBlock::remove_link(succ, bb);
+        jj_vm::ir::erase(&bb->back());
+        if (strategy == SwitchStrategy::BIT_TESTS)
+            bit_tests(bb, cases, default_bb);
+        else
+            binary_search(bb, cases.begin(), cases.end(), default_bb);
+        //
+        //! NOTE: phis of targets take the values of the switch on new edges
+        for (auto* succ : succs) {
+            std::vector<jj_vm::ir::BasicBlock*> sources{};
+            for (auto&& [target, src] : m_edges)
+                if (target == succ) sources.push_back(src);
+            jj_vm::ir::redirect_phis(succ, {bb}, sources);
+        }
+    }
+
+    void binary_search(jj_vm::ir::BasicBlock* bb, CaseIt first, CaseIt last,
+                       jj_vm::ir::BasicBlock* default_bb) {
+        jj_vm::ir::IRBuilder builder{bb};
+        auto num = static_cast<std::size_t>(std::distance(first, last));
+        if (num == 0) {
+            builder.create<jj_vm::ir::BranchInstr>(default_bb);
+            m_edges.emplace_back(default_bb, bb);
+            return;
+        }
+        if (num <= kMaxLinearCases) {
+            for (auto it = first; it != last; ++it) {
+                auto* next = std::next(it) == last ? default_bb : create_bb();
+                auto* cmp = builder.create<jj_vm::ir::BinInstr>(
+                    jj_vm::ir::Opcode::EQ, m_cond, it->first);
+                builder.create<jj_vm::ir::IfInstr>(it->second, next, cmp);
+                m_edges.emplace_back(it->second, bb);
+                m_edges.emplace_back(next, bb);
+                bb = next;
+                builder.set_insert_point(next);
+            }
+            return;
+        }
+        //! NOTE: the left half takes values up to its last case
+        auto mid = std::next(first, static_cast<std::ptrdiff_t>(num / 2));
+        auto* left = create_bb();
+        auto* right = create_bb();
+        auto* cmp = builder.create<jj_vm::ir::BinInstr>(
+            jj_vm::ir::Opcode::LE, m_cond, std::prev(mid)->first);
+        builder.create<jj_vm::ir::IfInstr>(left, right, cmp);
+        binary_search(left, first, mid, default_bb);
+        binary_search(right, mid, last, default_bb);
+    }
+
+    /**
+     * @brief Range of cases is checked, then bits of masks are tested:
+     *            idx = sub i64 (cast i64 cond), lo
+     *            bit = cast i1 (shr i64 mask, idx)
+     *        Cast to i1 truncates, so the bit 0 is taken
+     */
+    void bit_tests(jj_vm::ir::BasicBlock* bb, const std::vector<Case>& cases,
+                   jj_vm::ir::BasicBlock* default_bb) {
+        using jj_vm::ir::Opcode;
+        using jj_vm::ir::TypeId;
+        //
+        std::vector<std::pair<jj_vm::ir::BasicBlock*, std::uint64_t>> masks{};
+        auto lo = value(cases.front());
+        for (auto&& cur : cases) {
+            auto found = std::find_if(
+                masks.begin(), masks.end(),
+                [&cur](const auto& mask) { return mask.first == cur.second; });
+            if (found == masks.end())
+                found = masks.insert(masks.end(), {cur.second, 0});
+            found->second |= std::uint64_t{1} << offset(value(cur), lo);
+        }
+        //
+        jj_vm::ir::IRBuilder builder{bb};
+        auto* in_range = create_bb();
+        auto* tests = create_bb();
+        builder.create<jj_vm::ir::IfInstr>(
+            in_range, default_bb,
+            builder.create<jj_vm::ir::BinInstr>(Opcode::GE, m_cond,
+                                                cases.front().first));
+        builder.set_insert_point(in_range);
+        builder.create<jj_vm::ir::IfInstr>(
+            tests, default_bb,
+            builder.create<jj_vm::ir::BinInstr>(Opcode::LE, m_cond,
+                                                cases.back().first));
+        m_edges.emplace_back(default_bb, bb);
+        m_edges.emplace_back(default_bb, in_range);
+        //
+        builder.set_insert_point(tests);
+        auto* cond = m_cond;
+        if (cond->type() != TypeId::I64)
+            cond = builder.create<jj_vm::ir::CastInstr>(
+                jj_vm::ir::Type{TypeId::I64}, cond);
+        auto* idx = builder.create<jj_vm::ir::BinInstr>(
+            Opcode::SUB, cond, m_func->get_const(TypeId::I64, lo));
+        for (auto it = masks.begin(); it != masks.end(); ++it) {
+            auto* next =
+                std::next(it) == masks.end() ? default_bb : create_bb();
+            auto* bits = builder.create<jj_vm::ir::BinInstr>(
+                Opcode::SHR,
+                m_func->get_const(TypeId::I64,
+                                  static_cast<std::int64_t>(it->second)),
+                idx);
+            auto* bit = builder.create<jj_vm::ir::CastInstr>(
+                jj_vm::ir::Type{TypeId::I1}, bits);
+            builder.create<jj_vm::ir::IfInstr>(it->first, next, bit);
+            m_edges.emplace_back(it->first, tests);
+            m_edges.emplace_back(next, tests);
+            tests = next;
+            builder.set_insert_point(next);
+        }
+    }
+
+    jj_vm::ir::BasicBlock* create_bb() {
+        auto* bb = m_func->create<jj_vm::ir::BasicBlock>();
+        m_func->move(m_pos, bb);
+        return bb;
+    }
+};
+
+}  // namespace jj_vm::passes
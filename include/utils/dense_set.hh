@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "side_table.hh"
+
+namespace jj_vm::utils {
+
+/**
+ * @brief Set of IR entities with dense ids (see SideTableTraits), it keeps
+ *        the bit per id in contiguous words: 64 blocks per cache word
+ *        instead of the slot per block of SideTable<Key, bool>.
+ *        Ids beyond the capacity are absent, insertion grows the set
+ *
+ * @tparam Key - pointer to entity with dense id
+ */
+template <typename Key, typename Traits = SideTableTraits<Key>>
+class DenseSet final {
+public:
+    using key_type = Key;
+    using size_type = std::size_t;
+
+private:
+    static constexpr size_type kWordBits = 64;
+
+    std::vector<std::uint64_t> m_words{};
+
+public:
+    DenseSet() = default;
+    explicit DenseSet(size_type capacity) { reserve(capacity); }
+
+    /**
+     * @brief Preallocate bits for keys with index less than capacity
+     */
+    void reserve(size_type capacity) {
+        auto words = (capacity + kWordBits - 1) / kWordBits;
+        if (words > m_words.size()) m_words.resize(words);
+    }
+
+    /**
+     * @brief Lookup & modifiers. O(1) (amortized for insertion)
+     */
+    bool contains(Key key) const noexcept {
+        auto idx = Traits::index(key);
+        auto word = idx / kWordBits;
+        return word < m_words.size() &&
+               ((m_words[word] >> idx % kWordBits) & 1);
+    }
+
+    void insert(Key key) {
+        auto idx = Traits::index(key);
+        reserve(idx + 1);
+        m_words[idx / kWordBits] |= std::uint64_t{1} << idx % kWordBits;
+    }
+
+    void erase(Key key) noexcept {
+        auto idx = Traits::index(key);
+        auto word = idx / kWordBits;
+        if (word < m_words.size())
+            m_words[word] &= ~(std::uint64_t{1} << idx % kWordBits);
+    }
+
+    void clear() noexcept { m_words.assign(m_words.size(), 0); }
+};
+
+}  // namespace jj_vm::utils
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+namespace jj_vm::utils {
+
+/**
+ * @brief Non-owning pair of iterators usable in range-based for loops
+ *
+ * @tparam IteratorTy
+ */
+template <typename IteratorTy>
+class IteratorRange final {
+    IteratorTy m_begin{};
+    IteratorTy m_end{};
+
+public:
+    using iterator = IteratorTy;
+
+    IteratorRange() = default;
+    IteratorRange(IteratorTy begin, IteratorTy end)
+        : m_begin(std::move(begin)), m_end(std::move(end)) {}
+
+    iterator begin() const { return m_begin; }
+    iterator end() const { return m_end; }
+
+    bool empty() const { return m_begin == m_end; }
+
+    //! NOTE: O(n) for non random access iterators
+    std::size_t size() const {
+        return static_cast<std::size_t>(std::distance(m_begin, m_end));
+    }
+};
+
+template <typename IteratorTy>
+auto make_range(IteratorTy begin, IteratorTy end) {
+    return IteratorRange<IteratorTy>{std::move(begin), std::move(end)};
+}
+
+}  // namespace jj_vm::utils
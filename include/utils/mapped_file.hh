@@ -0,0 +1,84 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace jj_vm::utils {
+
+/**
+ * @brief Read-only memory mapped file (POSIX).
+ *        Content is paged in lazily by the kernel, nothing is copied into
+ *        user buffers
+ */
+class MappedFile final {
+    void* m_data = nullptr;
+    std::size_t m_size = 0;
+
+public:
+    MappedFile() = default;
+
+    /// Throws std::system_error if the file can't be mapped
+    explicit MappedFile(const std::filesystem::path& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw_error("open " + path.string());
+        //
+        struct stat st {};
+        if (::fstat(fd, &st) < 0) {
+            ::close(fd);
+            throw_error("fstat " + path.string());
+        }
+        //
+        m_size = static_cast<std::size_t>(st.st_size);
+        //! NOTE: mmap of zero length is an error, empty file is an empty view
+        if (m_size != 0) {
+            m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m_data == MAP_FAILED) {
+                m_data = nullptr;
+                ::close(fd);
+                throw_error("mmap " + path.string());
+            }
+            //! NOTE: parsers read the file front to back
+            ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)),
+          m_size(std::exchange(other.m_size, 0)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        return *this;
+    }
+
+    ~MappedFile() {
+        if (m_data != nullptr) ::munmap(m_data, m_size);
+    }
+
+    std::string_view view() const noexcept {
+        return {static_cast<const char*>(m_data), m_size};
+    }
+
+    std::size_t size() const noexcept { return m_size; }
+
+private:
+    [[noreturn]] static void throw_error(const std::string& what) {
+        throw std::system_error{errno, std::generic_category(), what};
+    }
+};
+
+}  // namespace jj_vm::utils
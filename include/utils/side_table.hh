@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jj_vm::utils {
+
+/**
+ * @brief Mapping of the key to its dense index.
+ *        By default key is a pointer to IR entity with dense per-function id
+ *        (ir::Value::id(), ir::BasicBlock::id())
+ *
+ * @tparam Key
+ */
+template <typename Key>
+struct SideTableTraits final {
+    static_assert(std::is_pointer_v<Key>, "Error: pointer key is expected");
+
+    static std::size_t index(Key key) noexcept {
+        return static_cast<std::size_t>(key->id());
+    }
+};
+
+/**
+ * @brief Associative container for analyses data attached to IR entities.
+ *        It is backed by contiguous vector indexed by dense id of the key, so
+ *        lookup is a plain array access. Interface mimics std::unordered_map,
+ *        iteration yields std::pair<const Key, T>& in the index order.
+ *
+ *        NOTE: nullptr key marks an empty slot
+ *
+ * @tparam Key - pointer to entity with dense id
+ * @tparam T - mapped type
+ */
+template <typename Key, typename T, typename Traits = SideTableTraits<Key>>
+class SideTable final {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = std::size_t;
+
+private:
+    //! NOTE: slot keeps key to check presence and to provide map-like
+    //!       iteration
+    struct Slot final {
+        value_type m_kv{nullptr, T{}};
+        //
+        Slot() = default;
+        Slot(Key key, T val) : m_kv(key, std::move(val)) {}
+        //
+        Slot(const Slot&) = default;
+        Slot(Slot&& other) = default;
+        //
+        Slot& operator=(const Slot& other) {
+            if (this != &other) reset(other.m_kv.first, other.m_kv.second);
+            return *this;
+        }
+        Slot& operator=(Slot&& other) noexcept(
+            std::is_nothrow_move_assignable_v<T>) {
+            if (this != &other)
+                reset(other.m_kv.first, std::move(other.m_kv.second));
+            return *this;
+        }
+        //
+        template <typename U>
+        void reset(Key key, U&& val) {
+            const_cast<Key&>(m_kv.first) = key;
+            m_kv.second = std::forward<U>(val);
+        }
+
+        bool empty() const noexcept { return m_kv.first == nullptr; }
+    };
+
+    std::vector<Slot> m_slots{};
+    size_type m_size = 0;
+
+    template <bool IsConst>
+    class IteratorImpl final {
+    public:
+        using value_type = typename SideTable::value_type;
+        using reference =
+            std::conditional_t<IsConst, const value_type&, value_type&>;
+        using pointer =
+            std::conditional_t<IsConst, const value_type*, value_type*>;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+    private:
+        using slot_pointer = std::conditional_t<IsConst, const Slot*, Slot*>;
+        //
+        slot_pointer m_cur = nullptr;
+        slot_pointer m_end = nullptr;
+
+        void skip_empty() noexcept {
+            while (m_cur != m_end && m_cur->empty()) ++m_cur;
+        }
+
+    public:
+        IteratorImpl() = default;
+        IteratorImpl(slot_pointer cur, slot_pointer end)
+            : m_cur(cur), m_end(end) {
+            skip_empty();
+        }
+
+        //! NOTE: iterator -> const_iterator conversion
+        template <bool OtherConst,
+                  typename = std::enable_if_t<IsConst && !OtherConst>>
+        IteratorImpl(const IteratorImpl<OtherConst>& other)
+            : m_cur(other.m_cur), m_end(other.m_end) {}
+
+        reference operator*() const noexcept { return m_cur->m_kv; }
+        pointer operator->() const noexcept { return &m_cur->m_kv; }
+
+        IteratorImpl& operator++() noexcept {
+            ++m_cur;
+            skip_empty();
+            return *this;
+        }
+        IteratorImpl operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        friend bool operator==(const IteratorImpl& lhs,
+                               const IteratorImpl& rhs) noexcept {
+            return lhs.m_cur == rhs.m_cur;
+        }
+        friend bool operator!=(const IteratorImpl& lhs,
+                               const IteratorImpl& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        friend IteratorImpl<!IsConst>;
+    };
+
+public:
+    using iterator = IteratorImpl<false>;
+    using const_iterator = IteratorImpl<true>;
+
+    SideTable() = default;
+    explicit SideTable(size_type capacity) { reserve(capacity); }
+
+    /**
+     * @brief Preallocate slots for keys with index less than capacity
+     *        (e.g. Function::values_num())
+     */
+    void reserve(size_type capacity) {
+        if (capacity > m_slots.size()) m_slots.resize(capacity);
+    }
+
+    /**
+     * @brief Iterators
+     */
+    iterator begin() noexcept { return iterator{m_slots.data(), slots_end()}; }
+    const_iterator begin() const noexcept {
+        return const_iterator{m_slots.data(), slots_end()};
+    }
+
+    iterator end() noexcept { return iterator{slots_end(), slots_end()}; }
+    const_iterator end() const noexcept {
+        return const_iterator{slots_end(), slots_end()};
+    }
+
+    /**
+     * @brief Capacity
+     */
+    size_type size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+
+    /**
+     * @brief Lookup. O(1)
+     */
+    iterator find(Key key) noexcept {
+        auto* slot = get_slot(key);
+        return slot ? iterator{slot, slots_end()} : end();
+    }
+    const_iterator find(Key key) const noexcept {
+        const auto* slot = get_slot(key);
+        return slot ? const_iterator{slot, slots_end()} : end();
+    }
+
+    bool contains(Key key) const noexcept { return get_slot(key) != nullptr; }
+    size_type count(Key key) const noexcept { return contains(key) ? 1 : 0; }
+
+    T& at(Key key) {
+        auto* slot = get_slot(key);
+        if (slot == nullptr) throw std::out_of_range{"SideTable::at"};
+        return slot->m_kv.second;
+    }
+    const T& at(Key key) const {
+        const auto* slot = get_slot(key);
+        if (slot == nullptr) throw std::out_of_range{"SideTable::at"};
+        return slot->m_kv.second;
+    }
+
+    /**
+     * @brief Modifiers. O(1) amortized
+     */
+    T& operator[](Key key) { return try_emplace(key).first->second; }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(Key key, Args&&... args) {
+        assert(key != nullptr && "Error: nullptr key in side table");
+        //
+        auto idx = Traits::index(key);
+        if (idx >= m_slots.size()) m_slots.resize(grow_size(idx));
+        //
+        auto* slot = &m_slots[idx];
+        assert((slot->empty() || slot->m_kv.first == key) &&
+               "Error: slot is taken by another key, ids are renumbered");
+        bool inserted = slot->empty();
+        if (inserted) {
+            slot->reset(key, T{std::forward<Args>(args)...});
+            ++m_size;
+        }
+        return {iterator{slot, slots_end()}, inserted};
+    }
+
+    std::pair<iterator, bool> insert(const std::pair<Key, T>& kv) {
+        return try_emplace(kv.first, kv.second);
+    }
+
+    std::pair<iterator, bool> insert(std::pair<Key, T>&& kv) {
+        return try_emplace(kv.first, std::move(kv.second));
+    }
+
+    size_type erase(Key key) {
+        auto* slot = get_slot(key);
+        if (slot == nullptr) return 0;
+        //
+        slot->reset(nullptr, T{});
+        --m_size;
+        return 1;
+    }
+
+    void clear() {
+        m_slots.clear();
+        m_size = 0;
+    }
+
+private:
+    Slot* slots_end() noexcept { return m_slots.data() + m_slots.size(); }
+    const Slot* slots_end() const noexcept {
+        return m_slots.data() + m_slots.size();
+    }
+
+    Slot* get_slot(Key key) noexcept {
+        return const_cast<Slot*>(std::as_const(*this).get_slot(key));
+    }
+
+    const Slot* get_slot(Key key) const noexcept {
+        if (key == nullptr) return nullptr;
+        //
+        auto idx = Traits::index(key);
+        if (idx >= m_slots.size()) return nullptr;
+        //
+        //! NOTE: slot may be kept for another key after ids are reused or
+        //!       renumbered, empty slot has nullptr key
+        const auto* slot = &m_slots[idx];
+        return slot->m_kv.first == key ? slot : nullptr;
+    }
+
+    size_type grow_size(size_type idx) const noexcept {
+        return std::max(idx + 1, m_slots.size() * 2);
+    }
+};
+
+}  // namespace jj_vm::utils
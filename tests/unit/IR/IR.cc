@@ -39,6 +39,7 @@ TEST(fib, init) {
         //! NOTE: fib function verification
         ASSERT_EQ(fib_func->name(), "fib");
         ASSERT_EQ(v0->type(), jj_vm::ir::TypeId::I32);
+        ASSERT_TRUE(v0->is_param());
         //
         ASSERT_EQ(fib_func->front().bb_id(), 0);
         ASSERT_EQ(fib_func->back().bb_id(), 3);
@@ -108,9 +109,11 @@ TEST(fib, init) {
 
     //   bb1:
     //     v3 = phi i32 [v2, bb0], [v7, bb2]
-    //     v4 = cmp le v3, v0
     //     v5 = phi i64 [v1, bb0], [v9, bb2]
+    //     v4 = cmp le v3, v0
     //     if v4, bb2, bb3
+    //
+    //   NOTE: phis are placed before v4, they are the prefix of the block
 
     builder.set_insert_point(bb1);
 
@@ -119,6 +122,7 @@ TEST(fib, init) {
 
     //! NOTE: cmp le
     auto* v4 = builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::LE, v3, v0);
+    ASSERT_FALSE(v4->is_param());
     //
     //! NOTE: phi i64 def, not init
     auto* v5 = builder.create<jj_vm::ir::PhiInstr>(jj_vm::ir::TypeId::I64);
@@ -131,13 +135,15 @@ TEST(fib, init) {
         ASSERT_EQ(v5->parent(), bb1);
         ASSERT_EQ(if_v4->parent(), bb1);
         //
-        ASSERT_EQ(v3->get_next(), v4);
-        ASSERT_EQ(v4->get_next(), v5);
-        ASSERT_EQ(v5->get_next(), if_v4);
+        ASSERT_EQ(v3->get_next(), v5);
+        ASSERT_EQ(v5->get_next(), v4);
+        ASSERT_EQ(v4->get_next(), if_v4);
         //
-        ASSERT_EQ(v4->get_prev(), v3);
-        ASSERT_EQ(v5->get_prev(), v4);
-        ASSERT_EQ(if_v4->get_prev(), v5);
+        ASSERT_EQ(v5->get_prev(), v3);
+        ASSERT_EQ(v4->get_prev(), v5);
+        ASSERT_EQ(if_v4->get_prev(), v4);
+        //
+        ASSERT_EQ(bb1->phis_end(), BasicBlock::iterator{v4});
         //
         ASSERT_EQ(v3->type(), jj_vm::ir::TypeId::I32);
         ASSERT_EQ(v5->type(), jj_vm::ir::TypeId::I64);
@@ -208,4 +214,30 @@ TEST(fib, init) {
 
 }
 
+TEST(constant_pool, canonical_nodes) {
+    Function func{Type::create<TypeId::I64>(), "pool"};
+    IRBuilder builder{};
+    auto* bb0 = func.create<BasicBlock>();
+    auto* bb1 = func.create<BasicBlock>();
+    builder.set_insert_point(bb1);
+    //
+    auto* one = builder.get_const<int64_t>(1);
+    ASSERT_EQ(one, builder.get_const<int64_t>(1));
+    ASSERT_EQ(one, func.get_const(TypeId::I64, 1));
+    ASSERT_NE(static_cast<Instr*>(one), func.get_const(TypeId::I32, 1));
+    ASSERT_EQ(func.consts().size(), 2);
+    //
+    //! NOTE: pooled constants live at the head of the entry block
+    ASSERT_EQ(one->parent(), bb0);
+    ASSERT_TRUE(bb1->empty());
+    //
+    //! NOTE: erased canonical node is dropped from the pool
+    erase(one);
+    ASSERT_EQ(func.consts().size(), 1);
+    auto* new_one = func.get_const<int64_t>(1);
+    ASSERT_EQ(func.consts().size(), 2);
+    ASSERT_EQ(&bb0->front(), new_one);
+    ASSERT_EQ(bb0->size(), 2);
+}
+
 }
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+#include "IR/binary_module.hh"
+#include "IR/compact_function.hh"
+#include "IR/ir_parser.hh"
+#include "IR/ir_printer.hh"
+
+namespace jj_vm::ir::testing {
+
+using namespace jj_vm::ir::compact;
+
+static constexpr std::string_view kModule = R"(
+func fact(v0: i32) -> i64 {
+bb0:
+    v1 = const i64 1
+    v2 = const i32 2
+    jmp bb1
+bb1:
+    v3 = phi i32 [v2, bb0], [v7, bb2]
+    v4 = phi i64 [v1, bb0], [v6, bb2]
+    v5 = le i32 v3, v0
+    if v5, bb2, bb3
+bb2:
+    v8 = cast i64 v3
+    v6 = mul i64 v4, v8
+    v9 = const i32 1
+    v7 = add i32 v3, v9
+    jmp bb1
+bb3:
+    ret v4
+}
+
+func main() -> i64 {
+bb0:
+    v0 = param i32 n
+    v1 = null_check i32 v0
+    v2 = call i64 @fact(v0)
+    v3 = const i64 0
+    v4 = select i64 v1, v2, v3
+    v5 = const i32 3
+    switch v1, bb1, [v5: bb2]
+bb1:
+    ret v4
+bb2:
+    ret v3
+}
+)";
+
+class BinaryModuleTest : public ::testing::Test {
+protected:
+    IRParser::FunctionList m_funcs = IRParser::parse(kModule);
+
+    std::string serialize() const {
+        ModuleWriter writer{};
+        for (auto&& func : m_funcs) writer.add(*func);
+        return writer.serialize();
+    }
+
+    template <typename FuncList>
+    static std::string to_string(const FuncList& funcs) {
+        std::ostringstream os{};
+        for (auto&& func : funcs) print(os, *func);
+        return os.str();
+    }
+};
+
+TEST_F(BinaryModuleTest, image_view) {
+    auto data = serialize();
+    ModuleImage image{data};
+    ASSERT_EQ(image.size(), 2);
+    //
+    auto compact = CompactFunction::build(*m_funcs[0]);
+    const auto& func = image[0];
+    EXPECT_EQ(func.name(), "fact");
+    EXPECT_EQ(func.func_ty().type(), TypeId::I64);
+    ASSERT_EQ(func.instrs_num(), compact.instrs_num());
+    ASSERT_EQ(func.blocks_num(), compact.blocks_num());
+    EXPECT_EQ(func.params().size(), 1);
+    //
+    for (std::size_t i = 0; i < func.instrs_num(); ++i) {
+        InstrHandle instr{static_cast<InstrHandle::index_type>(i)};
+        EXPECT_EQ(func.opcode(instr), compact.opcode(instr));
+        EXPECT_EQ(func.inputs(instr).size(), compact.inputs(instr).size());
+    }
+    for (std::size_t i = 0; i < func.blocks_num(); ++i) {
+        BlockHandle bb{static_cast<BlockHandle::index_type>(i)};
+        EXPECT_EQ(func.preds(bb).size(), compact.preds(bb).size());
+        EXPECT_EQ(func.succs(bb).size(), compact.succs(bb).size());
+    }
+    //! NOTE: image is used in place
+    EXPECT_GE(reinterpret_cast<const char*>(&func.get(InstrHandle{0})),
+              data.data());
+    //
+    auto call = image[1].next(image[1].next(image[1].front(BlockHandle{0})));
+    EXPECT_EQ(image[1].opcode(call), Opcode::CALL);
+    EXPECT_EQ(image[1].symbol(call), "fact");
+}
+
+TEST_F(BinaryModuleTest, round_trip) {
+    auto data = serialize();
+    auto decoded = decode(ModuleImage{data});
+    ASSERT_EQ(decoded.size(), 2);
+    EXPECT_EQ(to_string(decoded), to_string(m_funcs));
+    //
+    //! NOTE: call is resolved inside the module
+    auto& call = static_cast<CallInstr&>(
+        *std::next(decoded[1]->front().begin(), 2));
+    EXPECT_EQ(call.callee(), decoded[0].get());
+    //
+    //! NOTE: images of the same IR are identical
+    ModuleWriter writer{};
+    for (auto&& func : decoded) writer.add(*func);
+    EXPECT_EQ(writer.serialize(), data);
+}
+
+TEST_F(BinaryModuleTest, mapped_file) {
+    auto path = std::filesystem::temp_directory_path() / "jj_vm_module.bin";
+    {
+        ModuleWriter writer{};
+        for (auto&& func : m_funcs) writer.add(*func);
+        writer.write(path);
+    }
+    auto image = ModuleImage::load(path);
+    std::filesystem::remove(path);
+    //
+    EXPECT_EQ(image.image_size(), serialize().size());
+    EXPECT_EQ(to_string(decode(image)), to_string(m_funcs));
+}
+
+TEST_F(BinaryModuleTest, errors) {
+    auto data = serialize();
+    //
+    auto bad_magic = data;
+    bad_magic[0] = 'X';
+    EXPECT_THROW(ModuleImage{bad_magic}, binary::FormatError);
+    //
+    auto truncated = data.substr(0, data.size() - 8);
+    EXPECT_THROW(ModuleImage{truncated}, binary::FormatError);
+    //
+    auto bad_version = data;
+    bad_version[8] = 42;
+    EXPECT_THROW(ModuleImage{bad_version}, binary::FormatError);
+    //
+    //! NOTE: module w/o callee can't be decoded
+    ModuleWriter writer{};
+    writer.add(*m_funcs[1]);
+    auto single = writer.serialize();
+    EXPECT_THROW(decode(ModuleImage{single}), binary::FormatError);
+    //
+    //! NOTE: 32-bit counts & offsets are checked, not truncated
+    EXPECT_EQ(binary::narrow(std::size_t{0xffffffff}, "count"), 0xffffffffU);
+    EXPECT_THROW(binary::narrow(std::size_t{1} << 32, "count"),
+                 binary::FormatError);
+}
+
+}  // namespace jj_vm::ir::testing
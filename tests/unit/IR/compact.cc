@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "IR/basic_block.hh"
+#include "IR/compact_function.hh"
+#include "IR/function.hh"
+#include "IR/ir_builder.hh"
+
+namespace jj_vm::ir::testing {
+
+using namespace jj_vm::ir::compact;
+
+class CompactTest : public ::testing::Test {
+protected:
+    Function m_func{Type::create<TypeId::I64>(), "compact"};
+    IRBuilder m_builder{};
+
+    //   bb0:
+    //     v0 = const i64 1
+    //     v1 = const i1 0
+    //     if v1, bb1, bb2
+    //   bb1:
+    //     v2 = add v0, a0
+    //     jmp bb2
+    //   bb2:
+    //     v3 = phi [v0, bb0], [v2, bb1]
+    //     ret v3
+    void make_ir() {
+        auto* a0 = m_func.create<Param, Type>(TypeId::I64);
+        auto* bb0 = m_func.create<BasicBlock>();
+        auto* bb1 = m_func.create<BasicBlock>();
+        auto* bb2 = m_func.create<BasicBlock>();
+
+        m_builder.set_insert_point(bb0);
+        auto* v0 = m_builder.create<ConstI64>(1);
+        auto* v1 = m_builder.create<ConstI1>(false);
+        m_builder.create<IfInstr>(bb1, bb2, v1);
+
+        m_builder.set_insert_point(bb1);
+        auto* v2 = m_builder.create<BinInstr>(Opcode::ADD, v0, a0);
+        m_builder.create<BranchInstr>(bb2);
+
+        m_builder.set_insert_point(bb2);
+        auto* v3 = m_builder.create<PhiInstr>(TypeId::I64);
+        v3->add_node({v0, bb0});
+        v3->add_node({v2, bb1});
+        m_builder.create<RetInstr>(v3);
+    }
+
+    static std::vector<InstrHandle> collect(const CompactFunction& func,
+                                            BlockHandle bb) {
+        std::vector<InstrHandle> instrs{};
+        for (auto it = func.front(bb); it; it = func.next(it))
+            instrs.push_back(it);
+        return instrs;
+    }
+};
+
+TEST_F(CompactTest, build) {
+    make_ir();
+    auto compact = CompactFunction::build(m_func);
+
+    ASSERT_EQ(compact.blocks_num(), 3);
+    //! NOTE: 1 param + 7 instructions
+    ASSERT_EQ(compact.instrs_num(), 8);
+    ASSERT_EQ(compact.params().size(), 1);
+    auto a0 = compact.params().front();
+
+    BlockHandle bb0{0}, bb1{1}, bb2{2};
+    auto instrs0 = collect(compact, bb0);
+    auto instrs1 = collect(compact, bb1);
+    auto instrs2 = collect(compact, bb2);
+    ASSERT_EQ(instrs0.size(), 3);
+    ASSERT_EQ(instrs1.size(), 2);
+    ASSERT_EQ(instrs2.size(), 2);
+
+    EXPECT_EQ(compact.constant(instrs0[0]), 1);
+    EXPECT_EQ(compact.type(instrs0[1]), TypeId::I1);
+    EXPECT_EQ(compact.opcode(instrs0[2]), Opcode::IF);
+    EXPECT_EQ(compact.get_input(instrs0[2], 0), instrs0[1]);
+    EXPECT_EQ(compact.target(instrs0[2], 0), bb1);
+    EXPECT_EQ(compact.target(instrs0[2], 1), bb2);
+
+    EXPECT_EQ(compact.opcode(instrs1[0]), Opcode::ADD);
+    EXPECT_EQ(compact.get_input(instrs1[0], 0), instrs0[0]);
+    EXPECT_EQ(compact.get_input(instrs1[0], 1), a0);
+    EXPECT_EQ(compact.parent(instrs1[0]), bb1);
+
+    auto phi_inputs = compact.inputs(instrs2[0]);
+    ASSERT_EQ(phi_inputs.size(), 2);
+    EXPECT_EQ(phi_inputs.begin()[0], instrs0[0]);
+    EXPECT_EQ(phi_inputs.begin()[1], instrs1[0]);
+    EXPECT_EQ(compact.target(instrs2[0], 0), bb0);
+    EXPECT_EQ(compact.target(instrs2[0], 1), bb1);
+
+    ASSERT_EQ(compact.preds(bb2).size(), 2);
+    EXPECT_EQ(compact.preds(bb2).begin()[0], bb0);
+    EXPECT_EQ(compact.preds(bb2).begin()[1], bb1);
+    ASSERT_EQ(compact.succs(bb0).size(), 2);
+    EXPECT_TRUE(compact.succs(bb2).empty());
+}
+
+TEST_F(CompactTest, append_erase) {
+    CompactFunction func{Type::create<TypeId::I64>(), "manual"};
+    auto bb0 = func.create_block();
+    auto bb1 = func.create_block();
+
+    auto v0 = func.append_const(bb0, TypeId::I32, 2);
+    auto v1 = func.append(bb0, Opcode::MUL, TypeId::I32, {v0, v0});
+    auto v2 = func.append(bb0, Opcode::NEG, TypeId::I32, {v1});
+    func.append_branch(bb0, bb1);
+    func.append(bb1, Opcode::RET, TypeId::NONE, {v2});
+
+    EXPECT_EQ(collect(func, bb0).size(), 4);
+    EXPECT_EQ(func.succs(bb0).size(), 1);
+    EXPECT_EQ(func.preds(bb1).begin()[0], bb0);
+
+    func.erase(v1);
+    EXPECT_EQ(collect(func, bb0),
+              (std::vector<InstrHandle>{v0, v2, func.back(bb0)}));
+    EXPECT_EQ(func.prev(v2), v0);
+
+    func.erase(v0);
+    EXPECT_EQ(func.front(bb0), v2);
+    EXPECT_FALSE(func.prev(v2));
+}
+
+}  // namespace jj_vm::ir::testing
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "IR/function.hh"
+#include "IR/inst_visitor.hh"
+#include "IR/ir_builder.hh"
+
+namespace jj_vm::ir::testing {
+
+//! NOTE: records handler which was called for every instruction
+class Recorder final : public InstVisitor<Recorder> {
+public:
+    std::vector<std::string> m_calls{};
+
+    void visit_add(BinInstr&) { m_calls.emplace_back("add"); }
+    void visit_bin(BinInstr&) { m_calls.emplace_back("bin"); }
+    void visit_terminator(Instr&) { m_calls.emplace_back("terminator"); }
+    void visit_phi(PhiInstr&) { m_calls.emplace_back("phi"); }
+    void visit_instr(Instr&) { m_calls.emplace_back("instr"); }
+};
+
+//! NOTE: erases visited instruction
+class Eraser final : public InstVisitor<Eraser, bool> {
+public:
+    bool visit_bin(BinInstr& instr) {
+        erase(&instr);
+        return true;
+    }
+    bool visit_instr(Instr&) { return false; }
+};
+
+class InstVisitorTest : public ::testing::Test {
+protected:
+    Function m_func{Type::create<TypeId::I64>(), "visitor"};
+    IRBuilder m_builder{};
+
+    //   bb0:
+    //     v0 = const i64 1
+    //     v1 = add v0, v0
+    //     v2 = mul v1, v0
+    //     jmp bb1
+    //   bb1:
+    //     v3 = phi [v2, bb0]
+    //     ret v3
+    void make_ir() {
+        auto* bb0 = m_func.create<BasicBlock>();
+        auto* bb1 = m_func.create<BasicBlock>();
+        //
+        m_builder.set_insert_point(bb0);
+        auto* v0 = m_builder.create<ConstI64>(1);
+        auto* v1 = m_builder.create<BinInstr>(Opcode::ADD, v0, v0);
+        auto* v2 = m_builder.create<BinInstr>(Opcode::MUL, v1, v0);
+        m_builder.create<BranchInstr>(bb1);
+        //
+        m_builder.set_insert_point(bb1);
+        auto* v3 = m_builder.create<PhiInstr>(TypeId::I64);
+        v3->add_node({v2, bb0});
+        m_builder.create<RetInstr>(v3);
+    }
+};
+
+TEST_F(InstVisitorTest, dispatch) {
+    make_ir();
+    Recorder recorder{};
+    recorder.visit(m_func);
+    //
+    std::vector<std::string> expected{"instr", "add",  "bin",
+                                      "terminator", "phi", "terminator"};
+    ASSERT_EQ(recorder.m_calls, expected);
+}
+
+TEST_F(InstVisitorTest, return_value) {
+    make_ir();
+    Eraser eraser{};
+    auto& bb0 = m_func.front();
+    //
+    ASSERT_FALSE(eraser.visit(bb0.front()));
+    //
+    //! NOTE: block traversal survives erasing of the visited instructions
+    eraser.visit(bb0);
+    ASSERT_EQ(bb0.size(), 2);
+    ASSERT_EQ(bb0.back().opcode(), Opcode::BRANCH);
+}
+
+}  // namespace jj_vm::ir::testing
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "IR/function.hh"
+#include "IR/ir_parser.hh"
+#include "IR/ir_printer.hh"
+#include "IR/structural_hash.hh"
+
+namespace jj_vm::ir::testing {
+
+inline std::string to_string(const Function& func) {
+    std::ostringstream os{};
+    print(os, func);
+    return os.str();
+}
+
+/// Text with the first occurrence of from replaced, it must be found
+inline std::string replace(std::string_view text, std::string_view from,
+                           std::string_view to) {
+    std::string res{text};
+    auto pos = res.find(from);
+    EXPECT_NE(pos, std::string::npos) << from;
+    return res.replace(pos, from.size(), to);
+}
+
+inline std::size_t count(const Function& func, Opcode opc) {
+    std::size_t res = 0;
+    for (auto&& bb : func)
+        for (auto&& instr : bb) res += instr.opcode() == opc;
+    return res;
+}
+
+/**
+ * @brief The last function of the text is transformed to the expected one,
+ *        previous ones are its callees
+ *
+ * @param[in] run - runs the pass: std::size_t(Function&), returns the number
+ *                  of transformations
+ */
+template <typename RunFn>
+void expect_transformed(RunFn&& run, std::string_view text,
+                        std::string_view expected, std::size_t count = 1) {
+    auto funcs = IRParser::parse(text);
+    auto& func = *funcs.back();
+    ASSERT_EQ(run(func), count) << to_string(func);
+    //
+    auto reparsed = IRParser::parse(to_string(func));
+    EXPECT_TRUE(structurally_equal(*reparsed.front(),
+                                   *IRParser::parse(expected).back()))
+        << to_string(func);
+}
+
+/// The pass doesn't transform the last function of the text
+template <typename RunFn>
+void expect_unchanged(RunFn&& run, std::string_view text) {
+    auto orig = IRParser::parse(text);
+    auto funcs = IRParser::parse(text);
+    EXPECT_EQ(run(*funcs.back()), 0) << text;
+    EXPECT_TRUE(structurally_equal(*orig.back(), *funcs.back()));
+}
+
+}  // namespace jj_vm::ir::testing
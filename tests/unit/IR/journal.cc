@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+#include "IR/ir_parser.hh"
+#include "IR/ir_printer.hh"
+#include "IR/journal.hh"
+
+namespace jj_vm::ir::testing {
+
+static constexpr std::string_view kFact = R"(func fact(v0: i32) -> i64 {
+bb0:
+    v1 = const i64 1
+    v2 = const i32 2
+    jmp bb1
+bb1:
+    v3 = phi i32 [v2, bb0], [v7, bb2]
+    v4 = phi i64 [v1, bb0], [v6, bb2]
+    v5 = le i32 v3, v0
+    if v5, bb2, bb3
+bb2:
+    v8 = cast i64 v3
+    v6 = mul i64 v4, v8
+    v9 = const i32 1
+    v7 = add i32 v3, v9
+    jmp bb1
+bb3:
+    ret v4
+}
+)";
+
+/**
+ * @brief Everything observable about the function: text with ids, use
+ *        counts, CFG edges in order & dense id counters
+ */
+static std::string snapshot(const Function& func) {
+    std::ostringstream os{};
+    print(os, func);
+    //
+    for (auto&& bb : func) {
+        os << "bb" << bb.bb_id() << " preds:";
+        for (auto* pred : bb.preds()) os << ' ' << pred->bb_id();
+        os << " succs:";
+        for (auto* succ : bb.succs()) os << ' ' << succ->bb_id();
+        os << '\n';
+        for (auto&& instr : bb) {
+            std::size_t uses = 0;
+            for ([[maybe_unused]] auto* user : instr.users()) ++uses;
+            os << 'v' << instr.id() << " uses " << uses << '\n';
+        }
+    }
+    os << func.values_num() << ' ' << func.blocks_num() << ' '
+       << func.consts().size() << '\n';
+    return os.str();
+}
+
+static Instr* find(Function& func, Opcode opc) {
+    for (auto&& bb : func)
+        for (auto&& instr : bb)
+            if (instr.opcode() == opc) return &instr;
+    return nullptr;
+}
+
+/// Bunch of edits of every kind
+static void edit(Function& func) {
+    auto* mul = find(func, Opcode::MUL);
+    auto* add = find(func, Opcode::ADD);
+    auto* cast = find(func, Opcode::CAST);
+    //
+    //! NOTE: v6 = v4 * v4, cast is dead afterwards
+    mul->set_input(1, mul->get_input(0));
+    erase(cast);
+    //
+    //! NOTE: v7 = v3 + 1 is replaced by v3 + 2 from the pool
+    IRBuilder builder{add->parent()};
+    builder.set_insert_point(add);
+    auto* two = func.get_const(TypeId::I32, 2);
+    auto* new_add = builder.create<BinInstr>(Opcode::ADD, add->get_input(0),
+                                             two);
+    new_add->replace_users(*add);
+    erase(add);
+    //
+    //! NOTE: new block between bb2 & the latch edge
+    auto* latch = split_bb_after(mul->parent(), mul);
+    auto* extra = func.create<BasicBlock>();
+    builder.set_insert_point(extra);
+    builder.create<BranchInstr>(&func.front());
+    func.move(Function::iterator{latch}, extra);
+    //
+    func.renumber();
+}
+
+TEST(journal, rollback_restores_function) {
+    auto funcs = IRParser::parse(kFact);
+    auto& func = *funcs.front();
+    auto before = snapshot(func);
+    //
+    {
+        Journal journal{func};
+        EXPECT_EQ(func.journal(), &journal);
+        //
+        edit(func);
+        EXPECT_FALSE(journal.empty());
+        EXPECT_NE(snapshot(func), before);
+        //
+        journal.rollback();
+        EXPECT_FALSE(journal.is_active());
+    }
+    EXPECT_EQ(func.journal(), nullptr);
+    EXPECT_EQ(snapshot(func), before);
+    //
+    //! NOTE: function is usable after the rollback
+    edit(func);
+    EXPECT_EQ(find(func, Opcode::CAST), nullptr);
+}
+
+TEST(journal, destructor_rolls_back) {
+    auto funcs = IRParser::parse(kFact);
+    auto& func = *funcs.front();
+    auto before = snapshot(func);
+    //
+    {
+        Journal journal{func};
+        edit(func);
+    }
+    EXPECT_EQ(snapshot(func), before);
+}
+
+TEST(journal, commit_keeps_edits) {
+    auto funcs = IRParser::parse(kFact);
+    auto& func = *funcs.front();
+    auto expected_funcs = IRParser::parse(kFact);
+    auto& expected = *expected_funcs.front();
+    edit(expected);
+    //
+    Journal journal{func};
+    edit(func);
+    journal.commit();
+    //
+    EXPECT_FALSE(journal.is_active());
+    EXPECT_TRUE(journal.empty());
+    EXPECT_EQ(func.journal(), nullptr);
+    EXPECT_EQ(snapshot(func), snapshot(expected));
+}
+
+TEST(journal, nested_transactions) {
+    auto funcs = IRParser::parse(kFact);
+    auto& func = *funcs.front();
+    auto before = snapshot(func);
+    //
+    //! NOTE: every attempt is an independent transaction
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        Journal journal{func};
+        edit(func);
+        journal.rollback();
+        EXPECT_EQ(snapshot(func), before);
+    }
+}
+
+TEST(journal, splice_rollback) {
+    auto funcs = IRParser::parse(std::string{kFact} + R"(
+func id(v0: i32) -> i32 {
+bb0:
+    v1 = const i32 2
+    v2 = add i32 v0, v1
+    ret v2
+}
+)");
+    auto& dst = *funcs[0];
+    auto& src = *funcs[1];
+    auto dst_before = snapshot(dst);
+    auto src_before = snapshot(src);
+    //
+    {
+        Journal journal{dst, src};
+        dst.splice(dst.end(), src);
+        dst.renumber();
+        EXPECT_TRUE(src.empty());
+        EXPECT_EQ(dst.size(), 5);
+    }
+    EXPECT_EQ(snapshot(dst), dst_before);
+    EXPECT_EQ(snapshot(src), src_before);
+}
+
+}  // namespace jj_vm::ir::testing
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "IR/binary_module.hh"
+#include "IR/ir_parser.hh"
+#include "IR/ir_printer.hh"
+#include "IR/lazy_module.hh"
+#include "ir_helpers.hh"
+#include "opt_passes/pass_manager.hh"
+
+namespace jj_vm::ir::testing {
+
+using namespace jj_vm::ir::compact;
+
+static constexpr std::string_view kModule = R"(
+func main(v0: i64) -> i64 {
+bb0:
+    v1 = call i64 @square(v0)
+    ret v1
+}
+
+func square(v0: i64) -> i64 {
+bb0:
+    v1 = mul i64 v0, v0
+    ret v1
+}
+
+func unused(v0: i32, v1: i32) -> i32 {
+bb0:
+    v2 = add i32 v0, v1
+    jmp bb1
+bb1:
+    ret v2
+}
+)";
+
+class LazyModuleTest : public ::testing::Test {
+protected:
+    std::string m_data{};
+
+    void SetUp() override {
+        ModuleWriter writer{};
+        for (auto&& func : IRParser::parse(kModule)) writer.add(*func);
+        m_data = writer.serialize();
+    }
+};
+
+TEST_F(LazyModuleTest, headers) {
+    LazyModule module{ModuleImage{m_data}};
+    ASSERT_EQ(module.size(), 3);
+    EXPECT_EQ(module.pending_num(), 3);
+    //
+    auto* unused = module.find("unused");
+    ASSERT_NE(unused, nullptr);
+    EXPECT_EQ(unused->func_ty().type(), TypeId::I32);
+    EXPECT_EQ(unused->args().size(), 2);
+    EXPECT_FALSE(unused->is_materialized());
+    //! NOTE: headers don't decode bodies
+    EXPECT_EQ(module.materialized_num(), 0);
+}
+
+TEST_F(LazyModuleTest, on_access) {
+    LazyModule module{ModuleImage{m_data}};
+    auto* main = module.find("main");
+    auto* square = module.find("square");
+    //
+    std::size_t instrs_num = 0;
+    for (auto&& bb : *main) instrs_num += bb.size();
+    EXPECT_EQ(instrs_num, 2);
+    EXPECT_TRUE(main->is_materialized());
+    //
+    //! NOTE: callee is resolved to the header w/o decoding
+    auto& call = static_cast<CallInstr&>(main->front().front());
+    EXPECT_EQ(call.callee(), square);
+    EXPECT_FALSE(square->is_materialized());
+    EXPECT_EQ(module.materialized_num(), 1);
+    //
+    jj_vm::passes::PassManager manager{square};
+    manager.run();
+    EXPECT_TRUE(square->is_materialized());
+    //
+    EXPECT_EQ(module.materialized_num(), 2);
+    EXPECT_EQ(module.pending_num(), 1);
+    EXPECT_FALSE(module.find("unused")->is_materialized());
+}
+
+TEST_F(LazyModuleTest, bb_graph) {
+    LazyModule module{ModuleImage{m_data}};
+    auto* unused = module.find("unused");
+    auto graph = unused->bb_graph();
+    EXPECT_EQ(graph.size(), 2);
+    EXPECT_EQ(module.pending_num(), 2);
+}
+
+TEST_F(LazyModuleTest, same_as_eager) {
+    LazyModule module{ModuleImage{m_data}};
+    auto eager = decode(ModuleImage{m_data});
+    ASSERT_EQ(eager.size(), module.size());
+    //
+    module.materialize_all();
+    EXPECT_EQ(module.pending_num(), 0);
+    for (std::size_t i = 0; i < eager.size(); ++i)
+        EXPECT_EQ(to_string(module[i]), to_string(*eager[i]));
+}
+
+}  // namespace jj_vm::ir::testing
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "IR/ir_builder.hh"
+#include "IR/ir_parser.hh"
+#include "IR/ir_printer.hh"
+#include "IR/module.hh"
+
+namespace jj_vm::ir::testing {
+
+static constexpr std::string_view kModule = R"(
+func main(v0: i64) -> i64 {
+bb0:
+    v1 = call i64 @square(v0)
+    ret v1
+}
+
+func square(v0: i64) -> i64 {
+bb0:
+    v1 = mul i64 v0, v0
+    ret v1
+}
+)";
+
+TEST(ModuleTest, symbols) {
+    Module module{"test", IRParser::parse(kModule)};
+    EXPECT_EQ(module.name(), "test");
+    ASSERT_EQ(module.size(), 2);
+    //
+    auto* main = module.find("main");
+    auto* square = module.find("square");
+    ASSERT_NE(main, nullptr);
+    ASSERT_NE(square, nullptr);
+    EXPECT_EQ(module.find("cube"), nullptr);
+    //
+    //! NOTE: name is interned, call refers to the same function
+    auto& call = static_cast<CallInstr&>(main->front().front());
+    EXPECT_EQ(call.callee(), square);
+    EXPECT_EQ(module.get_function("square", TypeId::I64), square);
+    EXPECT_EQ(module.size(), 2);
+}
+
+TEST(ModuleTest, declaration) {
+    Module module{"test"};
+    auto* caller = module.create_function(TypeId::I64, "caller");
+    auto* callee = module.get_function("callee", TypeId::I64);
+    EXPECT_TRUE(callee->is_declaration());
+    //
+    IRBuilder builder{caller->create<BasicBlock>()};
+    auto* call = builder.create<CallInstr>(TypeId::I64, callee);
+    call->add_arg(builder.create<ConstI64>(3));
+    builder.create<RetInstr>(call);
+    //
+    //! NOTE: definition fills in the declaration
+    auto funcs = IRParser::parse(R"(
+func callee(v0: i64) -> i64 {
+bb0:
+    v1 = add i64 v0, v0
+    ret v1
+}
+)");
+    auto* defined = module.add(std::move(funcs.front()));
+    EXPECT_EQ(defined, callee);
+    EXPECT_FALSE(callee->is_declaration());
+    EXPECT_EQ(module.size(), 2);
+    //
+    std::ostringstream os{};
+    print(os, *callee);
+    EXPECT_EQ(os.str(), "func callee(v0: i64) -> i64 {\n"
+                        "bb0:\n"
+                        "    v1 = add i64 v0, v0\n"
+                        "    ret v1\n"
+                        "}\n");
+}
+
+TEST(ModuleTest, recursive_declaration) {
+    Module module{"test"};
+    auto* fact = module.get_function("fact", TypeId::I64);
+    //
+    auto funcs = IRParser::parse(R"(
+func fact(v0: i64) -> i64 {
+bb0:
+    v1 = call i64 @fact(v0)
+    ret v1
+}
+)");
+    ASSERT_EQ(module.add(std::move(funcs.front())), fact);
+    EXPECT_EQ(module.size(), 1);
+    //
+    //! NOTE: recursive call refers to the interned function, not the parsed one
+    auto& call = static_cast<CallInstr&>(fact->front().front());
+    EXPECT_EQ(call.callee(), fact);
+    EXPECT_EQ(call.callee()->name(), "fact");
+}
+
+}  // namespace jj_vm::ir::testing
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+#include "IR/opcodes.hh"
+
+namespace jj_vm::ir::testing {
+
+//! NOTE: table is usable in constant expressions
+static_assert(kOpcodesNum == static_cast<std::size_t>(Opcode::SWITCH) + 1);
+static_assert(mnemonic(Opcode::ADD) == "add");
+static_assert(arity(Opcode::SUB) == 2 && is_variadic(Opcode::PHI));
+static_assert(is_commutative(Opcode::MUL) && !is_commutative(Opcode::SHR));
+static_assert(is_terminator(Opcode::IF) && !is_terminator(Opcode::CALL));
+static_assert(is_check(Opcode::NULL_CHECK) && has_side_effects(Opcode::CALL));
+static_assert(is_foldable(Opcode::XOR) && !is_foldable(Opcode::CONST));
+
+TEST(opcodes, arity_matches_instructions) {
+    Function func{Type::create<TypeId::I64>(), "opcodes"};
+    IRBuilder builder{};
+    auto* bb0 = func.create<BasicBlock>();
+    auto* bb1 = func.create<BasicBlock>();
+    builder.set_insert_point(bb0);
+    //
+    auto* cond = builder.create<ConstI1>(true);
+    auto* val = builder.create<ConstI64>(1);
+    std::vector<Instr*> instrs{
+        cond,
+        builder.create<BinInstr>(Opcode::ADD, val, val),
+        builder.create<UnaryInstr>(Opcode::NEG, val),
+        builder.create<CastInstr>(TypeId::I32, val),
+        builder.create<SelectInstr>(cond, val, val),
+        builder.create<IfInstr>(bb1, bb1, cond),
+    };
+    builder.set_insert_point(bb1);
+    instrs.push_back(builder.create<RetInstr>(val));
+    //
+    for (auto* instr : instrs) {
+        ASSERT_FALSE(is_variadic(instr->opcode()));
+        EXPECT_EQ(arity(instr->opcode()), instr->num_inputs())
+            << mnemonic(instr->opcode());
+    }
+}
+
+TEST(opcodes, flags) {
+    std::size_t terminators = 0;
+    for (std::size_t i = 0; i < kOpcodesNum; ++i) {
+        auto opc = static_cast<Opcode>(i);
+        EXPECT_FALSE(mnemonic(opc).empty());
+        //
+        //! NOTE: only pure binary operations could be folded
+        if (is_foldable(opc)) {
+            EXPECT_EQ(arity(opc), 2);
+            EXPECT_FALSE(has_side_effects(opc));
+        }
+        if (is_terminator(opc)) {
+            EXPECT_TRUE(has_side_effects(opc));
+            ++terminators;
+        }
+    }
+    EXPECT_EQ(terminators, 4);
+}
+
+}  // namespace jj_vm::ir::testing
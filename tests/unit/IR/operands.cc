@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/instruction.hh"
+#include "IR/ir_builder.hh"
+
+namespace {
+//! NOTE: heap allocations are counted inside of AllocsCounter scope only,
+//!       so allocations of gtest itself aren't seen
+bool g_counting = false;
+std::size_t g_allocs_num = 0;
+
+void* allocate(std::size_t size,
+               std::size_t align = alignof(std::max_align_t)) {
+    if (g_counting) ++g_allocs_num;
+    size = size == 0 ? 1 : size;
+    auto* ptr = align <= alignof(std::max_align_t)
+                    ? std::malloc(size)
+                    : std::aligned_alloc(align,
+                                         (size + align - 1) / align * align);
+    if (ptr == nullptr) throw std::bad_alloc{};
+    return ptr;
+}
+
+//! NOTE: out of line, so free of the inlined delete isn't matched against
+//!       new of the caller (-Wmismatched-new-delete)
+[[gnu::noinline]] void deallocate(void* ptr) noexcept { std::free(ptr); }
+
+class AllocsCounter final {
+    std::size_t m_before = g_allocs_num;
+
+public:
+    AllocsCounter() { g_counting = true; }
+    ~AllocsCounter() { g_counting = false; }
+
+    std::size_t count() const noexcept { return g_allocs_num - m_before; }
+};
+}  // namespace
+
+//! NOTE: all forms are replaced, so any new is paired with its delete
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t align) {
+    return allocate(size, static_cast<std::size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return allocate(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    deallocate(ptr);
+}
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    deallocate(ptr);
+}
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    deallocate(ptr);
+}
+
+namespace jj_vm::ir::testing {
+
+class OperandsTest : public ::testing::Test {
+protected:
+    Function m_func{Type::create<TypeId::I64>(), "operands"};
+    IRBuilder m_builder{};
+    BasicBlock* m_bb = nullptr;
+
+    OperandsTest() {
+        m_bb = m_func.create<BasicBlock>();
+        m_builder.set_insert_point(m_bb);
+    }
+};
+
+TEST_F(OperandsTest, fixed_arity_no_allocations) {
+    auto* v0 = m_builder.create<ConstI64>(1);
+    auto* v1 = m_builder.create<ConstI64>(2);
+    m_func.arena().reserve(sizeof(BinInstr) * 64);
+    //
+    std::size_t allocs_num = 0;
+    {
+        AllocsCounter allocs{};
+        for (int i = 0; i < 32; ++i) {
+            auto* bin = m_builder.create<BinInstr>(Opcode::ADD, v0, v1);
+            m_builder.create<UnaryInstr>(Opcode::NULL_CHECK, bin);
+        }
+        allocs_num = allocs.count();
+    }
+    EXPECT_EQ(allocs_num, 0);
+}
+
+TEST_F(OperandsTest, inputs_view) {
+    auto* v0 = m_builder.create<ConstI64>(1);
+    auto* v1 = m_builder.create<ConstI64>(2);
+    auto* v2 = m_builder.create<BinInstr>(Opcode::SUB, v0, v1);
+
+    std::vector<Value*> expected{v0, v1};
+    std::size_t idx = 0, mismatches = 0;
+    //
+    std::size_t allocs_num = 0;
+    auto inputs = v2->inputs();
+    {
+        AllocsCounter allocs{};
+        for (auto* input : inputs) mismatches += input != expected[idx++];
+        allocs_num = allocs.count();
+    }
+    EXPECT_EQ(allocs_num, 0);
+    EXPECT_EQ(mismatches, 0);
+
+    EXPECT_EQ(inputs.size(), 2);
+    EXPECT_EQ(v2->num_inputs(), 2);
+    EXPECT_EQ(inputs.begin()[1], v1);
+
+    //! NOTE: view reflects operands update
+    v2->set_input(0, v1);
+    EXPECT_EQ(*inputs.begin(), v1);
+}
+
+TEST_F(OperandsTest, variadic) {
+    auto* v0 = m_builder.create<ConstI64>(1);
+    auto* v1 = m_builder.create<ConstI64>(2);
+    auto* phi = m_builder.create<PhiInstr>(TypeId::I64);
+
+    phi->add_node({v0, m_bb});
+    phi->add_node({v1, m_bb});
+    EXPECT_EQ(phi->num_inputs(), 2);
+
+    phi->clean_inputs();
+    EXPECT_EQ(phi->num_inputs(), 0);
+    EXPECT_FALSE(v0->has_users());
+
+    phi->add_node({v1, m_bb});
+    EXPECT_EQ(phi->num_inputs(), 1);
+    EXPECT_EQ(phi->get_input(0), v1);
+    EXPECT_EQ(v1->users().size(), 1);
+}
+
+}  // namespace jj_vm::ir::testing
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <vector>
+
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+#include "IR/journal.hh"
+
+namespace jj_vm::ir::testing {
+
+class PhiTest : public ::testing::Test {
+protected:
+    Function m_func{Type::create<TypeId::I64>(), "phi"};
+    IRBuilder m_builder{};
+    //
+    //! NOTE: entry -> {p0, p1, p2} -> join
+    BasicBlock* m_entry = nullptr;
+    std::vector<BasicBlock*> m_preds{};
+    BasicBlock* m_join = nullptr;
+    std::vector<Instr*> m_vals{};
+
+    PhiTest() {
+        m_entry = m_func.create<BasicBlock>();
+        for (int i = 0; i < 3; ++i)
+            m_preds.push_back(m_func.create<BasicBlock>());
+        m_join = m_func.create<BasicBlock>();
+        //
+        m_builder.set_insert_point(m_entry);
+        for (std::int64_t i = 0; i < 3; ++i)
+            m_vals.push_back(m_builder.create_const(TypeId::I64, i));
+    }
+
+    PhiInstr* create_phi() {
+        m_builder.set_insert_point(m_join);
+        return m_builder.create<PhiInstr>(Type::create<TypeId::I64>());
+    }
+
+    void link(std::size_t pred) {
+        m_builder.set_insert_point(m_preds[pred]);
+        m_builder.create<BranchInstr>(m_join);
+    }
+
+    /// Every input is taken from the pred with the same index
+    void expect_indexed(const PhiInstr& phi) {
+        ASSERT_EQ(phi.num_inputs(), m_join->preds().size());
+        for (std::size_t idx = 0; idx < phi.num_inputs(); ++idx) {
+            auto* pred = m_join->preds()[idx];
+            EXPECT_EQ(phi.incoming_block(idx), pred);
+            EXPECT_EQ(phi.incoming(idx), phi.get_input(idx));
+            EXPECT_EQ(phi.incoming(pred), phi.get_input(idx));
+        }
+    }
+};
+
+TEST_F(PhiTest, prefix) {
+    m_builder.set_insert_point(m_join);
+    auto* add = m_builder.create<BinInstr>(Opcode::ADD, m_vals[0], m_vals[1]);
+    EXPECT_FALSE(m_join->has_phis());
+    EXPECT_EQ(m_join->phis_end(), m_join->begin());
+    //
+    //! NOTE: phis are placed before add, non-phi isn't placed before phis
+    auto* phi0 = create_phi();
+    auto* phi1 = create_phi();
+    auto* sub = m_builder.emplace_front<BinInstr>(Opcode::SUB, m_vals[0],
+                                                  m_vals[1]);
+    auto* phi2 = m_builder.emplace_front<PhiInstr>(Type::create<TypeId::I64>());
+    //
+    std::vector<Instr*> order{};
+    for (auto&& instr : *m_join) order.push_back(&instr);
+    EXPECT_EQ(order, (std::vector<Instr*>{phi2, phi0, phi1, sub, add}));
+    EXPECT_EQ(m_join->phis_end(), BasicBlock::iterator{sub});
+    EXPECT_EQ(m_join->phis().size(), 3);
+    //
+    m_join->erase(phi1);
+    EXPECT_EQ(m_join->phis_end(), BasicBlock::iterator{sub});
+    m_join->erase(phi2);
+    m_join->erase(phi0);
+    EXPECT_FALSE(m_join->has_phis());
+    EXPECT_EQ(m_join->phis_end(), m_join->begin());
+}
+
+TEST_F(PhiTest, inputs_added_before_edges) {
+    auto* phi = create_phi();
+    phi->add_node({m_vals[2], m_preds[2]});
+    phi->add_node({m_vals[0], m_preds[0]});
+    phi->add_node({m_vals[1], m_preds[1]});
+    //
+    //! NOTE: edges are linked in other order than inputs are added
+    link(1);
+    link(0);
+    link(2);
+    expect_indexed(*phi);
+    for (std::size_t idx = 0; idx < 3; ++idx)
+        EXPECT_EQ(phi->incoming(m_preds[idx]), m_vals[idx]);
+}
+
+TEST_F(PhiTest, inputs_added_after_edges) {
+    link(0);
+    link(1);
+    link(2);
+    auto* phi = create_phi();
+    phi->add_node({m_vals[1], m_preds[1]});
+    phi->add_node({m_vals[2], m_preds[2]});
+    phi->add_node({m_vals[0], m_preds[0]});
+    expect_indexed(*phi);
+    //
+    //! NOTE: inputs of the following preds are shifted
+    BasicBlock::remove_link(m_join, m_preds[0]);
+    ASSERT_EQ(m_join->preds().size(), 2);
+    EXPECT_EQ(phi->incoming(std::size_t{0}), m_vals[1]);
+    EXPECT_EQ(phi->incoming(std::size_t{1}), m_vals[2]);
+}
+
+TEST_F(PhiTest, rollback) {
+    link(0);
+    link(1);
+    auto* phi = create_phi();
+    phi->add_node({m_vals[0], m_preds[0]});
+    phi->add_node({m_vals[1], m_preds[1]});
+    //
+    {
+        Journal journal{m_func};
+        phi->add_node({m_vals[2], m_preds[2]});
+        link(2);
+        create_phi();
+        expect_indexed(*phi);
+        EXPECT_EQ(m_join->phis().size(), 2);
+    }
+    EXPECT_EQ(phi->num_inputs(), 2);
+    EXPECT_EQ(m_join->phis().size(), 1);
+    expect_indexed(*phi);
+}
+
+}  // namespace jj_vm::ir::testing
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_builder.hh"
+#include "IR/ir_parser.hh"
+#include "IR/snapshot.hh"
+#include "analysis/liveness_analyzer.hh"
+#include "analysis/loop_analyzer.hh"
+#include "graph/dom3.hh"
+
+namespace jj_vm::ir::testing {
+
+static constexpr std::string_view kFact = R"(func fact(v0: i32) -> i64 {
+bb0:
+    v1 = const i64 1
+    v2 = const i32 2
+    jmp bb1
+bb1:
+    v3 = phi i32 [v2, bb0], [v7, bb2]
+    v4 = phi i64 [v1, bb0], [v6, bb2]
+    v5 = le i32 v3, v0
+    if v5, bb2, bb3
+bb2:
+    v8 = cast i64 v3
+    v6 = mul i64 v4, v8
+    v9 = const i32 1
+    v7 = add i32 v3, v9
+    jmp bb1
+bb3:
+    ret v4
+}
+)";
+
+using graph::BBGraph;
+
+/**
+ * @brief Results of the analyses flattened to ids, so results over IR and
+ *        over snapshot are comparable
+ */
+struct Results final {
+    std::vector<std::vector<std::size_t>> m_idommed{};
+    std::vector<std::size_t> m_loop_headers{};
+    std::vector<std::pair<std::size_t, std::size_t>> m_intervals{};
+
+    bool operator==(const Results& other) const {
+        return m_idommed == other.m_idommed &&
+               m_loop_headers == other.m_loop_headers &&
+               m_intervals == other.m_intervals;
+    }
+};
+
+template <typename GraphTy>
+static Results analyze(const GraphTy& graph, std::size_t blocks_num,
+                       std::size_t values_num) {
+    Results res{};
+    res.m_idommed.resize(blocks_num);
+    res.m_loop_headers.resize(blocks_num);
+    res.m_intervals.resize(values_num);
+    //
+    auto dom_tree = graph::dom3_impl::DomTreeBuilder<GraphTy>::build(graph);
+    for (auto&& [dommer, node] : dom_tree)
+        for (auto* dommed : node.idommed())
+            res.m_idommed[dommer->bb_id()].push_back(dommed->bb_id());
+    //
+    auto loop_tree = analysis::loop::LoopTreeBuilder<GraphTy>::build(graph);
+    for (auto&& [bb, loop] : loop_tree)
+        if (loop->header() != nullptr)
+            res.m_loop_headers[bb->bb_id()] = loop->header()->bb_id() + 1;
+    //
+    auto liveness = analysis::liveness::LivenessBuilder<GraphTy>::build(graph);
+    for (auto&& [val, interval] : liveness.intervals())
+        res.m_intervals[val->id()] = {interval.begin(), interval.end()};
+    return res;
+}
+
+TEST(snapshot, structure) {
+    auto funcs = IRParser::parse(kFact);
+    auto& func = *funcs.front();
+    FunctionSnapshot snapshot{func};
+    //
+    ASSERT_EQ(snapshot.size(), func.size());
+    EXPECT_EQ(snapshot.head()->source(), &func.front());
+    EXPECT_EQ(snapshot.params().size(), 1);
+    //
+    auto frozen = snapshot.blocks().begin();
+    for (auto&& bb : func) {
+        EXPECT_EQ(frozen->bb_id(), bb.bb_id());
+        EXPECT_EQ(snapshot.get_block(bb.bb_id()), &*frozen);
+        //
+        ASSERT_EQ(frozen->succs().size(), bb.succs().size());
+        for (std::size_t i = 0; i < bb.succs().size(); ++i)
+            EXPECT_EQ(frozen->succs().begin()[i]->source(), bb.succs()[i]);
+        ASSERT_EQ(frozen->preds().size(), bb.preds().size());
+        for (std::size_t i = 0; i < bb.preds().size(); ++i)
+            EXPECT_EQ(frozen->preds().begin()[i]->source(), bb.preds()[i]);
+        //
+        ASSERT_EQ(frozen->size(), bb.size());
+        auto* instr = frozen->begin();
+        for (auto&& src : bb) {
+            EXPECT_EQ(instr->source(), &src);
+            EXPECT_EQ(instr->id(), src.id());
+            EXPECT_EQ(instr->opcode(), src.opcode());
+            EXPECT_EQ(instr->parent(), &*frozen);
+            ASSERT_EQ(instr->num_inputs(), src.num_inputs());
+            for (std::size_t i = 0; i < src.num_inputs(); ++i)
+                EXPECT_EQ(instr->get_input(i)->source(), src.get_input(i));
+            //
+            if (src.opcode() == Opcode::CONST) {
+                EXPECT_EQ(instr->imm(), const_value(src));
+            }
+            if (src.opcode() == Opcode::PHI) {
+                auto vars = static_cast<const PhiInstr&>(src).vars();
+                for (std::size_t i = 0; i < vars.size(); ++i)
+                    EXPECT_EQ(instr->incoming_block(i)->source(),
+                              vars[i].second);
+            }
+            ++instr;
+        }
+        ++frozen;
+    }
+}
+
+TEST(snapshot, same_results_as_ir) {
+    auto funcs = IRParser::parse(kFact);
+    auto& func = *funcs.front();
+    FunctionSnapshot snapshot{func};
+    //
+    auto expected =
+        analyze(func.bb_graph(), func.blocks_num(), func.values_num());
+    auto frozen = analyze(snapshot, func.blocks_num(), func.values_num());
+    EXPECT_TRUE(frozen == expected);
+    EXPECT_FALSE(expected.m_intervals.empty());
+}
+
+TEST(snapshot, concurrent_analyses) {
+    auto funcs = IRParser::parse(kFact);
+    auto& func = *funcs.front();
+    const auto blocks_num = func.blocks_num();
+    const auto values_num = func.values_num();
+    //
+    auto expected = analyze(func.bb_graph(), blocks_num, values_num);
+    const FunctionSnapshot snapshot{func};
+    //
+    constexpr std::size_t kThreads = 4;
+    std::vector<Results> results(kThreads);
+    std::vector<std::thread> threads{};
+    for (std::size_t i = 0; i < kThreads; ++i)
+        threads.emplace_back([&, i] {
+            results[i] = analyze(snapshot, blocks_num, values_num);
+        });
+    //
+    //! NOTE: function is mutated meanwhile, snapshot doesn't see it
+    IRBuilder builder{};
+    for (int i = 0; i < 100; ++i) {
+        auto* bb = func.create<BasicBlock>();
+        builder.set_insert_point(bb);
+        builder.create<BranchInstr>(&func.front());
+    }
+    for (auto&& bb : func)
+        for (auto it = bb.begin(); it != bb.end();)
+            it = (it->opcode() == Opcode::CAST) ? bb.erase(&*it) : std::next(it);
+    func.renumber();
+    //
+    for (auto&& thread : threads) thread.join();
+    for (auto&& res : results) EXPECT_TRUE(res == expected);
+}
+
+}  // namespace jj_vm::ir::testing
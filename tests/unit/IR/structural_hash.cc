@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <unordered_map>
+
+#include "IR/function.hh"
+#include "IR/ir_builder.hh"
+#include "IR/ir_parser.hh"
+#include "IR/structural_hash.hh"
+#include "ir_helpers.hh"
+
+namespace jj_vm::ir::testing {
+
+static constexpr std::string_view kFact = R"(func fact(v0: i32) -> i64 {
+bb0:
+    v1 = const i64 1
+    v2 = const i32 2
+    jmp bb1
+bb1:
+    v3 = phi i32 [v2, bb0], [v7, bb2]
+    v4 = phi i64 [v1, bb0], [v6, bb2]
+    v5 = le i32 v3, v0
+    if v5, bb2, bb3
+bb2:
+    v8 = cast i64 v3
+    v6 = mul i64 v4, v8
+    v9 = const i32 1
+    v7 = add i32 v3, v9
+    jmp bb1
+bb3:
+    ret v4
+}
+)";
+
+//! NOTE: same function with other names & ids, blocks are listed in other
+//!       order and so are phi inputs
+static constexpr std::string_view kFactRenamed = R"(func factorial(v10: i32) -> i64 {
+bb4:
+    v11 = const i64 1
+    v12 = const i32 2
+    jmp bb5
+bb5:
+    v13 = phi i32 [v17, bb6], [v12, bb4]
+    v14 = phi i64 [v16, bb6], [v11, bb4]
+    v15 = le i32 v13, v10
+    if v15, bb6, bb7
+bb7:
+    ret v14
+bb6:
+    v18 = cast i64 v13
+    v16 = mul i64 v14, v18
+    v19 = const i32 1
+    v17 = add i32 v13, v19
+    jmp bb5
+}
+)";
+
+TEST(structural_hash, equal_up_to_renaming) {
+    auto lhs = IRParser::parse(kFact);
+    auto rhs = IRParser::parse(kFactRenamed);
+    //
+    EXPECT_TRUE(structurally_equal(*lhs.front(), *rhs.front()));
+    EXPECT_EQ(structural_hash(*lhs.front()), structural_hash(*rhs.front()));
+    //
+    //! NOTE: ids don't matter
+    rhs.front()->renumber();
+    EXPECT_TRUE(structurally_equal(*lhs.front(), *rhs.front()));
+    //
+    //! NOTE: neither does the order of preds (and indexes of phi inputs)
+    auto* entry = &rhs.front()->front();
+    auto* header = entry->succs().front();
+    BasicBlock::remove_link(header, entry);
+    BasicBlock::link_blocks(header, entry);
+    ASSERT_EQ(header->preds().back(), entry);
+    EXPECT_TRUE(structurally_equal(*lhs.front(), *rhs.front()));
+}
+
+TEST(structural_hash, differences) {
+    auto orig = IRParser::parse(kFact);
+    const StructuralForm form{*orig.front()};
+    //
+    for (auto&& [from, to] : {
+             std::pair{"const i32 1", "const i32 3"},
+             std::pair{"mul i64", "add i64"},
+             std::pair{"le i32 v3, v0", "ge i32 v3, v0"},
+             std::pair{"if v5, bb2, bb3", "if v5, bb3, bb2"},
+             std::pair{"add i32 v3, v9", "add i32 v9, v3"},
+             std::pair{"[v2, bb0], [v7, bb2]", "[v7, bb0], [v2, bb2]"},
+         }) {
+        auto funcs = IRParser::parse(replace(kFact, from, to));
+        const StructuralForm other{*funcs.front()};
+        EXPECT_NE(form, other) << from;
+        EXPECT_NE(form.hash(), other.hash()) << from;
+    }
+}
+
+TEST(structural_hash, calls) {
+    auto funcs = IRParser::parse(R"(
+func pow(v0: i64, v1: i64) -> i64 {
+bb0:
+    v2 = const i64 0
+    v3 = eq i64 v1, v2
+    if v3, bb1, bb2
+bb1:
+    v4 = const i64 1
+    ret v4
+bb2:
+    v5 = const i64 1
+    v6 = sub i64 v1, v5
+    v7 = call i64 @pow(v0, v6)
+    v8 = mul i64 v0, v7
+    ret v8
+}
+)");
+    auto& pow = *funcs.front();
+    //
+    //! NOTE: copy is recursive too, it calls itself
+    auto copy_funcs = IRParser::parse(R"(
+func pow_copy(v0: i64, v1: i64) -> i64 {
+bb0:
+    v2 = const i64 0
+    v3 = eq i64 v1, v2
+    if v3, bb1, bb2
+bb1:
+    v4 = const i64 1
+    ret v4
+bb2:
+    v5 = const i64 1
+    v6 = sub i64 v1, v5
+    v7 = call i64 @pow_copy(v0, v6)
+    v8 = mul i64 v0, v7
+    ret v8
+}
+
+func pow(v0: i64, v1: i64) -> i64 {
+bb0:
+    ret v0
+}
+
+func pow_other(v0: i64, v1: i64) -> i64 {
+bb0:
+    v2 = const i64 0
+    v3 = eq i64 v1, v2
+    if v3, bb1, bb2
+bb1:
+    v4 = const i64 1
+    ret v4
+bb2:
+    v5 = const i64 1
+    v6 = sub i64 v1, v5
+    v7 = call i64 @pow(v0, v6)
+    v8 = mul i64 v0, v7
+    ret v8
+}
+)");
+    EXPECT_TRUE(structurally_equal(pow, *copy_funcs[0]));
+    //
+    //! NOTE: pow_other calls another function
+    EXPECT_FALSE(structurally_equal(pow, *copy_funcs[2]));
+}
+
+TEST(structural_hash, unreachable_blocks) {
+    auto lhs = IRParser::parse(kFact);
+    auto rhs = IRParser::parse(kFact);
+    //
+    IRBuilder builder{rhs.front()->create<BasicBlock>()};
+    builder.create<BranchInstr>(&rhs.front()->front());
+    EXPECT_TRUE(structurally_equal(*lhs.front(), *rhs.front()));
+}
+
+TEST(structural_hash, cache_key) {
+    auto changed = replace(kFact, "const i32 2", "const i32 0");
+    auto funcs = IRParser::parse(
+        std::string{kFact} + std::string{kFactRenamed} +
+        replace(kFact, "func fact", "func other") +
+        replace(changed, "func fact", "func changed"));
+    ASSERT_EQ(funcs.size(), 4);
+    //
+    std::unordered_map<StructuralForm, Function*, StructuralForm::Hash>
+        cache{};
+    std::size_t merged = 0;
+    for (auto&& func : funcs)
+        if (!cache.emplace(StructuralForm{*func}, func.get()).second) ++merged;
+    //
+    EXPECT_EQ(merged, 2);
+    EXPECT_EQ(cache.size(), 2);
+}
+
+}  // namespace jj_vm::ir::testing
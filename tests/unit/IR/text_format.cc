@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+#include "IR/ir_parser.hh"
+#include "IR/ir_printer.hh"
+#include "ir_helpers.hh"
+
+namespace jj_vm::ir::testing {
+
+static constexpr std::string_view kFact = R"(func fact(v0: i32) -> i64 {
+bb0:
+    v1 = const i64 1
+    v2 = const i32 2
+    jmp bb1
+bb1:
+    v3 = phi i32 [v2, bb0], [v7, bb2]
+    v4 = phi i64 [v1, bb0], [v6, bb2]
+    v5 = le i32 v3, v0
+    if v5, bb2, bb3
+bb2:
+    v8 = cast i64 v3
+    v6 = mul i64 v4, v8
+    v9 = const i32 1
+    v7 = add i32 v3, v9
+    jmp bb1
+bb3:
+    ret v4
+}
+)";
+
+TEST(text_format, print_parsed) {
+    auto funcs = IRParser::parse(kFact);
+    ASSERT_EQ(funcs.size(), 1);
+    auto& func = *funcs.front();
+    EXPECT_EQ(func.name(), "fact");
+    EXPECT_EQ(func.size(), 4);
+    //
+    //! NOTE: ids are renumbered in the layout order, instructions w/o type
+    //!       (jmp v3, if v7) are numbered too
+    auto text = to_string(func);
+    EXPECT_NE(text.find("    v4 = phi i32 [v2, bb0], [v11, bb2]\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("    v8 = cast i64 v4\n    v9 = mul i64 v5, v8\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("    if v6, bb2, bb3\n"), std::string::npos);
+    EXPECT_NE(text.find("    ret v5\n"), std::string::npos);
+}
+
+TEST(text_format, round_trip) {
+    auto text = to_string(*IRParser::parse(kFact).front());
+    auto reparsed = IRParser::parse(text);
+    ASSERT_EQ(reparsed.size(), 1);
+    EXPECT_EQ(to_string(*reparsed.front()), text);
+}
+
+TEST(text_format, forward_refs) {
+    auto funcs = IRParser::parse(kFact);
+    auto& func = *funcs.front();
+    //
+    //! NOTE: v6 & v7 were used by phis before their definition
+    auto& header = *std::next(func.begin());
+    auto& phi = static_cast<PhiInstr&>(header.front());
+    ASSERT_EQ(phi.num_inputs(), 2);
+    auto* add = static_cast<Instr*>(phi.get_input(1));
+    EXPECT_EQ(add->opcode(), Opcode::ADD);
+    EXPECT_EQ(phi.vars()[1].second, &*std::next(func.begin(), 2));
+    EXPECT_EQ(std::distance(add->users().begin(), add->users().end()), 1);
+}
+
+TEST(text_format, calls) {
+    constexpr std::string_view kText = R"(
+// caller is defined before the callee
+func main() -> i64 {
+bb0:
+    v0 = const i64 5
+    v1 = call i64 @square(v0)
+    ret v1
+}
+
+func square(v0: i64) -> i64 {
+bb0:
+    v1 = mul i64 v0, v0
+    ret v1
+}
+)";
+    auto funcs = IRParser::parse(kText);
+    ASSERT_EQ(funcs.size(), 2);
+    auto& call = static_cast<CallInstr&>(*std::next(funcs[0]->front().begin()));
+    EXPECT_EQ(call.callee(), funcs[1].get());
+    EXPECT_EQ(funcs[1]->args().size(), 1);
+    //
+    auto text = to_string(*funcs[0]) + to_string(*funcs[1]);
+    auto reparsed = IRParser::parse(text);
+    ASSERT_EQ(reparsed.size(), 2);
+    EXPECT_EQ(to_string(*reparsed[0]) + to_string(*reparsed[1]), text);
+}
+
+TEST(text_format, vectors) {
+    constexpr std::string_view kText = R"(func lanes(v0: i32) -> i32 {
+bb0:
+    v1 = const i32 1
+    v2 = splat v4i32 v0
+    v3 = insert v4i32 v2, v1, v1
+    v4 = add v4i32 v2, v3
+    v5 = extract i32 v4, v1
+    ret v5
+}
+)";
+    auto funcs = IRParser::parse(kText);
+    auto& func = *funcs.front();
+    auto& extract = static_cast<ExtractLaneInstr&>(
+        *std::prev(func.front().end(), 2));
+    EXPECT_EQ(extract.type(), TypeId::I32);
+    EXPECT_EQ(extract.vec()->type(), TypeId::V4I32);
+    EXPECT_EQ(lane_index(extract.lane()), 1);
+    //
+    auto text = to_string(func);
+    EXPECT_EQ(to_string(*IRParser::parse(text).front()), text);
+}
+
+TEST(text_format, memory) {
+    constexpr std::string_view kText = R"(func mem(v0: ptr, v1: i64) -> i32 {
+bb0:
+    v2 = alloc ptr v1
+    v3 = gep ptr v2, v1
+    store v3, v0
+    v5 = load ptr v3
+    v6 = load i32 v5
+    ret v6
+}
+)";
+    auto funcs = IRParser::parse(kText);
+    auto& func = *funcs.front();
+    auto& store = static_cast<StoreInstr&>(*std::next(func.front().begin(), 2));
+    EXPECT_EQ(store.type(), TypeId::NONE);
+    EXPECT_EQ(store.val(), &*func.args().begin());
+    EXPECT_EQ(store.ptr()->type(), TypeId::PTR);
+    //
+    //! NOTE: the store has the id like every instruction
+    auto text = to_string(func);
+    EXPECT_EQ(text, kText);
+    EXPECT_EQ(to_string(*IRParser::parse(text).front()), text);
+}
+
+TEST(text_format, select) {
+    constexpr std::string_view kText = R"(func max(v0: i64, v1: i64) -> i64 {
+bb0:
+    v2 = ge i64 v0, v1
+    v3 = select i64 v2, v0, v1
+    ret v3
+}
+)";
+    auto funcs = IRParser::parse(kText);
+    auto& func = *funcs.front();
+    auto& select = static_cast<SelectInstr&>(*std::next(func.front().begin()));
+    EXPECT_EQ(select.type(), TypeId::I64);
+    EXPECT_EQ(select.cond(), &func.front().front());
+    EXPECT_EQ(select.true_val(), &*func.args().begin());
+    //
+    auto text = to_string(func);
+    EXPECT_EQ(text, kText);
+    EXPECT_EQ(to_string(*IRParser::parse(text).front()), text);
+}
+
+TEST(text_format, switch) {
+    constexpr std::string_view kText = R"(func dispatch(v0: i32) -> i32 {
+bb0:
+    v1 = const i32 1
+    v2 = const i32 5
+    v3 = const i32 7
+    switch v0, bb3, [v1: bb1, v2: bb2, v3: bb1]
+bb1:
+    ret v1
+bb2:
+    ret v2
+bb3:
+    v7 = phi i32 [v3, bb0]
+    ret v7
+}
+)";
+    auto funcs = IRParser::parse(kText);
+    auto& func = *funcs.front();
+    auto& entry = func.front();
+    const auto& term = static_cast<const SwitchInstr&>(entry.back());
+    ASSERT_EQ(term.cases_num(), 3);
+    EXPECT_EQ(term.case_value(1), 5);
+    EXPECT_EQ(term.target(7), term.case_target(0));
+    EXPECT_EQ(term.target(2), term.default_bb());
+    //! NOTE: default first, bb1 is linked once. Terminators take ids too
+    ASSERT_EQ(entry.succs_num(), 3);
+    EXPECT_EQ(entry.succs()[0], term.default_bb());
+    EXPECT_EQ(entry.succs()[1], term.case_target(0));
+    EXPECT_EQ(entry.succs()[2], term.case_target(1));
+    EXPECT_EQ(term.case_target(0)->preds_num(), 1);
+    //
+    auto text = to_string(func);
+    EXPECT_EQ(text, kText);
+    EXPECT_EQ(to_string(*IRParser::parse(text).front()), text);
+}
+
+TEST(text_format, errors) {
+    auto line_of = [](std::string_view text) -> std::size_t {
+        try {
+            IRParser::parse(text);
+        } catch (const ParseError& err) {
+            return err.line();
+        }
+        return 0;
+    };
+    //! NOTE: unknown instruction
+    EXPECT_EQ(line_of("func f() -> i64 {\nbb0:\n    v0 = foo i64 1\n}\n"), 3);
+    //! NOTE: undefined value
+    EXPECT_EQ(line_of("func f() -> i64 {\nbb0:\n    ret v3\n}\n"), 4);
+    //! NOTE: undefined block
+    EXPECT_EQ(line_of("func f() -> i64 {\nbb0:\n    jmp bb1\n}\n"), 4);
+    //! NOTE: type mismatch
+    EXPECT_EQ(line_of("func f(v0: i32) -> i64 {\nbb0:\n"
+                      "    v1 = add i64 v0, v0\n    ret v1\n}\n"),
+              3);
+    //! NOTE: redefinition
+    EXPECT_EQ(line_of("func f() -> i64 {\nbb0:\n    v0 = const i64 1\n"
+                      "    v0 = const i64 2\n    ret v0\n}\n"),
+              4);
+    //! NOTE: undefined callee
+    EXPECT_NE(line_of("func f() -> i64 {\nbb0:\n    v0 = call i64 @g()\n"
+                      "    ret v0\n}\n"),
+              0);
+    //! NOTE: lane isn't a constant
+    EXPECT_EQ(line_of("func f(v0: i32) -> i32 {\nbb0:\n"
+                      "    v1 = splat v4i32 v0\n"
+                      "    v2 = extract i32 v1, v0\n    ret v2\n}\n"),
+              4);
+    //! NOTE: arms of select have different types
+    EXPECT_EQ(line_of("func f(v0: i32, v1: i64) -> i64 {\nbb0:\n"
+                      "    v2 = select i64 v0, v0, v1\n    ret v2\n}\n"),
+              3);
+    //! NOTE: case value isn't a constant, duplicate case
+    EXPECT_EQ(line_of("func f(v0: i32) -> i32 {\nbb0:\n"
+                      "    switch v0, bb1, [v0: bb1]\nbb1:\n    ret v0\n}\n"),
+              3);
+    EXPECT_EQ(line_of("func f(v0: i32) -> i32 {\nbb0:\n    v1 = const i32 1\n"
+                      "    v2 = const i32 1\n    switch v0, bb1, [v1: bb1, "
+                      "v2: bb1]\nbb1:\n    ret v0\n}\n"),
+              5);
+    //! NOTE: case value of the other type
+    EXPECT_EQ(line_of("func f(v0: i32) -> i32 {\nbb0:\n    v1 = const i64 1\n"
+                      "    switch v0, bb1, [v1: bb1]\nbb1:\n    ret v0\n}\n"),
+              4);
+    //! NOTE: unterminated body
+    EXPECT_NE(line_of("func f() -> i64 {\nbb0:\n"), 0);
+}
+
+TEST(text_format, mapped_file) {
+    auto path = std::filesystem::temp_directory_path() / "jj_vm_text_format.ir";
+    {
+        std::ofstream os{path};
+        os << kFact;
+    }
+    auto funcs = IRParser::parse_file(path);
+    std::filesystem::remove(path);
+    ASSERT_EQ(funcs.size(), 1);
+    EXPECT_EQ(to_string(*funcs.front()),
+              to_string(*IRParser::parse(kFact).front()));
+    //
+    EXPECT_THROW(IRParser::parse_file(path), std::system_error);
+}
+
+}  // namespace jj_vm::ir::testing
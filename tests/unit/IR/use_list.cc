@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/instruction.hh"
+#include "IR/ir_builder.hh"
+
+namespace jj_vm::ir::testing {
+
+class UseListTest : public ::testing::Test {
+protected:
+    Function m_func{Type::create<TypeId::I64>(), "use_list"};
+    IRBuilder m_builder{};
+    BasicBlock* m_bb = nullptr;
+
+    UseListTest() {
+        m_bb = m_func.create<BasicBlock>();
+        m_builder.set_insert_point(m_bb);
+    }
+
+    static std::vector<Instr*> collect_users(const Value* val) {
+        std::vector<Instr*> users{};
+        for (auto* user : val->users()) users.push_back(user);
+        return users;
+    }
+};
+
+TEST_F(UseListTest, add_input) {
+    auto* v0 = m_builder.create<ConstI64>(1);
+    auto* v1 = m_builder.create<ConstI64>(2);
+    auto* v2 = m_builder.create<BinInstr>(Opcode::ADD, v0, v1);
+    auto* v3 = m_builder.create<BinInstr>(Opcode::XOR, v0, v0);
+
+    EXPECT_FALSE(v2->has_users());
+    EXPECT_EQ(v1->users().size(), 1);
+    EXPECT_EQ(*v1->users().begin(), v2);
+
+    //! NOTE: one entry per use
+    auto v0_users = collect_users(v0);
+    EXPECT_EQ(v0_users.size(), 3);
+    EXPECT_EQ(std::count(v0_users.begin(), v0_users.end(), v3), 2);
+    EXPECT_EQ(std::count(v0_users.begin(), v0_users.end(), v2), 1);
+}
+
+TEST_F(UseListTest, set_input) {
+    auto* v0 = m_builder.create<ConstI64>(1);
+    auto* v1 = m_builder.create<ConstI64>(2);
+    auto* v2 = m_builder.create<BinInstr>(Opcode::ADD, v0, v0);
+
+    v2->set_input(1, v1);
+
+    EXPECT_EQ(v2->lhs(), v0);
+    EXPECT_EQ(v2->rhs(), v1);
+    EXPECT_EQ(v0->users().size(), 1);
+    EXPECT_EQ(v1->users().size(), 1);
+}
+
+TEST_F(UseListTest, clean_inputs) {
+    auto* v0 = m_builder.create<ConstI64>(1);
+    auto* v1 = m_builder.create<ConstI64>(2);
+    auto* v2 = m_builder.create<BinInstr>(Opcode::ADD, v0, v1);
+
+    v2->clean_inputs();
+
+    EXPECT_FALSE(v0->has_users());
+    EXPECT_FALSE(v1->has_users());
+    EXPECT_TRUE(v2->inputs().empty());
+}
+
+TEST_F(UseListTest, replace_users) {
+    auto* v0 = m_builder.create<ConstI64>(1);
+    auto* v1 = m_builder.create<ConstI64>(2);
+    auto* v2 = m_builder.create<BinInstr>(Opcode::ADD, v0, v1);
+    auto* v3 = m_builder.create<BinInstr>(Opcode::SUB, v0, v0);
+
+    v1->replace_users(*v0);
+
+    EXPECT_FALSE(v0->has_users());
+    EXPECT_EQ(v1->users().size(), 4);
+    EXPECT_EQ(v2->lhs(), v1);
+    EXPECT_EQ(v2->rhs(), v1);
+    EXPECT_EQ(v3->lhs(), v1);
+    EXPECT_EQ(v3->rhs(), v1);
+}
+
+TEST_F(UseListTest, erase_user) {
+    auto* v0 = m_builder.create<ConstI64>(1);
+    auto* v1 = m_builder.create<BinInstr>(Opcode::ADD, v0, v0);
+
+    m_bb->erase(v1);
+
+    EXPECT_FALSE(v0->has_users());
+}
+
+TEST_F(UseListTest, operands_growth) {
+    auto* phi = m_builder.create<PhiInstr>(TypeId::I64);
+    std::vector<Instr*> values{};
+    //
+    for (int i = 0; i < 100; ++i) {
+        values.push_back(m_builder.create<ConstI64>(i));
+        phi->add_node({values.back(), m_bb});
+    }
+
+    //! NOTE: relocation of operands should keep use-lists consistent
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        EXPECT_EQ(phi->get_input(i), values[i]);
+        EXPECT_EQ(values[i]->users().size(), 1);
+        EXPECT_EQ(*values[i]->users().begin(), phi);
+    }
+}
+
+}  // namespace jj_vm::ir::testing
@@ -0,0 +1,147 @@
+#include "analysis/call_graph.hh"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "IR/ir_parser.hh"
+#include "graph/dfs.hh"
+
+namespace jj_vm::testing {
+
+using namespace jj_vm::ir;
+using namespace jj_vm::analysis::callgraph;
+
+/*
+    main -> a, d
+    a -> b
+    b -> a, c
+    c -> c
+    e is never called
+*/
+static constexpr std::string_view kModule = R"(
+func main(v0: i64) -> i64 {
+bb0:
+    v1 = call i64 @a(v0)
+    v2 = call i64 @d(v1)
+    v3 = call i64 @a(v2)
+    ret v3
+}
+
+func a(v0: i64) -> i64 {
+bb0:
+    v1 = call i64 @b(v0)
+    ret v1
+}
+
+func b(v0: i64) -> i64 {
+bb0:
+    v1 = const i64 0
+    v2 = eq i64 v0, v1
+    if v2, bb1, bb2
+bb1:
+    v3 = call i64 @c(v0)
+    ret v3
+bb2:
+    v4 = call i64 @a(v0)
+    ret v4
+}
+
+func c(v0: i64) -> i64 {
+bb0:
+    v1 = call i64 @c(v0)
+    ret v1
+}
+
+func d(v0: i64) -> i64 {
+bb0:
+    ret v0
+}
+
+func e(v0: i64) -> i64 {
+bb0:
+    ret v0
+}
+)";
+
+class CallGraphTest : public ::testing::Test {
+protected:
+    Module m_module{"test", IRParser::parse(kModule)};
+    CallGraph m_graph{m_module};
+
+    CallGraphNode* node(std::string_view name) const {
+        return m_graph.get_node(m_module.find(name));
+    }
+
+    template <typename T>
+    static std::size_t position(const std::vector<T*>& order, T* elem) {
+        return static_cast<std::size_t>(
+            std::find(order.begin(), order.end(), elem) - order.begin());
+    }
+};
+
+TEST_F(CallGraphTest, edges) {
+    EXPECT_EQ(m_graph.size(), m_module.size() + 1);
+    EXPECT_TRUE(m_graph.head()->is_external());
+    EXPECT_EQ(m_graph.head()->callees().size(), m_module.size());
+    //
+    auto* main = node("main");
+    EXPECT_EQ(main->callees(), (std::vector{node("a"), node("d")}));
+    EXPECT_EQ(main->call_sites().size(), 3);
+    EXPECT_TRUE(main->callers().empty());
+    //
+    EXPECT_EQ(node("a")->callers(), (std::vector{main, node("b")}));
+    EXPECT_TRUE(node("c")->calls(node("c")));
+    EXPECT_TRUE(node("e")->callees().empty());
+}
+
+TEST_F(CallGraphTest, sccs) {
+    //! NOTE: c, {a, b}, d, main, e
+    EXPECT_EQ(m_graph.sccs_num(), 5);
+    //
+    auto& ab = m_graph.get_scc(m_module.find("a"));
+    EXPECT_EQ(&ab, &m_graph.get_scc(m_module.find("b")));
+    EXPECT_EQ(ab.size(), 2);
+    EXPECT_TRUE(ab.is_recursive());
+    //
+    EXPECT_TRUE(m_graph.get_scc(m_module.find("c")).is_recursive());
+    EXPECT_FALSE(m_graph.get_scc(m_module.find("d")).is_recursive());
+    EXPECT_FALSE(m_graph.get_scc(m_module.find("main")).is_recursive());
+}
+
+TEST_F(CallGraphTest, orders) {
+    auto bottom_up = m_graph.bottom_up_functions();
+    auto top_down = m_graph.top_down_functions();
+    ASSERT_EQ(bottom_up.size(), m_module.size());
+    ASSERT_EQ(top_down.size(), m_module.size());
+    //
+    //! NOTE: callee of another component is placed before the caller
+    for (auto&& func : m_module) {
+        auto* caller = m_graph.get_node(func.get());
+        for (auto* callee : caller->callees()) {
+            if (&m_graph.get_scc(callee->function()) ==
+                &m_graph.get_scc(caller->function()))
+                continue;
+            EXPECT_LT(position(bottom_up, callee->function()),
+                      position(bottom_up, caller->function()));
+            EXPECT_GT(position(top_down, callee->function()),
+                      position(top_down, caller->function()));
+        }
+    }
+    EXPECT_EQ(bottom_up.front(), m_module.find("c"));
+}
+
+TEST_F(CallGraphTest, dfs) {
+    //! NOTE: generic DFS starts at the external node & reaches every function
+    auto preorder = jj_vm::graph::deep_first_search_preoder(m_graph);
+    ASSERT_EQ(preorder.size(), m_graph.size());
+    EXPECT_EQ(preorder.front(), m_graph.head());
+    //
+    auto postorder = jj_vm::graph::deep_first_search_postoder(m_graph);
+    EXPECT_EQ(postorder.back(), m_graph.head());
+    EXPECT_LT(position(postorder, node("d")),
+              position(postorder, node("main")));
+}
+
+}  // namespace jj_vm::testing
@@ -0,0 +1,70 @@
+#include "analysis/escape_analysis.hh"
+
+#include <gtest/gtest.h>
+
+#include <string_view>
+
+#include "IR/ir_parser.hh"
+
+namespace jj_vm::testing {
+
+using namespace jj_vm::ir;
+using namespace jj_vm::analysis::memory;
+
+static constexpr std::string_view kModule = R"(
+func ext(v0: ptr) -> ptr {
+bb0:
+    ret v0
+}
+
+func escapes(v0: ptr, v1: i1) -> ptr {
+bb0:
+    v2 = const i64 16
+    v3 = const i64 8
+    v4 = alloc ptr v2
+    v5 = gep ptr v4, v3
+    v6 = null_check ptr v5
+    store v5, v2
+    v7 = load i64 v4
+    v8 = alloc ptr v2
+    v9 = gep ptr v8, v3
+    store v0, v9
+    v10 = alloc ptr v2
+    v11 = call ptr @ext(v10)
+    v12 = alloc ptr v2
+    v13 = alloc ptr v2
+    v14 = gep ptr v13, v7
+    v15 = alloc ptr v2
+    if v1, bb1, bb2
+bb1:
+    jmp bb2
+bb2:
+    v16 = phi ptr [v15, bb0], [v12, bb1]
+    ret v14
+}
+)";
+
+TEST(escape_analysis, users) {
+    auto funcs = IRParser::parse(kModule);
+    const auto& func = *funcs[1];
+    EscapeAnalysis escape{func};
+    //
+    const auto& allocs = escape.allocs();
+    ASSERT_EQ(allocs.size(), 6);
+    for (auto* alloc : allocs) EXPECT_TRUE(escape.is_alloc(alloc));
+    //
+    //! NOTE: accesses, GEPs & null checks keep the address local, it
+    //        escapes as the stored value, call arg, phi input & return
+    EXPECT_FALSE(escape.escapes(allocs[0]));
+    EXPECT_TRUE(escape.escapes(allocs[1]));
+    EXPECT_TRUE(escape.escapes(allocs[2]));
+    EXPECT_TRUE(escape.escapes(allocs[3]));
+    EXPECT_TRUE(escape.escapes(allocs[4]));
+    EXPECT_TRUE(escape.escapes(allocs[5]));
+    //
+    //! NOTE: params & other values aren't known
+    EXPECT_FALSE(escape.is_alloc(&*func.args().begin()));
+    EXPECT_TRUE(escape.escapes(&*func.args().begin()));
+}
+
+}  // namespace jj_vm::testing
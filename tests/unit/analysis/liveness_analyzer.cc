@@ -120,7 +120,7 @@ TEST_F(LivenessTest1, lecture) {
     EXPECT_EQ(m_instr.size(), ref_live_nums.size());
 
     for (std::size_t i = 0; i < m_instr.size(); ++i)
-        EXPECT_EQ(m_instr.at(i)->live(), ref_live_nums[i]);
+        EXPECT_EQ(m_analyzer.live(m_instr.at(i)), ref_live_nums[i]);
 
     for (std::size_t i = 0; i < m_instr.size(); ++i) {
         EXPECT_EQ(*m_analyzer.get_interval(m_instr.at(i)), ref_life_ranges[i]);
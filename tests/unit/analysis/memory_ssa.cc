@@ -0,0 +1,234 @@
+#include "analysis/memory_ssa.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string_view>
+
+#include "IR/ir_parser.hh"
+
+namespace jj_vm::testing {
+
+using namespace jj_vm::ir;
+using namespace jj_vm::analysis::memory;
+
+//! NOTE: n-th instruction with the opcode in the order of blocks
+static Instr* nth(Function& func, Opcode opc, std::size_t idx) {
+    for (auto&& bb : func)
+        for (auto&& instr : bb)
+            if (instr.opcode() == opc && idx-- == 0) return &instr;
+    ADD_FAILURE() << "no instruction";
+    return nullptr;
+}
+
+static std::size_t pred_idx(const BasicBlock* bb, const BasicBlock* pred) {
+    for (std::size_t idx = 0; idx < bb->preds_num(); ++idx)
+        if (bb->preds()[idx] == pred) return idx;
+    ADD_FAILURE() << "no pred";
+    return 0;
+}
+
+/*
+    bb0: store 1
+     /     \
+    bb1:    bb2
+    store 2 |
+     \     /
+    bb3: load
+*/
+static constexpr std::string_view kDiamond = R"(
+func diamond(v0: i1) -> i64 {
+bb0:
+    v1 = const i64 8
+    v2 = alloc ptr v1
+    v3 = const i64 1
+    store v2, v3
+    if v0, bb1, bb2
+bb1:
+    v4 = const i64 2
+    store v2, v4
+    jmp bb3
+bb2:
+    jmp bb3
+bb3:
+    v5 = load i64 v2
+    ret v5
+}
+)";
+
+TEST(memory_ssa, diamond) {
+    auto funcs = IRParser::parse(kDiamond);
+    auto& func = *funcs.front();
+    MemorySSA mssa{func};
+    //
+    auto* first = mssa.access(nth(func, Opcode::STORE, 0));
+    auto* second = mssa.access(nth(func, Opcode::STORE, 1));
+    auto* load = mssa.access(nth(func, Opcode::LOAD, 0));
+    ASSERT_TRUE(first->is_def());
+    ASSERT_TRUE(load->is_use());
+    EXPECT_EQ(first->defining(), mssa.live_on_entry());
+    EXPECT_EQ(second->defining(), first);
+    EXPECT_EQ(mssa.access(nth(func, Opcode::ALLOC, 0)), nullptr);
+    //
+    auto* join = load->block();
+    auto* phi = mssa.phi(join);
+    ASSERT_NE(phi, nullptr);
+    EXPECT_EQ(load->defining(), phi);
+    EXPECT_EQ(phi->incoming()[pred_idx(join, second->block())], second);
+    EXPECT_EQ(phi->incoming()[pred_idx(join, &*std::next(func.begin(), 2))],
+              first);
+    for (auto&& bb : func) {
+        if (&bb != join) {
+            EXPECT_EQ(mssa.phi(&bb), nullptr);
+        }
+    }
+    //
+    ASSERT_EQ(mssa.exit_states().size(), 1);
+    EXPECT_TRUE(mssa.is_exit_state(phi));
+    EXPECT_TRUE(mssa.dominates(first, load));
+    EXPECT_FALSE(mssa.dominates(second, load));
+}
+
+static constexpr std::string_view kLoop = R"(
+func loop(v0: ptr, v1: i64) -> i64 {
+bb0:
+    v2 = const i64 0
+    jmp bb1
+bb1:
+    v3 = phi i64 [v2, bb0], [v5, bb2]
+    v4 = le i64 v3, v1
+    if v4, bb2, bb3
+bb2:
+    store v0, v3
+    v6 = const i64 1
+    v5 = add i64 v3, v6
+    jmp bb1
+bb3:
+    v7 = load i64 v0
+    ret v7
+}
+)";
+
+TEST(memory_ssa, loop) {
+    auto funcs = IRParser::parse(kLoop);
+    auto& func = *funcs.front();
+    MemorySSA mssa{func};
+    //
+    auto* store = mssa.access(nth(func, Opcode::STORE, 0));
+    auto* load = mssa.access(nth(func, Opcode::LOAD, 0));
+    auto* header = &*std::next(func.begin());
+    auto* phi = mssa.phi(header);
+    ASSERT_NE(phi, nullptr);
+    EXPECT_EQ(store->defining(), phi);
+    EXPECT_EQ(load->defining(), phi);
+    EXPECT_EQ(phi->incoming()[pred_idx(header, &func.front())],
+              mssa.live_on_entry());
+    EXPECT_EQ(phi->incoming()[pred_idx(header, store->block())], store);
+    EXPECT_EQ(phi->users().size(), 2);
+}
+
+static constexpr std::string_view kCalls = R"(
+func ext(v0: i64) -> i64 {
+bb0:
+    ret v0
+}
+
+func calls(v0: ptr) -> i64 {
+bb0:
+    v1 = const i64 8
+    v2 = alloc ptr v1
+    v3 = gep ptr v0, v1
+    store v2, v1
+    store v0, v1
+    store v3, v1
+    v4 = call i64 @ext(v1)
+    v5 = load i64 v2
+    v6 = load i64 v0
+    v7 = add i64 v5, v6
+    ret v7
+}
+)";
+
+TEST(memory_ssa, clobbering) {
+    auto funcs = IRParser::parse(kCalls);
+    auto& func = *funcs[1];
+    MemorySSA mssa{func};
+    AliasAnalysis aa{func};
+    //
+    auto* local = nth(func, Opcode::LOAD, 0);
+    auto* param = nth(func, Opcode::LOAD, 1);
+    auto* call = mssa.access(nth(func, Opcode::CALL, 0));
+    EXPECT_EQ(mssa.access(local)->defining(), call);
+    EXPECT_EQ(mssa.access(param)->defining(), call);
+    //
+    //! NOTE: the call doesn't see the local alloc, stores of other
+    //        locations are skipped
+    EXPECT_EQ(mssa.clobbering(mssa.access(local), aa.location(*local), aa),
+              mssa.access(nth(func, Opcode::STORE, 0)));
+    EXPECT_EQ(mssa.clobbering(mssa.access(param), aa.location(*param), aa),
+              call);
+    //
+    auto* store = mssa.access(nth(func, Opcode::STORE, 2));
+    mssa.remove(call);
+    EXPECT_EQ(mssa.access(param)->defining(), store);
+    EXPECT_EQ(mssa.clobbering(mssa.access(param), aa.location(*param), aa),
+              mssa.access(nth(func, Opcode::STORE, 1)));
+    EXPECT_TRUE(mssa.is_exit_state(store));
+}
+
+static constexpr std::string_view kLocations = R"(
+func locations(v0: ptr, v1: i64) -> i64 {
+bb0:
+    v2 = const i64 16
+    v3 = alloc ptr v2
+    v4 = alloc ptr v2
+    v5 = alloc ptr v2
+    v6 = const i64 4
+    v7 = gep ptr v3, v6
+    v8 = gep ptr v3, v1
+    v9 = const i32 0
+    store v3, v1
+    store v3, v9
+    store v7, v9
+    store v8, v1
+    store v4, v1
+    store v5, v1
+    store v0, v1
+    store v0, v5
+    ret v1
+}
+)";
+
+TEST(alias_analysis, locations) {
+    auto funcs = IRParser::parse(kLocations);
+    auto& func = *funcs.front();
+    AliasAnalysis aa{func};
+    auto store = [&func](std::size_t idx) -> const Instr& {
+        return *nth(func, Opcode::STORE, idx);
+    };
+    //
+    auto loc = aa.location(store(2));
+    EXPECT_EQ(loc.m_base, nth(func, Opcode::ALLOC, 0));
+    EXPECT_EQ(loc.m_offset, 4);
+    EXPECT_EQ(loc.m_size, 4);
+    EXPECT_TRUE(loc.m_exact);
+    EXPECT_FALSE(aa.location(store(3)).m_exact);
+    //
+    //! NOTE: same base: [0, 8), [0, 4), [4, 8) & unknown offset
+    EXPECT_EQ(aa.alias(store(0), store(0)), AliasResult::MUST_ALIAS);
+    EXPECT_EQ(aa.alias(store(0), store(1)), AliasResult::MAY_ALIAS);
+    EXPECT_EQ(aa.alias(store(1), store(2)), AliasResult::NO_ALIAS);
+    EXPECT_EQ(aa.alias(store(2), store(3)), AliasResult::MAY_ALIAS);
+    //
+    //! NOTE: the last alloc escapes, it is stored to the memory
+    EXPECT_TRUE(aa.is_local(nth(func, Opcode::ALLOC, 0)));
+    EXPECT_FALSE(aa.is_local(nth(func, Opcode::ALLOC, 2)));
+    EXPECT_TRUE(aa.is_alloc(nth(func, Opcode::ALLOC, 2)));
+    EXPECT_EQ(aa.alias(store(0), store(4)), AliasResult::NO_ALIAS);
+    EXPECT_EQ(aa.alias(store(4), store(5)), AliasResult::NO_ALIAS);
+    EXPECT_EQ(aa.alias(store(4), store(6)), AliasResult::NO_ALIAS);
+    EXPECT_EQ(aa.alias(store(5), store(6)), AliasResult::MAY_ALIAS);
+    EXPECT_EQ(aa.alias(store(6), store(7)), AliasResult::MUST_ALIAS);
+}
+
+}  // namespace jj_vm::testing
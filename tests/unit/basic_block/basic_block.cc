@@ -1,6 +1,102 @@
 #include "gtest/gtest.h"
 #include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/ir_builder.hh"
 
 TEST(BasicBlock, init) {
     jj_vm::ir::BasicBlock bb{1};
-}
\ No newline at end of file
+}
+
+namespace jj_vm::ir::testing {
+
+class BasicBlockOrder : public ::testing::Test {
+protected:
+    Function m_func{Type::create<TypeId::I64>(), "order"};
+    IRBuilder m_builder{};
+    BasicBlock* m_bb = nullptr;
+
+    BasicBlockOrder() {
+        m_bb = m_func.create<BasicBlock>();
+        m_builder.set_insert_point(m_bb);
+    }
+
+    std::vector<Instr*> fill(std::size_t num) {
+        std::vector<Instr*> instrs{};
+        for (std::size_t i = 0; i < num; ++i)
+            instrs.push_back(m_builder.create<ConstI64>(i));
+        return instrs;
+    }
+
+    void expect_ordered(const std::vector<Instr*>& instrs) {
+        for (std::size_t i = 0; i < instrs.size(); ++i)
+            for (std::size_t j = 0; j < instrs.size(); ++j)
+                EXPECT_EQ(m_bb->comes_before(instrs[i], instrs[j]), i < j);
+    }
+};
+
+TEST_F(BasicBlockOrder, lazy_numbering) {
+    auto instrs = fill(8);
+    EXPECT_FALSE(m_bb->is_order_valid());
+
+    expect_ordered(instrs);
+    EXPECT_TRUE(m_bb->is_order_valid());
+
+    //! NOTE: appending keeps order valid
+    instrs.push_back(m_builder.create<ConstI64>(42));
+    EXPECT_TRUE(m_bb->is_order_valid());
+    expect_ordered(instrs);
+}
+
+TEST_F(BasicBlockOrder, insert_into_gap) {
+    auto instrs = fill(4);
+    expect_ordered(instrs);
+
+    auto* front = m_builder.emplace_front<ConstI64>(-1);
+    instrs.insert(instrs.begin(), front);
+    EXPECT_TRUE(m_bb->is_order_valid());
+    expect_ordered(instrs);
+
+    //! NOTE: replace puts new instruction between the same neighbours
+    auto* replaced = m_func.create<ConstI64>(100);
+    m_bb->replace_instr(instrs[2], replaced);
+    instrs[2] = replaced;
+    EXPECT_TRUE(m_bb->is_order_valid());
+    expect_ordered(instrs);
+}
+
+TEST_F(BasicBlockOrder, gap_exhausted) {
+    auto instrs = fill(2);
+    expect_ordered(instrs);
+
+    //! NOTE: repeated insertions to the front eventually exhaust the gap
+    for (int i = 0; i < 16; ++i)
+        instrs.insert(instrs.begin(), m_builder.emplace_front<ConstI64>(i));
+    expect_ordered(instrs);
+}
+
+TEST_F(BasicBlockOrder, erase) {
+    auto instrs = fill(6);
+    expect_ordered(instrs);
+
+    erase(m_bb, instrs[3]);
+    instrs.erase(instrs.begin() + 3);
+    EXPECT_TRUE(m_bb->is_order_valid());
+    expect_ordered(instrs);
+}
+
+TEST_F(BasicBlockOrder, splice) {
+    auto instrs = fill(4);
+    expect_ordered(instrs);
+
+    auto* other = m_func.create<BasicBlock>();
+    m_builder.set_insert_point(other);
+    auto* moved0 = m_builder.create<ConstI64>(10);
+    auto* moved1 = m_builder.create<ConstI64>(11);
+
+    m_bb->splice(BasicBlock::iterator{instrs[1]}, *other);
+    EXPECT_FALSE(m_bb->is_order_valid());
+    instrs.insert(instrs.begin() + 1, {moved0, moved1});
+    expect_ordered(instrs);
+}
+
+}  // namespace jj_vm::ir::testing
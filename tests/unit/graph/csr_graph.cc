@@ -0,0 +1,132 @@
+#include "graph/csr_graph.hh"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+//
+#include "builder.hh"
+#include "graph/dfs.hh"
+#include "utils/dense_set.hh"
+
+namespace jj_vm::testing {
+
+/**
+ * @brief Graph example 2 of DFS tests: loops B-C-D-E-F-G-H, C-D & E-F
+ */
+class CSRGraphTest : public TestBuilder {
+protected:
+    void create_test() {
+        init_test(11);
+        //
+        create_edge('B', 'A');
+        create_edge('C', 'B');
+        create_edge('J', 'B');
+        create_edge('D', 'C');
+        create_edge('C', 'D');
+        create_edge('E', 'D');
+        create_edge('F', 'E');
+        create_edge('E', 'F');
+        create_edge('G', 'F');
+        create_edge('H', 'G');
+        create_edge('I', 'G');
+        create_edge('B', 'H');
+        create_edge('K', 'I');
+        create_edge('C', 'J');
+    }
+
+    template <typename GraphTy>
+    static std::vector<jj_vm::ir::BasicBlock*> succs(
+        const GraphTy& graph, jj_vm::ir::BasicBlock* bb) {
+        return {graph.succs_begin(bb), graph.succs_end(bb)};
+    }
+
+    template <typename GraphTy>
+    static std::vector<jj_vm::ir::BasicBlock*> preds(
+        const GraphTy& graph, jj_vm::ir::BasicBlock* bb) {
+        return {graph.preds_begin(bb), graph.preds_end(bb)};
+    }
+};
+
+TEST_F(CSRGraphTest, rows) {
+    create_test();
+    jj_vm::graph::CSRGraph graph{*m_func};
+    //
+    EXPECT_EQ(graph.head(), get_bb(0));
+    EXPECT_EQ(graph.size(), 11);
+    EXPECT_EQ(graph.edges_num(), 14);
+    for (auto* bb : m_basic_blocks) {
+        EXPECT_EQ(succs(graph, bb), bb->succs());
+        EXPECT_EQ(preds(graph, bb), bb->preds());
+    }
+}
+
+TEST_F(CSRGraphTest, erased_block) {
+    //! NOTE: id of the erased block is skipped
+    create_test();
+    auto* extra = m_func->create<jj_vm::ir::BasicBlock>();
+    auto* last = m_func->create<jj_vm::ir::BasicBlock>();
+    m_func->erase(extra);
+    jj_vm::ir::BasicBlock::link_blocks(last, get_bb(letter_cast('K')));
+    //
+    jj_vm::graph::CSRGraph graph{*m_func};
+    EXPECT_EQ(graph.size(), 12);
+    EXPECT_EQ(preds(graph, last),
+              std::vector<jj_vm::ir::BasicBlock*>{get_bb(letter_cast('K'))});
+    EXPECT_TRUE(succs(graph, last).empty());
+    auto order = jj_vm::graph::deep_first_search_postoder(graph);
+    ASSERT_EQ(order.size(), 12);
+    EXPECT_EQ(*std::next(std::find(order.begin(), order.end(), last)),
+              get_bb(letter_cast('K')));
+}
+
+TEST_F(CSRGraphTest, analyses) {
+    //! NOTE: results on the snapshot are the same as on blocks
+    create_test();
+    auto bb_graph = m_func->bb_graph();
+    jj_vm::graph::CSRGraph csr_graph{*m_func};
+    //
+    EXPECT_EQ(jj_vm::graph::deep_first_search_preoder(csr_graph),
+              jj_vm::graph::deep_first_search_preoder(bb_graph));
+    EXPECT_EQ(jj_vm::graph::deep_first_search_postoder(csr_graph),
+              jj_vm::graph::deep_first_search_postoder(bb_graph));
+    //
+    auto bb_dom = jj_vm::graph::dom3_impl::DomTreeBuilder<
+        jj_vm::graph::BBGraph>::build(bb_graph);
+    auto csr_dom = jj_vm::graph::dom3_impl::DomTreeBuilder<
+        jj_vm::graph::CSRGraph>::build(csr_graph);
+    for (auto* lhs : m_basic_blocks)
+        for (auto* rhs : m_basic_blocks)
+            EXPECT_EQ(csr_dom.dominates(lhs, rhs), bb_dom.dominates(lhs, rhs))
+                << lhs->bb_id() << " " << rhs->bb_id();
+    //
+    auto bb_loops = jj_vm::analysis::loop::LoopTreeBuilder<
+        jj_vm::graph::BBGraph>::build(bb_graph);
+    auto csr_loops = jj_vm::analysis::loop::LoopTreeBuilder<
+        jj_vm::graph::CSRGraph>::build(csr_graph);
+    ASSERT_EQ(csr_loops.size(), bb_loops.size());
+    for (auto* bb : m_basic_blocks) {
+        const auto* bb_loop = bb_loops.get_loop(bb);
+        const auto* csr_loop = csr_loops.get_loop(bb);
+        EXPECT_EQ(csr_loop->header(), bb_loop->header()) << bb->bb_id();
+        EXPECT_EQ(csr_loop->loop_body(), bb_loop->loop_body());
+    }
+}
+
+TEST_F(CSRGraphTest, dense_set) {
+    init_test(130);
+    jj_vm::utils::DenseSet<jj_vm::ir::BasicBlock*> set{};
+    set.insert(get_bb(0));
+    set.insert(get_bb(64));
+    set.insert(get_bb(129));
+    set.erase(get_bb(64));
+    set.erase(get_bb(65));
+    //
+    for (auto* bb : m_basic_blocks)
+        EXPECT_EQ(set.contains(bb), bb == get_bb(0) || bb == get_bb(129));
+    set.clear();
+    EXPECT_FALSE(set.contains(get_bb(129)));
+}
+
+}  // namespace jj_vm::testing
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+//
+#include "builder.hh"
+#include "graph/dfs.hh"
+
+namespace jj_vm::testing {
+
+/**
+ * @brief Machine-generated shapes of million blocks: paths of DFS, DSU &
+ *        loop search are as long as the CFG, so analyses shouldn't recurse
+ *        over them
+ */
+class DeepCFGTest : public TestBuilder {
+protected:
+    static constexpr std::size_t kBlocksNum = 1'000'000;
+
+    using dom_tree = jj_vm::graph::dom3_impl::DomTree<jj_vm::graph::BBGraph>;
+    using loop_tree = jj_vm::analysis::loop::LoopTree<jj_vm::graph::BBGraph>;
+
+    /// Chain 0 -> 1 -> ... -> N - 1 with the back edge N - 1 -> 1
+    void create_chain() {
+        init_test(kBlocksNum);
+        for (std::size_t i = 0; i + 1 < kBlocksNum; ++i) make_edge(i + 1, i);
+        make_edge(1, kBlocksNum - 1);
+    }
+
+    /**
+     * @brief Entry 0 & two rails x_i = 2i + 1, y_i = 2i + 2 with rungs
+     *        x_i -> y_i+1, the back edge x_last -> x_0
+     */
+    void create_ladder() {
+        init_test(kBlocksNum + 1);
+        make_edge(x(0), 0);
+        make_edge(y(0), 0);
+        for (std::size_t i = 0; i + 1 < rungs(); ++i) {
+            make_edge(x(i + 1), x(i));
+            make_edge(y(i + 1), x(i));
+            make_edge(y(i + 1), y(i));
+        }
+        make_edge(x(0), x(rungs() - 1));
+    }
+
+    static constexpr std::size_t rungs() { return kBlocksNum / 2; }
+    static constexpr std::size_t x(std::size_t idx) { return 2 * idx + 1; }
+    static constexpr std::size_t y(std::size_t idx) { return 2 * idx + 2; }
+
+    dom_tree build_dom() const {
+        return jj_vm::graph::dom3_impl::DomTreeBuilder<
+            jj_vm::graph::BBGraph>::build(m_func->bb_graph());
+    }
+
+    loop_tree build_loops() const {
+        return jj_vm::analysis::loop::LoopTreeBuilder<
+            jj_vm::graph::BBGraph>::build(m_func->bb_graph());
+    }
+};
+
+TEST_F(DeepCFGTest, chain) {
+    create_chain();
+    auto postorder =
+        jj_vm::graph::deep_first_search_postoder(m_func->bb_graph());
+    ASSERT_EQ(postorder.size(), kBlocksNum);
+    EXPECT_EQ(postorder.front(), get_bb(kBlocksNum - 1));
+    //
+    auto dom = build_dom();
+    for (std::size_t i = 1; i < kBlocksNum; ++i) {
+        ASSERT_EQ(dom.idom(get_bb(i)), get_bb(i - 1)) << i;
+        ASSERT_EQ(dom.depth(get_bb(i)), i);
+    }
+    EXPECT_TRUE(dom.dominates(get_bb(1), get_bb(kBlocksNum - 1)));
+    EXPECT_FALSE(dom.dominates(get_bb(kBlocksNum - 1), get_bb(1)));
+    //
+    auto loops = build_loops();
+    const auto* loop = loops.get_loop(get_bb(1));
+    ASSERT_EQ(loop->header(), get_bb(1));
+    EXPECT_TRUE(loop->is_reducible());
+    EXPECT_EQ(loop->loop_body().size(), kBlocksNum - 2);
+    for (std::size_t i = 2; i < kBlocksNum; ++i)
+        ASSERT_EQ(loops.get_loop(get_bb(i)), loop) << i;
+    EXPECT_TRUE(loops.get_loop(get_bb(0))->is_root());
+}
+
+TEST_F(DeepCFGTest, ladder) {
+    create_ladder();
+    auto dom = build_dom();
+    EXPECT_EQ(dom.idom(get_bb(x(0))), get_bb(0));
+    for (std::size_t i = 0; i < rungs(); ++i) {
+        if (i != 0) {
+            ASSERT_EQ(dom.idom(get_bb(x(i))), get_bb(x(i - 1))) << i;
+        }
+        ASSERT_EQ(dom.idom(get_bb(y(i))), get_bb(0)) << i;
+    }
+    EXPECT_TRUE(dom.dominates(get_bb(x(0)), get_bb(x(rungs() - 1))));
+    EXPECT_FALSE(dom.dominates(get_bb(x(0)), get_bb(y(rungs() - 1))));
+    //
+    //! NOTE: the loop is the x rail, y blocks are out of loops
+    auto loops = build_loops();
+    const auto* loop = loops.get_loop(get_bb(x(0)));
+    ASSERT_EQ(loop->header(), get_bb(x(0)));
+    EXPECT_TRUE(loop->is_reducible());
+    for (std::size_t i = 0; i < rungs(); ++i) {
+        ASSERT_EQ(loops.get_loop(get_bb(x(i))), loop) << i;
+        ASSERT_TRUE(loops.get_loop(get_bb(y(i)))->is_root()) << i;
+    }
+}
+
+}  // namespace jj_vm::testing
@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
 //
 #include "builder.hh"
 #include "graph/dfs.hh"
@@ -139,4 +142,104 @@ TEST_F(Dom3Tree3, basic) {
     ASSERT_TRUE(is_dominator(5, 7));
 }
 
+TEST_F(Dom3Tree3, idoms) {
+    create_test();
+    //! NOTE: A-B, B-C, B-D, B-E, B-G, B-I, E-F, F-H
+    const std::vector<std::size_t> kIdoms{0, 0, 1, 1, 1, 4, 1, 5, 1};
+    const std::vector<std::size_t> kDepths{0, 1, 2, 2, 2, 3, 2, 4, 2};
+    //
+    EXPECT_EQ(m_tree.idom(get_bb(0)), nullptr);
+    for (std::size_t i = 1; i < m_basic_blocks.size(); ++i)
+        EXPECT_EQ(m_tree.idom(get_bb(i)), get_bb(kIdoms[i])) << i;
+    for (std::size_t i = 0; i < m_basic_blocks.size(); ++i)
+        EXPECT_EQ(m_tree.depth(get_bb(i)), kDepths[i]) << i;
+    //
+    //! NOTE: children are in the DFS preorder: A B C D G I E F H
+    using Blocks = std::vector<jj_vm::ir::BasicBlock*>;
+    EXPECT_EQ(m_tree.children(get_bb(0)), Blocks{get_bb(1)});
+    EXPECT_EQ(m_tree.children(get_bb(1)),
+              (Blocks{get_bb(2), get_bb(3), get_bb(6), get_bb(8), get_bb(4)}));
+    EXPECT_TRUE(m_tree.children(get_bb(7)).empty());
+    EXPECT_FALSE(is_dominator(7, 5));
+    EXPECT_FALSE(is_dominator(2, 3));
+}
+
+TEST_F(DominatorInterface, unreachable) {
+    init_test(3);
+    make_edge(1, 0);
+    make_edge(1, 2);
+    build();
+    //
+    EXPECT_FALSE(m_tree.contains(get_bb(2)));
+    EXPECT_TRUE(is_dominator(2, 2));
+    EXPECT_FALSE(is_dominator(2, 1));
+    EXPECT_FALSE(is_dominator(0, 2));
+    EXPECT_EQ(m_tree.idom(get_bb(2)), nullptr);
+    EXPECT_EQ(m_tree.idom(get_bb(1)), get_bb(0));
+}
+
+TEST_F(DominatorInterface, random) {
+    //! NOTE: dominators are compared with the iterative dataflow solution
+    //!       dom(n) = {n} + intersection of dom(p) over preds
+    std::mt19937 gen{7};
+    for (std::size_t round = 0; round < 50; ++round) {
+        const std::size_t size = 2 + gen() % 40;
+        init_test(size);
+        for (std::size_t i = 0; i + 1 < size; ++i)
+            if (gen() % 4 != 0) make_edge(i + 1, gen() % (i + 1));
+        for (std::size_t edge = 0; edge < size; ++edge)
+            make_edge(gen() % size, gen() % size);
+        build();
+        //
+        auto rpo = jj_vm::graph::deep_first_search_reverse_postoder(
+            m_func->bb_graph());
+        std::vector<std::vector<bool>> doms(size,
+                                            std::vector<bool>(size, true));
+        std::vector<bool> reachable(size, false);
+        for (auto* bb : rpo) reachable[bb->bb_id()] = true;
+        doms[0].assign(size, false);
+        doms[0][0] = true;
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (auto* bb : rpo) {
+                if (bb == get_bb(0)) continue;
+                std::vector<bool> cur(size, true);
+                for (auto* pred : bb->preds()) {
+                    if (!reachable[pred->bb_id()]) continue;
+                    for (std::size_t i = 0; i < size; ++i)
+                        cur[i] = cur[i] && doms[pred->bb_id()][i];
+                }
+                cur[bb->bb_id()] = true;
+                changed = changed || cur != doms[bb->bb_id()];
+                doms[bb->bb_id()] = cur;
+            }
+        }
+        //
+        for (std::size_t lhs = 0; lhs < size; ++lhs)
+            for (std::size_t rhs = 0; rhs < size; ++rhs) {
+                bool expected =
+                    lhs == rhs ||
+                    (reachable[lhs] && reachable[rhs] && doms[rhs][lhs]);
+                ASSERT_EQ(is_dominator(lhs, rhs), expected)
+                    << round << ": " << lhs << " " << rhs;
+            }
+        //
+        //! NOTE: idom is the strict dominator with the largest depth
+        for (auto* bb : rpo) {
+            std::size_t depth = 0;
+            for (std::size_t i = 0; i < size; ++i)
+                depth += doms[bb->bb_id()][i];
+            ASSERT_EQ(m_tree.depth(bb), depth - 1);
+            auto* idom = m_tree.idom(bb);
+            if (bb == get_bb(0)) {
+                EXPECT_EQ(idom, nullptr);
+                continue;
+            }
+            ASSERT_NE(idom, nullptr);
+            EXPECT_TRUE(doms[bb->bb_id()][idom->bb_id()]);
+            EXPECT_EQ(m_tree.depth(idom) + 1, m_tree.depth(bb));
+        }
+    }
+}
+
 }  // namespace jj_vm::testing
\ No newline at end of file
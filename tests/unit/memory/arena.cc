@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "IR/function.hh"
+#include "IR/ir_builder.hh"
+#include "intrusive_list/ilist.hh"
+#include "memory/arena.hh"
+
+namespace jj_vm::testing {
+
+class CountedNode final : public jj_vm::ilist_detail::ilist_node {
+    int& m_counter;
+
+public:
+    explicit CountedNode(int& counter) : m_counter(counter) {}
+    ~CountedNode() { ++m_counter; }
+};
+
+TEST(Arena, alignment) {
+    jj_vm::memory::Arena arena{};
+    //
+    auto* byte = arena.allocate(1, 1);
+    auto* word = arena.allocate(sizeof(std::uint64_t), alignof(std::uint64_t));
+    auto* big = arena.allocate(1, 64);
+
+    EXPECT_NE(byte, word);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(word) % alignof(std::uint64_t),
+              0);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(big) % 64, 0);
+    EXPECT_EQ(arena.slabs_num(), 1);
+}
+
+TEST(Arena, huge_allocation) {
+    jj_vm::memory::Arena arena{};
+    //
+    arena.allocate(16);
+    arena.allocate(jj_vm::memory::Arena::kMaxSlabSize * 2);
+
+    EXPECT_EQ(arena.slabs_num(), 2);
+    EXPECT_GE(arena.reserved(), jj_vm::memory::Arena::kMaxSlabSize * 2);
+}
+
+TEST(Arena, ilist_destroys_nodes) {
+    int destroyed = 0;
+    {
+        jj_vm::memory::Arena arena{};
+        jj_vm::ilist_arena<CountedNode> list{};
+        //
+        for (int i = 0; i < 10; ++i)
+            jj_vm::emplace_back<CountedNode>(list, arena, destroyed);
+
+        list.erase(list.begin());
+        EXPECT_EQ(destroyed, 1);
+    }
+    EXPECT_EQ(destroyed, 10);
+}
+
+TEST(Arena, function_owns_nodes) {
+    jj_vm::ir::Function func{jj_vm::ir::Type::create<jj_vm::ir::TypeId::I64>(),
+                             "func"};
+    jj_vm::ir::IRBuilder builder{};
+    //
+    builder.set_insert_point(func.create<jj_vm::ir::BasicBlock>());
+    auto* lhs = builder.create<jj_vm::ir::ConstI64>(1);
+    auto* rhs = builder.create<jj_vm::ir::ConstI64>(2);
+    builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::ADD, lhs, rhs);
+
+    EXPECT_GE(func.arena().allocated(), sizeof(jj_vm::ir::BinInstr));
+    EXPECT_EQ(func.front().size(), 3);
+}
+
+TEST(Arena, splice_shares_memory) {
+    using jj_vm::ir::Function;
+    //
+    auto callee = std::make_unique<Function>();
+    Function caller{};
+    caller.create<jj_vm::ir::BasicBlock>();
+    auto* moved = callee->create<jj_vm::ir::BasicBlock>();
+    //
+    caller.splice(caller.end(), *callee);
+    callee.reset();
+
+    //! NOTE: moved block is still accessible after callee destruction
+    EXPECT_EQ(&caller.back(), moved);
+    EXPECT_EQ(moved->parent(), &caller);
+}
+
+}  // namespace jj_vm::testing
@@ -1,4 +1,5 @@
 #include <cstdint>
+#include <tuple>
 
 #include "../graph/builder.hh"
 //
@@ -26,13 +27,13 @@ TEST_F(FoldingBuilder, MUL) {
 
     ASSERT_EQ(bb0->size(), 3);
 
-    const auto &last_instr = bb0->back();
+    const auto &folded_instr = bb0->front();
     //
-    ASSERT_EQ(last_instr.opcode(), jj_vm::ir::Opcode::CONST);
-    ASSERT_EQ(last_instr.type(), jj_vm::ir::TypeId::I64);
+    ASSERT_EQ(folded_instr.opcode(), jj_vm::ir::Opcode::CONST);
+    ASSERT_EQ(folded_instr.type(), jj_vm::ir::TypeId::I64);
 
     const auto &folded_const =
-        static_cast<const jj_vm::ir::ConstI64&>(last_instr);
+        static_cast<const jj_vm::ir::ConstI64&>(folded_instr);
 
     ASSERT_EQ(folded_const.val(), 64);
 }
@@ -52,13 +53,13 @@ TEST_F(FoldingBuilder, SHR) {
 
     ASSERT_EQ(bb0->size(), 3);
 
-    const auto &last_instr = bb0->back();
+    const auto &folded_instr = bb0->front();
     //
-    ASSERT_EQ(last_instr.opcode(), jj_vm::ir::Opcode::CONST);
-    ASSERT_EQ(last_instr.type(), jj_vm::ir::TypeId::I64);
+    ASSERT_EQ(folded_instr.opcode(), jj_vm::ir::Opcode::CONST);
+    ASSERT_EQ(folded_instr.type(), jj_vm::ir::TypeId::I64);
 
     const auto&folded_const =
-        static_cast<const jj_vm::ir::ConstI64 &>(last_instr);
+        static_cast<const jj_vm::ir::ConstI64 &>(folded_instr);
 
     ASSERT_EQ(folded_const.val(), 16);
 }
@@ -78,14 +79,158 @@ TEST_F(FoldingBuilder, XOR) {
 
     ASSERT_EQ(bb0->size(), 3);
 
-    const auto &last_instr = bb0->back();
+    const auto &folded_instr = bb0->front();
     //
-    ASSERT_EQ(last_instr.opcode(), jj_vm::ir::Opcode::CONST);
-    ASSERT_EQ(last_instr.type(), jj_vm::ir::TypeId::I64);
+    ASSERT_EQ(folded_instr.opcode(), jj_vm::ir::Opcode::CONST);
+    ASSERT_EQ(folded_instr.type(), jj_vm::ir::TypeId::I64);
     //
     const auto &folded_const =
-        static_cast<const jj_vm::ir::ConstI64&>(last_instr);
+        static_cast<const jj_vm::ir::ConstI64&>(folded_instr);
 
     ASSERT_EQ(folded_const.val(), 33);
 }
+
+TEST_F(FoldingBuilder, reuse_pooled) {
+    init_test(2);
+
+    auto bb0 = get_bb(0);
+    auto bb1 = get_bb(1);
+    m_builder.set_insert_point(bb0);
+    m_builder.create<jj_vm::ir::BranchInstr>(bb1);
+    auto *pooled = m_builder.get_const<int64_t>(64);
+
+    m_builder.set_insert_point(bb1);
+    auto *lval = m_builder.create<jj_vm::ir::ConstI64>(32);
+    auto *rval = m_builder.create<jj_vm::ir::ConstI64>(2);
+    auto *mul = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::MUL,
+                                                      lval, rval);
+    auto *shl = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::SHR,
+                                                      lval, rval);
+    auto *ret = m_builder.create<jj_vm::ir::RetInstr>(mul);
+    //
+    m_pass.run(m_func.get());
+
+    //! NOTE: folded values are taken from the pool, nothing is allocated
+    //!       for the known one
+    ASSERT_EQ(ret->get_input(0), pooled);
+    ASSERT_EQ(bb0->size(), 3);
+    ASSERT_EQ(bb1->size(), 3);
+    ASSERT_EQ(m_func->consts().size(), 2);
+    ASSERT_EQ(&bb0->front(), m_func->get_const<int64_t>(8));
+    ASSERT_EQ(bb0->front().get_next(), pooled);
+}
+
+TEST_F(FoldingBuilder, splats) {
+    init_test(1);
+
+    auto bb0 = get_bb(0);
+    m_builder.set_insert_point(bb0);
+    auto *lval = m_builder.create<jj_vm::ir::ConstI32>(6);
+    auto *rval = m_builder.create<jj_vm::ir::ConstI32>(7);
+    auto type = jj_vm::ir::Type::create<jj_vm::ir::TypeId::V4I32>();
+    auto *lvec = m_builder.create<jj_vm::ir::SplatInstr>(type, lval);
+    auto *rvec = m_builder.create<jj_vm::ir::SplatInstr>(type, rval);
+    auto *mul = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::MUL,
+                                                      lvec, rvec);
+    auto *ret = m_builder.create<jj_vm::ir::RetInstr>(mul);
+    //
+    m_pass.run(m_func.get());
+
+    //! NOTE: mul of splats is the splat of the folded constant
+    const auto *splat = static_cast<jj_vm::ir::Instr *>(ret->get_input(0));
+    ASSERT_EQ(splat->opcode(), jj_vm::ir::Opcode::SPLAT);
+    ASSERT_EQ(splat->type(), jj_vm::ir::TypeId::V4I32);
+    ASSERT_EQ(splat->get_input(0), m_func->get_const<int32_t>(42));
+}
+
+TEST_F(FoldingBuilder, lanes) {
+    init_test(1);
+
+    auto bb0 = get_bb(0);
+    m_builder.set_insert_point(bb0);
+    auto *val = m_builder.create<jj_vm::ir::ConstI64>(5);
+    auto *other = m_builder.create<jj_vm::ir::ConstI64>(9);
+    auto *lane0 = m_builder.create<jj_vm::ir::ConstI32>(0);
+    auto *lane1 = m_builder.create<jj_vm::ir::ConstI32>(1);
+    auto type = jj_vm::ir::Type::create<jj_vm::ir::TypeId::V2I64>();
+    auto *vec = m_builder.create<jj_vm::ir::SplatInstr>(type, val);
+    auto *ins = m_builder.create<jj_vm::ir::InsertLaneInstr>(vec, other, lane1);
+    auto *inserted = m_builder.create<jj_vm::ir::ExtractLaneInstr>(ins, lane1);
+    auto *splatted = m_builder.create<jj_vm::ir::ExtractLaneInstr>(ins, lane0);
+    auto *sum = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::ADD,
+                                                      inserted, splatted);
+    m_builder.create<jj_vm::ir::RetInstr>(sum);
+    //
+    m_pass.run(m_func.get());
+
+    //! NOTE: inserted lane is known, other lanes are taken from the splat,
+    //!       then the sum is folded
+    ASSERT_EQ(bb0->back().get_input(0), m_func->get_const<int64_t>(14));
+}
+
+TEST_F(FoldingBuilder, param_lanes) {
+    init_test(1);
+
+    auto bb0 = get_bb(0);
+    m_builder.set_insert_point(bb0);
+    auto *arg = m_func->create<jj_vm::ir::Param, jj_vm::ir::Type>(
+        jj_vm::ir::TypeId::V2I64);
+    auto *other = m_builder.create<jj_vm::ir::ConstI64>(9);
+    auto *lane0 = m_builder.create<jj_vm::ir::ConstI32>(0);
+    auto *lane1 = m_builder.create<jj_vm::ir::ConstI32>(1);
+    auto *ins = m_builder.create<jj_vm::ir::InsertLaneInstr>(arg, other, lane1);
+    auto *direct = m_builder.create<jj_vm::ir::ExtractLaneInstr>(arg, lane0);
+    auto *through = m_builder.create<jj_vm::ir::ExtractLaneInstr>(ins, lane0);
+    auto *sum = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::ADD,
+                                                      direct, through);
+    m_builder.create<jj_vm::ir::RetInstr>(sum);
+    //
+    m_pass.run(m_func.get());
+
+    //! NOTE: lanes of the param are unknown, the insert of other lane is
+    //!       skipped though
+    ASSERT_EQ(direct->vec(), arg);
+    ASSERT_EQ(through->vec(), arg);
+    ASSERT_EQ(sum->lhs(), direct);
+    ASSERT_EQ(sum->rhs(), through);
+}
+
+TEST_F(FoldingBuilder, select) {
+    init_test(1);
+
+    auto bb0 = get_bb(0);
+    m_builder.set_insert_point(bb0);
+    auto *lval = m_builder.create<jj_vm::ir::ConstI64>(3);
+    auto *rval = m_builder.create<jj_vm::ir::ConstI64>(4);
+    auto *cond = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::GE,
+                                                       lval, rval);
+    auto *max = m_builder.create<jj_vm::ir::SelectInstr>(cond, lval, rval);
+    auto *ret = m_builder.create<jj_vm::ir::RetInstr>(max);
+    //
+    m_pass.run(m_func.get());
+
+    //! NOTE: the condition is folded first, then the select is its arm
+    ASSERT_EQ(ret->get_input(0), rval);
+    ASSERT_EQ(bb0->size(), 4);
+}
+
+TEST_F(FoldingBuilder, compares) {
+    //! NOTE: le & ge are inclusive, equal operands give 1
+    using jj_vm::ir::Opcode;
+    for (auto [opc, lhs, rhs, expected] :
+         {std::tuple{Opcode::LE, 3, 3, 1}, std::tuple{Opcode::GE, 3, 3, 1},
+          std::tuple{Opcode::LE, 4, 3, 0}, std::tuple{Opcode::GE, 3, 4, 0},
+          std::tuple{Opcode::LE, -1, 3, 1}, std::tuple{Opcode::EQ, 3, 3, 1}}) {
+        init_test(1);
+        m_builder.set_insert_point(get_bb(0));
+        auto *lval = m_builder.create<jj_vm::ir::ConstI64>(lhs);
+        auto *rval = m_builder.create<jj_vm::ir::ConstI64>(rhs);
+        auto *cond = m_builder.create<jj_vm::ir::BinInstr>(opc, lval, rval);
+        auto *ret = m_builder.create<jj_vm::ir::RetInstr>(cond);
+        //
+        m_pass.run(m_func.get());
+        EXPECT_EQ(ret->get_input(0), m_func->get_const<int64_t>(expected))
+            << jj_vm::ir::mnemonic(opc) << " " << lhs << " " << rhs;
+    }
+}
 }
@@ -0,0 +1,155 @@
+#include "opt_passes/dead_store_elimination.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+
+#include "../IR/ir_helpers.hh"
+
+namespace jj_vm::ir::testing {
+
+static std::size_t run(Function& func) {
+    jj_vm::passes::DeadStoreElimination pass{};
+    pass.run(&func);
+    return pass.eliminated();
+}
+
+static constexpr std::string_view kModule = R"(
+func ext(v0: i64) -> i64 {
+bb0:
+    ret v0
+}
+
+func overwritten(v0: ptr, v1: i64) -> i64 {
+bb0:
+    v2 = const i64 8
+    v3 = alloc ptr v2
+    store v3, v1
+    store v3, v2
+    store v0, v1
+    store v0, v2
+    v4 = load i64 v3
+    ret v4
+}
+
+func never_read(v0: ptr, v1: i64) -> i64 {
+bb0:
+    v2 = const i64 16
+    v3 = alloc ptr v2
+    v4 = gep ptr v3, v1
+    store v3, v1
+    store v4, v1
+    store v0, v1
+    ret v1
+}
+
+func calls(v0: ptr, v1: i64) -> i64 {
+bb0:
+    v2 = const i64 8
+    v3 = alloc ptr v2
+    store v3, v1
+    store v0, v1
+    v4 = call i64 @ext(v1)
+    store v3, v4
+    store v0, v4
+    v5 = load i64 v3
+    ret v5
+}
+
+func partial(v0: ptr, v1: i64) -> i64 {
+bb0:
+    v2 = const i64 8
+    v3 = gep ptr v0, v2
+    v4 = const i32 0
+    store v0, v1
+    store v0, v4
+    store v3, v1
+    store v0, v1
+    ret v1
+}
+)";
+
+TEST(dead_store_elimination, straight_line) {
+    auto funcs = IRParser::parse(kModule);
+    //! NOTE: overwritten stores are dead, stores of local allocs which
+    //        aren't read are dead, params are read by the caller
+    //        & calls read all but local allocs
+    for (auto&& [idx, eliminated, left] :
+         {std::tuple{1, 2, 2}, {2, 2, 1}, {3, 1, 3}, {4, 2, 2}}) {
+        auto& func = *funcs[idx];
+        EXPECT_EQ(run(func), eliminated) << to_string(func);
+        EXPECT_EQ(count(func, Opcode::STORE), left) << to_string(func);
+        EXPECT_EQ(run(func), 0);
+    }
+}
+
+TEST(dead_store_elimination, control_flow) {
+    static constexpr std::string_view kText = R"(
+func control_flow(v0: i1, v1: i64) -> i64 {
+bb0:
+    v2 = const i64 8
+    v3 = alloc ptr v2
+    v4 = alloc ptr v2
+    store v3, v1
+    store v4, v1
+    if v0, bb1, bb2
+bb1:
+    store v3, v2
+    store v4, v2
+    jmp bb3
+bb2:
+    store v4, v2
+    jmp bb3
+bb3:
+    v5 = load i64 v3
+    v6 = load i64 v4
+    v7 = add i64 v5, v6
+    ret v7
+}
+)";
+    //! NOTE: the first store of v4 is overwritten on both paths, the first
+    //        store of v3 is read through bb2
+    auto funcs = IRParser::parse(kText);
+    auto& func = *funcs.front();
+    EXPECT_EQ(run(func), 1) << to_string(func);
+    ASSERT_EQ(count(func, Opcode::STORE), 4);
+    auto& first = *std::prev(func.front().end(), 2);
+    ASSERT_EQ(first.opcode(), Opcode::STORE);
+    EXPECT_EQ(first.get_input(0), &*std::next(func.front().begin()));
+}
+
+TEST(dead_store_elimination, loop) {
+    static constexpr std::string_view kText = R"(
+func loop(v0: i64) -> i64 {
+bb0:
+    v1 = const i64 0
+    v2 = const i64 8
+    v3 = alloc ptr v2
+    v4 = alloc ptr v2
+    store v3, v1
+    store v4, v1
+    jmp bb1
+bb1:
+    v5 = phi i64 [v1, bb0], [v7, bb2]
+    v6 = le i64 v5, v0
+    if v6, bb2, bb3
+bb2:
+    v8 = load i64 v3
+    v7 = add i64 v5, v8
+    store v4, v7
+    jmp bb1
+bb3:
+    ret v5
+}
+)";
+    //! NOTE: stores of v4 are never read
+    auto funcs = IRParser::parse(kText);
+    auto& func = *funcs.front();
+    EXPECT_EQ(run(func), 2) << to_string(func);
+    EXPECT_EQ(count(func, Opcode::STORE), 1);
+    EXPECT_EQ(count(func, Opcode::LOAD), 1);
+}
+
+}  // namespace jj_vm::ir::testing
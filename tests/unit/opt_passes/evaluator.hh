@@ -0,0 +1,156 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../IR/ir_helpers.hh"
+#include "IR/function.hh"
+#include "IR/instructions.hh"
+
+namespace jj_vm::ir::testing {
+
+/**
+ * @brief Interpreter of the function with lanes of vectors, integers are
+ *        wrapped to the width of the type
+ */
+class Evaluator final {
+    using Lanes = std::vector<std::int64_t>;
+
+    std::unordered_map<const Value*, Lanes> m_vals{};
+
+public:
+    std::int64_t run(const Function& func, std::vector<std::int64_t> args) {
+        std::size_t idx = 0;
+        for (auto&& arg : func.args())
+            m_vals[&arg] = {wrap(arg.type(), args.at(idx++))};
+        //
+        const BasicBlock* prev = nullptr;
+        const auto* bb = &func.front();
+        for (std::size_t steps = 0; steps < 100000; ++steps) {
+            //! NOTE: phis are evaluated at once
+            std::vector<std::pair<const Instr*, Lanes>> phis{};
+            for (auto&& phi : bb->phis()) {
+                const auto& phi_instr = static_cast<const PhiInstr&>(phi);
+                phis.emplace_back(&phi, get(phi_instr.incoming(prev)));
+            }
+            for (auto&& [phi, val] : phis) m_vals[phi] = val;
+            //
+            const BasicBlock* next = nullptr;
+            for (auto it = bb->phis_end(); next == nullptr; ++it) {
+                const auto& instr = *it;
+                switch (instr.opcode()) {
+                    case Opcode::RET:
+                        return get(instr.get_input(0)).front();
+                    case Opcode::BRANCH:
+                        next = static_cast<const BranchInstr&>(instr).dst();
+                        break;
+                    case Opcode::IF: {
+                        const auto& cond = static_cast<const IfInstr&>(instr);
+                        next = get(cond.cond()).front() ? cond.true_bb()
+                                                        : cond.false_bb();
+                        break;
+                    }
+                    case Opcode::SWITCH: {
+                        const auto& term =
+                            static_cast<const SwitchInstr&>(instr);
+                        next = term.target(get(term.cond()).front());
+                        break;
+                    }
+                    default:
+                        m_vals[&instr] = eval(instr);
+                }
+            }
+            prev = std::exchange(bb, next);
+        }
+        ADD_FAILURE() << "function doesn't return";
+        return 0;
+    }
+
+private:
+    const Lanes& get(const Value* val) const { return m_vals.at(val); }
+
+    static std::int64_t wrap(TypeId type, std::int64_t val) {
+        switch (element_type(type)) {
+            case TypeId::I1:
+                return val & 1;
+            case TypeId::I8:
+                return static_cast<std::int8_t>(val);
+            case TypeId::I16:
+                return static_cast<std::int16_t>(val);
+            case TypeId::I32:
+                return static_cast<std::int32_t>(val);
+            default:
+                return val;
+        }
+    }
+
+    static std::int64_t apply(Opcode opc, std::int64_t lhs, std::int64_t rhs) {
+        //! NOTE: wrapping arithmetic
+        auto ulhs = static_cast<std::uint64_t>(lhs);
+        auto urhs = static_cast<std::uint64_t>(rhs);
+        switch (opc) {
+            case Opcode::ADD:
+                return static_cast<std::int64_t>(ulhs + urhs);
+            case Opcode::SUB:
+                return static_cast<std::int64_t>(ulhs - urhs);
+            case Opcode::MUL:
+                return static_cast<std::int64_t>(ulhs * urhs);
+            case Opcode::DIV:
+                return lhs / rhs;
+            case Opcode::SHR:
+                return lhs >> rhs;
+            case Opcode::XOR:
+                return lhs ^ rhs;
+            case Opcode::EQ:
+            case Opcode::LE:
+            case Opcode::GE:
+                return compare(opc, lhs, rhs);
+            default:
+                ADD_FAILURE() << "unexpected opcode";
+                return 0;
+        }
+    }
+
+    Lanes eval(const Instr& instr) const {
+        auto type = instr.type();
+        switch (instr.opcode()) {
+            case Opcode::CONST:
+                return {const_value(instr)};
+            case Opcode::SPLAT:
+                return Lanes(lanes(type), get(instr.get_input(0)).front());
+            case Opcode::EXTRACT:
+                return {get(instr.get_input(0))
+                            .at(lane_index(instr.get_input(1)))};
+            case Opcode::INSERT: {
+                auto res = get(instr.get_input(0));
+                res.at(lane_index(instr.get_input(2))) =
+                    get(instr.get_input(1)).front();
+                return res;
+            }
+            case Opcode::NEG:
+            case Opcode::CAST: {
+                auto res = get(instr.get_input(0));
+                bool is_neg = instr.opcode() == Opcode::NEG;
+                for (auto& val : res) val = wrap(type, is_neg ? -val : val);
+                return res;
+            }
+            default: {
+                const auto& lhs = get(instr.get_input(0));
+                const auto& rhs = get(instr.get_input(1));
+                EXPECT_EQ(lhs.size(), rhs.size());
+                Lanes res(lhs.size());
+                for (std::size_t idx = 0; idx < res.size(); ++idx)
+                    res[idx] = wrap(type, apply(instr.opcode(), lhs[idx],
+                                                rhs[idx]));
+                return res;
+            }
+        }
+    }
+};
+
+}  // namespace jj_vm::ir::testing
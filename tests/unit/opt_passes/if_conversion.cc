@@ -0,0 +1,236 @@
+#include "opt_passes/if_conversion.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string_view>
+
+#include "../IR/ir_helpers.hh"
+
+namespace jj_vm::ir::testing {
+
+static constexpr std::string_view kDiamond = R"(
+func diamond(v0: i64, v1: i64) -> i64 {
+bb0:
+    v2 = ge i64 v0, v1
+    if v2, bb1, bb2
+bb1:
+    v4 = add i64 v0, v1
+    jmp bb3
+bb2:
+    v5 = sub i64 v0, v1
+    jmp bb3
+bb3:
+    v3 = phi i64 [v4, bb1], [v5, bb2]
+    ret v3
+}
+)";
+
+static std::size_t convert(Function& func) {
+    jj_vm::passes::IfConversion pass{};
+    pass.run(&func);
+    return pass.converted();
+}
+
+TEST(if_conversion, diamond) {
+    expect_transformed(convert, kDiamond, R"(
+func diamond(v0: i64, v1: i64) -> i64 {
+bb0:
+    v2 = ge i64 v0, v1
+    v4 = add i64 v0, v1
+    v5 = sub i64 v0, v1
+    v3 = select i64 v2, v4, v5
+    ret v3
+}
+)");
+    //
+    auto funcs = IRParser::parse(kDiamond);
+    auto& func = *funcs.front();
+    jj_vm::passes::IfConversion{}.run(&func);
+    ASSERT_EQ(func.size(), 1);
+    EXPECT_EQ(func.front().preds_num(), 0);
+    EXPECT_EQ(func.front().succs_num(), 0);
+}
+
+TEST(if_conversion, triangle) {
+    static constexpr std::string_view kAbs = R"(
+func abs(v0: i64) -> i64 {
+bb0:
+    v1 = const i64 0
+    v2 = add i64 v0, v1
+    v3 = ge i64 v2, v1
+    if v3, bb2, bb1
+bb1:
+    v4 = neg i64 v2
+    jmp bb2
+bb2:
+    v5 = phi i64 [v2, bb0], [v4, bb1]
+    ret v5
+}
+)";
+    expect_transformed(convert, kAbs, R"(
+func abs(v0: i64) -> i64 {
+bb0:
+    v1 = const i64 0
+    v2 = add i64 v0, v1
+    v3 = ge i64 v2, v1
+    v4 = neg i64 v2
+    v5 = select i64 v3, v2, v4
+    ret v5
+}
+)");
+    //! NOTE: the arm is on the true edge
+    expect_transformed(convert, replace(kAbs, "bb2, bb1", "bb1, bb2"),
+                       R"(
+func abs(v0: i64) -> i64 {
+bb0:
+    v1 = const i64 0
+    v2 = add i64 v0, v1
+    v3 = ge i64 v2, v1
+    v4 = neg i64 v2
+    v5 = select i64 v3, v4, v2
+    ret v5
+}
+)");
+}
+
+TEST(if_conversion, nested) {
+    //! NOTE: clamp(x, lo, hi), the inner triangle makes the arm of the outer
+    //!       diamond after its join is merged
+    expect_transformed(convert, R"(
+func clamp(v0: i64, v1: i64, v2: i64) -> i64 {
+bb0:
+    v3 = const i64 0
+    v4 = add i64 v0, v3
+    v5 = add i64 v1, v3
+    v6 = add i64 v2, v3
+    v7 = le i64 v4, v5
+    if v7, bb1, bb2
+bb1:
+    jmp bb5
+bb2:
+    v8 = ge i64 v4, v6
+    if v8, bb3, bb4
+bb3:
+    jmp bb4
+bb4:
+    v9 = phi i64 [v6, bb3], [v4, bb2]
+    jmp bb5
+bb5:
+    v10 = phi i64 [v5, bb1], [v9, bb4]
+    ret v10
+}
+)",
+                       R"(
+func clamp(v0: i64, v1: i64, v2: i64) -> i64 {
+bb0:
+    v3 = const i64 0
+    v4 = add i64 v0, v3
+    v5 = add i64 v1, v3
+    v6 = add i64 v2, v3
+    v7 = le i64 v4, v5
+    v8 = ge i64 v4, v6
+    v9 = select i64 v8, v6, v4
+    v10 = select i64 v7, v5, v9
+    ret v10
+}
+)",
+                       2);
+}
+
+TEST(if_conversion, loop_body) {
+    static constexpr std::string_view kLoop = R"(
+func loop(v0: i64) -> i64 {
+bb0:
+    v1 = const i64 0
+    v2 = const i64 1
+    jmp bb1
+bb1:
+    v3 = phi i64 [v1, bb0], [v9, bb4]
+    v4 = phi i64 [v1, bb0], [v8, bb4]
+    v5 = le i64 v3, v0
+    if v5, bb2, bb5
+bb2:
+    v6 = xor i64 v3, v2
+    v7 = ge i64 v6, v3
+    if v7, bb3, bb4
+bb3:
+    v10 = sub i64 v4, v6
+    jmp bb4
+bb4:
+    v8 = phi i64 [v10, bb3], [v4, bb2]
+    v9 = add i64 v3, v2
+    jmp bb1
+bb5:
+    ret v4
+}
+)";
+    //! NOTE: the latch is merged into the head of the triangle
+    expect_transformed(convert, kLoop, R"(
+func loop(v0: i64) -> i64 {
+bb0:
+    v1 = const i64 0
+    v2 = const i64 1
+    jmp bb1
+bb1:
+    v3 = phi i64 [v1, bb0], [v9, bb2]
+    v4 = phi i64 [v1, bb0], [v8, bb2]
+    v5 = le i64 v3, v0
+    if v5, bb2, bb3
+bb2:
+    v6 = xor i64 v3, v2
+    v7 = ge i64 v6, v3
+    v10 = sub i64 v4, v6
+    v8 = select i64 v7, v10, v4
+    v9 = add i64 v3, v2
+    jmp bb1
+bb3:
+    ret v4
+}
+)");
+    //
+    auto funcs = IRParser::parse(kLoop);
+    auto& func = *funcs.front();
+    jj_vm::passes::IfConversion{}.run(&func);
+    auto& header = *std::next(func.begin());
+    auto& body = *std::next(func.begin(), 2);
+    ASSERT_EQ(header.preds_num(), 2);
+    EXPECT_EQ(header.preds()[1], &body);
+    ASSERT_EQ(body.succs_num(), 1);
+    EXPECT_EQ(body.succs().front(), &header);
+    EXPECT_EQ(body.preds().front(), &header);
+}
+
+TEST(if_conversion, cost_threshold) {
+    //! NOTE: two hoisted instructions & the select
+    expect_unchanged(
+        [](Function& func) {
+            jj_vm::passes::IfConversion pass{2};
+            pass.run(&func);
+            return pass.converted();
+        },
+        kDiamond);
+    auto funcs = IRParser::parse(kDiamond);
+    jj_vm::passes::IfConversion pass{3};
+    pass.run(funcs.front().get());
+    EXPECT_EQ(pass.converted(), 1);
+}
+
+TEST(if_conversion, not_candidates) {
+    //! NOTE: trapping instruction is executed only if its arm is taken
+    expect_unchanged(convert, replace(kDiamond, "add i64", "div i64"));
+    //! NOTE: side effects
+    expect_unchanged(convert, replace(kDiamond, "v5 = sub i64 v0, v1",
+                                      "v6 = alloc ptr v0\n"
+                                      "    store v6, v1\n"
+                                      "    v5 = sub i64 v0, v1"));
+    //! NOTE: join has the pred outside of the diamond
+    expect_unchanged(convert, replace(replace(kDiamond, "if v2, bb1, bb2",
+                                              "v6 = eq i64 v0, v1\n"
+                                              "    if v6, bb3, bb4\n"
+                                              "bb4:\n"
+                                              "    if v2, bb1, bb2"),
+                                      "[v5, bb2]", "[v5, bb2], [v2, bb0]"));
+}
+
+}  // namespace jj_vm::ir::testing
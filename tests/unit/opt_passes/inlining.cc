@@ -4,9 +4,11 @@
 
 #include <cstdint>
 
+#include "../IR/ir_helpers.hh"
 #include "../graph/builder.hh"
 
 using namespace jj_vm::ir;
+using jj_vm::ir::testing::to_string;
 
 namespace jj_vm::testing {
 
@@ -249,4 +251,25 @@ TEST_F(InliningTest1, lecture) {
         EXPECT_EQ(phi_vars[1].second, bb3);
     }
 }
+
+TEST_F(InliningTest1, rollback_over_budget) {
+    build();
+    auto caller_before = to_string(m_caller);
+    auto callee_before = to_string(m_callee);
+    //
+    //! NOTE: caller would have 15 instructions after inlining
+    jj_vm::passes::Inlining pass{8};
+    pass.run(&m_caller);
+    //
+    EXPECT_EQ(m_caller.journal(), nullptr);
+    EXPECT_EQ(to_string(m_caller), caller_before);
+    EXPECT_EQ(to_string(m_callee), callee_before);
+    EXPECT_EQ(m_caller.size(), 2);
+    EXPECT_EQ(m_callee.size(), 4);
+    //
+    //! NOTE: successful attempt after the rolled back one
+    run();
+    EXPECT_EQ(m_caller.size(), 6);
+    EXPECT_TRUE(m_callee.empty());
+}
 }  // namespace jj_vm::testing
@@ -0,0 +1,125 @@
+#include "opt_passes/load_elimination.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string_view>
+
+#include "../IR/ir_helpers.hh"
+
+namespace jj_vm::ir::testing {
+
+static std::size_t run(Function& func) {
+    jj_vm::passes::LoadElimination pass{};
+    pass.run(&func);
+    return pass.eliminated();
+}
+
+static constexpr std::string_view kForwarding = R"(
+func forwarding(v0: ptr, v1: i64) -> i64 {
+bb0:
+    v2 = const i64 8
+    v3 = gep ptr v0, v2
+    store v0, v1
+    store v3, v2
+    v4 = load i64 v0
+    v5 = load i32 v3
+    v6 = cast i64 v5
+    v7 = add i64 v4, v6
+    ret v7
+}
+)";
+
+TEST(load_elimination, store_forwarding) {
+    auto funcs = IRParser::parse(kForwarding);
+    auto& func = *funcs.front();
+    //! NOTE: the second load reads the part of the stored value
+    EXPECT_EQ(run(func), 1) << to_string(func);
+    EXPECT_EQ(count(func, Opcode::LOAD), 1);
+    EXPECT_EQ(count(func, Opcode::STORE), 2);
+    //
+    auto& add = *std::prev(func.front().end(), 2);
+    ASSERT_EQ(add.opcode(), Opcode::ADD);
+    EXPECT_EQ(add.get_input(0), &*std::next(func.args().begin()));
+}
+
+static constexpr std::string_view kRedundant = R"(
+func ext(v0: i64) -> i64 {
+bb0:
+    ret v0
+}
+
+func redundant(v0: ptr, v1: i1) -> i64 {
+bb0:
+    v2 = const i64 8
+    v3 = alloc ptr v2
+    v4 = load i64 v0
+    store v3, v2
+    v5 = load i64 v0
+    if v1, bb1, bb2
+bb1:
+    v6 = load i64 v0
+    v7 = call i64 @ext(v6)
+    v8 = load i64 v0
+    v9 = add i64 v7, v8
+    jmp bb3
+bb2:
+    store v0, v2
+    jmp bb3
+bb3:
+    v10 = phi i64 [v9, bb1], [v2, bb2]
+    v11 = load i64 v0
+    v12 = add i64 v4, v5
+    v13 = add i64 v12, v10
+    v14 = add i64 v13, v11
+    ret v14
+}
+)";
+
+TEST(load_elimination, redundant_loads) {
+    auto funcs = IRParser::parse(kRedundant);
+    auto& func = *funcs[1];
+    //! NOTE: the store to the local alloc and the branch keep the memory,
+    //        loads after the call and at the join stay
+    EXPECT_EQ(run(func), 2) << to_string(func);
+    EXPECT_EQ(count(func, Opcode::LOAD), 3);
+    for (auto&& instr : func.front()) {
+        if (instr.opcode() == Opcode::ADD) {
+            EXPECT_EQ(instr.get_input(0), instr.get_input(1));
+        }
+    }
+    //
+    //! NOTE: fixed point
+    EXPECT_EQ(run(func), 0);
+    auto reparsed = IRParser::parse(to_string(*funcs[0]) + to_string(func));
+    EXPECT_EQ(count(*reparsed[1], Opcode::LOAD), 3);
+}
+
+TEST(load_elimination, not_redundant) {
+    static constexpr std::string_view kText = R"(
+func not_redundant(v0: ptr, v1: ptr, v2: i64) -> i64 {
+bb0:
+    v3 = const i32 1
+    v4 = gep ptr v0, v2
+    store v0, v2
+    v5 = load i32 v0
+    v6 = load i64 v1
+    store v1, v2
+    v7 = load i64 v0
+    store v4, v3
+    v8 = load i64 v0
+    v9 = cast i64 v5
+    v10 = add i64 v9, v6
+    v11 = add i64 v10, v7
+    v12 = add i64 v11, v8
+    ret v12
+}
+)";
+    //! NOTE: different type, unknown params & unknown offset
+    auto funcs = IRParser::parse(kText);
+    auto& func = *funcs.front();
+    EXPECT_EQ(run(func), 0) << to_string(func);
+    EXPECT_EQ(count(func, Opcode::LOAD), 4);
+}
+
+}  // namespace jj_vm::ir::testing
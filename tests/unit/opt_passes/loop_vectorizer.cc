@@ -0,0 +1,179 @@
+#include "opt_passes/loop_vectorizer.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "IR/ir_parser.hh"
+#include "IR/structural_hash.hh"
+#include "evaluator.hh"
+
+namespace jj_vm::ir::testing {
+
+//! NOTE: i from 1 to n, s += i * i
+static constexpr std::string_view kSumSquares = R"(func sum_sq(v0: i32) -> i32 {
+bb0:
+    v1 = const i32 0
+    v2 = const i32 1
+    jmp bb1
+bb1:
+    v3 = phi i32 [v2, bb0], [v7, bb2]
+    v4 = phi i32 [v1, bb0], [v6, bb2]
+    v5 = le i32 v3, v0
+    if v5, bb2, bb3
+bb2:
+    v8 = mul i32 v3, v3
+    v6 = add i32 v4, v8
+    v7 = add i32 v3, v2
+    jmp bb1
+bb3:
+    ret v4
+}
+)";
+
+static constexpr std::string_view kFact = R"(func fact(v0: i32) -> i64 {
+bb0:
+    v1 = const i64 1
+    v2 = const i32 2
+    jmp bb1
+bb1:
+    v3 = phi i32 [v2, bb0], [v7, bb2]
+    v4 = phi i64 [v1, bb0], [v6, bb2]
+    v5 = le i32 v3, v0
+    if v5, bb2, bb3
+bb2:
+    v8 = cast i64 v3
+    v6 = mul i64 v4, v8
+    v9 = const i32 1
+    v7 = add i32 v3, v9
+    jmp bb1
+bb3:
+    ret v4
+}
+)";
+
+//! NOTE: step 3, "ge n, i" check, invariant operand & two reductions
+static constexpr std::string_view kXorSum = R"(func xor_sum(v0: i64) -> i64 {
+bb0:
+    v1 = const i64 0
+    v2 = const i64 3
+    v3 = const i64 5
+    jmp bb1
+bb1:
+    v4 = phi i64 [v1, bb0], [v8, bb2]
+    v5 = phi i64 [v1, bb0], [v9, bb2]
+    v6 = phi i64 [v3, bb0], [v10, bb2]
+    v7 = ge i64 v0, v4
+    if v7, bb2, bb3
+bb2:
+    v11 = sub i64 v4, v0
+    v12 = mul i64 v11, v3
+    v9 = xor i64 v5, v12
+    v10 = add i64 v11, v6
+    v8 = add i64 v4, v2
+    jmp bb1
+bb3:
+    v13 = mul i64 v5, v6
+    v14 = add i64 v13, v4
+    ret v14
+}
+)";
+
+static std::int64_t evaluate(const Function& func, std::int64_t arg) {
+    return Evaluator{}.run(func, {arg});
+}
+
+/// Results of the vectorized function (and of its reparsed text) match
+/// the original ones, n covers empty loop, vector loop only & epilogue
+static void expect_same(std::string_view text, std::size_t vector_bits,
+                        std::size_t vectorized) {
+    auto orig = IRParser::parse(text);
+    auto funcs = IRParser::parse(text);
+    auto& func = *funcs.front();
+    //
+    jj_vm::passes::LoopVectorizer pass{vector_bits};
+    pass.run(&func);
+    ASSERT_EQ(pass.vectorized(), vectorized) << to_string(func);
+    //
+    auto reparsed = IRParser::parse(to_string(func));
+    for (std::int64_t n = -2; n < 14; ++n) {
+        auto expected = evaluate(*orig.front(), n);
+        EXPECT_EQ(evaluate(func, n), expected) << n << "\n" << to_string(func);
+        EXPECT_EQ(evaluate(*reparsed.front(), n), expected) << n;
+    }
+}
+
+TEST(loop_vectorizer, sum_of_squares) {
+    auto funcs = IRParser::parse(kSumSquares);
+    auto& func = *funcs.front();
+    jj_vm::passes::LoopVectorizer pass{};
+    pass.run(&func);
+    ASSERT_EQ(pass.vectorized(), 1);
+    //
+    //! NOTE: 4 blocks of the vector loop, i32 vectors of SSE
+    EXPECT_EQ(func.size(), 8);
+    EXPECT_EQ(count(func, Opcode::EXTRACT), 4);
+    for (auto&& bb : func) {
+        for (auto&& instr : bb) {
+            if (is_vector(instr.type())) {
+                EXPECT_EQ(instr.type(), TypeId::V4I32);
+            }
+        }
+    }
+    //
+    expect_same(kSumSquares, jj_vm::passes::LoopVectorizer::kSSEBits, 1);
+    expect_same(kSumSquares, jj_vm::passes::LoopVectorizer::kAVX2Bits, 1);
+}
+
+TEST(loop_vectorizer, widest_type) {
+    //! NOTE: i32 & i64 lanes: v2i32 doesn't exist, v4i32 & v4i64 of AVX2 do
+    expect_same(kFact, jj_vm::passes::LoopVectorizer::kSSEBits, 0);
+    expect_same(kFact, jj_vm::passes::LoopVectorizer::kAVX2Bits, 1);
+}
+
+TEST(loop_vectorizer, step_and_invariants) {
+    expect_same(kXorSum, jj_vm::passes::LoopVectorizer::kSSEBits, 1);
+    expect_same(kXorSum, jj_vm::passes::LoopVectorizer::kAVX2Bits, 1);
+}
+
+TEST(loop_vectorizer, not_candidates) {
+    auto replace = [](std::string_view text, std::string_view from,
+                      std::string_view to) {
+        std::string res{text};
+        auto pos = res.find(from);
+        EXPECT_NE(pos, std::string::npos);
+        return res.replace(pos, from.size(), to);
+    };
+    auto cast_invariant = [&replace](std::string_view type) {
+        auto text = replace(kSumSquares, "v2 = const i32 1",
+                            "v2 = const i32 1\n    v10 = const " +
+                                std::string{type} + " 7");
+        return replace(text, "v8 = mul i32 v3, v3",
+                       "v11 = cast i32 v10\n    v8 = mul i32 v3, v11");
+    };
+    for (auto&& text : {
+             //! NOTE: reduction value is used by the loop
+             replace(kSumSquares, "v3, v3", "v3, v4"),
+             //! NOTE: decreasing induction variable
+             replace(kSumSquares, "add i32 v3, v2", "sub i32 v3, v2"),
+             //! NOTE: unsupported reduction
+             replace(kSumSquares, "add i32 v4, v8", "sub i32 v4, v8"),
+             //! NOTE: check isn't "le i, n"
+             replace(kSumSquares, "v5 = le i32 v3, v0", "v5 = le i32 v0, v3"),
+             //! NOTE: casts of invariants of other widths: i16 has no
+             //!       vector of 4 lanes, i64 ones are wider than SSE
+             cast_invariant("i16"),
+             cast_invariant("i64"),
+         }) {
+        auto orig = IRParser::parse(text);
+        auto funcs = IRParser::parse(text);
+        jj_vm::passes::LoopVectorizer pass{};
+        pass.run(funcs.front().get());
+        EXPECT_EQ(pass.vectorized(), 0) << text;
+        EXPECT_TRUE(structurally_equal(*orig.front(), *funcs.front()));
+    }
+}
+
+}  // namespace jj_vm::ir::testing
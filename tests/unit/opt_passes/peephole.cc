@@ -181,4 +181,102 @@ TEST_F(PeepholeTestBuilder, XOR3) {
     ASSERT_EQ(last_operation.rhs(), another_val);
 }
 
+TEST_F(PeepholeTestBuilder, MUL_commutative) {
+    init_test(1);
+
+    auto bb0 = get_bb(0);
+    m_builder.set_insert_point(bb0);
+
+    auto *one = m_builder.create<jj_vm::ir::ConstI64>(1);
+    auto *val = m_builder.create<jj_vm::ir::ConstI64>(32);
+    auto *another_val = m_builder.create<jj_vm::ir::ConstI64>(42);
+    auto *sum = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::ADD,
+                                                      val, another_val);
+    //! NOTE: constant is lhs operand of commutative operation
+    auto *mul = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::MUL,
+                                                      one, sum);
+    auto *add = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::ADD,
+                                                      mul, another_val);
+    //
+    m_pass.run(m_func.get());
+
+    ASSERT_EQ(bb0->size(), 5);
+    ASSERT_EQ(add->lhs(), sum);
+    ASSERT_EQ(add->rhs(), another_val);
+}
+
+TEST_F(PeepholeTestBuilder, PARAM_operands) {
+    init_test(1);
+
+    auto bb0 = get_bb(0);
+    m_builder.set_insert_point(bb0);
+
+    auto *arg = m_func->create<jj_vm::ir::Param, jj_vm::ir::Type>(
+        jj_vm::ir::TypeId::I64);
+    auto *one = m_builder.create<jj_vm::ir::ConstI64>(1);
+    auto *val = m_builder.create<jj_vm::ir::ConstI64>(32);
+    //! NOTE: param is lhs & rhs operand of commutative operations
+    auto *lmul = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::MUL,
+                                                       arg, val);
+    auto *rmul = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::MUL,
+                                                       one, arg);
+    auto *shr = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::SHR,
+                                                      val, arg);
+    auto *xor_ = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::XOR,
+                                                       arg, arg);
+    auto *add = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::ADD,
+                                                      lmul, rmul);
+    auto *sum = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::ADD,
+                                                      shr, xor_);
+    m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::ADD, add, sum);
+    //
+    m_pass.run(m_func.get());
+
+    ASSERT_EQ(lmul->lhs(), arg);
+    ASSERT_EQ(lmul->rhs(), val);
+    ASSERT_EQ(add->lhs(), lmul);
+    ASSERT_EQ(add->rhs(), arg);
+    ASSERT_EQ(shr->lhs(), val);
+    ASSERT_EQ(shr->rhs(), arg);
+    ASSERT_EQ(sum->lhs(), shr);
+    ASSERT_EQ(sum->rhs(), m_func->get_const<int64_t>(0));
+}
+
+TEST_F(PeepholeTestBuilder, SELECT) {
+    init_test(1);
+
+    auto bb0 = get_bb(0);
+    m_builder.set_insert_point(bb0);
+
+    auto *lval = m_builder.create<jj_vm::ir::ConstI64>(32);
+    auto *rval = m_builder.create<jj_vm::ir::ConstI64>(42);
+    auto *cmp = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::EQ,
+                                                      lval, rval);
+    auto *cond = m_builder.create<jj_vm::ir::CastInstr>(
+        jj_vm::ir::TypeId::I1, cmp);
+    auto *one = m_builder.create<jj_vm::ir::ConstI1>(true);
+    auto *zero = m_builder.create<jj_vm::ir::ConstI1>(false);
+    //! NOTE: select of the same values & select of the flag
+    auto *same = m_builder.create<jj_vm::ir::SelectInstr>(cond, lval, lval);
+    auto *flag = m_builder.create<jj_vm::ir::SelectInstr>(cond, one, zero);
+    auto *inverted = m_builder.create<jj_vm::ir::SelectInstr>(cond, zero, one);
+    auto *ext = m_builder.create<jj_vm::ir::CastInstr>(
+        jj_vm::ir::TypeId::I64, flag);
+    auto *add = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::ADD,
+                                                      same, ext);
+    auto *inverted_ext = m_builder.create<jj_vm::ir::CastInstr>(
+        jj_vm::ir::TypeId::I64, inverted);
+    auto *sum = m_builder.create<jj_vm::ir::BinInstr>(jj_vm::ir::Opcode::ADD,
+                                                      add, inverted_ext);
+    m_builder.create<jj_vm::ir::RetInstr>(sum);
+    //
+    m_pass.run(m_func.get());
+
+    ASSERT_EQ(add->lhs(), lval);
+    ASSERT_EQ(ext->get_input(0), cond);
+    //! NOTE: inverted flag is kept
+    ASSERT_EQ(inverted_ext->get_input(0), inverted);
+    ASSERT_EQ(bb0->size(), 12);
+}
+
 }  // namespace jj_vm::testing
@@ -0,0 +1,297 @@
+#include "opt_passes/scalar_replacement.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <iterator>
+
+#include "../IR/ir_helpers.hh"
+#include "opt_passes/inlining.hh"
+
+namespace jj_vm::ir::testing {
+
+static std::size_t run(Function& func) {
+    jj_vm::passes::ScalarReplacement pass{};
+    pass.run(&func);
+    return pass.replaced();
+}
+
+TEST(scalar_replacement, fields) {
+    expect_transformed(run, R"(
+func fields(v0: i64, v1: i32) -> i64 {
+bb0:
+    v2 = const i64 16
+    v3 = alloc ptr v2
+    v4 = null_check ptr v3
+    v5 = const i64 8
+    v6 = gep ptr v3, v5
+    store v3, v0
+    store v6, v1
+    v7 = load i32 v6
+    v8 = cast i64 v7
+    v9 = load i64 v3
+    v10 = add i64 v8, v9
+    ret v10
+}
+)",
+                       R"(
+func fields(v0: i64, v1: i32) -> i64 {
+bb0:
+    v2 = const i64 16
+    v5 = const i64 8
+    v8 = cast i64 v1
+    v10 = add i64 v8, v0
+    ret v10
+}
+)");
+}
+
+TEST(scalar_replacement, diamond) {
+    //! NOTE: the second field isn't stored, it is zero
+    expect_transformed(run, R"(
+func diamond(v0: i1) -> i64 {
+bb0:
+    v1 = const i64 16
+    v2 = alloc ptr v1
+    v3 = const i64 8
+    v4 = gep ptr v2, v3
+    store v2, v3
+    if v0, bb1, bb2
+bb1:
+    store v2, v1
+    jmp bb3
+bb2:
+    jmp bb3
+bb3:
+    v5 = load i64 v2
+    v6 = load i64 v4
+    v7 = add i64 v5, v6
+    ret v7
+}
+)",
+                       R"(
+func diamond(v0: i1) -> i64 {
+bb0:
+    v8 = const i64 0
+    v1 = const i64 16
+    v3 = const i64 8
+    if v0, bb1, bb2
+bb1:
+    jmp bb3
+bb2:
+    jmp bb3
+bb3:
+    v5 = phi i64 [v1, bb1], [v3, bb2]
+    v7 = add i64 v5, v8
+    ret v7
+}
+)");
+}
+
+TEST(scalar_replacement, loop) {
+    //! NOTE: the store to the other alloc makes the trivial phi of v2
+    expect_transformed(run, R"(
+func loop(v0: i64) -> i64 {
+bb0:
+    v1 = const i64 8
+    v2 = alloc ptr v1
+    v3 = alloc ptr v1
+    v4 = const i64 0
+    store v2, v4
+    store v3, v0
+    jmp bb1
+bb1:
+    v5 = load i64 v2
+    v6 = load i64 v3
+    v7 = le i64 v5, v6
+    if v7, bb2, bb3
+bb2:
+    v8 = const i64 1
+    v9 = add i64 v5, v8
+    store v2, v9
+    jmp bb1
+bb3:
+    v10 = load i64 v2
+    ret v10
+}
+)",
+                       R"(
+func loop(v0: i64) -> i64 {
+bb0:
+    v1 = const i64 8
+    v4 = const i64 0
+    jmp bb1
+bb1:
+    v5 = phi i64 [v4, bb0], [v9, bb2]
+    v7 = le i64 v5, v0
+    if v7, bb2, bb3
+bb2:
+    v8 = const i64 1
+    v9 = add i64 v5, v8
+    jmp bb1
+bb3:
+    ret v5
+}
+)",
+                       2);
+}
+
+TEST(scalar_replacement, alloc_in_loop) {
+    //! NOTE: every iteration loads the fresh slot, not the previous store
+    auto funcs = IRParser::parse(R"(
+func fresh(v0: i64) -> i64 {
+bb0:
+    v1 = const i64 0
+    v2 = const i64 1
+    v20 = const i64 8
+    jmp bb1
+bb1:
+    v3 = phi i64 [v1, bb0], [v9, bb2]
+    v10 = phi i64 [v1, bb0], [v6, bb2]
+    v4 = le i64 v3, v0
+    if v4, bb2, bb3
+bb2:
+    v8 = alloc ptr v20
+    v6 = load i64 v8
+    store v8, v3
+    v9 = add i64 v3, v2
+    jmp bb1
+bb3:
+    ret v10
+}
+)");
+    auto& func = *funcs.back();
+    ASSERT_EQ(run(func), 1) << to_string(func);
+    EXPECT_EQ(count(func, Opcode::PHI), 2) << to_string(func);
+    //
+    const auto& loaded = static_cast<const PhiInstr&>(*std::next(
+        std::next(func.begin())->begin()));
+    const auto* latch = &*std::next(func.begin(), 2);
+    const auto* zero = static_cast<const Instr*>(loaded.incoming(latch));
+    ASSERT_EQ(zero->opcode(), Opcode::CONST) << to_string(func);
+    EXPECT_EQ(const_value(*zero), 0);
+}
+
+TEST(scalar_replacement, not_candidates) {
+    static constexpr std::string_view kText = R"(
+func ext(v0: ptr) -> i64 {
+bb0:
+    v1 = load i64 v0
+    ret v1
+}
+
+func not_candidates(v0: i64, v1: i1) -> i64 {
+bb0:
+    v2 = const i64 16
+    v3 = const i32 1
+    v4 = const i64 4
+    v5 = alloc ptr v2
+    v6 = call i64 @ext(v5)
+    v7 = alloc ptr v2
+    v8 = gep ptr v7, v0
+    store v8, v0
+    v9 = alloc ptr v2
+    store v9, v0
+    v10 = load i32 v9
+    v11 = alloc ptr v2
+    v12 = gep ptr v11, v4
+    store v11, v0
+    store v12, v3
+    v13 = alloc ptr v2
+    if v1, bb1, bb2
+bb1:
+    store v13, v0
+    jmp bb2
+bb2:
+    v14 = load i64 v13
+    v15 = cast i64 v10
+    v16 = add i64 v14, v15
+    ret v16
+}
+)";
+    //! NOTE: escaped, unknown offset, different types of the slot,
+    //        overlapped slots & param as the phi input
+    auto funcs = IRParser::parse(kText);
+    auto& func = *funcs.back();
+    auto before = to_string(func);
+    EXPECT_EQ(run(func), 0);
+    EXPECT_EQ(to_string(func), before);
+}
+
+TEST(scalar_replacement, out_of_bounds) {
+    //! NOTE: the slot past the end, before the start & the alloc of the
+    //        unknown size
+    expect_unchanged(run, R"(
+func out_of_bounds(v0: i64, v1: i32) -> i64 {
+bb0:
+    v2 = const i64 8
+    v3 = const i64 -8
+    v4 = const i64 4
+    v5 = alloc ptr v2
+    v6 = gep ptr v5, v4
+    store v6, v0
+    v7 = alloc ptr v2
+    v8 = gep ptr v7, v3
+    store v8, v1
+    v9 = alloc ptr v0
+    store v9, v0
+    v10 = load i64 v6
+    v11 = load i32 v8
+    v12 = cast i64 v11
+    v13 = load i64 v9
+    v14 = add i64 v10, v12
+    v15 = add i64 v14, v13
+    ret v15
+}
+)");
+}
+
+TEST(scalar_replacement, after_inlining) {
+    static constexpr std::string_view kText = R"(
+func pair(v0: i64) -> i64 {
+bb0:
+    v1 = const i64 16
+    v2 = alloc ptr v1
+    v3 = call i64 @init(v2, v0)
+    v4 = const i64 8
+    v5 = gep ptr v2, v4
+    v6 = load i64 v2
+    v7 = load i64 v5
+    v8 = mul i64 v6, v7
+    ret v8
+}
+
+func init() -> i64 {
+bb0:
+    v0 = param ptr self
+    v1 = param i64 val
+    v2 = null_check ptr v0
+    v3 = const i64 8
+    v4 = gep ptr v0, v3
+    store v0, v1
+    v5 = add i64 v1, v1
+    store v4, v5
+    ret v1
+}
+)";
+    auto funcs = IRParser::parse(kText);
+    auto& func = *funcs.front();
+    //! NOTE: the alloc escapes to the call before inlining
+    EXPECT_EQ(run(func), 0);
+    jj_vm::passes::Inlining{}.run(&func);
+    ASSERT_EQ(count(func, Opcode::CALL), 0) << to_string(func);
+    //! NOTE: the callee entry isn't left as the pred
+    EXPECT_EQ(func.back().preds_num(), 1);
+    EXPECT_EQ(run(func), 1) << to_string(func);
+    for (auto opc : {Opcode::ALLOC, Opcode::LOAD, Opcode::STORE, Opcode::GEP,
+                     Opcode::NULL_CHECK})
+        EXPECT_EQ(count(func, opc), 0) << to_string(func);
+    //
+    auto& mul = *std::prev(func.back().end(), 2);
+    ASSERT_EQ(mul.opcode(), Opcode::MUL);
+    EXPECT_EQ(mul.get_input(0), &*func.args().begin());
+    EXPECT_EQ(static_cast<const Instr*>(mul.get_input(1))->opcode(),
+              Opcode::ADD);
+}
+
+}  // namespace jj_vm::ir::testing
@@ -0,0 +1,141 @@
+#include "opt_passes/switch_formation.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string_view>
+
+#include "../IR/ir_helpers.hh"
+
+namespace jj_vm::ir::testing {
+
+static constexpr std::string_view kChain = R"(
+func dispatch(v0: i32) -> i32 {
+bb0:
+    v1 = const i32 1
+    v2 = eq i32 v0, v1
+    if v2, bb3, bb1
+bb1:
+    v3 = const i32 4
+    v4 = eq i32 v0, v3
+    if v4, bb4, bb2
+bb2:
+    v5 = const i32 9
+    v6 = eq i32 v0, v5
+    if v6, bb3, bb5
+bb3:
+    v7 = phi i32 [v1, bb0], [v1, bb2]
+    ret v7
+bb4:
+    ret v3
+bb5:
+    ret v5
+}
+)";
+
+static std::size_t form(Function& func) {
+    jj_vm::passes::SwitchFormation pass{};
+    pass.run(&func);
+    return pass.formed();
+}
+
+TEST(switch_formation, chain) {
+    expect_transformed(form, kChain, R"(
+func dispatch(v0: i32) -> i32 {
+bb0:
+    v1 = const i32 1
+    v3 = const i32 4
+    v5 = const i32 9
+    switch v0, bb3, [v1: bb1, v3: bb2, v5: bb1]
+bb1:
+    v7 = phi i32 [v1, bb0]
+    ret v7
+bb2:
+    ret v3
+bb3:
+    ret v5
+}
+)");
+    //
+    auto funcs = IRParser::parse(kChain);
+    auto& func = *funcs.front();
+    jj_vm::passes::SwitchFormation{}.run(&func);
+    ASSERT_EQ(func.size(), 4);
+    auto& head = func.front();
+    ASSERT_EQ(head.back().opcode(), Opcode::SWITCH);
+    const auto& term = static_cast<const SwitchInstr&>(head.back());
+    EXPECT_EQ(term.cases_num(), 3);
+    EXPECT_EQ(term.target(9), term.case_target(0));
+    EXPECT_EQ(term.target(2), term.default_bb());
+    //! NOTE: the shared target is linked once
+    EXPECT_EQ(head.succs_num(), 3);
+    for (auto* succ : head.succs()) {
+        ASSERT_EQ(succ->preds_num(), 1);
+        EXPECT_EQ(succ->preds().front(), &head);
+    }
+}
+
+TEST(switch_formation, cut_chain) {
+    //! NOTE: the fourth compare is of the other value
+    expect_transformed(form,
+                       replace(kChain, "if v6, bb3, bb5",
+                               "if v6, bb3, bb6\n"
+                               "bb6:\n"
+                               "    v8 = const i32 7\n"
+                               "    v9 = eq i32 v3, v8\n"
+                               "    if v9, bb4, bb5"),
+                       R"(
+func dispatch(v0: i32) -> i32 {
+bb0:
+    v1 = const i32 1
+    v3 = const i32 4
+    v5 = const i32 9
+    switch v0, bb4, [v1: bb1, v3: bb2, v5: bb1]
+bb1:
+    v7 = phi i32 [v1, bb0]
+    ret v7
+bb2:
+    ret v3
+bb3:
+    ret v5
+bb4:
+    v8 = const i32 7
+    v9 = eq i32 v3, v8
+    if v9, bb2, bb3
+}
+)");
+    //! NOTE: values differ on edges to bb3, the chain is too short without
+    //!       the last compare
+    expect_unchanged(form, replace(kChain, "[v1, bb2]", "[v5, bb2]"));
+}
+
+TEST(switch_formation, not_candidates) {
+    //! NOTE: two cases only
+    expect_unchanged(form, R"(
+func two(v0: i32) -> i32 {
+bb0:
+    v1 = const i32 1
+    v2 = eq i32 v0, v1
+    if v2, bb2, bb1
+bb1:
+    v3 = const i32 4
+    v4 = eq i32 v0, v3
+    if v4, bb2, bb3
+bb2:
+    ret v1
+bb3:
+    ret v3
+}
+)");
+    //! NOTE: the link block has other instructions
+    expect_unchanged(form, replace(kChain, "v5 = const i32 9",
+                                   "v5 = const i32 9\n"
+                                   "    v8 = add i32 v0, v5"));
+    //! NOTE: the link block is reached from elsewhere
+    expect_unchanged(form, replace(kChain, "ret v3", "jmp bb2"));
+    //! NOTE: the repeated case value ends the chain
+    expect_unchanged(form,
+                     replace(kChain, "v5 = const i32 9", "v5 = const i32 1"));
+}
+
+}  // namespace jj_vm::ir::testing
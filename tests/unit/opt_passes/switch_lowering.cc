@@ -0,0 +1,195 @@
+#include "opt_passes/switch_lowering.hh"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "IR/ir_parser.hh"
+#include "evaluator.hh"
+#include "opt_passes/constant_fold.hh"
+
+namespace jj_vm::ir::testing {
+
+using jj_vm::passes::SwitchLowering;
+using jj_vm::passes::SwitchStrategy;
+
+/**
+ * @brief Switch by the param over cases (value, target), targets are bb2,
+ *        bb3... & return their numbers, the default bb1 returns -1 through
+ *        the phi
+ */
+static std::string make_switch(
+    std::string_view type,
+    const std::vector<std::pair<std::int64_t, std::size_t>>& cases) {
+    std::size_t targets_num = 0;
+    for (auto&& cur : cases)
+        targets_num = std::max(targets_num, cur.second + 1);
+    std::ostringstream os{};
+    os << "func f(v0: " << type << ") -> " << type << " {\nbb0:\n";
+    for (std::size_t idx = 0; idx < cases.size(); ++idx)
+        os << "    v" << idx + 1 << " = const " << type << " "
+           << cases[idx].first << "\n";
+    for (std::size_t idx = 0; idx < targets_num; ++idx)
+        os << "    v" << 100 + idx << " = const " << type << " " << idx
+           << "\n";
+    os << "    v98 = const " << type << " -1\n    switch v0, bb1, [";
+    for (std::size_t idx = 0; idx < cases.size(); ++idx)
+        os << (idx != 0 ? ", " : "") << "v" << idx + 1 << ": bb"
+           << cases[idx].second + 2;
+    os << "]\nbb1:\n    v99 = phi " << type << " [v98, bb0]\n    ret v99\n";
+    for (std::size_t idx = 0; idx < targets_num; ++idx)
+        os << "bb" << idx + 2 << ":\n    ret v" << 100 + idx << "\n";
+    os << "}\n";
+    return os.str();
+}
+
+static const SwitchInstr& switch_of(const Function& func) {
+    return static_cast<const SwitchInstr&>(func.front().back());
+}
+
+/// Links are symmetric & every block ends with the terminator
+static void expect_consistent(const Function& func) {
+    for (auto&& bb : func) {
+        EXPECT_NE(bb.back().opcode(), Opcode::SWITCH);
+        for (auto* succ : bb.succs()) {
+            auto preds = succ->preds();
+            EXPECT_NE(std::find(preds.begin(), preds.end(), &bb), preds.end());
+        }
+        for (auto&& phi : bb.phis())
+            EXPECT_EQ(phi.num_inputs(), bb.preds_num());
+    }
+}
+
+/// Lowered function & its reparsed text give the same results
+static void expect_lowered(std::string_view text, SwitchStrategy strategy,
+                           const std::vector<std::int64_t>& args) {
+    auto orig = IRParser::parse(text);
+    auto funcs = IRParser::parse(text);
+    auto& func = *funcs.front();
+    ASSERT_EQ(SwitchLowering::choose(switch_of(func)), strategy);
+    SwitchLowering pass{};
+    pass.run(&func);
+    ASSERT_EQ(pass.lowered(), 1) << to_string(func);
+    expect_consistent(func);
+    //
+    auto reparsed = IRParser::parse(to_string(func));
+    for (auto arg : args) {
+        auto expected = Evaluator{}.run(*orig.front(), {arg});
+        EXPECT_EQ(Evaluator{}.run(func, {arg}), expected) << arg;
+        EXPECT_EQ(Evaluator{}.run(*reparsed.front(), {arg}), expected) << arg;
+    }
+}
+
+static std::vector<std::int64_t> args_of(
+    const std::vector<std::pair<std::int64_t, std::size_t>>& cases) {
+    std::vector<std::int64_t> args{0, INT32_MIN, INT32_MAX};
+    for (auto&& cur : cases)
+        for (auto delta : {-1, 0, 1}) args.push_back(cur.first + delta);
+    return args;
+}
+
+TEST(switch_lowering, binary_search) {
+    const std::vector<std::pair<std::int64_t, std::size_t>> kCases{
+        {4096, 0}, {-100, 1}, {17, 2}, {250, 3},
+        {1000, 4}, {3, 5},    {70000, 1}};
+    expect_lowered(make_switch("i64", kCases), SwitchStrategy::BINARY_SEARCH,
+                   args_of(kCases));
+    expect_lowered(make_switch("i32", kCases), SwitchStrategy::BINARY_SEARCH,
+                   args_of(kCases));
+    //
+    //! NOTE: the path to any target has O(log(cases)) compares
+    auto funcs = IRParser::parse(make_switch("i64", kCases));
+    SwitchLowering{}.run(funcs.front().get());
+    std::size_t compares = 0;
+    for (auto&& bb : *funcs.front())
+        for (auto&& instr : bb)
+            compares += instr.opcode() == Opcode::EQ ||
+                        instr.opcode() == Opcode::LE;
+    EXPECT_EQ(compares, kCases.size() + 2);
+}
+
+TEST(switch_lowering, bit_tests) {
+    const std::vector<std::pair<std::int64_t, std::size_t>> kCases{
+        {10, 0}, {12, 0}, {14, 0}, {11, 1}, {13, 1}, {73, 2}};
+    expect_lowered(make_switch("i64", kCases), SwitchStrategy::BIT_TESTS,
+                   args_of(kCases));
+    expect_lowered(make_switch("i32", kCases), SwitchStrategy::BIT_TESTS,
+                   args_of(kCases));
+    //! NOTE: the highest bit of the mask
+    const std::vector<std::pair<std::int64_t, std::size_t>> kWide{
+        {-5, 0}, {58, 0}, {0, 1}};
+    expect_lowered(make_switch("i64", kWide), SwitchStrategy::BIT_TESTS,
+                   args_of(kWide));
+}
+
+TEST(switch_lowering, jump_table) {
+    //! NOTE: 4 cases of 6 values, 4 targets
+    const std::vector<std::pair<std::int64_t, std::size_t>> kCases{
+        {15, 0}, {10, 1}, {11, 2}, {13, 3}};
+    auto funcs = IRParser::parse(make_switch("i32", kCases));
+    auto& func = *funcs.front();
+    const auto& term = switch_of(func);
+    ASSERT_EQ(SwitchLowering::choose(term), SwitchStrategy::JUMP_TABLE);
+    //
+    auto table = SwitchLowering::jump_table(term);
+    EXPECT_EQ(table.m_min, 10);
+    ASSERT_EQ(table.m_targets.size(), 6);
+    for (std::int64_t val = 10; val <= 15; ++val)
+        EXPECT_EQ(table.m_targets[val - 10], term.target(val));
+    //
+    SwitchLowering pass{};
+    pass.run(&func);
+    EXPECT_EQ(pass.tables(), 1);
+    EXPECT_EQ(pass.lowered(), 0);
+    EXPECT_EQ(func.front().back().opcode(), Opcode::SWITCH);
+    //
+    //! NOTE: sparse cases are searched
+    auto sparse = kCases;
+    sparse.back().first = 30;
+    expect_lowered(make_switch("i32", sparse), SwitchStrategy::BINARY_SEARCH,
+                   args_of(sparse));
+}
+
+TEST(switch_lowering, default_cases) {
+    //! NOTE: cases jumping to the default are ignored, two cases left
+    auto text = make_switch("i64", {{1, 0}, {2, 1}, {3, 0}});
+    auto pos = text.find("v2: bb3");
+    ASSERT_NE(pos, std::string::npos);
+    text.replace(pos, 7, "v2: bb1");
+    expect_lowered(text, SwitchStrategy::BINARY_SEARCH, {0, 1, 2, 3, 4});
+    //
+    //! NOTE: all cases go to the default
+    auto funcs = IRParser::parse(
+        "func f(v0: i64) -> i64 {\nbb0:\n    v1 = const i64 1\n"
+        "    switch v0, bb1, [v1: bb1]\nbb1:\n"
+        "    v2 = phi i64 [v1, bb0]\n    ret v2\n}\n");
+    auto& func = *funcs.front();
+    SwitchLowering{}.run(&func);
+    EXPECT_EQ(func.front().back().opcode(), Opcode::BRANCH);
+    expect_consistent(func);
+}
+
+TEST(switch_lowering, folded_bounds) {
+    //! NOTE: range checks of the known cond are folded inclusive
+    const std::string_view kText =
+        "func f(v0: i64) -> i64 {\nbb0:\n    v1 = const i64 1\n"
+        "    v2 = const i64 2\n    v3 = const i64 3\n"
+        "    v4 = const i64 0\n    v5 = const i64 -1\n"
+        "    switch v1, bb1, [v1: bb2, v2: bb2, v3: bb2]\n"
+        "bb1:\n    ret v5\nbb2:\n    ret v4\n}\n";
+    auto funcs = IRParser::parse(kText);
+    auto& func = *funcs.front();
+    SwitchLowering pass{};
+    pass.run(&func);
+    ASSERT_EQ(pass.lowered(), 1);
+    jj_vm::passes::ConstantFold{}.run(&func);
+    EXPECT_EQ(Evaluator{}.run(func, {0}), 0) << to_string(func);
+}
+
+}  // namespace jj_vm::ir::testing
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "IR/basic_block.hh"
+#include "IR/function.hh"
+#include "IR/ir_builder.hh"
+#include "utils/side_table.hh"
+
+namespace jj_vm::testing {
+
+using namespace jj_vm::ir;
+
+class SideTableTest : public ::testing::Test {
+protected:
+    Function m_func{Type::create<TypeId::I64>(), "side_table"};
+    IRBuilder m_builder{};
+    BasicBlock* m_bb = nullptr;
+
+    SideTableTest() {
+        m_bb = m_func.create<BasicBlock>();
+        m_builder.set_insert_point(m_bb);
+    }
+};
+
+TEST_F(SideTableTest, dense_ids) {
+    auto* arg = m_func.create<Param, Type>(TypeId::I64);
+    auto* v0 = m_builder.create<ConstI64>(1);
+    auto* v1 = m_builder.create<BinInstr>(Opcode::ADD, v0, v0);
+    auto* detached = m_func.create<ConstI64>(2);
+    auto* bb1 = m_func.create<BasicBlock>();
+
+    EXPECT_EQ(arg->id(), 0);
+    EXPECT_EQ(v0->id(), 1);
+    EXPECT_EQ(v1->id(), 2);
+    EXPECT_EQ(detached->id(), 3);
+    EXPECT_EQ(m_func.values_num(), 4);
+
+    EXPECT_EQ(m_bb->id(), 0);
+    EXPECT_EQ(bb1->id(), 1);
+    EXPECT_EQ(m_func.blocks_num(), 2);
+}
+
+TEST_F(SideTableTest, renumber) {
+    auto* v0 = m_builder.create<ConstI64>(1);
+    auto* v1 = m_builder.create<ConstI64>(2);
+    auto* v2 = m_builder.create<BinInstr>(Opcode::ADD, v0, v1);
+    auto* bb1 = m_func.create<BasicBlock>();
+    auto* bb2 = m_func.create<BasicBlock>();
+
+    utils::SideTable<Value*, int> table{};
+    table[v0] = 0;
+
+    erase(v1->parent(), v0);
+    m_func.erase(bb1);
+    m_func.renumber();
+
+    //! NOTE: v1 takes the slot of erased v0, stale entry isn't its one
+    EXPECT_FALSE(table.contains(v1));
+    EXPECT_EQ(table.find(v1), table.end());
+    EXPECT_THROW(table.at(v1), std::out_of_range);
+
+    EXPECT_EQ(v1->id(), 0);
+    EXPECT_EQ(v2->id(), 1);
+    EXPECT_EQ(m_func.values_num(), 2);
+    EXPECT_EQ(bb2->id(), 1);
+    EXPECT_EQ(m_func.blocks_num(), 2);
+}
+
+TEST_F(SideTableTest, map_interface) {
+    std::vector<Instr*> instrs{};
+    for (int i = 0; i < 8; ++i)
+        instrs.push_back(m_builder.create<ConstI64>(i));
+
+    utils::SideTable<Value*, int> table{};
+    EXPECT_TRUE(table.empty());
+
+    //! NOTE: holes are skipped by iteration
+    table[instrs[5]] = 5;
+    table.insert({instrs[1], 1});
+    auto [it, inserted] = table.try_emplace(instrs[3], 3);
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(it->first, instrs[3]);
+    EXPECT_FALSE(table.insert({instrs[3], 42}).second);
+
+    EXPECT_EQ(table.size(), 3);
+    EXPECT_EQ(table.at(instrs[3]), 3);
+    EXPECT_THROW(table.at(instrs[0]), std::out_of_range);
+    EXPECT_EQ(table.find(instrs[7]), table.end());
+    EXPECT_TRUE(table.contains(instrs[1]));
+
+    std::vector<int> values{};
+    for (auto&& [key, val] : table) {
+        EXPECT_EQ(key, instrs[val]);
+        values.push_back(val);
+    }
+    EXPECT_EQ(values, (std::vector<int>{1, 3, 5}));
+
+    EXPECT_EQ(table.erase(instrs[3]), 1);
+    EXPECT_EQ(table.erase(instrs[3]), 0);
+    EXPECT_FALSE(table.contains(instrs[3]));
+    EXPECT_EQ(table.size(), 2);
+    EXPECT_EQ(++table.find(instrs[1]), table.find(instrs[5]));
+}
+
+}  // namespace jj_vm::testing